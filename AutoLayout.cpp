@@ -0,0 +1,887 @@
+/**
+ * @file AutoLayout.cpp
+ * @brief 自动布局类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "AutoLayout.h"
+#include "NodeScene.h"
+#include "Node.h"
+#include "Connection.h"
+#include "UndoCommands.h"
+#include "Logging.h"
+#include <QHash>
+#include <QPair>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief Barnes–Hut 四叉树
+ *
+ * 每个格子记录落在其中的节点总数（质量）和质心。计算某个节点受到的斥力时，
+ * 距离足够远的格子整体当作位于质心的一个质点，单个节点的计算量约为 O(log n)。
+ */
+class QuadTree
+{
+public:
+    /**
+     * @brief 按点集重建四叉树
+     * @param points 节点中心
+     */
+    void build(const QVector<QPointF> &points)
+    {
+        m_cells.clear();
+        if (points.isEmpty()) {
+            return;
+        }
+
+        qreal minX = points.first().x(), maxX = minX;
+        qreal minY = points.first().y(), maxY = minY;
+        for (const QPointF &p : points) {
+            minX = qMin(minX, p.x());
+            maxX = qMax(maxX, p.x());
+            minY = qMin(minY, p.y());
+            maxY = qMax(maxY, p.y());
+        }
+
+        m_cells.reserve(points.size() * 4);
+        Cell root;
+        root.center = QPointF((minX + maxX) / 2, (minY + maxY) / 2);
+        root.half = qMax(maxX - minX, maxY - minY) / 2 + 1.0;
+        m_cells.append(root);
+        for (int i = 0; i < points.size(); ++i) {
+            insert(i, points[i]);
+        }
+    }
+
+    /**
+     * @brief 计算节点受到的斥力（Fruchterman–Reingold：k²/d）
+     * @param index 节点下标
+     * @param point 节点中心
+     * @param k2 理想边长的平方
+     * @param theta 近似阈值，格子边长与距离之比小于它时按质心计算
+     * @return 斥力
+     */
+    QPointF repulsion(int index, const QPointF &point, qreal k2, qreal theta) const
+    {
+        QPointF force;
+        if (m_cells.isEmpty()) {
+            return force;
+        }
+
+        QVarLengthArray<int, 128> stack;
+        stack.append(0);
+        while (!stack.isEmpty()) {
+            const Cell &cell = m_cells[stack.last()];
+            stack.removeLast();
+            if (cell.mass == 0 || (cell.firstChild < 0 && cell.body == index && cell.mass == 1)) {
+                continue;
+            }
+
+            const QPointF delta = point - cell.massCenter;
+            const qreal distance = std::hypot(delta.x(), delta.y());
+            if (cell.firstChild < 0 || 2 * cell.half < theta * distance) {
+                // 重合的点由初始位置展开处理，这里跳过
+                if (distance > 1e-6) {
+                    force += delta / distance * (k2 * cell.mass / distance);
+                }
+            } else {
+                for (int q = 0; q < 4; ++q) {
+                    stack.append(cell.firstChild + q);
+                }
+            }
+        }
+        return force;
+    }
+
+    /**
+     * @brief 获取所有节点的质心
+     * @return 质心，树为空时返回原点
+     */
+    QPointF massCenter() const { return m_cells.isEmpty() ? QPointF() : m_cells.first().massCenter; }
+
+private:
+    /**
+     * @brief 四叉树格子
+     */
+    struct Cell {
+        QPointF center;        ///< 格子中心
+        qreal half = 0;        ///< 格子半边长
+        qreal mass = 0;        ///< 格子内节点数
+        QPointF massCenter;    ///< 格子内节点的质心
+        int body = -1;         ///< 叶子格子中的节点下标
+        int firstChild = -1;   ///< 第一个子格子的下标（四个子格子连续存放），叶子为-1
+    };
+
+    /**
+     * @brief 重合点最多细分的层数，超过后合并在同一个叶子中
+     */
+    static constexpr int MAX_DEPTH = 24;
+
+    static int quadrant(const Cell &cell, const QPointF &p)
+    {
+        return (p.x() >= cell.center.x() ? 1 : 0) | (p.y() >= cell.center.y() ? 2 : 0);
+    }
+
+    void subdivide(int index)
+    {
+        const qreal half = m_cells[index].half / 2;
+        const QPointF center = m_cells[index].center;
+        m_cells[index].firstChild = m_cells.size();
+        for (int q = 0; q < 4; ++q) {
+            Cell child;
+            child.half = half;
+            child.center = center + QPointF((q & 1) ? half : -half, (q & 2) ? half : -half);
+            m_cells.append(child);
+        }
+    }
+
+    void insert(int index, const QPointF &point)
+    {
+        int c = 0;
+        for (int depth = 0; ; ++depth) {
+            if (m_cells[c].mass == 0) {
+                Cell &cell = m_cells[c];
+                cell.body = index;
+                cell.mass = 1;
+                cell.massCenter = point;
+                return;
+            }
+            if (m_cells[c].firstChild < 0) {
+                if (depth >= MAX_DEPTH) {
+                    Cell &cell = m_cells[c];
+                    cell.massCenter = (cell.massCenter * cell.mass + point) / (cell.mass + 1);
+                    cell.mass += 1;
+                    return;
+                }
+                // 叶子中已有一个节点：细分后把它移到对应的子格子
+                const int body = m_cells[c].body;
+                const QPointF bodyPoint = m_cells[c].massCenter;
+                subdivide(c);
+                Cell &child = m_cells[m_cells[c].firstChild + quadrant(m_cells[c], bodyPoint)];
+                child.body = body;
+                child.mass = 1;
+                child.massCenter = bodyPoint;
+                m_cells[c].body = -1;
+            }
+            Cell &cell = m_cells[c];
+            cell.massCenter = (cell.massCenter * cell.mass + point) / (cell.mass + 1);
+            cell.mass += 1;
+            c = cell.firstChild + quadrant(cell, point);
+        }
+    }
+
+    QVector<Cell> m_cells;     ///< 所有格子，下标0为根
+};
+
+/**
+ * @brief 统计相邻两层之间的连线交叉数
+ * @param upper 上层节点（按当前顺序）
+ * @param lowerSize 下层节点数
+ * @param down 每个节点在下一层的邻居
+ * @param position 每个节点在所在层中的位置
+ * @return 交叉数
+ *
+ * 按上层顺序依次取出各连线在下层的端点位置，交叉数即该序列的逆序对数，用树状数组在 O(E log V) 内求出。
+ */
+qint64 countCrossings(const QVector<int> &upper, int lowerSize, const QVector<QVector<int>> &down,
+                      const QVector<int> &position)
+{
+    QVector<int> tree(lowerSize + 1, 0);
+    qint64 crossings = 0;
+    int inserted = 0;
+    QVarLengthArray<int, 16> targets;
+    for (int u : upper) {
+        targets.clear();
+        for (int v : down[u]) {
+            targets.append(position[v]);
+        }
+        std::sort(targets.begin(), targets.end());
+        for (int target : targets) {
+            // 已插入的端点中位置大于 target 的个数
+            int notGreater = 0;
+            for (int i = target + 1; i > 0; i -= i & -i) {
+                notGreater += tree[i];
+            }
+            crossings += inserted - notGreater;
+            for (int i = target + 1; i <= lowerSize; i += i & -i) {
+                ++tree[i];
+            }
+            ++inserted;
+        }
+    }
+    return crossings;
+}
+
+/**
+ * @brief 按邻居位置的重心重新排列一层
+ * @param level 层中的节点，原地重排
+ * @param neighbors 每个节点在参照层中的邻居
+ * @param position 每个节点在所在层中的位置，随重排更新
+ *
+ * 没有邻居的节点以自己当前的位置为键，大致留在原处。
+ */
+void sortByBarycenter(QVector<int> &level, const QVector<QVector<int>> &neighbors, QVector<int> &position)
+{
+    QVector<QPair<qreal, int>> keyed;
+    keyed.reserve(level.size());
+    for (int v : level) {
+        const QVector<int> &adjacent = neighbors[v];
+        qreal key = position[v];
+        if (!adjacent.isEmpty()) {
+            qreal sum = 0;
+            for (int u : adjacent) {
+                sum += position[u];
+            }
+            key = sum / adjacent.size();
+        }
+        keyed.append(qMakePair(key, v));
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const QPair<qreal, int> &a, const QPair<qreal, int> &b) {
+        return a.first < b.first;
+    });
+    for (int i = 0; i < keyed.size(); ++i) {
+        level[i] = keyed[i].second;
+        position[keyed[i].second] = i;
+    }
+}
+
+/**
+ * @brief 按邻居坐标的重心放置一层，同时保证相邻节点不重叠
+ * @param level 层中的节点（顺序不变）
+ * @param neighbors 每个节点在参照层中的邻居
+ * @param heights 每个节点的高度
+ * @param spacing 相邻节点的最小间距
+ * @param y 每个节点的中心纵坐标，原地更新
+ *
+ * 先自上而下把期望坐标推开到满足间距，再整体平移使结果与期望坐标的平均偏差为零。
+ */
+void placeLevel(const QVector<int> &level, const QVector<QVector<int>> &neighbors, const QVector<qreal> &heights,
+                qreal spacing, QVector<qreal> &y)
+{
+    if (level.isEmpty()) {
+        return;
+    }
+
+    QVector<qreal> desired(level.size());
+    for (int i = 0; i < level.size(); ++i) {
+        const QVector<int> &adjacent = neighbors[level[i]];
+        if (adjacent.isEmpty()) {
+            desired[i] = y[level[i]];
+        } else {
+            qreal sum = 0;
+            for (int u : adjacent) {
+                sum += y[u];
+            }
+            desired[i] = sum / adjacent.size();
+        }
+    }
+
+    QVector<qreal> placed(desired);
+    for (int i = 1; i < level.size(); ++i) {
+        const qreal minimum = placed[i - 1] + (heights[level[i - 1]] + heights[level[i]]) / 2 + spacing;
+        placed[i] = qMax(placed[i], minimum);
+    }
+    qreal shift = 0;
+    for (int i = 0; i < level.size(); ++i) {
+        shift += placed[i] - desired[i];
+    }
+    shift /= level.size();
+    for (int i = 0; i < level.size(); ++i) {
+        y[level[i]] = placed[i] - shift;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 构造函数
+ * @param scene 节点场景
+ * @param parent 父对象指针
+ */
+AutoLayout::AutoLayout(NodeScene *scene, QObject *parent)
+    : QObject(parent)
+    , m_scene(scene)
+    , m_busy(false)
+    , m_sceneCleared(false)
+{
+    // 计算期间场景被清空或重新打开项目时结果作废：新场景的节点可能恰好使用相同的持久ID
+    connect(m_scene, &NodeScene::nodesCleared, this, [this]() {
+        if (m_busy) {
+            m_sceneCleared = true;
+            cancel();
+        }
+    });
+    connect(&m_watcher, &QFutureWatcherBase::progressValueChanged, this, [this](int value) {
+        emit progressChanged(value, m_watcher.progressText());
+    });
+    connect(&m_watcher, &QFutureWatcherBase::finished, this, &AutoLayout::onLayoutFinished);
+}
+
+/**
+ * @brief 开始异步布局场景中的所有节点
+ * @param options 布局参数
+ * @return 已有布局任务在进行或场景为空时返回false
+ *
+ * 图形项只能在GUI线程中访问，布局需要的数据在这里一次复制出来，复制耗时与节点数和连接数成线性关系。
+ */
+bool AutoLayout::start(const Options &options)
+{
+    if (m_busy) {
+        return false;
+    }
+    const QList<Node*> &nodes = m_scene->getNodes();
+    if (nodes.isEmpty()) {
+        return false;
+    }
+
+    const int count = nodes.size();
+    Graph graph;
+    graph.sizes.resize(count);
+    graph.positions.resize(count);
+    graph.ranks.resize(count);
+    graph.successors.resize(count);
+    graph.predecessors.resize(count);
+    m_nodeIds.resize(count);
+
+    QHash<Node*, int> indexOf;
+    indexOf.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Node *node = nodes[i];
+        indexOf.insert(node, i);
+        m_nodeIds[i] = node->getId();
+        graph.sizes[i] = QSizeF(node->getWidth(), node->getHeight());
+        graph.positions[i] = node->pos();
+        graph.ranks[i] = m_scene->topology().order(node);
+    }
+
+    // 同一对节点之间的多条连接（不同端口）只保留一条边
+    QSet<QPair<int, int>> edges;
+    edges.reserve(m_scene->getConnections().size());
+    for (Connection *conn : m_scene->getConnections()) {
+        const int from = indexOf.value(conn->getFromNode(), -1);
+        const int to = indexOf.value(conn->getToNode(), -1);
+        if (from < 0 || to < 0 || from == to) {
+            continue;
+        }
+        const QPair<int, int> edge(from, to);
+        if (edges.contains(edge)) {
+            continue;
+        }
+        edges.insert(edge);
+        graph.successors[from].append(to);
+        graph.predecessors[to].append(from);
+    }
+
+    m_busy = true;
+    m_sceneCleared = false;
+    emit progressChanged(0, "正在计算布局");
+    m_watcher.setFuture(QtConcurrent::run(&AutoLayout::computeLayout, graph, options));
+    return true;
+}
+
+/**
+ * @brief 取消当前布局
+ *
+ * 工作线程在下一轮扫描或迭代开始前退出，场景保持不变。
+ */
+void AutoLayout::cancel()
+{
+    if (!m_busy) {
+        return;
+    }
+    m_watcher.cancel();
+}
+
+/**
+ * @brief 工作线程计算完成，把结果应用到场景
+ *
+ * 计算期间被删除的节点跳过；所有移动合并为一条撤销命令，
+ * MoveNodesCommand 设置完全部位置后统一重算一次连接线路径。
+ */
+void AutoLayout::onLayoutFinished()
+{
+    if (m_sceneCleared) {
+        finish(false, "场景已清空，自动布局已取消");
+        return;
+    }
+    if (m_watcher.isCanceled() || m_watcher.future().resultCount() == 0) {
+        finish(false, "自动布局已取消");
+        return;
+    }
+
+    const QVector<QPointF> centers = m_watcher.result();
+    QList<Node*> nodes;
+    QList<QPointF> oldPositions;
+    QList<QPointF> newPositions;
+    for (int i = 0; i < m_nodeIds.size() && i < centers.size(); ++i) {
+        Node *node = m_scene->nodeById(m_nodeIds[i]);
+        if (!node || node->pos() == centers[i]) {
+            continue;
+        }
+        nodes.append(node);
+        oldPositions.append(node->pos());
+        newPositions.append(centers[i]);
+    }
+
+    if (nodes.isEmpty()) {
+        finish(true, "布局没有变化");
+        return;
+    }
+    {
+        // 大量节点移动期间暂停场景索引，结束时按新范围一次重建
+        NodeScene::BulkUpdateGuard guard(m_scene);
+        m_scene->undoStack()->push(new MoveNodesCommand(nodes, oldPositions, newPositions));
+    }
+    finish(true, QString("已自动布局 %1 个节点").arg(nodes.size()));
+}
+
+/**
+ * @brief 在工作线程中计算布局
+ *
+ * 新布局外框的左上角与原布局对齐，视图中的内容不会跳到别处。
+ */
+void AutoLayout::computeLayout(QPromise<QVector<QPointF>> &promise, const Graph &graph, const Options &options)
+{
+    promise.setProgressRange(0, 100);
+    QVector<QPointF> centers = options.algorithm == ForceDirected
+        ? forceDirectedLayout(promise, graph, options)
+        : layeredLayout(promise, graph, options);
+    if (promise.isCanceled() || centers.isEmpty()) {
+        return;
+    }
+
+    const qreal inf = std::numeric_limits<qreal>::max();
+    QPointF oldTopLeft(inf, inf);
+    QPointF newTopLeft(inf, inf);
+    for (int i = 0; i < centers.size(); ++i) {
+        const QPointF half(graph.sizes[i].width() / 2, graph.sizes[i].height() / 2);
+        const QPointF oldCorner = graph.positions[i] - half;
+        const QPointF newCorner = centers[i] - half;
+        oldTopLeft = QPointF(qMin(oldTopLeft.x(), oldCorner.x()), qMin(oldTopLeft.y(), oldCorner.y()));
+        newTopLeft = QPointF(qMin(newTopLeft.x(), newCorner.x()), qMin(newTopLeft.y(), newCorner.y()));
+    }
+    const QPointF offset = oldTopLeft - newTopLeft;
+    for (QPointF &center : centers) {
+        center += offset;
+    }
+
+    promise.setProgressValueAndText(100, "正在应用布局");
+    promise.addResult(centers);
+}
+
+/**
+ * @brief 分层布局
+ *
+ * 各连通分量互不影响，连同大分量的几组不同初始顺序一起作为独立任务放入线程池；
+ * 每个分量保留交叉数最少的结果，再按行把各分量排成接近正方形的区域。
+ */
+QVector<QPointF> AutoLayout::layeredLayout(QPromise<QVector<QPointF>> &promise, const Graph &graph,
+                                           const Options &options)
+{
+    const int count = graph.sizes.size();
+
+    // 忽略方向求连通分量
+    QVector<int> componentOf(count, -1);
+    QVector<QVector<int>> components;
+    for (int start = 0; start < count; ++start) {
+        if (componentOf[start] >= 0) {
+            continue;
+        }
+        const int id = components.size();
+        QVector<int> members;
+        QVector<int> stack{start};
+        componentOf[start] = id;
+        while (!stack.isEmpty()) {
+            const int v = stack.takeLast();
+            members.append(v);
+            for (const QVector<int> *adjacent : {&graph.successors[v], &graph.predecessors[v]}) {
+                for (int u : *adjacent) {
+                    if (componentOf[u] < 0) {
+                        componentOf[u] = id;
+                        stack.append(u);
+                    }
+                }
+            }
+        }
+        components.append(members);
+    }
+
+    // 分量内按拓扑序排列
+    QVector<int> localIndex(count);
+    for (QVector<int> &members : components) {
+        std::sort(members.begin(), members.end(), [&graph](int a, int b) {
+            return graph.ranks[a] < graph.ranks[b];
+        });
+        for (int i = 0; i < members.size(); ++i) {
+            localIndex[members[i]] = i;
+        }
+    }
+
+    // 大分量多试几组打乱的初始顺序，单节点分量直接放置
+    const int threads = options.maxThreads > 0 ? options.maxThreads : QThread::idealThreadCount();
+    const int trials = qBound(1, threads, 4);
+    QVector<QPair<int, quint32>> tasks;
+    QVector<LayeredResult> best(components.size());
+    for (int c = 0; c < components.size(); ++c) {
+        const QVector<int> &members = components[c];
+        if (members.size() == 1) {
+            const QSizeF size = graph.sizes[members.first()];
+            best[c].crossings = 0;
+            best[c].centers = {QPointF(size.width() / 2, size.height() / 2)};
+            best[c].size = size;
+            continue;
+        }
+        const int componentTrials = members.size() >= 16 ? trials : 1;
+        for (int t = 0; t < componentTrials; ++t) {
+            tasks.append(qMakePair(c, quint32(t)));
+        }
+    }
+    // 大分量先开始，缩短总耗时
+    std::stable_sort(tasks.begin(), tasks.end(), [&components](const QPair<int, quint32> &a,
+                                                               const QPair<int, quint32> &b) {
+        return components[a.first].size() > components[b.first].size();
+    });
+
+    QVector<LayeredResult> results(tasks.size());
+    std::atomic<int> done(0);
+    QThreadPool pool;
+    if (options.maxThreads > 0) {
+        pool.setMaxThreadCount(options.maxThreads);
+    }
+    // 每个任务只写自己的结果槽，不需要加锁
+    for (int i = 0; i < tasks.size(); ++i) {
+        pool.start([&, i]() {
+            if (promise.isCanceled()) {
+                return;
+            }
+            results[i] = layoutComponent(promise, graph, components[tasks[i].first], localIndex, options,
+                                         tasks[i].second);
+            promise.setProgressValueAndText(90 * ++done / tasks.size(), "正在减少连线交叉");
+        });
+    }
+    pool.waitForDone();
+    if (promise.isCanceled()) {
+        return QVector<QPointF>();
+    }
+
+    for (int i = 0; i < tasks.size(); ++i) {
+        LayeredResult &candidate = best[tasks[i].first];
+        if (candidate.crossings < 0 || results[i].crossings < candidate.crossings) {
+            candidate = results[i];
+        }
+    }
+
+    // 按高度从大到小逐行排布，行宽取总面积的平方根与最宽分量中的较大者
+    const qreal gap = options.layerSpacing;
+    QVector<int> order(components.size());
+    qreal area = 0;
+    qreal widest = 0;
+    for (int c = 0; c < components.size(); ++c) {
+        order[c] = c;
+        area += (best[c].size.width() + gap) * (best[c].size.height() + gap);
+        widest = qMax(widest, best[c].size.width());
+    }
+    std::stable_sort(order.begin(), order.end(), [&best](int a, int b) {
+        return best[a].size.height() > best[b].size.height();
+    });
+    const qreal rowWidth = qMax(widest, std::sqrt(area));
+
+    QVector<QPointF> centers(count);
+    qreal x = 0;
+    qreal y = 0;
+    qreal rowHeight = 0;
+    for (int c : order) {
+        const QSizeF size = best[c].size;
+        if (x > 0 && x + size.width() > rowWidth) {
+            x = 0;
+            y += rowHeight + gap;
+            rowHeight = 0;
+        }
+        const QPointF offset(x, y);
+        const QVector<int> &members = components[c];
+        for (int i = 0; i < members.size(); ++i) {
+            centers[members[i]] = best[c].centers[i] + offset;
+        }
+        x += size.width() + gap;
+        rowHeight = qMax(rowHeight, size.height());
+    }
+    return centers;
+}
+
+/**
+ * @brief 对一个连通分量做分层布局
+ *
+ * 1. 分层：节点已按拓扑序排列，最长路径分层只需一次遍历；形成环路的边（拓扑序相反）不参与分层
+ * 2. 跨越多层的边拆成经过每一层虚拟节点的链
+ * 3. 重心法上下交替扫描，保留交叉数最少的顺序
+ * 4. 横坐标按层排列，纵坐标按相邻层重心对齐并保持间距
+ */
+AutoLayout::LayeredResult AutoLayout::layoutComponent(QPromise<QVector<QPointF>> &promise, const Graph &graph,
+                                                      const QVector<int> &nodes, const QVector<int> &localIndex,
+                                                      const Options &options, quint32 seed)
+{
+    LayeredResult result;
+    const int count = nodes.size();
+
+    // 1. 最长路径分层
+    QVector<int> vertexLayer(count, 0);
+    int layerCount = 1;
+    for (int i = 0; i < count; ++i) {
+        for (int s : graph.successors[nodes[i]]) {
+            const int j = localIndex[s];
+            if (j > i) {
+                vertexLayer[j] = qMax(vertexLayer[j], vertexLayer[i] + 1);
+                layerCount = qMax(layerCount, vertexLayer[j] + 1);
+            }
+        }
+    }
+
+    // 2. 分层图：前 count 个顶点是真实节点，其后是虚拟节点
+    QVector<QVector<int>> up(count);
+    QVector<QVector<int>> down(count);
+    for (int i = 0; i < count; ++i) {
+        for (int s : graph.successors[nodes[i]]) {
+            const int j = localIndex[s];
+            if (j <= i) {
+                continue;
+            }
+            int previous = i;
+            for (int layer = vertexLayer[i] + 1; layer < vertexLayer[j]; ++layer) {
+                const int dummy = vertexLayer.size();
+                vertexLayer.append(layer);
+                up.append(QVector<int>{previous});
+                down.append(QVector<int>());
+                down[previous].append(dummy);
+                previous = dummy;
+            }
+            down[previous].append(j);
+            up[j].append(previous);
+        }
+    }
+    const int total = vertexLayer.size();
+
+    QVector<QVector<int>> levels(layerCount);
+    for (int v = 0; v < total; ++v) {
+        levels[vertexLayer[v]].append(v);
+    }
+    if (seed != 0) {
+        QRandomGenerator random(seed);
+        for (QVector<int> &level : levels) {
+            std::shuffle(level.begin(), level.end(), random);
+        }
+    }
+    QVector<int> position(total);
+    auto updatePositions = [&]() {
+        for (const QVector<int> &level : levels) {
+            for (int i = 0; i < level.size(); ++i) {
+                position[level[i]] = i;
+            }
+        }
+    };
+    auto totalCrossings = [&]() {
+        qint64 crossings = 0;
+        for (int layer = 0; layer + 1 < layerCount; ++layer) {
+            crossings += countCrossings(levels[layer], levels[layer + 1].size(), down, position);
+        }
+        return crossings;
+    };
+    updatePositions();
+
+    // 3. 交叉最小化
+    qint64 bestCrossings = totalCrossings();
+    QVector<QVector<int>> bestLevels = levels;
+    for (int sweep = 0; sweep < options.crossingSweeps && bestCrossings > 0; ++sweep) {
+        if (promise.isCanceled()) {
+            return result;
+        }
+        if (sweep % 2 == 0) {
+            for (int layer = 1; layer < layerCount; ++layer) {
+                sortByBarycenter(levels[layer], up, position);
+            }
+        } else {
+            for (int layer = layerCount - 2; layer >= 0; --layer) {
+                sortByBarycenter(levels[layer], down, position);
+            }
+        }
+        const qint64 crossings = totalCrossings();
+        if (crossings < bestCrossings) {
+            bestCrossings = crossings;
+            bestLevels = levels;
+        }
+    }
+    levels = bestLevels;
+    updatePositions();
+
+    // 4. 坐标分配
+    QVector<qreal> heights(total, 0.0);
+    QVector<qreal> layerWidth(layerCount, 0.0);
+    for (int i = 0; i < count; ++i) {
+        const QSizeF size = graph.sizes[nodes[i]];
+        heights[i] = size.height();
+        layerWidth[vertexLayer[i]] = qMax(layerWidth[vertexLayer[i]], size.width());
+    }
+    QVector<qreal> layerX(layerCount);
+    qreal x = 0;
+    for (int layer = 0; layer < layerCount; ++layer) {
+        layerX[layer] = x + layerWidth[layer] / 2;
+        x += layerWidth[layer] + options.layerSpacing;
+    }
+
+    QVector<qreal> y(total);
+    for (const QVector<int> &level : levels) {
+        qreal cursor = 0;
+        for (int v : level) {
+            y[v] = cursor + heights[v] / 2;
+            cursor += heights[v] + options.nodeSpacing;
+        }
+    }
+    for (int pass = 0; pass < 4; ++pass) {
+        if (promise.isCanceled()) {
+            return result;
+        }
+        if (pass % 2 == 0) {
+            for (int layer = 1; layer < layerCount; ++layer) {
+                placeLevel(levels[layer], up, heights, options.nodeSpacing, y);
+            }
+        } else {
+            for (int layer = layerCount - 2; layer >= 0; --layer) {
+                placeLevel(levels[layer], down, heights, options.nodeSpacing, y);
+            }
+        }
+    }
+
+    // 分量左上角对齐原点
+    qreal minY = std::numeric_limits<qreal>::max();
+    qreal maxY = std::numeric_limits<qreal>::lowest();
+    qreal maxX = 0;
+    for (int i = 0; i < count; ++i) {
+        minY = qMin(minY, y[i] - heights[i] / 2);
+        maxY = qMax(maxY, y[i] + heights[i] / 2);
+        maxX = qMax(maxX, layerX[vertexLayer[i]] + graph.sizes[nodes[i]].width() / 2);
+    }
+    result.centers.resize(count);
+    for (int i = 0; i < count; ++i) {
+        result.centers[i] = QPointF(layerX[vertexLayer[i]], y[i] - minY);
+    }
+    result.size = QSizeF(maxX, maxY - minY);
+    result.crossings = bestCrossings;
+    return result;
+}
+
+/**
+ * @brief 力导向布局
+ *
+ * 从当前位置出发迭代：斥力由 Barnes–Hut 四叉树近似，引力沿连接作用（d²/k），
+ * 另加指向质心的弱引力使不相连的部分不会无限远离；每轮位移不超过逐渐降低的温度。
+ * 重合的初始位置（如全部导入在原点）先沿螺旋展开。
+ */
+QVector<QPointF> AutoLayout::forceDirectedLayout(QPromise<QVector<QPointF>> &promise, const Graph &graph,
+                                                 const Options &options)
+{
+    const int count = graph.sizes.size();
+    QVector<QPointF> positions = graph.positions;
+
+    qreal sizeSum = 0;
+    for (const QSizeF &size : graph.sizes) {
+        sizeSum += qMax(size.width(), size.height());
+    }
+    const qreal k = sizeSum / count + options.nodeSpacing;
+    const qreal k2 = k * k;
+    const qreal gravity = 0.01;
+
+    QHash<QPair<qint64, qint64>, int> occupied;
+    occupied.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QPair<qint64, qint64> key(qRound64(positions[i].x()), qRound64(positions[i].y()));
+        const int duplicates = occupied[key]++;
+        if (duplicates > 0) {
+            const qreal angle = duplicates * 2.399963;   // 黄金角
+            const qreal radius = k * std::sqrt(qreal(duplicates));
+            positions[i] += QPointF(std::cos(angle), std::sin(angle)) * radius;
+        }
+    }
+
+    QVector<QVector<int>> neighbors(count);
+    for (int i = 0; i < count; ++i) {
+        neighbors[i] = graph.successors[i] + graph.predecessors[i];
+    }
+
+    const int threads = options.maxThreads > 0 ? options.maxThreads : QThread::idealThreadCount();
+    const int chunkSize = qMax(64, count / qMax(1, threads * 4));
+    QVector<QPair<int, int>> ranges;
+    for (int begin = 0; begin < count; begin += chunkSize) {
+        ranges.append(qMakePair(begin, qMin(count, begin + chunkSize)));
+    }
+    QThreadPool pool;
+    if (options.maxThreads > 0) {
+        pool.setMaxThreadCount(options.maxThreads);
+    }
+
+    const int iterations = qMax(1, options.forceIterations);
+    const qreal initialTemperature = k * qMax<qreal>(1.0, std::sqrt(qreal(count)) / 4);
+    QVector<QPointF> displacement(count);
+    QuadTree tree;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        if (promise.isCanceled()) {
+            return QVector<QPointF>();
+        }
+
+        tree.build(positions);
+        const QPointF center = tree.massCenter();
+        // 各节点只写自己的位移，按块并行
+        QtConcurrent::blockingMap(&pool, ranges, [&](const QPair<int, int> &range) {
+            for (int i = range.first; i < range.second; ++i) {
+                const QPointF p = positions[i];
+                QPointF force = tree.repulsion(i, p, k2, options.theta);
+                for (int j : neighbors[i]) {
+                    const QPointF delta = p - positions[j];
+                    const qreal distance = std::hypot(delta.x(), delta.y());
+                    if (distance > 1e-6) {
+                        force -= delta * (distance / k);
+                    }
+                }
+                force -= (p - center) * gravity;
+                displacement[i] = force;
+            }
+        });
+
+        const qreal temperature = initialTemperature * (1.0 - qreal(iteration) / iterations) + k * 0.01;
+        for (int i = 0; i < count; ++i) {
+            const QPointF d = displacement[i];
+            const qreal length = std::hypot(d.x(), d.y());
+            if (length > 1e-6) {
+                positions[i] += d / length * qMin(length, temperature);
+            }
+        }
+
+        if (iteration % 10 == 0) {
+            promise.setProgressValueAndText(95 * iteration / iterations, "正在计算力导向布局");
+        }
+    }
+    return positions;
+}
+
+/**
+ * @brief 结束当前任务并发出 finished 信号
+ */
+void AutoLayout::finish(bool success, const QString &message)
+{
+    m_busy = false;
+    m_nodeIds.clear();
+    qCDebug(lcScene) << "自动布局:" << message;
+    emit finished(success, message);
+}
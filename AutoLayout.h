@@ -0,0 +1,189 @@
+/**
+ * @file AutoLayout.h
+ * @brief 自动布局类头文件，在工作线程中为场景节点计算分层布局或力导向布局
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef AUTOLAYOUT_H
+#define AUTOLAYOUT_H
+
+#include <QObject>                     // Qt对象基类
+#include <QFutureWatcher>              // 异步任务监视器
+#include <QPointF>                     // 点类
+#include <QPromise>                    // 异步任务结果
+#include <QSizeF>                      // 尺寸类
+#include <QVector>                     // 向量类
+
+// 前向声明
+class NodeScene;                       // 节点场景类
+
+/**
+ * @class AutoLayout
+ * @brief 自动布局类
+ *
+ * 开始布局时在GUI线程把场景中的节点尺寸、位置、拓扑序号和连接复制成一份只含整数下标的图，
+ * 布局计算全部在工作线程中进行，不访问任何图形项；GUI线程在计算期间保持响应，可以随时取消。
+ *
+ * 提供两种算法：
+ * - 分层布局（Sugiyama）：按 TopologyIndex 的拓扑序做最长路径分层，长边插入虚拟节点，
+ *   用重心法上下扫描减少交叉，按层间和层内间距分配坐标。各连通分量以及大分量的多组
+ *   不同初始顺序在线程池中并行计算，每个分量取交叉数最少的结果，最后按行排布各分量。
+ * - 力导向布局：Fruchterman–Reingold 弹簧模型，斥力用 Barnes–Hut 四叉树近似，
+ *   每轮迭代各节点的受力在线程池中并行计算。
+ *
+ * 组节点作为一个整体按其外框尺寸参与布局，内部子图不展开，内部节点相对组节点的位置不变。
+ * 计算完成后仍在场景中的节点作为一条 MoveNodesCommand 移动到新位置，可以一次撤销；
+ * 连接线路径在命令执行结束时统一重算一次。
+ */
+class AutoLayout : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 布局算法
+     */
+    enum Algorithm {
+        Layered,          ///< 分层布局（Sugiyama）
+        ForceDirected     ///< 力导向布局（Barnes–Hut）
+    };
+
+    /**
+     * @brief 布局参数
+     */
+    struct Options {
+        Algorithm algorithm = Layered;  ///< 布局算法
+        qreal layerSpacing = 120.0;     ///< 分层布局相邻层之间的水平间距
+        qreal nodeSpacing = 40.0;       ///< 同层相邻节点的垂直间距；力导向布局理想边长的附加距离
+        int crossingSweeps = 8;         ///< 分层布局交叉最小化的上下扫描轮数
+        int forceIterations = 300;      ///< 力导向布局的迭代次数
+        qreal theta = 0.8;              ///< Barnes–Hut 近似阈值（越小越精确）
+        int maxThreads = 0;             ///< 最大线程数，0表示使用CPU核心数
+    };
+
+    /**
+     * @brief 构造函数
+     * @param scene 节点场景
+     * @param parent 父对象指针
+     */
+    explicit AutoLayout(NodeScene *scene, QObject *parent = nullptr);
+
+    /**
+     * @brief 开始异步布局场景中的所有节点
+     * @param options 布局参数
+     * @return 已有布局任务在进行或场景为空时返回false
+     */
+    bool start(const Options &options = Options());
+
+    /**
+     * @brief 取消当前布局（场景保持不变）
+     */
+    void cancel();
+
+    /**
+     * @brief 是否有布局任务正在进行
+     * @return 正在进行返回true
+     */
+    bool isBusy() const { return m_busy; }
+
+signals:
+    /**
+     * @brief 进度变化
+     * @param percent 进度百分比（0 ~ 100）
+     * @param stage 当前阶段的说明
+     */
+    void progressChanged(int percent, const QString &stage);
+
+    /**
+     * @brief 布局结束（成功、失败或取消）
+     * @param success 成功返回true
+     * @param message 结果说明
+     */
+    void finished(bool success, const QString &message);
+
+private slots:
+    /**
+     * @brief 工作线程计算完成，把结果应用到场景
+     */
+    void onLayoutFinished();
+
+private:
+    /**
+     * @brief 场景图的副本，节点以下标表示
+     */
+    struct Graph {
+        QVector<QSizeF> sizes;                 ///< 节点尺寸
+        QVector<QPointF> positions;            ///< 节点中心（Node::pos）
+        QVector<int> ranks;                    ///< 拓扑序号
+        QVector<QVector<int>> successors;      ///< 后继节点（同一对节点只保留一条边）
+        QVector<QVector<int>> predecessors;    ///< 前驱节点
+    };
+
+    /**
+     * @brief 一个连通分量的分层布局结果
+     */
+    struct LayeredResult {
+        qint64 crossings = -1;         ///< 交叉数，-1表示未完成（已取消）
+        QVector<QPointF> centers;      ///< 分量内各节点的中心，左上角对齐原点
+        QSizeF size;                   ///< 分量外框尺寸
+    };
+
+    /**
+     * @brief 在工作线程中计算布局
+     * @param promise 任务结果（各节点的新中心）与进度
+     * @param graph 场景图副本
+     * @param options 布局参数
+     */
+    static void computeLayout(QPromise<QVector<QPointF>> &promise, const Graph &graph, const Options &options);
+
+    /**
+     * @brief 分层布局
+     * @param promise 任务结果与进度
+     * @param graph 场景图副本
+     * @param options 布局参数
+     * @return 各节点的新中心，取消时返回空
+     */
+    static QVector<QPointF> layeredLayout(QPromise<QVector<QPointF>> &promise, const Graph &graph,
+                                          const Options &options);
+
+    /**
+     * @brief 对一个连通分量做分层布局
+     * @param promise 任务结果与进度（只用于检查取消）
+     * @param graph 场景图副本
+     * @param nodes 分量中的节点，已按拓扑序排列
+     * @param localIndex 节点下标到分量内下标的映射
+     * @param options 布局参数
+     * @param seed 初始顺序扰动种子，0表示按拓扑序
+     * @return 布局结果
+     */
+    static LayeredResult layoutComponent(QPromise<QVector<QPointF>> &promise, const Graph &graph,
+                                         const QVector<int> &nodes, const QVector<int> &localIndex,
+                                         const Options &options, quint32 seed);
+
+    /**
+     * @brief 力导向布局
+     * @param promise 任务结果与进度
+     * @param graph 场景图副本
+     * @param options 布局参数
+     * @return 各节点的新中心，取消时返回空
+     */
+    static QVector<QPointF> forceDirectedLayout(QPromise<QVector<QPointF>> &promise, const Graph &graph,
+                                                const Options &options);
+
+    /**
+     * @brief 结束当前任务并发出 finished 信号
+     * @param success 是否成功
+     * @param message 结果说明
+     */
+    void finish(bool success, const QString &message);
+
+    NodeScene *m_scene;                            ///< 节点场景
+    QFutureWatcher<QVector<QPointF>> m_watcher;    ///< 布局任务监视器
+    QVector<quint64> m_nodeIds;                    ///< 参与布局的节点ID（下标与图副本一致）
+    bool m_busy;                                   ///< 是否有任务正在进行
+    bool m_sceneCleared;                           ///< 计算期间场景被清空，结果作废
+};
+
+#endif // AUTOLAYOUT_H
@@ -0,0 +1,229 @@
+/**
+ * @file BatchGenerator.cpp
+ * @brief 批量代码生成器类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "BatchGenerator.h"
+#include "CodeGenerator.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @brief 总耗时（纳秒）
+ * @return 读取、解析和所有后端耗时之和
+ */
+qint64 BatchGenerator::Result::totalNs() const
+{
+    qint64 total = loadNs;
+    for (qint64 ns : backendNs) {
+        total += ns;
+    }
+    return total;
+}
+
+/**
+ * @brief 构造函数
+ * @param options 生成选项
+ */
+BatchGenerator::BatchGenerator(const Options &options)
+    : m_options(options)
+{
+}
+
+/**
+ * @brief 在线程池中处理所有文件，全部完成后返回
+ * @param inputFiles 输入文件列表
+ * @param maxThreads 最大线程数，0表示使用CPU核心数
+ * @return 处理结果，顺序与 inputFiles 相同
+ */
+QList<BatchGenerator::Result> BatchGenerator::run(const QStringList &inputFiles, int maxThreads) const
+{
+    QVector<Result> results(inputFiles.size());
+
+    // 输出文件按输入文件的基本名命名，同名的输入会互相覆盖，在生成前检出并报告为失败
+    QHash<QString, QList<int>> filesByOutput;
+    for (int i = 0; i < inputFiles.size(); ++i) {
+        filesByOutput[outputBase(inputFiles.at(i))].append(i);
+    }
+    QVector<bool> conflicting(inputFiles.size(), false);
+    for (const QList<int> &indices : filesByOutput) {
+        if (indices.size() < 2) {
+            continue;
+        }
+        QStringList names;
+        for (int i : indices) {
+            names << inputFiles.at(i);
+        }
+        for (int i : indices) {
+            conflicting[i] = true;
+            results[i].inputFile = inputFiles.at(i);
+            results[i].error = QString("输出文件名冲突，未生成: %1").arg(names.join(", "));
+        }
+    }
+
+    QThreadPool pool;
+    if (maxThreads > 0) {
+        pool.setMaxThreadCount(maxThreads);
+    }
+    // 每个任务只写自己的结果槽，不需要加锁
+    for (int i = 0; i < inputFiles.size(); ++i) {
+        if (conflicting.at(i)) {
+            continue;
+        }
+        pool.start([this, &inputFiles, &results, i]() {
+            results[i] = process(inputFiles.at(i));
+        });
+    }
+    pool.waitForDone();
+
+    return QList<Result>(results.begin(), results.end());
+}
+
+/**
+ * @brief 处理单个文件
+ * @param inputFile 输入文件
+ * @return 处理结果
+ */
+BatchGenerator::Result BatchGenerator::process(const QString &inputFile) const
+{
+    Result result;
+    result.inputFile = inputFile;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(inputFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.error = QString("无法打开文件: %1").arg(file.errorString());
+        return result;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    file.close();
+    if (!doc.isObject()) {
+        // 二进制项目文件需要场景才能读取，这里只支持JSON
+        result.error = QString("不是JSON项目文件: %1（位置 %2）")
+            .arg(parseError.errorString()).arg(parseError.offset);
+        return result;
+    }
+    const QJsonObject flowData = doc.object();
+    result.loadNs = timer.nsecsElapsed();
+
+    // 增量模式不写入生成时间，内容未变化的输出文件才能保持不变
+    CodeGenerator generator;
+    generator.setIncremental(true);
+    generator.setTemplatePipeline(m_options.templatePipeline);
+    generator.setParallelExecution(m_options.maxWorkers != 1);
+    generator.setMaxWorkers(m_options.maxWorkers);
+
+    for (Backend backend : m_options.backends) {
+        timer.restart();
+
+        QString code;
+        switch (backend) {
+        case JsonBackend:
+            code = generator.generateCode(flowData);
+            break;
+        case CppBackend:
+            code = generator.generateCppCode(flowData);
+            break;
+        case PythonBackend:
+            code = generator.generatePythonCode(flowData);
+            break;
+        case ConfigBackend:
+            code = generator.generateConfigFile(flowData);
+            break;
+        }
+
+        const QString outputFile = outputBase(inputFile) + fileSuffix(backend);
+        bool written = false;
+        if (!CodeGenerator::writeFileIfChanged(outputFile, code, &written)) {
+            result.error = QString("无法写入 %1").arg(outputFile);
+            result.backendNs.append(timer.nsecsElapsed());
+            return result;
+        }
+        result.outputFiles.append(outputFile);
+        if (!written) {
+            ++result.unchangedCount;
+        }
+        result.backendNs.append(timer.nsecsElapsed());
+    }
+    return result;
+}
+
+/**
+ * @brief 获取输入文件对应的输出路径（不含扩展名）
+ * @param inputFile 输入文件
+ * @return 输出目录下以输入文件基本名命名的绝对路径
+ */
+QString BatchGenerator::outputBase(const QString &inputFile) const
+{
+    const QFileInfo inputInfo(inputFile);
+    const QDir outputDir(m_options.outputDir.isEmpty() ? inputInfo.absolutePath() : m_options.outputDir);
+    return QDir::cleanPath(outputDir.absoluteFilePath(inputInfo.completeBaseName()));
+}
+
+/**
+ * @brief 按名称解析后端
+ * @param name 后端名称（json、cpp、python、yaml）
+ * @param backend 输出参数，解析到的后端
+ * @return 名称有效返回true
+ */
+bool BatchGenerator::backendFromName(const QString &name, Backend *backend)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == "json") {
+        *backend = JsonBackend;
+    } else if (key == "cpp" || key == "c++") {
+        *backend = CppBackend;
+    } else if (key == "python" || key == "py") {
+        *backend = PythonBackend;
+    } else if (key == "yaml" || key == "config") {
+        *backend = ConfigBackend;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 获取后端名称
+ * @param backend 后端
+ * @return 后端名称
+ */
+QString BatchGenerator::backendName(Backend backend)
+{
+    switch (backend) {
+    case JsonBackend: return "json";
+    case CppBackend: return "cpp";
+    case PythonBackend: return "python";
+    case ConfigBackend: return "yaml";
+    }
+    return QString();
+}
+
+/**
+ * @brief 获取后端输出文件的扩展名
+ * @param backend 后端
+ * @return 扩展名（含点），JSON输出使用 .code.json 以免覆盖输入文件
+ */
+QString BatchGenerator::fileSuffix(Backend backend)
+{
+    switch (backend) {
+    case JsonBackend: return ".code.json";
+    case CppBackend: return ".cpp";
+    case PythonBackend: return ".py";
+    case ConfigBackend: return ".yaml";
+    }
+    return QString();
+}
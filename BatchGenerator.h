@@ -0,0 +1,119 @@
+/**
+ * @file BatchGenerator.h
+ * @brief 批量代码生成器类头文件，在线程池中为多个流程文件生成代码（命令行工具使用）
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BATCHGENERATOR_H
+#define BATCHGENERATOR_H
+
+#include <QList>                       // 列表类
+#include <QString>                     // 字符串类
+#include <QStringList>                 // 字符串列表类
+
+/**
+ * @class BatchGenerator
+ * @brief 批量代码生成器
+ *
+ * 只依赖 QtCore，不创建场景和图形项，也不读取节点库：流程文件按JSON直接交给 CodeGenerator。
+ * 每个输入文件是一个任务，在线程池中并行处理；同一个文件的各后端依次生成，JSON只解析一次。
+ * 每个任务使用独立的 CodeGenerator 实例，任务之间不共享状态。
+ * 输出经 CodeGenerator::writeFileIfChanged 写入，内容未变化的文件保持原修改时间。
+ */
+class BatchGenerator
+{
+public:
+    /**
+     * @brief 生成后端
+     */
+    enum Backend {
+        JsonBackend,      ///< 标准JSON（CodeGenerator::generateCode）
+        CppBackend,       ///< C++源文件（CodeGenerator::generateCppCode）
+        PythonBackend,    ///< Python脚本（CodeGenerator::generatePythonCode）
+        ConfigBackend     ///< YAML部署配置（CodeGenerator::generateConfigFile）
+    };
+
+    /**
+     * @brief 生成选项（对所有文件相同）
+     */
+    struct Options {
+        QList<Backend> backends{CppBackend};  ///< 要生成的后端
+        QString outputDir;                    ///< 输出目录，为空时输出到输入文件所在目录
+        bool templatePipeline = false;        ///< C++使用模板流水线后端
+        int maxWorkers = 0;                   ///< 生成的C++代码的工作线程数（1为顺序执行，0为自动）
+    };
+
+    /**
+     * @brief 单个文件的处理结果
+     */
+    struct Result {
+        QString inputFile;                    ///< 输入文件
+        QStringList outputFiles;              ///< 写出的文件（含内容未变化而跳过写入的文件）
+        int unchangedCount = 0;               ///< 内容未变化而跳过写入的文件数
+        qint64 loadNs = 0;                    ///< 读取和解析耗时（纳秒）
+        QList<qint64> backendNs;              ///< 各后端的生成和写入耗时（纳秒），与 Options::backends 对应
+        QString error;                        ///< 错误信息，成功时为空
+
+        bool success() const { return error.isEmpty(); }
+        qint64 totalNs() const;               ///< 总耗时（纳秒）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param options 生成选项
+     */
+    explicit BatchGenerator(const Options &options);
+
+    /**
+     * @brief 在线程池中处理所有文件，全部完成后返回
+     * @param inputFiles 输入文件列表
+     * @param maxThreads 最大线程数，0表示使用CPU核心数
+     * @return 处理结果，顺序与 inputFiles 相同
+     *
+     * 输出路径相同的文件（如 -o 指定同一目录时 a/flow.json 和 b/flow.json）不生成，结果中报告冲突。
+     */
+    QList<Result> run(const QStringList &inputFiles, int maxThreads = 0) const;
+
+    /**
+     * @brief 处理单个文件
+     * @param inputFile 输入文件
+     * @return 处理结果
+     */
+    Result process(const QString &inputFile) const;
+
+    /**
+     * @brief 按名称解析后端
+     * @param name 后端名称（json、cpp、python、yaml）
+     * @param backend 输出参数，解析到的后端
+     * @return 名称有效返回true
+     */
+    static bool backendFromName(const QString &name, Backend *backend);
+
+    /**
+     * @brief 获取后端名称
+     * @param backend 后端
+     * @return 后端名称
+     */
+    static QString backendName(Backend backend);
+
+    /**
+     * @brief 获取后端输出文件的扩展名
+     * @param backend 后端
+     * @return 扩展名（含点），JSON输出使用 .code.json 以免覆盖输入文件
+     */
+    static QString fileSuffix(Backend backend);
+
+private:
+    /**
+     * @brief 获取输入文件对应的输出路径（不含扩展名）
+     * @param inputFile 输入文件
+     * @return 输出目录下以输入文件基本名命名的绝对路径
+     */
+    QString outputBase(const QString &inputFile) const;
+
+    Options m_options;                 ///< 生成选项
+};
+
+#endif // BATCHGENERATOR_H
@@ -0,0 +1,537 @@
+/**
+ * @file BinaryProject.cpp
+ * @brief 二进制项目文件类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "BinaryProject.h"
+#include "Node.h"
+#include "GroupNode.h"
+#include <QCborMap>
+#include <QCborValue>
+#include <QColor>
+#include <QDebug>
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+const char kMagic[4] = {'D', 'A', 'G', 'B'};
+
+constexpr qint64 kHeaderSize = 32;         // 魔数、版本号、段数、标志、文件长度、保留
+constexpr qint64 kSectionEntrySize = 24;   // 段标识、保留、偏移、长度
+constexpr qint64 kNodeRecordSize = 56;
+constexpr qint64 kEdgeRecordSize = 16;
+constexpr qint64 kGroupRecordSize = 32;
+constexpr qint64 kSectionAlignment = 8;
+
+constexpr quint32 kNodeIsGroup = 0x1;
+constexpr quint32 kNodeHasCustomColor = 0x2;
+constexpr quint32 kNoGroup = 0xFFFFFFFFu;
+
+template <typename T>
+void put(QByteArray &out, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToLittleEndian<T>(value, bytes);
+    out.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+void putDouble(QByteArray &out, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put<quint64>(out, bits);
+}
+
+template <typename T>
+T get(const uchar *data)
+{
+    return qFromLittleEndian<T>(data);
+}
+
+double getDouble(const uchar *data)
+{
+    const quint64 bits = get<quint64>(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief 编码时使用的字符串表，相同的字符串只存一次，下标0为空字符串
+ */
+class StringTable
+{
+public:
+    StringTable() { index(QString()); }
+
+    quint32 index(const QString &text)
+    {
+        auto it = m_indices.constFind(text);
+        if (it != m_indices.constEnd()) {
+            return it.value();
+        }
+        const quint32 index = static_cast<quint32>(m_offsets.size());
+        m_indices.insert(text, index);
+        m_offsets.append(static_cast<quint32>(m_data.size()));
+        m_data.append(text.toUtf8());
+        return index;
+    }
+
+    // 个数、count + 1 个偏移（最后一个为内容总长度）、UTF-8内容
+    QByteArray encode() const
+    {
+        QByteArray out;
+        out.reserve(4 + 4 * (m_offsets.size() + 1) + m_data.size());
+        put<quint32>(out, static_cast<quint32>(m_offsets.size()));
+        for (quint32 offset : m_offsets) {
+            put<quint32>(out, offset);
+        }
+        put<quint32>(out, static_cast<quint32>(m_data.size()));
+        out.append(m_data);
+        return out;
+    }
+
+private:
+    QHash<QString, quint32> m_indices;
+    QList<quint32> m_offsets;
+    QByteArray m_data;
+};
+
+} // namespace
+
+/**
+ * @brief 检查文件是否为二进制项目文件（只读取文件头的魔数）
+ * @param fileName 文件路径
+ * @return 是二进制项目文件返回true
+ */
+bool BinaryProject::isBinaryProject(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.read(sizeof(kMagic)) == QByteArray(kMagic, sizeof(kMagic));
+}
+
+/**
+ * @brief 把流程数据编码为二进制项目文件内容
+ * @param flowData 流程数据，格式与 NodeScene::getFlowData 相同
+ * @return 文件内容
+ */
+QByteArray BinaryProject::encode(const QJsonObject &flowData)
+{
+    StringTable strings;
+    QByteArray lists;
+    QByteArray nodes;
+    QByteArray edges;
+    QByteArray groups;
+    QByteArray groupBlobs;
+    QByteArray nodeIds;
+
+    // 把一组字符串写入 LIST 段，返回起始位置
+    auto appendList = [&](const QJsonArray &values) {
+        const quint32 first = static_cast<quint32>(lists.size() / 4);
+        for (const QJsonValue &value : values) {
+            put<quint32>(lists, strings.index(value.toString()));
+        }
+        return first;
+    };
+
+    const QJsonArray nodesArray = flowData["nodes"].toArray();
+    QHash<QString, quint32> nodeIndices;
+    nodeIndices.reserve(nodesArray.size());
+    nodes.reserve(nodesArray.size() * kNodeRecordSize);
+    nodeIds.reserve(nodesArray.size() * 8);
+
+    for (int i = 0; i < nodesArray.size(); ++i) {
+        const QJsonObject nodeObj = nodesArray.at(i).toObject();
+        nodeIndices.insert(nodeObj["id"].toString(), static_cast<quint32>(i));
+        put<quint64>(nodeIds, Node::idFromString(nodeObj["id"].toString()));
+
+        quint32 flags = 0;
+        quint32 color = 0;
+        if (nodeObj.contains("customColor")) {
+            flags |= kNodeHasCustomColor;
+            color = QColor(nodeObj["customColor"].toString()).rgba();
+        }
+
+        quint32 groupIndex = kNoGroup;
+        if (nodeObj["isGroup"].toBool(false)) {
+            flags |= kNodeIsGroup;
+            groupIndex = static_cast<quint32>(groups.size() / kGroupRecordSize);
+
+            const QJsonArray internalNodes = nodeObj["internalNodes"].toArray();
+            const QJsonObject interior{
+                {"internalNodes", internalNodes},
+                {"internalConnections", nodeObj["internalConnections"]},
+                {"originalPositions", nodeObj["originalPositions"]}
+            };
+            const QByteArray blob = QCborValue::fromJsonValue(interior).toCbor();
+            const QJsonArray inputLabels = nodeObj["inputPortLabels"].toArray();
+            const QJsonArray outputLabels = nodeObj["outputPortLabels"].toArray();
+
+            put<quint64>(groups, static_cast<quint64>(groupBlobs.size()));
+            put<quint32>(groups, static_cast<quint32>(blob.size()));
+            put<quint32>(groups, appendList(inputLabels));
+            put<quint32>(groups, static_cast<quint32>(inputLabels.size()));
+            put<quint32>(groups, appendList(outputLabels));
+            put<quint32>(groups, static_cast<quint32>(outputLabels.size()));
+            put<quint32>(groups, static_cast<quint32>(internalNodes.size()));
+            groupBlobs.append(blob);
+        }
+
+        const QJsonObject posObj = nodeObj["position"].toObject();
+        const QJsonArray parameters = nodeObj["parameters"].toArray();
+        putDouble(nodes, posObj["x"].toDouble());
+        putDouble(nodes, posObj["y"].toDouble());
+        put<quint32>(nodes, strings.index(nodeObj["type"].toString()));
+        put<quint32>(nodes, strings.index(nodeObj["name"].toString()));
+        put<quint32>(nodes, strings.index(nodeObj["displayTypeName"].toString()));
+        put<quint32>(nodes, color);
+        put<quint32>(nodes, flags);
+        put<quint16>(nodes, static_cast<quint16>(qBound(0, nodeObj["inputPortCount"].toInt(1), 0xFFFF)));
+        put<quint16>(nodes, static_cast<quint16>(qBound(0, nodeObj["outputPortCount"].toInt(1), 0xFFFF)));
+        put<quint32>(nodes, appendList(parameters));
+        put<quint32>(nodes, static_cast<quint32>(parameters.size()));
+        put<quint32>(nodes, groupIndex);
+        put<quint32>(nodes, 0);  // 保留
+    }
+
+    // 连接端点换成节点下标，找不到端点的连接与JSON导入时一样被丢弃
+    const QJsonArray connectionsArray = flowData["connections"].toArray();
+    edges.reserve(connectionsArray.size() * kEdgeRecordSize);
+    for (const QJsonValue &connValue : connectionsArray) {
+        const QJsonObject connObj = connValue.toObject();
+        const QString fromNodeId = connObj.contains("from") ?
+            connObj["from"].toString() : connObj["fromNode"].toString();
+        const QString toNodeId = connObj.contains("to") ?
+            connObj["to"].toString() : connObj["toNode"].toString();
+        auto from = nodeIndices.constFind(fromNodeId);
+        auto to = nodeIndices.constFind(toNodeId);
+        if (from == nodeIndices.constEnd() || to == nodeIndices.constEnd()) {
+            continue;
+        }
+        put<quint32>(edges, from.value());
+        put<quint32>(edges, to.value());
+        put<quint16>(edges, static_cast<quint16>(qBound(0, connObj["fromPort"].toInt(0), 0xFFFF)));
+        put<quint16>(edges, static_cast<quint16>(qBound(0, connObj["toPort"].toInt(0), 0xFFFF)));
+        put<quint32>(edges, static_cast<quint32>(connObj["lineType"].toInt(0)));
+    }
+
+    const QList<QPair<QByteArray, QByteArray>> sections{
+        {"META", QCborValue::fromJsonValue(flowData["metadata"]).toCbor()},
+        {"STRS", strings.encode()},
+        {"LIST", lists},
+        {"NODE", nodes},
+        {"EDGE", edges},
+        {"GRPS", groups},
+        {"GBLB", groupBlobs},
+        {"NIDS", nodeIds}
+    };
+
+    // 计算各段偏移（按8字节对齐）
+    QList<qint64> offsets;
+    qint64 offset = kHeaderSize + sections.size() * kSectionEntrySize;
+    for (const auto &section : sections) {
+        offset = (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+        offsets.append(offset);
+        offset += section.second.size();
+    }
+    const qint64 fileSize = offset;
+
+    QByteArray out;
+    out.reserve(fileSize);
+    out.append(kMagic, sizeof(kMagic));
+    put<quint16>(out, VERSION_MAJOR);
+    put<quint16>(out, VERSION_MINOR);
+    put<quint32>(out, static_cast<quint32>(sections.size()));
+    put<quint32>(out, 0);  // 标志
+    put<quint64>(out, static_cast<quint64>(fileSize));
+    put<quint64>(out, 0);  // 保留
+
+    for (int i = 0; i < sections.size(); ++i) {
+        out.append(sections[i].first.constData(), 4);
+        put<quint32>(out, 0);  // 保留
+        put<quint64>(out, static_cast<quint64>(offsets[i]));
+        put<quint64>(out, static_cast<quint64>(sections[i].second.size()));
+    }
+    for (int i = 0; i < sections.size(); ++i) {
+        out.append(QByteArray(offsets[i] - out.size(), '\0'));
+        out.append(sections[i].second);
+    }
+    return out;
+}
+
+/**
+ * @brief 映射并打开二进制项目文件
+ * @param fileName 文件路径
+ * @param error 失败时写入错误信息，可以为空指针
+ * @return 打开成功返回文件对象，失败返回空指针
+ */
+QSharedPointer<BinaryProject> BinaryProject::open(const QString &fileName, QString *error)
+{
+    QSharedPointer<BinaryProject> project(new BinaryProject);
+    QString message;
+    if (!project->map(fileName, &message)) {
+        qWarning() << "无法打开二进制项目文件" << fileName << ":" << message;
+        if (error) {
+            *error = message;
+        }
+        return QSharedPointer<BinaryProject>();
+    }
+    return project;
+}
+
+/**
+ * @brief 映射文件并校验文件头和段表
+ * @param fileName 文件路径
+ * @param error 失败时写入错误信息
+ * @return 成功返回true
+ */
+bool BinaryProject::map(const QString &fileName, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        *error = message;
+        return false;
+    };
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+    const qint64 size = m_file.size();
+    if (size < kHeaderSize) {
+        return fail("文件过短");
+    }
+    const uchar *data = m_file.map(0, size);
+    if (!data) {
+        return fail(QString("无法映射文件: %1").arg(m_file.errorString()));
+    }
+
+    // 文件头
+    if (std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        return fail("不是二进制项目文件");
+    }
+    const quint16 major = get<quint16>(data + 4);
+    const quint16 minor = get<quint16>(data + 6);
+    if (major != VERSION_MAJOR) {
+        return fail(QString("不支持的文件格式版本 %1.%2").arg(major).arg(minor));
+    }
+    const quint64 sectionCount = get<quint32>(data + 8);
+    if (get<quint64>(data + 16) != static_cast<quint64>(size)) {
+        return fail("文件长度与文件头不符，文件可能不完整");
+    }
+    if (static_cast<quint64>(kHeaderSize) + sectionCount * kSectionEntrySize > static_cast<quint64>(size)) {
+        return fail("段表越界");
+    }
+
+    // 段表：未知的段（较新的次版本号）被忽略
+    QByteArray missing = "META STRS LIST NODE EDGE GRPS GBLB";
+    for (quint64 i = 0; i < sectionCount; ++i) {
+        const uchar *entry = data + kHeaderSize + i * kSectionEntrySize;
+        const QByteArray id(reinterpret_cast<const char*>(entry), 4);
+        const quint64 offset = get<quint64>(entry + 8);
+        const quint64 length = get<quint64>(entry + 16);
+        if (offset > static_cast<quint64>(size) || length > static_cast<quint64>(size) - offset) {
+            return fail(QString("段 %1 越界").arg(QString::fromLatin1(id)));
+        }
+        const Section section{data + offset, static_cast<qint64>(length)};
+        if (id == "META") m_meta = section;
+        else if (id == "STRS") m_stringOffsets = section;
+        else if (id == "LIST") m_lists = section;
+        else if (id == "NODE") m_nodes = section;
+        else if (id == "EDGE") m_edges = section;
+        else if (id == "GRPS") m_groups = section;
+        else if (id == "GBLB") m_groupBlobs = section;
+        else if (id == "NIDS") { m_nodeIds = section; continue; }  // 可选段
+        else continue;
+        missing.replace(id, "");
+    }
+    if (!missing.trimmed().isEmpty()) {
+        return fail(QString("缺少段 %1").arg(QString::fromLatin1(missing.simplified())));
+    }
+
+    // 定长记录段
+    if (m_nodes.size % kNodeRecordSize != 0 || m_edges.size % kEdgeRecordSize != 0
+        || m_groups.size % kGroupRecordSize != 0 || m_lists.size % 4 != 0) {
+        return fail("记录段长度错误");
+    }
+    if (m_nodes.size / kNodeRecordSize > INT_MAX || m_edges.size / kEdgeRecordSize > INT_MAX) {
+        return fail("节点或连接数量过多");
+    }
+    m_nodeCount = static_cast<int>(m_nodes.size / kNodeRecordSize);
+    m_edgeCount = static_cast<int>(m_edges.size / kEdgeRecordSize);
+    m_groupCount = static_cast<int>(m_groups.size / kGroupRecordSize);
+    if (m_nodeIds.size != static_cast<qint64>(m_nodeCount) * 8) {
+        m_nodeIds = Section();  // 与节点数不符时忽略，加载后分配新的ID
+    }
+
+    // 字符串表：偏移必须单调不减且不超出内容，之后按下标读取时不再检查
+    if (m_stringOffsets.size < 8) {
+        return fail("字符串表错误");
+    }
+    m_stringCount = get<quint32>(m_stringOffsets.data);
+    const quint64 offsetsSize = 4 * (static_cast<quint64>(m_stringCount) + 1);
+    if (4 + offsetsSize > static_cast<quint64>(m_stringOffsets.size)) {
+        return fail("字符串表越界");
+    }
+    m_stringData = Section{m_stringOffsets.data + 4 + offsetsSize,
+                           m_stringOffsets.size - 4 - static_cast<qint64>(offsetsSize)};
+    m_stringOffsets = Section{m_stringOffsets.data + 4, static_cast<qint64>(offsetsSize)};
+    quint32 previous = 0;
+    for (quint32 i = 0; i <= m_stringCount; ++i) {
+        const quint32 current = get<quint32>(m_stringOffsets.data + 4 * static_cast<qint64>(i));
+        if (current < previous || current > static_cast<quint64>(m_stringData.size)) {
+            return fail("字符串表偏移错误");
+        }
+        previous = current;
+    }
+    return true;
+}
+
+/**
+ * @brief 获取流程元数据
+ * @return 元数据JSON对象
+ */
+QJsonObject BinaryProject::metadata() const
+{
+    const QByteArray cbor = QByteArray::fromRawData(reinterpret_cast<const char*>(m_meta.data), m_meta.size);
+    return QCborValue::fromCbor(cbor).toMap().toJsonObject();
+}
+
+/**
+ * @brief 按下标读取字符串
+ * @param index 字符串表下标，越界时返回空字符串
+ * @return 字符串
+ */
+QString BinaryProject::string(quint32 index) const
+{
+    if (index >= m_stringCount) {
+        return QString();
+    }
+    const quint32 begin = get<quint32>(m_stringOffsets.data + 4 * static_cast<qint64>(index));
+    const quint32 end = get<quint32>(m_stringOffsets.data + 4 * static_cast<qint64>(index) + 4);
+    return QString::fromUtf8(reinterpret_cast<const char*>(m_stringData.data) + begin, end - begin);
+}
+
+/**
+ * @brief 读取一段字符串下标列表
+ * @param first LIST 段中的起始位置
+ * @param count 个数
+ * @return 字符串列表，越界部分被忽略
+ */
+QStringList BinaryProject::stringList(quint32 first, quint32 count) const
+{
+    const quint64 available = static_cast<quint64>(m_lists.size / 4);
+    const quint64 end = qMin<quint64>(static_cast<quint64>(first) + count, available);
+    QStringList result;
+    for (quint64 i = first; i < end; ++i) {
+        result.append(string(get<quint32>(m_lists.data + 4 * i)));
+    }
+    return result;
+}
+
+/**
+ * @brief 按下标构造节点（尚未加入场景）
+ * @param index 节点下标
+ * @return 新建的节点，组节点的内部子图延迟加载
+ */
+Node* BinaryProject::createNode(int index) const
+{
+    if (index < 0 || index >= m_nodeCount) {
+        return nullptr;
+    }
+
+    Node *node = decodeNode(index);
+    if (m_nodeIds.data) {
+        node->setId(get<quint64>(m_nodeIds.data + index * 8));
+    }
+    return node;
+}
+
+/**
+ * @brief 解码节点记录
+ * @param index 节点下标（已检查范围）
+ * @return 新建的节点
+ */
+Node* BinaryProject::decodeNode(int index) const
+{
+    const uchar *record = m_nodes.data + index * kNodeRecordSize;
+    const QPointF position(getDouble(record), getDouble(record + 8));
+    const QString name = string(get<quint32>(record + 20));
+    const quint32 flags = get<quint32>(record + 32);
+    const quint32 groupIndex = get<quint32>(record + 48);
+
+    if ((flags & kNodeIsGroup) && groupIndex < static_cast<quint32>(m_groupCount)) {
+        // 组节点：只设置端口，内部子图在第一次访问时从映射内存中解码
+        const uchar *group = m_groups.data + groupIndex * kGroupRecordSize;
+        GroupNode *groupNode = new GroupNode(name, position);
+        const QSharedPointer<const BinaryProject> self = sharedFromThis();
+        const int interiorIndex = static_cast<int>(groupIndex);
+        groupNode->setDeferredInterior([self, interiorIndex]() { return self->groupInterior(interiorIndex); },
+                                       static_cast<int>(get<quint32>(group + 28)),
+                                       stringList(get<quint32>(group + 12), get<quint32>(group + 16)),
+                                       stringList(get<quint32>(group + 20), get<quint32>(group + 24)));
+        return groupNode;
+    }
+
+    Node *node = new Node(string(get<quint32>(record + 16)), name, position);
+    node->setParameters(stringList(get<quint32>(record + 40), get<quint32>(record + 44)));
+    if (flags & kNodeHasCustomColor) {
+        node->setCustomColor(QColor::fromRgba(get<quint32>(record + 28)));
+    }
+    const QString displayTypeName = string(get<quint32>(record + 24));
+    if (!displayTypeName.isEmpty()) {
+        node->setDisplayTypeName(displayTypeName);
+    }
+    node->setInputPortCount(get<quint16>(record + 36));
+    node->setOutputPortCount(get<quint16>(record + 38));
+    return node;
+}
+
+/**
+ * @brief 按下标读取连接记录
+ * @param index 连接下标
+ * @return 连接记录
+ */
+BinaryProject::Edge BinaryProject::edge(int index) const
+{
+    const uchar *record = m_edges.data + index * kEdgeRecordSize;
+    Edge edge;
+    edge.fromNode = static_cast<int>(get<quint32>(record));
+    edge.toNode = static_cast<int>(get<quint32>(record + 4));
+    edge.fromPort = get<quint16>(record + 8);
+    edge.toPort = get<quint16>(record + 10);
+    edge.lineType = static_cast<int>(get<quint32>(record + 12));
+    return edge;
+}
+
+/**
+ * @brief 解码组节点的内部子图
+ * @param groupIndex 组节点索引下标
+ * @return 包含 internalNodes、internalConnections 和 originalPositions 的JSON对象
+ */
+QJsonObject BinaryProject::groupInterior(int groupIndex) const
+{
+    if (groupIndex < 0 || groupIndex >= m_groupCount) {
+        return QJsonObject();
+    }
+    const uchar *group = m_groups.data + groupIndex * kGroupRecordSize;
+    const quint64 offset = get<quint64>(group);
+    const quint64 length = get<quint32>(group + 8);
+    if (offset > static_cast<quint64>(m_groupBlobs.size) || length > static_cast<quint64>(m_groupBlobs.size) - offset) {
+        qWarning() << "二进制项目文件" << fileName() << "中的组节点数据越界";
+        return QJsonObject();
+    }
+    const QByteArray cbor = QByteArray::fromRawData(reinterpret_cast<const char*>(m_groupBlobs.data + offset),
+                                                    static_cast<qsizetype>(length));
+    return QCborValue::fromCbor(cbor).toMap().toJsonObject();
+}
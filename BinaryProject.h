@@ -0,0 +1,182 @@
+/**
+ * @file BinaryProject.h
+ * @brief 二进制项目文件类头文件，定义紧凑的二进制项目格式及其内存映射读取
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BINARYPROJECT_H
+#define BINARYPROJECT_H
+
+#include <QByteArray>                  // 字节数组类
+#include <QFile>                       // 文件类
+#include <QJsonObject>                 // JSON对象类
+#include <QSharedPointer>              // 共享指针类
+#include <QString>                     // 字符串类
+#include <QStringList>                 // 字符串列表类
+
+// 前向声明
+class Node;                            // 节点类
+
+/**
+ * @class BinaryProject
+ * @brief 二进制项目文件（.dagb）
+ *
+ * 文件由固定长度的文件头、段表和若干段组成，所有整数按小端序存储：
+ * - META: 流程元数据（CBOR）
+ * - STRS: 字符串表，所有名称、类型和参数只存一次，其余位置用下标引用
+ * - LIST: 字符串下标列表（节点参数、组节点端口标签）
+ * - NODE: 定长节点记录（位置、类型、名称、端口数量、参数区间等）
+ * - EDGE: 定长连接记录（端点节点下标、端口索引和线型）
+ * - GRPS: 组节点索引（内部子图数据的位置、端口标签区间、内部节点数量）
+ * - GBLB: 组节点内部子图（CBOR，格式与JSON项目文件中组节点的内部数据相同）
+ * - NIDS: 每个节点的持久ID（自1.1版起，可选；缺少时加载后分配新的ID）
+ *
+ * 打开时用 QFile::map 映射整个文件，只校验文件头和段边界，不复制数据；
+ * 节点和连接按下标直接从映射内存中解码，可以在多个线程中并行调用 createNode。
+ * 组节点的内部子图延迟到第一次访问时才解码（见 GroupNode::setDeferredInterior），
+ * 此前组节点持有文件的共享指针，映射一直有效。
+ *
+ * 主版本号不同的文件拒绝打开；次版本号只增加可忽略的段，旧版本程序仍可读取。
+ */
+class BinaryProject : public QEnableSharedFromThis<BinaryProject>
+{
+public:
+    /**
+     * @brief 文件格式主版本号，不兼容的改动时增加
+     */
+    static constexpr quint16 VERSION_MAJOR = 1;
+
+    /**
+     * @brief 文件格式次版本号，增加可选段时增加
+     */
+    static constexpr quint16 VERSION_MINOR = 1;
+
+    /**
+     * @brief 连接记录
+     */
+    struct Edge {
+        int fromNode;                  ///< 源节点下标
+        int fromPort;                  ///< 源节点输出端口索引
+        int toNode;                    ///< 目标节点下标
+        int toPort;                    ///< 目标节点输入端口索引
+        int lineType;                  ///< 连线类型（Connection::LineType 的值）
+    };
+
+    /**
+     * @brief 检查文件是否为二进制项目文件（只读取文件头的魔数）
+     * @param fileName 文件路径
+     * @return 是二进制项目文件返回true
+     */
+    static bool isBinaryProject(const QString &fileName);
+
+    /**
+     * @brief 把流程数据编码为二进制项目文件内容
+     * @param flowData 流程数据，格式与 NodeScene::getFlowData 相同
+     * @return 文件内容
+     *
+     * 只处理JSON数据，不访问图形项，可以在工作线程中调用。
+     */
+    static QByteArray encode(const QJsonObject &flowData);
+
+    /**
+     * @brief 映射并打开二进制项目文件
+     * @param fileName 文件路径
+     * @param error 失败时写入错误信息，可以为空指针
+     * @return 打开成功返回文件对象，失败返回空指针
+     */
+    static QSharedPointer<BinaryProject> open(const QString &fileName, QString *error = nullptr);
+
+    // 基本信息访问器
+    QString fileName() const { return m_file.fileName(); }   ///< 获取文件路径
+    int nodeCount() const { return m_nodeCount; }            ///< 获取节点数量
+    int edgeCount() const { return m_edgeCount; }            ///< 获取连接数量
+
+    /**
+     * @brief 获取流程元数据
+     * @return 元数据JSON对象
+     */
+    QJsonObject metadata() const;
+
+    /**
+     * @brief 按下标构造节点（尚未加入场景）
+     * @param index 节点下标
+     * @return 新建的节点，组节点的内部子图延迟加载
+     *
+     * 只读取映射内存，可以在工作线程中并行调用。
+     */
+    Node* createNode(int index) const;
+
+    /**
+     * @brief 按下标读取连接记录
+     * @param index 连接下标
+     * @return 连接记录
+     */
+    Edge edge(int index) const;
+
+    /**
+     * @brief 解码组节点的内部子图
+     * @param groupIndex 组节点索引下标
+     * @return 包含 internalNodes、internalConnections 和 originalPositions 的JSON对象
+     */
+    QJsonObject groupInterior(int groupIndex) const;
+
+private:
+    /**
+     * @brief 文件中的一段数据
+     */
+    struct Section {
+        const uchar *data = nullptr;   ///< 段在映射内存中的起始地址
+        qint64 size = 0;               ///< 段的字节数
+    };
+
+    BinaryProject() = default;
+
+    /**
+     * @brief 映射文件并校验文件头和段表
+     * @param fileName 文件路径
+     * @param error 失败时写入错误信息
+     * @return 成功返回true
+     */
+    bool map(const QString &fileName, QString *error);
+
+    /**
+     * @brief 解码节点记录（不含持久ID）
+     * @param index 节点下标（已检查范围）
+     * @return 新建的节点
+     */
+    Node* decodeNode(int index) const;
+
+    /**
+     * @brief 按下标读取字符串
+     * @param index 字符串表下标，越界时返回空字符串
+     * @return 字符串
+     */
+    QString string(quint32 index) const;
+
+    /**
+     * @brief 读取一段字符串下标列表
+     * @param first LIST 段中的起始位置
+     * @param count 个数
+     * @return 字符串列表，越界部分被忽略
+     */
+    QStringList stringList(quint32 first, quint32 count) const;
+
+    QFile m_file;                      ///< 被映射的文件（映射随文件对象一起释放）
+    Section m_meta;                    ///< 元数据段
+    Section m_stringOffsets;           ///< 字符串偏移表（count + 1 项）
+    Section m_stringData;              ///< 字符串内容（UTF-8）
+    Section m_lists;                   ///< 字符串下标列表段
+    Section m_nodes;                   ///< 节点记录段
+    Section m_edges;                   ///< 连接记录段
+    Section m_groups;                  ///< 组节点索引段
+    Section m_groupBlobs;              ///< 组节点内部子图段
+    Section m_nodeIds;                 ///< 节点持久ID段（可选）
+    quint32 m_stringCount = 0;         ///< 字符串个数
+    int m_nodeCount = 0;               ///< 节点个数
+    int m_edgeCount = 0;               ///< 连接个数
+    int m_groupCount = 0;              ///< 组节点个数
+};
+
+#endif // BINARYPROJECT_H
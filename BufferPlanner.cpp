@@ -0,0 +1,130 @@
+/**
+ * @file BufferPlanner.cpp
+ * @brief 缓冲区规划器类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "BufferPlanner.h"
+#include "FlowScheduler.h"
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 构造函数，完成缓冲区规划
+ * @param scheduler 已完成调度的流程调度器
+ * @param stageOf 每个节点所在的执行阶段
+ * @param kinds 每个节点的访问方式
+ *
+ * 分两遍完成：
+ * 1. 逆拓扑序计算每个输出数据的最后读取阶段，以及该阶段的读者数量，
+ *    只读直通节点的读者会合并到其上游数据上
+ * 2. 按执行顺序线性扫描分配缓冲区，阶段严格早于当前节点的缓冲区才视为空闲，
+ *    因此同一阶段并发执行的节点不会写入同一个缓冲区
+ */
+BufferPlanner::BufferPlanner(const FlowScheduler &scheduler, const QVector<int> &stageOf, const QVector<NodeKind> &kinds)
+    : m_slabCount(0)
+{
+    const int count = scheduler.nodeCount();
+    const QVector<int> &order = scheduler.orderIndices();
+    const int kForever = std::numeric_limits<int>::max(); // 没有下游的输出是最终结果，保留到程序结束
+
+    m_slabOf.fill(-1, count);
+    m_outputMode.fill(NoOutput, count);
+
+    // 第一遍：计算生命周期
+    QVector<int> lastRead(count, -1);   // 数据最后被读取的阶段
+    QVector<int> lastReaders(count, 0); // 该阶段的读者数量
+    auto merge = [&](int index, int stage, int readers) {
+        if (stage > lastRead.at(index)) {
+            lastRead[index] = stage;
+            lastReaders[index] = readers;
+        } else if (stage == lastRead.at(index)) {
+            lastReaders[index] += readers;
+        }
+    };
+
+    for (int i = order.size() - 1; i >= 0; --i) {
+        const int index = order.at(i);
+        if (kinds.at(index) == SinkNode) {
+            continue;
+        }
+
+        QVector<int> consumers;
+        for (int consumer : scheduler.successors(index)) {
+            if (stageOf.at(consumer) < 0 || consumers.contains(consumer)) {
+                continue;
+            }
+            consumers.append(consumer);
+            merge(index, stageOf.at(consumer), 1);
+
+            // 直通节点的读者读的也是这份数据
+            if (kinds.at(consumer) == PassThroughNode && scheduler.predecessors(consumer).first() == index) {
+                merge(index, lastRead.at(consumer), lastReaders.at(consumer));
+            }
+        }
+
+        if (consumers.isEmpty()) {
+            lastRead[index] = kForever;
+            lastReaders[index] = 0;
+        }
+    }
+
+    // 第二遍：线性扫描分配缓冲区
+    QVector<int> slabEnd;                 // 缓冲区中数据的最后读取阶段
+    QVector<int> rootOf(count, -1);       // 缓冲区中数据的真正生产者（跳过直通别名）
+    typedef std::pair<int, int> Entry;    // (结束阶段, 缓冲区编号)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> expiring;
+
+    for (int index : order) {
+        const int stage = stageOf.at(index);
+        if (stage < 0 || kinds.at(index) == SinkNode) {
+            continue;
+        }
+
+        const QVector<int> &preds = scheduler.predecessors(index);
+        const int input = preds.isEmpty() ? -1 : preds.first();
+        const bool hasInput = input >= 0 && m_slabOf.at(input) >= 0;
+
+        int slab = -1;
+        if (hasInput && kinds.at(index) == PassThroughNode) {
+            slab = m_slabOf.at(input);
+            rootOf[index] = rootOf.at(input);
+            m_outputMode[index] = Alias;
+        } else if (hasInput && lastRead.at(rootOf.at(input)) == stage
+                   && lastReaders.at(rootOf.at(input)) == 1) {
+            // 当前节点是这份数据在该阶段唯一的读者，之后也不再有人读取
+            slab = m_slabOf.at(input);
+            rootOf[index] = index;
+            m_outputMode[index] = InPlace;
+        } else {
+            // 取一个已经过期的缓冲区，跳过因生命周期延长而失效的条目
+            while (!expiring.empty() && expiring.top().first < stage) {
+                const Entry entry = expiring.top();
+                expiring.pop();
+                if (slabEnd.at(entry.second) == entry.first) {
+                    slab = entry.second;
+                    break;
+                }
+            }
+            if (slab < 0) {
+                slab = m_slabCount++;
+                slabEnd.append(-1);
+            }
+            rootOf[index] = index;
+            m_outputMode[index] = Fresh;
+        }
+
+        m_slabOf[index] = slab;
+        if (lastRead.at(index) > slabEnd.at(slab)) {
+            slabEnd[slab] = lastRead.at(index);
+            if (slabEnd.at(slab) != kForever) {
+                expiring.push(Entry(slabEnd.at(slab), slab));
+            }
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file BufferPlanner.h
+ * @brief 缓冲区规划器类头文件，负责为生成代码中的节点输出分配复用的缓冲区
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef BUFFERPLANNER_H
+#define BUFFERPLANNER_H
+
+#include <QVector>
+
+class FlowScheduler;
+
+/**
+ * @class BufferPlanner
+ * @brief 缓冲区规划器类
+ *
+ * 类似寄存器分配，根据执行阶段计算每个节点输出的生命周期，
+ * 再用线性扫描把所有输出分配到少量缓冲区（slab）上：
+ * - 只读的直通节点（如FFT）与上游共用同一个缓冲区
+ * - 上游数据的最后一个读者若独占该阶段，则原地处理上游缓冲区
+ * - 其余节点使用生命周期已结束的空闲缓冲区，没有空闲缓冲区时才新建
+ *
+ * 这样生成代码的峰值内存只与图的"宽度"相关，而不是与节点总数相关。
+ */
+class BufferPlanner
+{
+public:
+    /**
+     * @brief 节点对输入数据的访问方式
+     */
+    enum NodeKind {
+        SinkNode,         // 只读输入，不产生输出
+        PassThroughNode,  // 只读输入，输出即主输入本身
+        TransformNode     // 修改主输入（或在无输入时生成数据）
+    };
+
+    /**
+     * @brief 节点输出缓冲区的来源
+     */
+    enum OutputMode {
+        NoOutput,   // 不产生输出（汇节点或无法调度的节点）
+        Alias,      // 与主输入共用缓冲区，不修改数据
+        InPlace,    // 直接在主输入的缓冲区上原地处理
+        Fresh       // 使用单独的缓冲区（有输入时需先复制主输入）
+    };
+
+    /**
+     * @brief 构造函数，完成缓冲区规划
+     * @param scheduler 已完成调度的流程调度器
+     * @param stageOf 每个节点所在的执行阶段，同一阶段的节点可能并发执行，-1表示不执行
+     * @param kinds 每个节点的访问方式
+     */
+    BufferPlanner(const FlowScheduler &scheduler, const QVector<int> &stageOf, const QVector<NodeKind> &kinds);
+
+    /**
+     * @brief 获取需要预先分配的缓冲区数量
+     * @return 缓冲区数量
+     */
+    int slabCount() const { return m_slabCount; }
+
+    /**
+     * @brief 获取节点输出所在的缓冲区编号
+     * @param index 节点索引
+     * @return 缓冲区编号，不产生输出返回-1
+     */
+    int slabOf(int index) const { return m_slabOf.at(index); }
+
+    /**
+     * @brief 获取节点输出缓冲区的来源
+     * @param index 节点索引
+     * @return 输出模式
+     */
+    OutputMode outputMode(int index) const { return m_outputMode.at(index); }
+
+private:
+    QVector<int> m_slabOf;             ///< 节点 -> 缓冲区编号
+    QVector<OutputMode> m_outputMode;  ///< 节点 -> 输出模式
+    int m_slabCount;                   ///< 缓冲区总数
+};
+
+#endif // BUFFERPLANNER_H
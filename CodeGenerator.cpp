@@ -11,14 +11,359 @@
 #include <QJsonDocument> // JSON文档类
 #include <QDateTime>    // 日期时间类
 #include <QDebug>       // 调试输出类
+#include <QHash>        // 哈希表类
+#include <QSet>         // 集合类
+#include <QFile>        // 文件操作类
+#include <QDir>         // 目录操作类
+#include <QCryptographicHash> // 哈希计算类
+#include <QRegularExpression> // 正则表达式类
+#include "FlowScheduler.h" // 流程调度器类
+#include "BufferPlanner.h" // 缓冲区规划器类
 
 /**
  * @brief 构造函数
  */
 CodeGenerator::CodeGenerator()
+    : m_parallelExecution(true)
+    , m_maxWorkers(0)
+    , m_blockSize(0)
+    , m_templatePipeline(false)
+    , m_projectLayout(false)
+    , m_instrumentation(false)
+    , m_benchmarkIterations(100)
+    , m_benchmarkWarmup(10)
+    , m_incremental(false)
+    , m_reusedFragments(0)
+    , m_emittedFragments(0)
 {
 }
 
+/**
+ * @brief 设置是否启用增量生成
+ * @param enabled 为true时缓存节点片段并省略生成时间
+ */
+void CodeGenerator::setIncremental(bool enabled)
+{
+    m_incremental = enabled;
+    if (!enabled) {
+        m_fragments.clear();
+    }
+}
+
+/**
+ * @brief 计算每个节点的内容哈希
+ * @param flowData 标准流程图的JSON数据
+ * @return 节点ID到哈希值的映射
+ */
+QHash<QString, QByteArray> CodeGenerator::nodeHashes(const QJsonObject &flowData)
+{
+    // 每个节点的输入连接，排序后与连接在数组中的顺序无关
+    QHash<QString, QStringList> incoming;
+    for (const QJsonValue &connValue : flowData["connections"].toArray()) {
+        QJsonObject conn = connValue.toObject();
+        incoming[conn["to"].toString()].append(QString("%1:%2>%3")
+            .arg(conn["from"].toString()).arg(conn["fromPort"].toInt(0)).arg(conn["toPort"].toInt(0)));
+    }
+    
+    QHash<QString, QByteArray> hashes;
+    QJsonArray nodes = flowData["nodes"].toArray();
+    hashes.reserve(nodes.size());
+    for (const QJsonValue &nodeValue : nodes) {
+        QJsonObject node = nodeValue.toObject();
+        const QString nodeId = node["id"].toString();
+        QStringList inputs = incoming.value(nodeId);
+        inputs.sort();
+        
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(node["type"].toString().toUtf8());
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(node["name"].toString().toUtf8());
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(QJsonDocument(node["parameters"].toArray()).toJson(QJsonDocument::Compact));
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(inputs.join(',').toUtf8());
+        hashes.insert(nodeId, hash.result());
+    }
+    return hashes;
+}
+
+/**
+ * @brief 建立节点ID到节点数据的索引
+ * @param flowData 标准流程图的JSON数据
+ * @return 节点ID到节点JSON对象的映射
+ */
+QHash<QString, QJsonObject> CodeGenerator::nodeTable(const QJsonObject &flowData)
+{
+    const QJsonArray nodes = flowData["nodes"].toArray();
+    QHash<QString, QJsonObject> table;
+    table.reserve(nodes.size());
+    for (const QJsonValue &nodeValue : nodes) {
+        QJsonObject node = nodeValue.toObject();
+        table.insert(node["id"].toString(), node);
+    }
+    return table;
+}
+
+/**
+ * @brief 仅在内容变化时写入文件
+ * @param fileName 文件路径
+ * @param content 文件内容
+ * @param written 输出参数，实际写入了文件时为true
+ * @return 成功返回true，无法写入返回false
+ */
+bool CodeGenerator::writeFileIfChanged(const QString &fileName, const QString &content, bool *written)
+{
+    if (written) {
+        *written = false;
+    }
+    
+    const QByteArray data = content.toUtf8();
+    QFile existing(fileName);
+    if (existing.exists() && existing.size() == data.size()
+        && existing.open(QIODevice::ReadOnly) && existing.readAll() == data) {
+        return true;
+    }
+    existing.close();
+    
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入文件" << fileName << ":" << file.errorString();
+        return false;
+    }
+    file.write(data);
+    file.close();
+    if (written) {
+        *written = true;
+    }
+    return true;
+}
+
+/**
+ * @brief 删除导出目录中已不属于工程的阶段编译单元
+ * @param dirName 导出目录
+ * @param files 本次导出的文件，见 generateCppProject()
+ * @return 被删除的文件名列表
+ *
+ * 只删除文件头带有生成标记的 stage_*.cpp，用户自己的文件不受影响。
+ */
+QStringList CodeGenerator::removeStaleStageFiles(const QString &dirName, const QMap<QString, QString> &files)
+{
+    QStringList removed;
+    QDir dir(dirName);
+    const QStringList candidates = dir.entryList(QStringList() << "stage_*.cpp", QDir::Files);
+    for (const QString &name : candidates) {
+        if (files.contains(name)) {
+            continue;
+        }
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const bool generated = QString::fromUtf8(file.read(512)).contains("此文件由Qt节点编辑器自动生成");
+        file.close();
+        if (!generated) {
+            continue;
+        }
+        if (file.remove()) {
+            removed.append(name);
+        } else {
+            qWarning() << "无法删除过期的阶段文件" << file.fileName() << ":" << file.errorString();
+        }
+    }
+    return removed;
+}
+
+/**
+ * @brief 开始一次生成：计算节点哈希并重置片段统计
+ * @param flowData 标准流程图的JSON数据
+ */
+void CodeGenerator::beginGeneration(const QJsonObject &flowData)
+{
+    m_reusedFragments = 0;
+    m_emittedFragments = 0;
+    m_nodeHashes = m_incremental ? nodeHashes(flowData) : QHash<QString, QByteArray>();
+}
+
+/**
+ * @brief 结束一次生成：丢弃已删除节点的缓存片段
+ */
+void CodeGenerator::endGeneration()
+{
+    for (auto it = m_fragments.begin(); it != m_fragments.end(); ) {
+        if (m_nodeHashes.contains(it.value().nodeId)) {
+            ++it;
+        } else {
+            it = m_fragments.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief 获取节点的缓存片段，哈希变化或未缓存时重新生成
+ * @param slot 片段位置
+ * @param nodeId 节点ID
+ * @param context 影响片段内容的其他因素
+ * @param generate 生成片段的函数
+ * @return 片段代码字符串
+ */
+QString CodeGenerator::cachedFragment(const QString &slot, const QString &nodeId, const QString &context,
+                                      const std::function<QString()> &generate)
+{
+    auto nodeHash = m_nodeHashes.constFind(nodeId);
+    if (!m_incremental || nodeHash == m_nodeHashes.constEnd()) {
+        ++m_emittedFragments;
+        return generate();
+    }
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(nodeHash.value());
+    hash.addData(context.toUtf8());
+    const QByteArray fragmentHash = hash.result();
+    
+    const QString key = slot + ':' + nodeId;
+    auto cached = m_fragments.constFind(key);
+    if (cached != m_fragments.constEnd() && cached.value().hash == fragmentHash) {
+        ++m_reusedFragments;
+        return cached.value().code;
+    }
+    
+    ++m_emittedFragments;
+    Fragment fragment;
+    fragment.nodeId = nodeId;
+    fragment.hash = fragmentHash;
+    fragment.code = generate();
+    m_fragments.insert(key, fragment);
+    return fragment.code;
+}
+
+/**
+ * @brief 获取写入生成代码的时间戳
+ * @return 当前时间，增量生成时返回固定文本
+ *
+ * 增量生成要求图不变时输出逐字节相同，因此不写入时间。
+ */
+QString CodeGenerator::generationTimestamp() const
+{
+    if (m_incremental) {
+        return "增量生成（不记录时间）";
+    }
+    return QDateTime::currentDateTime().toString(Qt::ISODate);
+}
+
+/**
+ * @brief 将代码块整体增加缩进
+ * @param code 代码块（每行以换行结尾）
+ * @param spaces 增加的空格数
+ * @return 缩进后的代码块
+ */
+static QString indentCode(const QString &code, int spaces)
+{
+    const QString padding(spaces, ' ');
+    QStringList lines = code.split('\n');
+    for (QString &line : lines) {
+        if (!line.isEmpty()) {
+            line.prepend(padding);
+        }
+    }
+    return lines.join('\n');
+}
+
+/**
+ * @brief 读取节点参数列表中 "key=value" 形式的参数
+ * @param node 节点的JSON数据
+ * @param key 参数名
+ * @return 参数值，不存在时返回空字符串
+ */
+static QString nodeParameter(const QJsonObject &node, const QString &key)
+{
+    for (const QJsonValue &paramValue : node["parameters"].toArray()) {
+        const QString param = paramValue.toString().trimmed();
+        const int separator = param.indexOf('=');
+        if (separator > 0 && param.left(separator).trimmed() == key) {
+            return param.mid(separator + 1).trimmed();
+        }
+    }
+    return QString();
+}
+
+/**
+ * @brief 读取数值参数，缺失或超出范围时使用默认值
+ * @param node 节点的JSON数据
+ * @param key 参数名
+ * @param defaultValue 默认值
+ * @param minValue 允许的最小值
+ * @param maxValue 允许的最大值
+ * @return 参数值
+ */
+static double numericParameter(const QJsonObject &node, const QString &key, double defaultValue,
+                               double minValue, double maxValue)
+{
+    bool ok = false;
+    const double value = nodeParameter(node, key).toDouble(&ok);
+    if (!ok || value < minValue || value > maxValue) {
+        return defaultValue;
+    }
+    return value;
+}
+
+/**
+ * @brief 读取随程序打包的资源文件
+ * @param resourcePath 资源路径
+ * @param content 输出参数，文件内容
+ * @return 成功返回true
+ */
+static bool readResource(const QString &resourcePath, QString *content)
+{
+    QFile file(resourcePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    *content = QString::fromUtf8(file.readAll());
+    return true;
+}
+
+/**
+ * @brief 读取随程序打包的头文件资源，嵌入生成的代码
+ * @param resourcePath 资源路径
+ * @param fileName 资源缺失时改为包含的头文件名
+ * @return 头文件内容，资源缺失时为对应的 #include 语句
+ */
+static QString embeddedHeader(const QString &resourcePath, const QString &fileName)
+{
+    QString content;
+    if (!readResource(resourcePath, &content)) {
+        qWarning() << "无法读取资源" << resourcePath << "，生成代码将包含外部" << fileName;
+        return QString("#include \"%1\"\n").arg(fileName);
+    }
+    return content;
+}
+
+/**
+ * @brief 生成信号长度和流式块大小常量
+ * @param blockSize 流式块大小，0表示整段处理
+ * @return 常量定义代码
+ */
+static QString signalConstants(int blockSize)
+{
+    QString code = "static const size_t kSignalLength = 1000; // 信号总采样点数\n";
+    if (blockSize > 0) {
+        code += QString("static const size_t kBlockSize = %1; // 流式处理每块的采样点数\n").arg(blockSize);
+    }
+    return code;
+}
+
+/**
+ * @brief 将文本转换为C++字符串字面量
+ * @param text 文本
+ * @return 带引号并已转义的字符串字面量
+ */
+static QString cStringLiteral(const QString &text)
+{
+    QString escaped = text;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n").replace('\r', "\\r");
+    return '"' + escaped + '"';
+}
+
 /**
  * @brief 生成代码的主函数
  * @param flowData 流程图的JSON数据，包含节点和连接信息
@@ -31,6 +376,7 @@ CodeGenerator::CodeGenerator()
  */
 QString CodeGenerator::generateCode(const QJsonObject &flowData)
 {
+    beginGeneration(flowData);
     QJsonObject output;
     
     // 1. 生成元数据
@@ -39,7 +385,7 @@ QString CodeGenerator::generateCode(const QJsonObject &flowData)
         metadata = flowData["metadata"].toObject();
     } else {
         metadata["title"] = "可视化节点编辑器流程图";
-        metadata["created"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        metadata["created"] = generationTimestamp();
         metadata["version"] = "1.0";
     }
     output["metadata"] = metadata;
@@ -101,9 +447,185 @@ QString CodeGenerator::generateCode(const QJsonObject &flowData)
     
     // 转换为格式化的JSON字符串
     QJsonDocument doc(output);
+    endGeneration();
     return doc.toJson(QJsonDocument::Indented);
 }
 
+/**
+ * @brief 生成完整的C++源文件
+ * @param flowData 标准流程图的JSON数据
+ * @return 生成的C++代码字符串
+ *
+ * 由文件头部、并行运行时（启用并行时）、各节点的变量声明、主函数和辅助函数组成。
+ * 流程设置了块大小时生成流式处理的主函数，见 resolveBlockSize()。
+ * 启用模板流水线后端时改为生成编译期组合的流水线类型，见 generatePipelineMain()。
+ */
+QString CodeGenerator::generateCppCode(const QJsonObject &flowData)
+{
+    QJsonArray nodes = flowData["nodes"].toArray();
+    buildIdentifiers(nodes);
+    m_blockSize = resolveBlockSize(flowData);
+    beginGeneration(flowData);
+    
+    QString code = generateHeader();
+    if (m_templatePipeline) {
+        if (m_instrumentation) {
+            qWarning() << "模板流水线后端已合并各节点的处理循环，不支持逐节点性能测量";
+        }
+        code += generatePipelineLibrary();
+        code += generatePipelineMain(flowData);
+        code += generateFooter();
+        endGeneration();
+        return code;
+    }
+    
+    code += generateKernelLibrary();
+    
+    if (useParallelLevels()) {
+        code += generateParallelRuntime();
+    }
+    if (m_instrumentation) {
+        code += generateBenchmarkRuntime();
+    }
+    
+    code += "\n// ==================== 节点数据 ====================\n\n";
+    for (const QJsonValue &nodeValue : nodes) {
+        const QJsonObject node = nodeValue.toObject();
+        const QString nodeId = node["id"].toString();
+        code += cachedFragment("cpp-node", nodeId, identifierFor(nodeId),
+                               [&]() { return generateNodeCode(node); });
+    }
+    
+    code += generateMainFunction(flowData);
+    code += generateFooter();
+    endGeneration();
+    return code;
+}
+
+/**
+ * @brief 生成多文件C++工程
+ * @param flowData 标准流程图的JSON数据
+ * @return 相对文件名到文件内容的映射
+ *
+ * 主函数与单文件模式共用 generateMainFunction()，只是各节点的处理代码被替换为
+ * 对 stage_<节点>() 的调用。各阶段编译单元不含时间戳，结合增量生成，
+ * 只修改了参数的节点只会改写它自己的 .cpp 文件。
+ */
+QMap<QString, QString> CodeGenerator::generateCppProject(const QJsonObject &flowData)
+{
+    // 模板流水线没有逐节点的阶段函数，工程导出固定使用默认后端
+    const bool templatePipeline = m_templatePipeline;
+    m_templatePipeline = false;
+    m_projectLayout = true;
+    m_projectFiles.clear();
+    m_stageInterfaces.clear();
+    
+    QJsonArray nodes = flowData["nodes"].toArray();
+    buildIdentifiers(nodes);
+    m_blockSize = resolveBlockSize(flowData);
+    beginGeneration(flowData);
+    
+    // main.cpp：执行计划，同时生成各阶段的编译单元
+    QString mainCode = QString(R"(/**
+ * @file main.cpp
+ * @brief 自动生成的信号处理流程入口
+ * @date %1
+ *
+ * 此文件由Qt节点编辑器自动生成，各节点的处理代码位于对应的 stage_*.cpp 中。
+ */
+
+#include "stages.h"
+)").arg(generationTimestamp());
+    const QString mainFunction = generateMainFunction(flowData);
+    
+    // 阶段接口只在 main.cpp 中声明，增删或重命名节点不会改动 stages.h，其他阶段无需重新编译
+    mainCode += "\n// ==================== 阶段接口 ====================\n\n";
+    mainCode += m_stageInterfaces.join('\n');
+    mainCode += "\n";
+    if (useParallelLevels()) {
+        mainCode += generateParallelRuntime();
+    }
+    if (m_instrumentation) {
+        mainCode += generateBenchmarkRuntime();
+    }
+    mainCode += mainFunction;
+    mainCode += generateFooter();
+    
+    // stages.h：公共类型和常量，与具体节点无关
+    QString stagesHeader = "#ifndef GENERATED_STAGES_H\n#define GENERATED_STAGES_H\n";
+    stagesHeader += generateHeader("stages.h");
+    stagesHeader += "#include \"DspKernels.h\"\n\n";
+    stagesHeader += signalConstants(m_blockSize);
+    stagesHeader += "\n#endif // GENERATED_STAGES_H\n";
+    
+    QMap<QString, QString> files = m_projectFiles;
+    files.insert("main.cpp", mainCode);
+    files.insert("stages.h", stagesHeader);
+    
+    QString kernels;
+    if (readResource(":/kernels/DspKernels.h", &kernels)) {
+        files.insert("DspKernels.h", kernels);
+    } else {
+        qWarning() << "无法读取内核库资源，导出的工程缺少 DspKernels.h";
+    }
+    
+    // CMakeLists.txt：每个节点一个编译单元，源文件按文件名排序保证输出稳定
+    QString cmake = "# 此文件由Qt节点编辑器自动生成\n"
+                    "cmake_minimum_required(VERSION 3.10)\n"
+                    "project(generated_flow CXX)\n\n"
+                    "set(CMAKE_CXX_STANDARD 17)\n"
+                    "set(CMAKE_CXX_STANDARD_REQUIRED ON)\n\n"
+                    "# 每个节点一个编译单元，make -j 或 ninja 可以并行编译\n"
+                    "add_executable(generated_flow\n"
+                    "    main.cpp\n";
+    for (auto it = m_projectFiles.constBegin(); it != m_projectFiles.constEnd(); ++it) {
+        cmake += QString("    %1\n").arg(it.key());
+    }
+    cmake += ")\n";
+    if (useParallelLevels()) {
+        cmake += "\nfind_package(Threads REQUIRED)\n"
+                 "target_link_libraries(generated_flow PRIVATE Threads::Threads)\n";
+    }
+    files.insert("CMakeLists.txt", cmake);
+    
+    endGeneration();
+    m_projectFiles.clear();
+    m_stageInterfaces.clear();
+    m_projectLayout = false;
+    m_templatePipeline = templatePipeline;
+    return files;
+}
+
+/**
+ * @brief 确定流式处理的块大小
+ * @param flowData 标准流程图的JSON数据
+ * @return 块大小（采样点数），0表示整段处理
+ *
+ * 优先使用流程元数据中的 blockSize；未设置时取信号源节点参数
+ * "blockSize=N" 中的最小值，保证所有信号源按同一节拍产生数据。
+ */
+int CodeGenerator::resolveBlockSize(const QJsonObject &flowData) const
+{
+    const int flowBlockSize = flowData["metadata"].toObject()["blockSize"].toInt(0);
+    if (flowBlockSize > 0) {
+        return flowBlockSize;
+    }
+    
+    int blockSize = 0;
+    QJsonArray nodes = flowData["nodes"].toArray();
+    for (const QJsonValue &nodeValue : nodes) {
+        QJsonObject node = nodeValue.toObject();
+        if (node["type"].toString() != "signal_source") continue;
+        
+        bool ok = false;
+        const int value = nodeParameter(node, "blockSize").toInt(&ok);
+        if (ok && value > 0) {
+            blockSize = blockSize > 0 ? qMin(blockSize, value) : value;
+        }
+    }
+    return blockSize;
+}
+
 /**
  * @brief 生成连接状态的JSON表示
  * @param flowData 流程图的JSON数据
@@ -115,47 +637,39 @@ QJsonObject CodeGenerator::generateConnectionStatus(const QJsonObject &flowData)
     
     // 基本元数据
     status["metadata"] = flowData["metadata"];
-    status["analysis_timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    status["analysis_timestamp"] = generationTimestamp();
     
-    // 节点信息
+    // 节点信息：ID到下标的哈希表，连接状态先按下标累积，最后一次性写入JSON，
+    // 避免每条连接都复制并回写整个节点对象
+    struct NodeLinks {
+        QJsonArray incoming;
+        QJsonArray outgoing;
+        QJsonArray predecessors;
+        QJsonArray successors;
+    };
     QJsonArray nodes = flowData["nodes"].toArray();
-    QJsonObject nodeStatus;
-    QMap<QString, QString> nodeIdToName;  // 节点ID到名称的映射
+    QHash<QString, int> nodeIndex;
+    QStringList nodeNames;
+    QVector<NodeLinks> links(nodes.size());
+    QMap<QString, QStringList> dependencies;
+    nodeIndex.reserve(nodes.size());
+    nodeNames.reserve(nodes.size());
     
-    for (const QJsonValue &nodeValue : nodes) {
-        QJsonObject node = nodeValue.toObject();
+    for (int i = 0; i < nodes.size(); ++i) {
+        QJsonObject node = nodes.at(i).toObject();
         QString nodeId = node["id"].toString();
-        QString nodeName = node["name"].toString();
-        QString nodeType = node["type"].toString();
-        
-        nodeIdToName[nodeId] = nodeName;
-        
-        QJsonObject nodeInfo;
-        nodeInfo["id"] = nodeId;
-        nodeInfo["name"] = nodeName;
-        nodeInfo["type"] = nodeType;
-        nodeInfo["position"] = node["position"];  // 直接使用标准格式的position对象
-        nodeInfo["parameters"] = node["parameters"];
-        
-        // 初始化连接状态
-        nodeInfo["incoming_connections"] = QJsonArray();
-        nodeInfo["outgoing_connections"] = QJsonArray();
-        nodeInfo["predecessors"] = QJsonArray();
-        nodeInfo["successors"] = QJsonArray();
-        
-        nodeStatus[nodeId] = nodeInfo;
+        nodeIndex.insert(nodeId, i);
+        nodeNames.append(node["name"].toString());
+        dependencies[nodeId] = QStringList();  // 初始化依赖关系
     }
+    auto nameOf = [&](const QString &nodeId) {
+        const int index = nodeIndex.value(nodeId, -1);
+        return index < 0 ? QString() : nodeNames.at(index);
+    };
     
     // 连接关系分析 - 使用标准格式的from/to字段
     QJsonArray connections = flowData["connections"].toArray();
     QJsonArray connectionList;
-    QMap<QString, QStringList> dependencies;
-    
-    // 初始化依赖关系
-    for (const QJsonValue &nodeValue : nodes) {
-        QString nodeId = nodeValue.toObject()["id"].toString();
-        dependencies[nodeId] = QStringList();
-    }
     
     for (const QJsonValue &connValue : connections) {
         QJsonObject conn = connValue.toObject();
@@ -167,11 +681,11 @@ QJsonObject CodeGenerator::generateConnectionStatus(const QJsonObject &flowData)
         connectionDetail["id"] = QString("conn_%1_%2").arg(fromNodeId).arg(toNodeId);
         connectionDetail["from_node"] = QJsonObject{
             {"id", fromNodeId},
-            {"name", nodeIdToName[fromNodeId]}
+            {"name", nameOf(fromNodeId)}
         };
         connectionDetail["to_node"] = QJsonObject{
             {"id", toNodeId},
-            {"name", nodeIdToName[toNodeId]}
+            {"name", nameOf(toNodeId)}
         };
         connectionDetail["connection_type"] = "data_flow";
         connectionDetail["status"] = "active";
@@ -179,44 +693,51 @@ QJsonObject CodeGenerator::generateConnectionStatus(const QJsonObject &flowData)
         connectionList.append(connectionDetail);
         
         // 更新节点连接状态
-        if (nodeStatus.contains(fromNodeId)) {
-            QJsonObject fromNode = nodeStatus[fromNodeId].toObject();
-            QJsonArray outgoing = fromNode["outgoing_connections"].toArray();
-            outgoing.append(QJsonObject{
+        const int fromIndex = nodeIndex.value(fromNodeId, -1);
+        if (fromIndex >= 0) {
+            links[fromIndex].outgoing.append(QJsonObject{
                 {"target_id", toNodeId},
-                {"target_name", nodeIdToName[toNodeId]},
+                {"target_name", nameOf(toNodeId)},
                 {"connection_id", connectionDetail["id"]}
             });
-            fromNode["outgoing_connections"] = outgoing;
-            
-            QJsonArray successors = fromNode["successors"].toArray();
-            successors.append(toNodeId);
-            fromNode["successors"] = successors;
-            
-            nodeStatus[fromNodeId] = fromNode;
+            links[fromIndex].successors.append(toNodeId);
         }
         
-        if (nodeStatus.contains(toNodeId)) {
-            QJsonObject toNode = nodeStatus[toNodeId].toObject();
-            QJsonArray incoming = toNode["incoming_connections"].toArray();
-            incoming.append(QJsonObject{
+        const int toIndex = nodeIndex.value(toNodeId, -1);
+        if (toIndex >= 0) {
+            links[toIndex].incoming.append(QJsonObject{
                 {"source_id", fromNodeId},
-                {"source_name", nodeIdToName[fromNodeId]},
+                {"source_name", nameOf(fromNodeId)},
                 {"connection_id", connectionDetail["id"]}
             });
-            toNode["incoming_connections"] = incoming;
-            
-            QJsonArray predecessors = toNode["predecessors"].toArray();
-            predecessors.append(fromNodeId);
-            toNode["predecessors"] = predecessors;
-            
-            nodeStatus[toNodeId] = toNode;
+            links[toIndex].predecessors.append(fromNodeId);
         }
         
         // 构建依赖关系
         dependencies[toNodeId].append(fromNodeId);
     }
     
+    QJsonObject nodeStatus;
+    for (int i = 0; i < nodes.size(); ++i) {
+        QJsonObject node = nodes.at(i).toObject();
+        QString nodeId = node["id"].toString();
+        if (nodeIndex.value(nodeId) != i) {
+            continue;  // 重复的ID以最后一个节点为准
+        }
+        
+        QJsonObject nodeInfo;
+        nodeInfo["id"] = nodeId;
+        nodeInfo["name"] = nodeNames.at(i);
+        nodeInfo["type"] = node["type"];
+        nodeInfo["position"] = node["position"];  // 直接使用标准格式的position对象
+        nodeInfo["parameters"] = node["parameters"];
+        nodeInfo["incoming_connections"] = links.at(i).incoming;
+        nodeInfo["outgoing_connections"] = links.at(i).outgoing;
+        nodeInfo["predecessors"] = links.at(i).predecessors;
+        nodeInfo["successors"] = links.at(i).successors;
+        nodeStatus[nodeId] = nodeInfo;
+    }
+    
     status["nodes"] = nodeStatus;
     status["connections"] = connectionList;
     
@@ -232,12 +753,12 @@ QJsonObject CodeGenerator::generateConnectionStatus(const QJsonObject &flowData)
     status["dependencies"] = depsObj;
     
     // 执行顺序分析
-    QStringList executionOrder = generateExecutionOrder(dependencies);
+    FlowScheduler scheduler(dependencies);
     QJsonArray execOrderArray;
-    for (const QString &nodeId : executionOrder) {
+    for (const QString &nodeId : scheduler.executionOrder()) {
         execOrderArray.append(QJsonObject{
             {"id", nodeId},
-            {"name", nodeIdToName[nodeId]}
+            {"name", nameOf(nodeId)}
         });
     }
     status["execution_order"] = execOrderArray;
@@ -246,8 +767,8 @@ QJsonObject CodeGenerator::generateConnectionStatus(const QJsonObject &flowData)
     QJsonObject flowAnalysis;
     flowAnalysis["total_nodes"] = nodes.size();
     flowAnalysis["total_connections"] = connections.size();
-    flowAnalysis["entry_nodes"] = QJsonArray();  // 没有前驱的节点
-    flowAnalysis["exit_nodes"] = QJsonArray();   // 没有后继的节点
+    QJsonArray entryNodes;  // 没有前驱的节点
+    QJsonArray exitNodes;   // 没有后继的节点
     
     for (auto it = nodeStatus.begin(); it != nodeStatus.end(); ++it) {
         QJsonObject nodeInfo = it.value().toObject();
@@ -255,11 +776,32 @@ QJsonObject CodeGenerator::generateConnectionStatus(const QJsonObject &flowData)
         QJsonArray successors = nodeInfo["successors"].toArray();
         
         if (predecessors.isEmpty()) {
-            flowAnalysis["entry_nodes"].toArray().append(nodeInfo["name"]);
+            entryNodes.append(nodeInfo["name"]);
         }
         if (successors.isEmpty()) {
-            flowAnalysis["exit_nodes"].toArray().append(nodeInfo["name"]);
+            exitNodes.append(nodeInfo["name"]);
+        }
+    }
+    flowAnalysis["entry_nodes"] = entryNodes;
+    flowAnalysis["exit_nodes"] = exitNodes;
+    
+    // 循环依赖分析
+    flowAnalysis["has_cycle"] = scheduler.hasCycle();
+    if (scheduler.hasCycle()) {
+        QJsonArray cycleNodes;
+        for (const QString &nodeId : scheduler.cycleNodes()) {
+            cycleNodes.append(QJsonObject{
+                {"id", nodeId},
+                {"name", nameOf(nodeId)}
+            });
+        }
+        QJsonArray unscheduledNodes;
+        for (const QString &nodeId : scheduler.unscheduledNodes()) {
+            unscheduledNodes.append(nodeId);
         }
+        flowAnalysis["cycle_nodes"] = cycleNodes;
+        flowAnalysis["unscheduled_nodes"] = unscheduledNodes;
+        flowAnalysis["cycle_path"] = scheduler.describeCycle();
     }
     
     status["flow_analysis"] = flowAnalysis;
@@ -303,73 +845,382 @@ QMap<QString, QStringList> CodeGenerator::analyzeDependencies(const QJsonObject
  */
 QStringList CodeGenerator::generateExecutionOrder(const QMap<QString, QStringList> &dependencies)
 {
-    QStringList executionOrder;
-    QMap<QString, int> inDegree;
-    
-    // 计算每个节点的入度
-    for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
-        inDegree[it.key()] = it.value().size();
+    FlowScheduler scheduler(dependencies);
+    if (scheduler.hasCycle()) {
+        qWarning() << "检测到循环依赖，以下节点无法调度:" << scheduler.unscheduledNodes()
+                   << "循环路径:" << scheduler.describeCycle();
     }
-    
-    // 拓扑排序
-    QList<QString> queue;
-    
-    // 找到所有入度为0的节点
-    for (auto it = inDegree.begin(); it != inDegree.end(); ++it) {
-        if (it.value() == 0) {
-            queue.append(it.key());
+    return scheduler.executionOrder();
+}
+
+/**
+ * @brief 生成代码文件头部
+ * @param fileName 写入文件注释的文件名
+ * @return 头部代码字符串，包含注释和必要的包含语句
+ */
+QString CodeGenerator::generateHeader(const QString &fileName)
+{
+    QString header = R"(
+/**
+ * @file %3
+ * @brief 自动生成的信号处理代码
+ * @date %1
+ * 
+ * 此文件由Qt节点编辑器自动生成，包含完整的信号处理流程。
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <complex>
+#include <string>
+%2
+using namespace std;
+
+// 信号类型定义
+typedef vector<double> Signal;
+typedef complex<double> ComplexSignal;
+
+)";
+
+    QString extraIncludes;
+    if (useParallelLevels()) {
+        extraIncludes = "#include <thread>\n"
+                        "#include <atomic>\n"
+                        "#include <functional>\n"
+                        "#include <algorithm>\n";
+    } else if (m_blockSize > 0) {
+        extraIncludes = "#include <algorithm>\n";
+    }
+    if (m_instrumentation && !m_templatePipeline) {
+        if (!extraIncludes.contains("<algorithm>")) {
+            extraIncludes += "#include <algorithm>\n";
         }
+        extraIncludes += "#include <chrono>\n"
+                         "#include <cstdlib>\n"
+                         "#include <fstream>\n"
+                         "#include <new>\n";
     }
+
+    return header.arg(generationTimestamp(), extraIncludes, fileName);
+}
+
+/**
+ * @brief 生成内置节点使用的向量化信号处理内核库
+ * @return 内核库代码字符串
+ *
+ * 内核库随程序打包在资源文件中，直接嵌入生成的代码，使导出的文件可以独立编译。
+ * 资源缺失时退化为包含同名头文件。
+ */
+QString CodeGenerator::generateKernelLibrary()
+{
+    return "\n// ==================== 信号处理内核 ====================\n"
+           + embeddedHeader(":/kernels/DspKernels.h", "DspKernels.h");
+}
+
+/**
+ * @brief 生成模板流水线后端使用的阶段模板库
+ * @return 阶段模板库代码字符串
+ *
+ * 与内核库相同，随程序打包在资源文件中并直接嵌入生成的代码。
+ */
+QString CodeGenerator::generatePipelineLibrary()
+{
+    return "\n// ==================== 流水线阶段模板 ====================\n"
+           + embeddedHeader(":/kernels/PipelineStages.h", "PipelineStages.h");
+}
+
+/**
+ * @brief 生成按层级并行执行所需的运行时辅助代码
+ * @return 运行时辅助代码字符串
+ *
+ * runLevel 以原子计数器分发任务，调用线程本身也参与执行，
+ * 因此只有一个节点的层级不会产生任何线程开销。
+ */
+QString CodeGenerator::generateParallelRuntime()
+{
+    QString runtime = R"(
+// ==================== 并行运行时 ====================
+
+/**
+ * @brief 最大工作线程数，0表示使用硬件并发数
+ */
+static const unsigned kMaxWorkers = %1;
+
+/**
+ * @brief 获取实际使用的工作线程数
+ */
+static unsigned workerCount()
+{
+    unsigned workers = kMaxWorkers;
+    if (workers == 0) {
+        workers = thread::hardware_concurrency();
+    }
+    return workers == 0 ? 1 : workers;
+}
+
+/**
+ * @brief 并发执行同一依赖层级内的所有节点，全部完成后返回
+ * @param tasks 该层级的节点任务
+ */
+static void runLevel(const vector<function<void()>> &tasks)
+{
+    const size_t workers = min<size_t>(workerCount(), tasks.size());
+    if (workers <= 1) {
+        for (const auto &task : tasks) {
+            task();
+        }
+        return;
+    }
+
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < tasks.size(); i = next.fetch_add(1)) {
+            tasks[i]();
+        }
+    };
+
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : pool) {
+        t.join();
+    }
+}
+)";
+
+    return runtime.arg(m_maxWorkers);
+}
+
+/**
+ * @brief 生成性能测量模式所需的运行时辅助代码
+ * @return 运行时辅助代码字符串
+ *
+ * 通过替换全局 operator new 统计每个节点申请的堆内存，计数器为线程局部变量，
+ * 因此并行执行时各节点的统计互不干扰。报告为JSON格式，节点ID与流程图数据一致。
+ */
+QString CodeGenerator::generateBenchmarkRuntime()
+{
+    QString runtime = R"(
+// ==================== 性能测量 ====================
+
+namespace bench {
+
+typedef chrono::steady_clock Clock;
+
+static const int kWarmup = %1;      // 预热次数，不计入统计
+static const int kIterations = %2;  // 计入统计的运行次数
+
+static thread_local size_t t_allocated = 0;  // 当前线程累计申请的堆内存字节数
+static bool g_recording = false;             // 当前运行是否计入统计
+static vector<double> g_runs;                // 每次完整运行的耗时（纳秒）
+
+/**
+ * @brief 单个节点的测量结果
+ */
+struct NodeStats {
+    const char *id;
+    const char *name;
+    const char *type;
+    vector<double> latencies;  // 每次执行的耗时（纳秒）
+    size_t samples = 0;        // 每次执行处理的采样点数
+    size_t bytes = 0;          // 计入统计的执行中累计申请的字节数
+};
+
+/**
+ * @brief 测量起点
+ */
+struct Mark {
+    Clock::time_point start;
+    size_t allocated;
+};
+
+static Mark begin()
+{
+    return Mark{Clock::now(), t_allocated};
+}
+
+/**
+ * @brief 记录一次节点执行
+ */
+static void end(NodeStats &stats, const Mark &mark, size_t samples)
+{
+    const double elapsed = chrono::duration<double, nano>(Clock::now() - mark.start).count();
+    if (!g_recording) {
+        return;
+    }
+    stats.bytes += t_allocated - mark.allocated;
+    stats.samples = samples;
+    stats.latencies.push_back(elapsed);
+}
+
+/**
+ * @brief 记录一次完整运行
+ */
+static void endRun(const Mark &mark)
+{
+    if (g_recording) {
+        g_runs.push_back(chrono::duration<double, nano>(Clock::now() - mark.start).count());
+    }
+}
+
+/**
+ * @brief 最近秩法计算百分位数
+ */
+static double percentile(vector<double> values, double fraction)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(ceil(fraction * values.size()));
+    return values[min(values.size(), max<size_t>(rank, 1)) - 1];
+}
+
+/**
+ * @brief 转换为JSON字符串
+ */
+static string jsonString(const char *text)
+{
+    string out = "\"";
+    for (const char *p = text; *p; ++p) {
+        const unsigned char ch = static_cast<unsigned char>(*p);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += *p;
+        } else if (ch < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            out += "\\u00";
+            out += hex[ch >> 4];
+            out += hex[ch & 0xf];
+        } else {
+            out += *p;
+        }
+    }
+    return out + "\"";
+}
+
+/**
+ * @brief 写入性能报告
+ * @param path 报告文件路径
+ * @param nodes 节点测量结果
+ * @param count 节点数量
+ */
+static bool writeReport(const char *path, const NodeStats *nodes, size_t count)
+{
+    ofstream out(path);
+    if (!out) {
+        cerr << "无法写入性能报告 " << path << endl;
+        return false;
+    }
+
+    out.setf(ios::fixed);
+    out.precision(1);
+    out << "{\n";
+    out << "  \"format\": \"dagflow-profile\",\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"iterations\": " << kIterations << ",\n";
+    out << "  \"warmup\": " << kWarmup << ",\n";
+    out << "  \"run_median_ns\": " << percentile(g_runs, 0.5) << ",\n";
+    out << "  \"nodes\": [";
+    for (size_t i = 0; i < count; ++i) {
+        const NodeStats &stats = nodes[i];
+        const double median = percentile(stats.latencies, 0.5);
+        const size_t executions = stats.latencies.size();
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"id\": " << jsonString(stats.id)
+            << ", \"name\": " << jsonString(stats.name)
+            << ", \"type\": " << jsonString(stats.type)
+            << ", \"executions\": " << executions
+            << ", \"samples\": " << stats.samples
+            << ", \"min_ns\": " << percentile(stats.latencies, 0.0)
+            << ", \"median_ns\": " << median
+            << ", \"p99_ns\": " << percentile(stats.latencies, 0.99)
+            << ", \"throughput_samples_per_s\": " << (median > 0.0 ? stats.samples * 1e9 / median : 0.0)
+            << ", \"output_bytes\": " << stats.samples * sizeof(double)
+            << ", \"bytes_allocated\": " << (executions > 0 ? stats.bytes / executions : 0)
+            << "}";
+    }
+    out << "\n  ]\n}\n";
+
+    cout << "性能报告已写入 " << path << endl;
+    return true;
+}
+
+} // namespace bench
+
+/**
+ * @brief 替换全局 operator new，统计堆内存申请量
+ */
+void *operator new(size_t size)
+{
+    bench::t_allocated += size;
+    if (void *p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+)";
+
+    return runtime.arg(m_benchmarkWarmup).arg(m_benchmarkIterations);
+}
+
+/**
+ * @brief 为所有节点分配C++标识符
+ * @param nodes 节点数组
+ *
+ * 节点名称可能重复或包含空格、标点，直接用作变量名会导致生成的代码无法编译。
+ * 这里将非法的ASCII字符替换为下划线，并为重名节点追加序号。
+ */
+void CodeGenerator::buildIdentifiers(const QJsonArray &nodes)
+{
+    m_identifiers.clear();
+    QSet<QString> used;
     
-    while (!queue.isEmpty()) {
-        QString current = queue.takeFirst();
-        executionOrder.append(current);
+    for (const QJsonValue &nodeValue : nodes) {
+        QJsonObject node = nodeValue.toObject();
+        QString identifier = node["name"].toString();
+        
+        for (QChar &ch : identifier) {
+            // 非ASCII字符（如中文）按C++标准可用于标识符，保留以便阅读
+            if (ch.unicode() < 128 && !ch.isLetterOrNumber() && ch != '_') {
+                ch = '_';
+            }
+        }
+        if (identifier.isEmpty() || identifier.at(0).isDigit()) {
+            identifier.prepend("node_");
+        }
         
-        // 更新依赖当前节点的其他节点的入度
-        for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
-            if (it.value().contains(current)) {
-                inDegree[it.key()]--;
-                if (inDegree[it.key()] == 0) {
-                    queue.append(it.key());
-                }
-            }
+        QString unique = identifier;
+        for (int suffix = 2; used.contains(unique); ++suffix) {
+            unique = QString("%1_%2").arg(identifier).arg(suffix);
         }
+        used.insert(unique);
+        m_identifiers.insert(node["id"].toString(), unique);
     }
-    
-    return executionOrder;
 }
 
 /**
- * @brief 生成代码文件头部
- * @return 头部代码字符串，包含注释和必要的包含语句
+ * @brief 获取节点对应的C++标识符
+ * @param nodeId 节点ID
+ * @return C++标识符，节点不存在时返回空字符串
  */
-QString CodeGenerator::generateHeader()
+QString CodeGenerator::identifierFor(const QString &nodeId) const
 {
-    QString header = R"(
-/**
- * @file generated_code.cpp
- * @brief 自动生成的信号处理代码
- * @date %1
- * 
- * 此文件由Qt节点编辑器自动生成，包含完整的信号处理流程。
- */
-
-#include <iostream>
-#include <vector>
-#include <cmath>
-#include <complex>
-#include <string>
-
-using namespace std;
-
-// 信号类型定义
-typedef vector<double> Signal;
-typedef complex<double> ComplexSignal;
-
-// 前向声明
-)";
-
-    return header.arg(QDateTime::currentDateTime().toString(Qt::ISODate));
+    return m_identifiers.value(nodeId);
 }
 
 /**
@@ -380,8 +1231,7 @@ typedef complex<double> ComplexSignal;
 QString CodeGenerator::generateNodeCode(const QJsonObject &node)
 {
     QString nodeType = node["type"].toString();
-    QString nodeName = node["name"].toString();
-    QString nodeId = node["id"].toString();
+    QString nodeName = identifierFor(node["id"].toString());
     
     QString code = generateVariableDeclaration(nodeType, nodeName);
     code += generateInitializationCode(node);
@@ -395,21 +1245,15 @@ QString CodeGenerator::generateNodeCode(const QJsonObject &node)
  * @param nodeType 节点类型
  * @param nodeName 节点名称
  * @return 变量声明代码
+ *
+ * 节点的信号输出位于缓冲区池中，在主函数中绑定，这里只声明节点私有的附加数据。
  */
 QString CodeGenerator::generateVariableDeclaration(const QString &nodeType, const QString &nodeName)
 {
-    if (nodeType == "signal_source") {
-        return QString("Signal %1;\n").arg(nodeName);
-    } else if (nodeType == "filter") {
-        return QString("Signal %1;\nSignal %1_filtered;\n").arg(nodeName);
-    } else if (nodeType == "fft") {
-        return QString("Signal %1;\nvector<ComplexSignal> %1_spectrum;\n").arg(nodeName);
-    } else if (nodeType == "modulator") {
-        return QString("Signal %1;\nSignal %1_modulated;\n").arg(nodeName);
-    } else if (nodeType == "demodulator") {
-        return QString("Signal %1;\nSignal %1_demodulated;\n").arg(nodeName);
+    if (nodeType == "fft") {
+        return QString("vector<ComplexSignal> %1_spectrum;\n").arg(nodeName);
     } else {
-        return QString("Signal %1;\n").arg(nodeName);
+        return QString();
     }
 }
 
@@ -421,64 +1265,302 @@ QString CodeGenerator::generateVariableDeclaration(const QString &nodeType, cons
 QString CodeGenerator::generateInitializationCode(const QJsonObject &node)
 {
     QString nodeType = node["type"].toString();
-    QString nodeName = node["name"].toString();
+    QString nodeName = identifierFor(node["id"].toString());
     
+    // 频率均为相对采样率的归一化频率
     if (nodeType == "signal_source") {
         return QString("// 初始化信号源 %1\n// TODO: 配置信号源参数\n").arg(nodeName);
     } else if (nodeType == "filter") {
-        return QString("// 初始化滤波器 %1\n// TODO: 配置滤波器参数\n").arg(nodeName);
+        const int taps = qRound(numericParameter(node, "taps", 31, 1, 4096));
+        const double cutoff = numericParameter(node, "cutoff", 0.1, 0.0, 0.5);
+        return QString("// 滤波器 %1：%2 阶低通，截止频率 %3\n"
+                       "static dsp::FirFilter %1_fir(dsp::lowpassTaps(%2, %3));\n")
+            .arg(nodeName).arg(taps).arg(cutoff, 0, 'g', 17);
     } else if (nodeType == "fft") {
-        return QString("// 初始化FFT变换 %1\n// TODO: 配置FFT参数\n").arg(nodeName);
+        return QString("// FFT变换 %1\nstatic dsp::Fft %1_fft;\n").arg(nodeName);
     } else if (nodeType == "modulator") {
-        return QString("// 初始化调制器 %1\n// TODO: 配置调制器参数\n").arg(nodeName);
+        const double frequency = numericParameter(node, "frequency", 0.1, -0.5, 0.5);
+        const double phase = numericParameter(node, "phase", 0.0, -1e9, 1e9);
+        return QString("// 调制器 %1：载波频率 %2\n"
+                       "static dsp::Mixer %1_mixer(%2, %3);\n")
+            .arg(nodeName).arg(frequency, 0, 'g', 17).arg(phase, 0, 'g', 17);
     } else if (nodeType == "demodulator") {
-        return QString("// 初始化解调器 %1\n// TODO: 配置解调器参数\n").arg(nodeName);
+        const double frequency = numericParameter(node, "frequency", 0.1, -0.5, 0.5);
+        const int taps = qRound(numericParameter(node, "taps", 31, 1, 4096));
+        const double cutoff = numericParameter(node, "cutoff", 0.05, 0.0, 0.5);
+        return QString("// 解调器 %1：载波频率 %2，%3 阶低通，截止频率 %4\n"
+                       "static dsp::Demodulator %1_demod(%2, %3, %4);\n")
+            .arg(nodeName).arg(frequency, 0, 'g', 17).arg(taps).arg(cutoff, 0, 'g', 17);
     } else {
         return QString("// 初始化节点 %1\n").arg(nodeName);
     }
 }
 
+/**
+ * @brief 获取节点类型对输入数据的访问方式
+ * @param nodeType 节点类型
+ * @return 访问方式
+ */
+static BufferPlanner::NodeKind nodeKindOf(const QString &nodeType)
+{
+    if (nodeType == "sink") {
+        return BufferPlanner::SinkNode;
+    } else if (nodeType == "fft") {
+        return BufferPlanner::PassThroughNode;
+    }
+    return BufferPlanner::TransformNode;
+}
+
 /**
  * @brief 生成主函数代码
  * @param flowData 流程图的JSON数据
- * @return 主函数代码字符串
+ * @return 缓冲区池定义和主函数代码字符串
+ *
+ * 节点输出不再各自占用一个全局缓冲区，而是由 BufferPlanner 根据生命周期
+ * 分配到启动时一次性分配的缓冲区池中，峰值内存只取决于同时存活的输出数量。
  */
 QString CodeGenerator::generateMainFunction(const QJsonObject &flowData)
 {
     // 分析依赖关系和执行顺序
     QMap<QString, QStringList> dependencies = analyzeDependencies(flowData);
-    QStringList executionOrder = generateExecutionOrder(dependencies);
+    FlowScheduler scheduler(dependencies);
+    
+    // 建立节点ID到节点数据的索引，避免每个节点都线性扫描一遍节点数组
+    const QHash<QString, QJsonObject> nodeTable = CodeGenerator::nodeTable(flowData);
+    
+    // 执行阶段：并行模式下为依赖层级，顺序模式下为执行顺序中的位置
+    const int count = scheduler.nodeCount();
+    const QVector<int> &order = scheduler.orderIndices();
+    QVector<int> stageOf(count, -1);
+    for (int position = 0; position < order.size(); ++position) {
+        const int index = order.at(position);
+        stageOf[index] = useParallelLevels() ? scheduler.levelOf(index) : position;
+    }
+    
+    // 缓冲区规划（不存在的节点视为不产生输出）
+    QVector<BufferPlanner::NodeKind> kinds(count, BufferPlanner::SinkNode);
+    for (int i = 0; i < count; ++i) {
+        auto it = nodeTable.constFind(scheduler.nodeId(i));
+        if (it != nodeTable.constEnd()) {
+            kinds[i] = nodeKindOf(it.value()["type"].toString());
+        }
+    }
+    BufferPlanner planner(scheduler, stageOf, kinds);
+    
+    // 性能测量的节点表，按执行顺序排列
+    QHash<int, int> statsIndex;
+    QStringList statsEntries;
+    if (m_instrumentation) {
+        for (int index : order) {
+            const QString nodeId = scheduler.nodeId(index);
+            auto it = nodeTable.constFind(nodeId);
+            if (it == nodeTable.constEnd()) continue;
+            statsIndex.insert(index, statsEntries.size());
+            statsEntries.append(QString("    {%1, %2, %3, {}, 0, 0},\n")
+                .arg(cStringLiteral(nodeId), cStringLiteral(it.value()["name"].toString()),
+                     cStringLiteral(it.value()["type"].toString())));
+        }
+    }
+    
+    // 生成单个节点的处理代码
+    auto nodeBlock = [&](int index) -> QString {
+        const QString nodeId = scheduler.nodeId(index);
+        const QJsonObject node = nodeTable.value(nodeId);
+        const QString nodeName = identifierFor(nodeId);
+        if (nodeName.isEmpty()) {
+            return QString();
+        }
+        
+        // 只有产生输出的上游节点才有可读的缓冲区
+        QStringList inputs;
+        for (int input : scheduler.predecessors(index)) {
+            const QString inputName = identifierFor(scheduler.nodeId(input));
+            if (planner.slabOf(input) >= 0 && !inputs.contains(inputName)) {
+                inputs.append(inputName);
+            }
+        }
+        const BufferPlanner::OutputMode mode = planner.outputMode(index);
+        const QString context = QString("%1|%2|%3|%4|%5").arg(nodeName, inputs.join(','))
+            .arg(static_cast<int>(mode)).arg(m_blockSize).arg(m_instrumentation);
+        QString body = cachedFragment("cpp-process", nodeId, context, [&]() {
+            return generateNodeProcessingCode(nodeName, node["type"].toString(), inputs, mode);
+        });
+        
+        // 工程导出时处理代码放入节点自己的编译单元，主函数中只保留调用
+        if (m_projectLayout) {
+            body = generateStageUnit(node, planner.slabOf(index) >= 0, inputs, body);
+        }
+        
+        // 性能测量：计时范围只包含节点自身的处理代码，采样点数取输出（汇节点取主输入）
+        if (m_instrumentation) {
+            const QString measured = planner.slabOf(index) >= 0 ? nodeName
+                                   : (inputs.isEmpty() ? QString() : inputs.first());
+            if (body.endsWith("\n\n")) {
+                body.chop(1);
+            }
+            body = QString("    {\n"
+                           "        const bench::Mark mark = bench::begin();\n"
+                           "%1"
+                           "        bench::end(g_nodeStats[%2], mark, %3);\n"
+                           "    }\n\n")
+                .arg(indentCode(body, 4)).arg(statsIndex.value(index))
+                .arg(measured.isEmpty() ? QString("0") : measured + ".size()");
+        }
+        return body;
+    };
+    
+    QString mainFunction = "\n// ==================== 缓冲区池 ====================\n\n";
+    if (!m_projectLayout) {
+        // 工程导出时这些常量位于 stages.h，供各阶段共用
+        mainFunction += signalConstants(m_blockSize);
+    }
+    if (planner.slabCount() > 0) {
+        mainFunction += QString("\n// 由活跃性分析得出：%1 个节点共用 %2 个缓冲区，启动时一次性分配\n"
+                                "static Signal g_slabs[%2];\n")
+            .arg(scheduler.nodeCount()).arg(planner.slabCount());
+    }
+    if (!statsEntries.isEmpty()) {
+        mainFunction += "\n// 性能测量的节点表，ID与流程图数据一致，报告可以载回编辑器\n";
+        mainFunction += "static bench::NodeStats g_nodeStats[] = {\n" + statsEntries.join("") + "};\n";
+    }
     
-    QString mainFunction = R"(
+    mainFunction += R"(
 /**
  * @brief 主处理函数，按依赖顺序执行所有节点
  */
-int main()
-{
+)";
+    mainFunction += m_instrumentation ? "int main(int argc, char *argv[])\n" : "int main()\n";
+    mainFunction += R"({
     cout << "开始执行信号处理流程..." << endl;
+    cout << "信号处理内核: " << dsp::kernelIsa() << endl;
     
 )";
+    if (!statsEntries.isEmpty()) {
+        mainFunction += "    // 预先分配测量结果的存储，避免计入节点的内存申请\n";
+        mainFunction += "    for (bench::NodeStats &stats : g_nodeStats) {\n";
+        mainFunction += m_blockSize > 0
+            ? "        stats.latencies.reserve(bench::kIterations * ((kSignalLength + kBlockSize - 1) / kBlockSize));\n"
+            : "        stats.latencies.reserve(bench::kIterations);\n";
+        mainFunction += "    }\n";
+        mainFunction += "    bench::g_runs.reserve(bench::kIterations);\n\n";
+    }
+
+    if (planner.slabCount() > 0) {
+        mainFunction += "    // 一次性分配缓冲区池，运行过程中不再申请内存\n";
+        mainFunction += "    for (Signal &slab : g_slabs) {\n";
+        mainFunction += QString("        slab.reserve(%1);\n").arg(m_blockSize > 0 ? "kBlockSize" : "kSignalLength");
+        mainFunction += "    }\n\n";
+        
+        mainFunction += "    // 节点输出到缓冲区的映射\n";
+        for (int index : order) {
+            const int slab = planner.slabOf(index);
+            if (slab >= 0) {
+                mainFunction += QString("    Signal &%1 = g_slabs[%2];\n")
+                    .arg(identifierFor(scheduler.nodeId(index))).arg(slab);
+            }
+        }
+        mainFunction += "\n";
+    }
+
+    if (scheduler.hasCycle()) {
+        mainFunction += QString("    // 警告: 检测到循环依赖 %1\n").arg(scheduler.describeCycle());
+        mainFunction += QString("    // 以下节点无法调度: %1\n\n").arg(scheduler.unscheduledNodes().join(", "));
+    }
 
-    // 按执行顺序生成处理代码
-    for (const QString &nodeId : executionOrder) {
-        // 找到对应的节点信息
-        QJsonArray nodes = flowData["nodes"].toArray();
-        QString nodeName;
-        QString nodeType;
-        
-        for (const QJsonValue &nodeValue : nodes) {
-            QJsonObject node = nodeValue.toObject();
-            if (node["id"].toString() == nodeId) {
-                nodeName = node["name"].toString();
-                nodeType = node["type"].toString();
-                break;
+    QString setup;      // 执行前的准备
+    QString execution;  // 一次完整的执行
+    QString report;     // 执行后的输出
+    if (m_blockSize > 0) {
+        // 流式处理：信号按块依次流经各级节点，工作集只有 kBlockSize 个采样点。
+        // 一块数据的处理量很小，线程切换的开销会超过收益，因此块内按执行顺序串行执行。
+        QString sinkCounters;
+        QString sinkReset;
+        QString sinkReport;
+        QString loopBody;
+        for (int index : order) {
+            const QString nodeId = scheduler.nodeId(index);
+            if (kinds.at(index) == BufferPlanner::SinkNode && nodeTable.contains(nodeId)) {
+                const QString sinkName = identifierFor(nodeId);
+                if (!m_projectLayout) {
+                    sinkCounters += QString("    size_t %1_samples = 0;\n").arg(sinkName);
+                }
+                sinkReset += QString("    %1_samples = 0;\n").arg(sinkName);
+                sinkReport += QString("    cout << \"输出 %1 共接收 \" << %1_samples << \" 个采样点\" << endl;\n").arg(sinkName);
             }
+            loopBody += nodeBlock(index);
         }
         
-        if (nodeName.isEmpty()) continue;
+        setup += sinkCounters;
+        if (m_instrumentation && !sinkReset.isEmpty()) {
+            // 性能测量时整个流程重复执行，计数器每次运行前清零，报告的是单次运行的采样点数
+            execution += sinkReset + "\n";
+        }
+        execution += "    for (size_t offset = 0; offset < kSignalLength; offset += kBlockSize) {\n";
+        execution += "        const size_t blockLength = min(kBlockSize, kSignalLength - offset);\n\n";
+        execution += indentCode(loopBody, 4);
+        execution += "    }\n\n";
+        report += sinkReport;
+    } else if (!useParallelLevels()) {
+        // 按执行顺序生成处理代码
+        for (int index : order) {
+            execution += nodeBlock(index);
+        }
+    } else {
+        // 按依赖层级生成处理代码，同一层级的节点并发执行
+        execution += QString("    // 共 %1 个依赖层级，最大并行度 %2\n\n")
+            .arg(scheduler.levels().size()).arg(scheduler.maxLevelWidth());
         
-        // 生成节点处理代码
-        mainFunction += generateNodeProcessingCode(nodeName, nodeType, dependencies[nodeId]);
+        for (int level = 0; level < scheduler.levels().size(); ++level) {
+            QStringList blocks;
+            for (int index : scheduler.levels().at(level)) {
+                QString block = nodeBlock(index);
+                if (!block.isEmpty()) {
+                    blocks.append(block);
+                }
+            }
+            
+            if (blocks.isEmpty()) continue;
+            
+            execution += QString("    // ---------- 第 %1 层（%2 个节点）----------\n")
+                .arg(level + 1).arg(blocks.size());
+            
+            if (blocks.size() == 1) {
+                // 单节点层级直接执行
+                execution += blocks.first();
+            } else {
+                execution += "    runLevel({\n";
+                for (const QString &block : blocks) {
+                    QString body = block;
+                    if (body.endsWith("\n\n")) {
+                        body.chop(1);
+                    }
+                    execution += "        [&]() {\n";
+                    execution += indentCode(body, 8);
+                    execution += "        },\n";
+                }
+                execution += "    });\n\n";
+            }
+        }
+    }
+    
+    mainFunction += setup;
+    if (m_instrumentation) {
+        // 预热后重复执行整个流程，预热的结果不计入统计
+        if (execution.endsWith("\n\n")) {
+            execution.chop(1);
+        }
+        mainFunction += "    for (int iteration = 0; iteration < bench::kWarmup + bench::kIterations; ++iteration) {\n";
+        mainFunction += "        bench::g_recording = iteration >= bench::kWarmup;\n";
+        mainFunction += "        const bench::Mark run = bench::begin();\n\n";
+        mainFunction += indentCode(execution, 4);
+        mainFunction += "        bench::endRun(run);\n";
+        mainFunction += "    }\n\n";
+        mainFunction += report;
+        mainFunction += QString("    bench::writeReport(argc > 1 ? argv[1] : \"profile_report.json\", %1, %2);\n")
+            .arg(statsEntries.isEmpty() ? "nullptr" : "g_nodeStats").arg(statsEntries.size());
+    } else {
+        mainFunction += execution;
+        mainFunction += report;
     }
     
     mainFunction += R"(
@@ -495,47 +1577,85 @@ int main()
  * @brief 生成节点处理代码
  * @param nodeName 节点名称
  * @param nodeType 节点类型
- * @param dependencies 依赖列表
+ * @param inputs 输入缓冲区列表，第一个为主输入
+ * @param mode 输出缓冲区的来源
  * @return 处理代码字符串
  */
-QString CodeGenerator::generateNodeProcessingCode(const QString &nodeName, const QString &nodeType, const QStringList &dependencies)
+QString CodeGenerator::generateNodeProcessingCode(const QString &nodeName, const QString &nodeType,
+                                                  const QStringList &inputs, BufferPlanner::OutputMode mode)
 {
     QString code = QString("    // 处理节点: %1\n").arg(nodeName);
     
+    // 性能测量时不输出进度信息，避免控制台输出计入节点耗时
+    auto progress = [this](const QString &message) {
+        return m_instrumentation ? QString() : QString("    cout << \"%1\" << endl;\n").arg(message);
+    };
+    
+    // 准备输出缓冲区：原地处理和直通共用上游缓冲区，只有必要时才复制主输入
+    QString acquire;
+    if (!inputs.isEmpty()) {
+        const QString &input = inputs.first();
+        if (mode == BufferPlanner::Alias) {
+            acquire = QString("    // 与 %1 共用缓冲区（只读）\n").arg(input);
+        } else if (mode == BufferPlanner::InPlace) {
+            acquire = QString("    // 原地处理 %1 的缓冲区（之后不再被读取）\n").arg(input);
+        } else if (mode == BufferPlanner::Fresh) {
+            acquire = QString("    %1 = %2; // 主输入仍被其他节点读取，复制到空闲缓冲区\n").arg(nodeName, input);
+        }
+        for (int i = 1; i < inputs.size(); ++i) {
+            acquire += QString("    // 附加输入: %1（只读）\n").arg(inputs.at(i));
+        }
+    }
+    
     if (nodeType == "signal_source") {
-        code += QString("    cout << \"生成信号源 %1 数据...\" << endl;\n").arg(nodeName);
-        code += QString("    // TODO: 实现信号源生成逻辑\n");
-        code += QString("    // %1.resize(1000); // 示例：设置信号长度\n").arg(nodeName);
+        code += progress(QString("生成信号源 %1 数据...").arg(nodeName));
+        if (m_blockSize > 0) {
+            code += QString("    %1.assign(blockLength, 0.0);\n").arg(nodeName);
+            code += QString("    // TODO: 实现信号源生成逻辑，生成第 [offset, offset + blockLength) 个采样点\n");
+        } else {
+            code += QString("    %1.assign(kSignalLength, 0.0);\n").arg(nodeName);
+            code += QString("    // TODO: 实现信号源生成逻辑\n");
+        }
     } else if (nodeType == "filter") {
-        code += QString("    cout << \"应用滤波器 %1...\" << endl;\n").arg(nodeName);
-        if (!dependencies.isEmpty()) {
-            QString inputNode = dependencies.first(); // 简化处理，取第一个依赖
-            code += QString("    // TODO: 从 %1 接收信号并进行滤波\n").arg(inputNode);
-            code += QString("    // applyFilter(%1, %1_filtered);\n").arg(nodeName);
+        code += progress(QString("应用滤波器 %1...").arg(nodeName));
+        if (!inputs.isEmpty()) {
+            code += acquire;
+            code += QString("    %1_fir.process(%1);\n").arg(nodeName);
         }
     } else if (nodeType == "fft") {
-        code += QString("    cout << \"执行FFT变换 %1...\" << endl;\n").arg(nodeName);
-        if (!dependencies.isEmpty()) {
-            QString inputNode = dependencies.first();
-            code += QString("    // TODO: 从 %1 接收信号并进行FFT变换\n").arg(inputNode);
-            code += QString("    // performFFT(%1, %1_spectrum);\n").arg(nodeName);
+        code += progress(QString("执行FFT变换 %1...").arg(nodeName));
+        if (!inputs.isEmpty()) {
+            code += acquire;
+            code += QString("    %1_fft.forward(%1, %1_spectrum);\n").arg(nodeName);
         }
     } else if (nodeType == "modulator") {
-        code += QString("    cout << \"执行调制 %1...\" << endl;\n").arg(nodeName);
-        if (!dependencies.isEmpty()) {
-            QString inputNode = dependencies.first();
-            code += QString("    // TODO: 从 %1 接收信号并进行调制\n").arg(inputNode);
-            code += QString("    // performModulation(%1, %1_modulated);\n").arg(nodeName);
+        code += progress(QString("执行调制 %1...").arg(nodeName));
+        if (!inputs.isEmpty()) {
+            code += acquire;
+            code += QString("    %1_mixer.process(%1);\n").arg(nodeName);
         }
     } else if (nodeType == "demodulator") {
-        code += QString("    cout << \"执行解调 %1...\" << endl;\n").arg(nodeName);
-        if (!dependencies.isEmpty()) {
-            QString inputNode = dependencies.first();
-            code += QString("    // TODO: 从 %1 接收信号并进行解调\n").arg(inputNode);
-            code += QString("    // performDemodulation(%1, %1_demodulated);\n").arg(nodeName);
+        code += progress(QString("执行解调 %1...").arg(nodeName));
+        if (!inputs.isEmpty()) {
+            code += acquire;
+            code += QString("    %1_demod.process(%1);\n").arg(nodeName);
+        }
+    } else if (nodeType == "sink") {
+        if (m_blockSize > 0) {
+            // 流式模式下每块都会执行，只累计采样点数，结束后统一输出
+            for (const QString &input : inputs) {
+                code += QString("    %1_samples += %2.size();\n").arg(nodeName, input);
+            }
+        } else {
+            code += progress(QString("输出 %1...").arg(nodeName));
+            for (const QString &input : inputs) {
+                if (m_instrumentation) break;
+                code += QString("    cout << \"  %1: \" << %1.size() << \" 个采样点\" << endl;\n").arg(input);
+            }
         }
     } else {
-        code += QString("    cout << \"处理节点 %1...\" << endl;\n").arg(nodeName);
+        code += progress(QString("处理节点 %1...").arg(nodeName));
+        code += acquire;
         code += QString("    // TODO: 实现节点 %1 的处理逻辑\n").arg(nodeName);
     }
     
@@ -544,54 +1664,332 @@ QString CodeGenerator::generateNodeProcessingCode(const QString &nodeName, const
 }
 
 /**
- * @brief 生成代码文件尾部
- * @return 尾部代码字符串
+ * @brief 生成单个节点的编译单元（工程导出），并返回主函数中的调用语句
+ * @param node 节点的JSON数据
+ * @param hasOutput 节点是否产生输出缓冲区
+ * @param inputs 输入缓冲区列表，第一个为主输入
+ * @param body 节点处理代码
+ * @return 主函数中调用该阶段的代码
+ *
+ * 缓冲区由主函数中的缓冲区池持有，以引用形式传入阶段函数；参数名与缓冲区名一致，
+ * 因此单文件模式的处理代码可以原样作为函数体。原地处理时输出和主输入引用同一个缓冲区。
  */
-QString CodeGenerator::generateFooter()
+QString CodeGenerator::generateStageUnit(const QJsonObject &node, bool hasOutput,
+                                         const QStringList &inputs, const QString &body)
 {
-    return R"(
+    const QString nodeId = node["id"].toString();
+    const QString nodeName = identifierFor(nodeId);
+    const QString nodeType = node["type"].toString();
+    
+    QStringList params;
+    QStringList args;
+    if (hasOutput) {
+        params << QString("Signal &%1").arg(nodeName);
+        args << nodeName;
+    }
+    for (const QString &input : inputs) {
+        params << QString("const Signal &%1").arg(input);
+        args << input;
+    }
+    const bool streamingSource = m_blockSize > 0 && nodeType == "signal_source";
+    if (streamingSource) {
+        params << "size_t offset" << "size_t blockLength";
+        args << "offset" << "blockLength";
+    }
+    
+    const QString signature = QString("void stage_%1(%2)").arg(nodeName, params.join(", "));
+    m_stageInterfaces.append(signature + ";");
+    
+    QString unit = QString(R"(/**
+ * @file stage_%1.cpp
+ * @brief 节点 %1（%2）的处理阶段
+ *
+ * 此文件由Qt节点编辑器自动生成。
+ */
 
-// ==================== 辅助函数 ====================
+#include "stages.h"
 
-/**
- * @brief 滤波器处理函数
- * @param input 输入信号
- * @param output 输出信号
- */
-void applyFilter(const Signal& input, Signal& output) {
-    // TODO: 实现滤波算法
-    output = input; // 临时实现
+)").arg(nodeName, nodeType);
+    unit += cachedFragment("cpp-node", nodeId, nodeName, [&]() { return generateNodeCode(node); });
+    
+    // 流式模式下汇节点的计数器由主函数在处理结束后输出
+    if (m_blockSize > 0 && nodeType == "sink") {
+        m_stageInterfaces.append(QString("extern size_t %1_samples;").arg(nodeName));
+        unit += QString("size_t %1_samples = 0;\n\n").arg(nodeName);
+    }
+    
+    QString functionBody = body;
+    if (functionBody.endsWith("\n\n")) {
+        functionBody.chop(1);
+    }
+    unit += QString("/**\n * @brief 执行节点 %1\n */\n").arg(nodeName);
+    unit += signature + "\n{\n";
+    if (streamingSource) {
+        unit += "    (void)offset; // 供信号源生成逻辑使用\n";
+    }
+    // 并非每个节点的处理代码都会读取全部输入，未引用的参数需避免 -Wunused-parameter 警告
+    for (const QString &input : inputs) {
+        const QRegularExpression reference(QString("\\b%1\\b").arg(QRegularExpression::escape(input)));
+        if (!functionBody.contains(reference)) {
+            unit += QString("    (void)%1; // 该节点的处理代码未读取此输入\n").arg(input);
+        }
+    }
+    unit += functionBody;
+    unit += "}\n";
+    m_projectFiles.insert(QString("stage_%1.cpp").arg(nodeName), unit);
+    
+    return QString("    stage_%1(%2);\n").arg(nodeName, args.join(", "));
 }
 
 /**
- * @brief FFT变换函数
- * @param input 输入信号
- * @param spectrum 输出频谱
+ * @brief 生成节点对应的流水线阶段类型及其参数结构体
+ * @param node 节点的JSON数据
+ * @param nodeName 节点的C++标识符
+ * @param paramsStruct 输出参数，参数结构体定义
+ * @param perSample 输出参数，阶段是否逐采样处理（可与相邻阶段合并）
+ * @return 阶段类型
+ *
+ * 参数取值与 generateInitializationCode() 一致，只是改为 static constexpr 成员，
+ * 使其成为阶段模板的编译期常量。
  */
-void performFFT(const Signal& input, vector<ComplexSignal>& spectrum) {
-    // TODO: 实现FFT算法
-    spectrum.clear();
+static QString pipelineStage(const QJsonObject &node, const QString &nodeName,
+                             QString *paramsStruct, bool *perSample)
+{
+    const QString nodeType = node["type"].toString();
+    const QString params = nodeName + "_params";
+    QStringList members;
+    QString stage;
+    *perSample = true;
+    
+    if (nodeType == "signal_source") {
+        members << "static constexpr size_t length = kSignalLength;";
+        stage = "Source";
+        *perSample = false;
+    } else if (nodeType == "filter") {
+        members << QString("static constexpr size_t taps = %1;").arg(qRound(numericParameter(node, "taps", 31, 1, 4096)))
+                << QString("static constexpr double cutoff = %1;").arg(numericParameter(node, "cutoff", 0.1, 0.0, 0.5), 0, 'g', 17);
+        stage = "Filter";
+    } else if (nodeType == "fft") {
+        // FFT长度必须是2的幂，向上取整
+        const int requested = qRound(numericParameter(node, "size", 1024, 2, 65536));
+        int size = 2;
+        while (size < requested) {
+            size <<= 1;
+        }
+        members << QString("static constexpr size_t size = %1;").arg(size);
+        stage = "Fft";
+        *perSample = false;
+    } else if (nodeType == "modulator") {
+        members << QString("static constexpr double frequency = %1;").arg(numericParameter(node, "frequency", 0.1, -0.5, 0.5), 0, 'g', 17)
+                << QString("static constexpr double phase = %1;").arg(numericParameter(node, "phase", 0.0, -1e9, 1e9), 0, 'g', 17);
+        stage = "Mixer";
+    } else if (nodeType == "demodulator") {
+        members << QString("static constexpr double frequency = %1;").arg(numericParameter(node, "frequency", 0.1, -0.5, 0.5), 0, 'g', 17)
+                << "static constexpr double phase = 0.0;"
+                << QString("static constexpr size_t taps = %1;").arg(qRound(numericParameter(node, "taps", 31, 1, 4096)))
+                << QString("static constexpr double cutoff = %1;").arg(numericParameter(node, "cutoff", 0.05, 0.0, 0.5), 0, 'g', 17);
+        stage = "Demodulator";
+    } else if (nodeType == "sink") {
+        stage = "Sink";
+        *perSample = false;
+    } else {
+        stage = "Identity";
+    }
+    
+    if (members.isEmpty()) {
+        *paramsStruct = QString("struct %1 {};\n").arg(params);
+    } else {
+        *paramsStruct = QString("struct %1 {\n    %2\n};\n").arg(params, members.join("\n    "));
+    }
+    return QString("pipeline::%1<%2>").arg(stage, params);
 }
 
 /**
- * @brief 调制函数
- * @param input 输入信号
- * @param output 输出调制信号
+ * @brief 生成模板流水线的类型定义和主函数
+ * @param flowData 流程图的JSON数据
+ * @return 流水线类型定义和主函数代码字符串
+ *
+ * 把依赖图划分为尽可能长的线性链：节点只有一个后继、后继也只有这一个前驱时，
+ * 后继并入同一条链。每条链生成一个 pipeline::Pipeline<...> 类型，相邻的逐采样阶段
+ * 合并为 pipeline::Fused<...>，整条链的调用关系对编译器完全可见。
+ * 链与链之间（分叉、汇合处）通过工作缓冲区传递数据，上游只剩一个读者时直接交换缓冲区。
+ */
+QString CodeGenerator::generatePipelineMain(const QJsonObject &flowData)
+{
+    FlowScheduler scheduler(analyzeDependencies(flowData));
+    
+    const QHash<QString, QJsonObject> nodeTable = CodeGenerator::nodeTable(flowData);
+    
+    // 去重后的前驱/后继，只保留已调度且存在的节点
+    const int count = scheduler.nodeCount();
+    auto isLive = [&](int index) {
+        return scheduler.levelOf(index) >= 0 && nodeTable.contains(scheduler.nodeId(index));
+    };
+    auto liveNeighbours = [&](const QVector<int> &neighbours) {
+        QVector<int> result;
+        for (int neighbour : neighbours) {
+            if (isLive(neighbour) && !result.contains(neighbour)) {
+                result.append(neighbour);
+            }
+        }
+        return result;
+    };
+    
+    // 按执行顺序划分线性链，链的编号顺序即执行顺序
+    QVector<int> chainOf(count, -1);
+    QVector<QVector<int>> chains;
+    for (int index : scheduler.orderIndices()) {
+        if (!isLive(index)) continue;
+        
+        int chain = -1;
+        const QVector<int> preds = liveNeighbours(scheduler.predecessors(index));
+        if (preds.size() == 1) {
+            const int pred = preds.first();
+            if (chains.at(chainOf.at(pred)).last() == pred
+                && liveNeighbours(scheduler.successors(pred)).size() == 1) {
+                chain = chainOf.at(pred);
+            }
+        }
+        if (chain < 0) {
+            chain = chains.size();
+            chains.append(QVector<int>());
+        }
+        chains[chain].append(index);
+        chainOf[index] = chain;
+    }
+    
+    // 链头的主输入来自上游链的末尾，统计每条链输出的读者数
+    QVector<int> inputChain(chains.size(), -1);
+    QVector<int> readers(chains.size(), 0);
+    for (int c = 0; c < chains.size(); ++c) {
+        const QVector<int> preds = liveNeighbours(scheduler.predecessors(chains.at(c).first()));
+        if (!preds.isEmpty()) {
+            inputChain[c] = chainOf.at(preds.first());
+            ++readers[inputChain.at(c)];
+        }
+    }
+    
+    QString code = "\n// ==================== 流水线 ====================\n\n";
+    code += signalConstants(m_blockSize);
+    
+    const QString length = m_blockSize > 0 ? "blockLength" : "kSignalLength";
+    QString body;
+    QString sinkReport;
+    for (int c = 0; c < chains.size(); ++c) {
+        const QString chainName = QString("pipeline%1").arg(c + 1);
+        QStringList names;
+        QStringList segments;
+        QStringList fused;
+        auto flush = [&]() {
+            if (!fused.isEmpty()) {
+                segments.append(QString("pipeline::Fused<%1>").arg(fused.join(", ")));
+                fused.clear();
+            }
+        };
+        
+        QString structs;
+        for (int index : chains.at(c)) {
+            const QString nodeId = scheduler.nodeId(index);
+            const QJsonObject node = nodeTable.value(nodeId);
+            const QString nodeName = identifierFor(nodeId);
+            names.append(nodeName);
+            
+            QString paramsStruct;
+            bool perSample = false;
+            const QString stage = pipelineStage(node, nodeName, &paramsStruct, &perSample);
+            structs += paramsStruct;
+            if (perSample) {
+                fused.append(stage);
+                continue;
+            }
+            
+            flush();
+            if (node["type"].toString() == "sink") {
+                sinkReport += QString("    cout << \"输出 %1 共接收 \" << g_%2.segment<%3>().samples() << \" 个采样点\" << endl;\n")
+                    .arg(nodeName, chainName).arg(segments.size());
+            }
+            segments.append(stage);
+        }
+        flush();
+        
+        code += QString("\n// 流水线 %1: %2\n").arg(c + 1).arg(names.join(" -> "));
+        code += structs;
+        code += QString("typedef pipeline::Pipeline<%1> Pipeline%2;\n"
+                        "static Pipeline%2 g_%3;\n")
+            .arg(segments.join(", ")).arg(c + 1).arg(chainName);
+        
+        // 链头的输入
+        body += QString("    // 流水线 %1: %2\n").arg(c + 1).arg(names.join(" -> "));
+        if (m_blockSize == 0) {
+            body += QString("    cout << \"执行流水线 %1...\" << endl;\n").arg(c + 1);
+        }
+        const int input = inputChain.at(c);
+        if (input < 0) {
+            body += QString("    %1_signal.assign(%2, 0.0);\n").arg(chainName, length);
+        } else if (--readers[input] == 0) {
+            body += QString("    %1_signal.swap(pipeline%2_signal); // 上游不再被读取，直接接管缓冲区\n")
+                .arg(chainName).arg(input + 1);
+        } else {
+            body += QString("    %1_signal = pipeline%2_signal;\n").arg(chainName).arg(input + 1);
+        }
+        const QVector<int> preds = liveNeighbours(scheduler.predecessors(chains.at(c).first()));
+        for (int i = 1; i < preds.size(); ++i) {
+            body += QString("    // 附加输入: %1（只读）\n").arg(identifierFor(scheduler.nodeId(preds.at(i))));
+        }
+        body += QString("    g_%1.process(%1_signal);\n\n").arg(chainName);
+    }
+    
+    code += R"(
+/**
+ * @brief 主处理函数，按执行顺序运行所有流水线
  */
-void performModulation(const Signal& input, Signal& output) {
-    // TODO: 实现调制算法
-    output = input; // 临时实现
+int main()
+{
+    cout << "开始执行信号处理流程..." << endl;
+    
+)";
+    
+    if (!chains.isEmpty()) {
+        code += "    // 每条流水线一个工作缓冲区\n";
+        for (int c = 0; c < chains.size(); ++c) {
+            code += QString("    Signal pipeline%1_signal;\n").arg(c + 1);
+            code += QString("    pipeline%1_signal.reserve(%2);\n").arg(c + 1).arg(m_blockSize > 0 ? "kBlockSize" : "kSignalLength");
+        }
+        code += "\n";
+    }
+    
+    if (scheduler.hasCycle()) {
+        code += QString("    // 警告: 检测到循环依赖 %1\n").arg(scheduler.describeCycle());
+        code += QString("    // 以下节点无法调度: %1\n\n").arg(scheduler.unscheduledNodes().join(", "));
+    }
+    
+    if (m_blockSize > 0) {
+        // 阶段对象跨块保留状态（滤波器延迟线、载波相位），逐块处理与整段处理结果一致
+        code += "    for (size_t offset = 0; offset < kSignalLength; offset += kBlockSize) {\n";
+        code += "        const size_t blockLength = min(kBlockSize, kSignalLength - offset);\n\n";
+        code += indentCode(body, 4);
+        code += "    }\n\n";
+    } else {
+        code += body;
+    }
+    code += sinkReport;
+    
+    code += R"(
+    cout << "信号处理流程执行完成。" << endl;
+    return 0;
+}
+)";
+    
+    return code;
 }
 
 /**
- * @brief 解调函数
- * @param input 输入信号
- * @param output 输出解调信号
+ * @brief 生成代码文件尾部
+ * @return 尾部代码字符串
  */
-void performDemodulation(const Signal& input, Signal& output) {
-    // TODO: 实现解调算法
-    output = input; // 临时实现
-}
+QString CodeGenerator::generateFooter()
+{
+    return R"(
 
 /*
  * 生成完毕 - 此文件由Qt节点编辑器自动生成
@@ -599,42 +1997,233 @@ void performDemodulation(const Signal& input, Signal& output) {
 )";
 }
 
+/**
+ * @brief 生成内置节点类型在Python中的构造表达式
+ * @param node 节点的JSON数据
+ * @param inPlace 缓冲区规划允许原地处理主输入
+ * @return 构造节点对象的Python表达式
+ *
+ * 参数的读取和默认值与C++后端的 generateInitializationCode 相同。
+ */
+static QString pythonNodeExpression(const QJsonObject &node, bool inPlace)
+{
+    const QString nodeType = node["type"].toString();
+    double x = 0, y = 0;
+    if (node.contains("position")) {
+        QJsonObject pos = node["position"].toObject();
+        x = pos["x"].toDouble();
+        y = pos["y"].toDouble();
+    }
+    const QString common = QString("%1, %2, %3, {'x': %4, 'y': %5}")
+        .arg(cStringLiteral(node["id"].toString()), cStringLiteral(nodeType), cStringLiteral(node["name"].toString()))
+        .arg(x).arg(y);
+    const QString flag = inPlace ? "True" : "False";
+    
+    if (nodeType == "signal_source") {
+        return QString("SignalSource(%1)").arg(common);
+    } else if (nodeType == "filter") {
+        const int taps = qRound(numericParameter(node, "taps", 31, 1, 4096));
+        const double cutoff = numericParameter(node, "cutoff", 0.1, 0.0, 0.5);
+        return QString("FirFilter(%1, taps=%2, cutoff=%3)").arg(common).arg(taps).arg(cutoff, 0, 'g', 17);
+    } else if (nodeType == "fft") {
+        return QString("Fft(%1)").arg(common);
+    } else if (nodeType == "modulator") {
+        const double frequency = numericParameter(node, "frequency", 0.1, -0.5, 0.5);
+        const double phase = numericParameter(node, "phase", 0.0, -1e9, 1e9);
+        return QString("Mixer(%1, frequency=%2, phase=%3, in_place=%4)")
+            .arg(common).arg(frequency, 0, 'g', 17).arg(phase, 0, 'g', 17).arg(flag);
+    } else if (nodeType == "demodulator") {
+        const double frequency = numericParameter(node, "frequency", 0.1, -0.5, 0.5);
+        const int taps = qRound(numericParameter(node, "taps", 31, 1, 4096));
+        const double cutoff = numericParameter(node, "cutoff", 0.05, 0.0, 0.5);
+        return QString("Demodulator(%1, frequency=%2, taps=%3, cutoff=%4, in_place=%5)")
+            .arg(common).arg(frequency, 0, 'g', 17).arg(taps).arg(cutoff, 0, 'g', 17).arg(flag);
+    } else if (nodeType == "sink") {
+        return QString("Sink(%1)").arg(common);
+    }
+    return QString("Node(%1)").arg(common);
+}
+
 /**
  * @brief 根据标准JSON格式生成Python代码
  * @param flowData 标准流程图的JSON数据
  * @return 生成的Python代码字符串
+ *
+ * 内置节点类型映射为 NumPy/SciPy 的向量化调用（FIR滤波用 scipy.signal.lfilter，FFT用 numpy.fft），
+ * 整段信号作为 ndarray 在节点之间传递，不逐采样点循环。
+ * 调度和缓冲区规划与C++后端共用：直通节点（FFT）直接返回输入数组，
+ * BufferPlanner 判定为原地处理的混频节点写回上游数组，其余节点才产生新数组。
+ * 启用并行执行且图中存在可并行的层级时，同一依赖层级的节点提交到 concurrent.futures 线程池，
+ * 层级划分与C++并行执行计划相同。
  */
 QString CodeGenerator::generatePythonCode(const QJsonObject &flowData)
 {
+    beginGeneration(flowData);
+    
+    // 调度与缓冲区规划：并行模式下阶段为依赖层级，顺序模式下为执行顺序中的位置
+    FlowScheduler scheduler(analyzeDependencies(flowData));
+    const QHash<QString, QJsonObject> nodeTable = CodeGenerator::nodeTable(flowData);
+    const bool parallel = m_parallelExecution && scheduler.maxLevelWidth() > 1;
+    const int count = scheduler.nodeCount();
+    const QVector<int> &order = scheduler.orderIndices();
+    QVector<int> stageOf(count, -1);
+    for (int position = 0; position < order.size(); ++position) {
+        const int index = order.at(position);
+        stageOf[index] = parallel ? scheduler.levelOf(index) : position;
+    }
+    QVector<BufferPlanner::NodeKind> kinds(count, BufferPlanner::SinkNode);
+    for (int i = 0; i < count; ++i) {
+        auto it = nodeTable.constFind(scheduler.nodeId(i));
+        if (it != nodeTable.constEnd()) {
+            kinds[i] = nodeKindOf(it.value()["type"].toString());
+        }
+    }
+    BufferPlanner planner(scheduler, stageOf, kinds);
+    
+    // 只生成图中用到的节点类
+    QSet<QString> types;
+    for (auto it = nodeTable.constBegin(); it != nodeTable.constEnd(); ++it) {
+        types.insert(it.value()["type"].toString());
+    }
+    const bool usesMixer = types.contains("modulator") || types.contains("demodulator");
+    const bool usesFir = types.contains("filter") || types.contains("demodulator");
+    
     QString code;
     
     // 文件头
     code += "#!/usr/bin/env python3\n";
     code += "# -*- coding: utf-8 -*-\n";
     code += QString("# 自动生成的节点流程代码\n");
-    code += QString("# 生成时间: %1\n\n").arg(QDateTime::currentDateTime().toString(Qt::ISODate));
+    code += QString("# 生成时间: %1\n\n").arg(generationTimestamp());
     
     code += "import json\n";
-    code += "import numpy as np\n\n";
+    code += "import numpy as np\n";
+    if (parallel) {
+        code += "from concurrent.futures import ThreadPoolExecutor\n";
+    }
+    if (usesFir) {
+        code += "\n";
+        code += "try:\n";
+        code += "    from scipy.signal import lfilter\n";
+        code += "except ImportError:\n";
+        code += "    def lfilter(b, a, x):\n";
+        code += "        # 没有SciPy时用NumPy卷积实现FIR滤波（分母为1，结果相同）\n";
+        code += "        return np.convolve(x, b)[:len(x)]\n";
+    }
+    code += "\n";
+    code += "SIGNAL_LENGTH = 1000  # 信号总采样点数\n";
+    if (parallel) {
+        code += QString("MAX_WORKERS = %1  # 同一层级并发执行的最大线程数\n")
+            .arg(m_maxWorkers > 0 ? QString::number(m_maxWorkers) : QString("None"));
+    }
+    code += "\n";
+    
+    if (usesFir) {
+        code += "def lowpass_taps(tap_count, cutoff, gain=1.0):\n";
+        code += "    # 与C++内核 dsp::lowpassTaps 相同：汉明窗 sinc 低通，直流增益归一化为 gain\n";
+        code += "    cutoff = min(max(cutoff, 1e-6), 0.5)\n";
+        code += "    n = np.arange(tap_count) - 0.5 * (tap_count - 1)\n";
+        code += "    taps = 2.0 * cutoff * np.sinc(2.0 * cutoff * n) * np.hamming(tap_count)\n";
+        code += "    return taps * (gain / taps.sum())\n\n";
+    }
     
-    // 节点类定义
+    // 节点类定义：process 接收输入数组列表，返回输出数组（汇节点返回None）
     code += "class Node:\n";
     code += "    def __init__(self, node_id, node_type, name, position):\n";
     code += "        self.id = node_id\n";
     code += "        self.type = node_type\n";
     code += "        self.name = name\n";
-    code += "        self.position = position\n";
-    code += "        self.inputs = []\n";
-    code += "        self.outputs = []\n\n";
-    code += "    def process(self, data):\n";
-    code += "        # 根据节点类型处理数据\n";
-    code += "        return data\n\n";
+    code += "        self.position = position\n\n";
+    code += "    def process(self, inputs):\n";
+    code += "        # 未内置的节点类型直通主输入（不复制）\n";
+    code += "        # TODO: 实现节点的处理逻辑\n";
+    code += "        return inputs[0] if inputs else None\n\n";
+    code += "    def report(self):\n";
+    code += "        pass\n\n";
+    
+    if (types.contains("signal_source")) {
+        code += "class SignalSource(Node):\n";
+        code += "    def process(self, inputs):\n";
+        code += "        # TODO: 实现信号源生成逻辑\n";
+        code += "        return np.zeros(SIGNAL_LENGTH)\n\n";
+    }
+    if (types.contains("filter")) {
+        code += "class FirFilter(Node):\n";
+        code += "    def __init__(self, node_id, node_type, name, position, taps, cutoff):\n";
+        code += "        super().__init__(node_id, node_type, name, position)\n";
+        code += "        self.taps = lowpass_taps(taps, cutoff)\n\n";
+        code += "    def process(self, inputs):\n";
+        code += "        if not inputs:\n";
+        code += "            return None\n";
+        code += "        return lfilter(self.taps, 1.0, inputs[0])\n\n";
+    }
+    if (types.contains("fft")) {
+        code += "class Fft(Node):\n";
+        code += "    def __init__(self, node_id, node_type, name, position):\n";
+        code += "        super().__init__(node_id, node_type, name, position)\n";
+        code += "        self.spectrum = None\n\n";
+        code += "    def process(self, inputs):\n";
+        code += "        if not inputs:\n";
+        code += "            return None\n";
+        code += "        x = inputs[0]\n";
+        code += "        # 与C++内核一致补零到2的幂；频谱保存在节点上，输出就是输入数组本身\n";
+        code += "        self.spectrum = np.fft.fft(x, n=1 << max(len(x) - 1, 0).bit_length())\n";
+        code += "        return x\n\n";
+    }
+    if (usesMixer) {
+        code += "class Mixer(Node):\n";
+        code += "    def __init__(self, node_id, node_type, name, position, frequency, phase, in_place):\n";
+        code += "        super().__init__(node_id, node_type, name, position)\n";
+        code += "        self.frequency = frequency\n";
+        code += "        self.phase = phase\n";
+        code += "        self.in_place = in_place\n";
+        code += "        self._carrier = np.empty(0)\n\n";
+        code += "    def carrier(self, length):\n";
+        code += "        # 载波只在信号长度变化时重新计算\n";
+        code += "        if len(self._carrier) != length:\n";
+        code += "            self._carrier = np.cos(2.0 * np.pi * self.frequency * np.arange(length) + self.phase)\n";
+        code += "        return self._carrier\n\n";
+        code += "    def process(self, inputs):\n";
+        code += "        if not inputs:\n";
+        code += "            return None\n";
+        code += "        x = inputs[0]\n";
+        code += "        if self.in_place and x.flags.writeable:\n";
+        code += "            # 上游数组之后不再被读取，直接写回\n";
+        code += "            return np.multiply(x, self.carrier(len(x)), out=x)\n";
+        code += "        return x * self.carrier(len(x))\n\n";
+    }
+    if (types.contains("demodulator")) {
+        code += "class Demodulator(Mixer):\n";
+        code += "    def __init__(self, node_id, node_type, name, position, frequency, taps, cutoff, in_place):\n";
+        code += "        super().__init__(node_id, node_type, name, position, frequency, 0.0, in_place)\n";
+        code += "        self.taps = lowpass_taps(taps, cutoff, 2.0)\n\n";
+        code += "    def process(self, inputs):\n";
+        code += "        # 与本地载波混频后低通滤除倍频分量\n";
+        code += "        mixed = super().process(inputs)\n";
+        code += "        return None if mixed is None else lfilter(self.taps, 1.0, mixed)\n\n";
+    }
+    if (types.contains("sink")) {
+        code += "class Sink(Node):\n";
+        code += "    def __init__(self, node_id, node_type, name, position):\n";
+        code += "        super().__init__(node_id, node_type, name, position)\n";
+        code += "        self.received = []\n\n";
+        code += "    def process(self, inputs):\n";
+        code += "        # 执行期间不输出，结束后由 report 统一打印\n";
+        code += "        self.received = [len(x) for x in inputs]\n";
+        code += "        return None\n\n";
+        code += "    def report(self):\n";
+        code += "        for samples in self.received:\n";
+        code += "            print(f'  {self.name}: {samples} 个采样点')\n\n";
+    }
     
     // 流程图类
     code += "class FlowGraph:\n";
     code += "    def __init__(self):\n";
     code += "        self.nodes = {}\n";
-    code += "        self.connections = []\n\n";
+    code += "        self.connections = []\n";
+    code += "        self.inputs = {}\n";
+    code += "        self.execution_order = []\n";
+    code += "        self.levels = []\n\n";
     
     code += "    def add_node(self, node):\n";
     code += "        self.nodes[node.id] = node\n\n";
@@ -645,13 +2234,110 @@ QString CodeGenerator::generatePythonCode(const QJsonObject &flowData)
     code += "            'to': to_id,\n";
     code += "            'fromPort': from_port,\n";
     code += "            'toPort': to_port\n";
-    code += "        })\n\n";
+    code += "        })\n";
+    code += "        # 输入表在添加连接时建立，执行时不再扫描连接列表\n";
+    code += "        sources = self.inputs.setdefault(to_id, [])\n";
+    code += "        if from_id not in sources:\n";
+    code += "            sources.append(from_id)\n\n";
+    
+    code += "    def gather(self, node_id, results):\n";
+    code += "        # 输入数组按引用传递，不复制\n";
+    code += "        return [results[s] for s in self.inputs.get(node_id, ()) if results.get(s) is not None]\n\n";
+    
+    code += "    def run_node(self, node_id, results):\n";
+    code += "        return self.nodes[node_id].process(self.gather(node_id, results))\n\n";
     
     code += "    def execute(self):\n";
-    code += "        # 按拓扑顺序执行节点\n";
     code += "        print('执行流程图...')\n";
-    code += "        for conn in self.connections:\n";
-    code += "            print(f\"  {conn['from']} -> {conn['to']}\")\n\n";
+    code += "        results = {}\n";
+    if (parallel) {
+        code += "        # 同一层级的节点互不依赖；NumPy/SciPy 在C代码中释放GIL，线程可以真正并行，数组也无需跨进程复制\n";
+        code += "        with ThreadPoolExecutor(max_workers=MAX_WORKERS) as pool:\n";
+        code += "            for level in self.levels:\n";
+        code += "                for node_id in level:\n";
+        code += "                    node = self.nodes[node_id]\n";
+        code += "                    print(f\"  执行 {node.name} ({node.type})\")\n";
+        code += "                if len(level) == 1:\n";
+        code += "                    results[level[0]] = self.run_node(level[0], results)\n";
+        code += "                    continue\n";
+        code += "                futures = [(node_id, pool.submit(self.run_node, node_id, results)) for node_id in level]\n";
+        code += "                for node_id, future in futures:\n";
+        code += "                    results[node_id] = future.result()\n";
+    } else {
+        code += "        for node_id in self.execution_order:\n";
+        code += "            node = self.nodes[node_id]\n";
+        code += "            print(f\"  执行 {node.name} ({node.type})\")\n";
+        code += "            results[node_id] = self.run_node(node_id, results)\n";
+    }
+    code += "        for node_id in self.execution_order:\n";
+    code += "            self.nodes[node_id].report()\n";
+    code += "        return results\n\n";
+    
+    if (m_instrumentation) {
+        // 逐节点计时，与C++性能测量使用相同的报告格式；节点按执行顺序串行运行，耗时互不干扰
+        code += QString("    def benchmark(self, iterations=%1, warmup=%2, report_path='profile_report.json'):\n")
+            .arg(m_benchmarkIterations).arg(m_benchmarkWarmup);
+        code += "        # 预热后重复执行，逐节点统计耗时和内存申请量，结果写入JSON报告\n";
+        code += "        import math\n";
+        code += "        import time\n";
+        code += "        import tracemalloc\n";
+        code += "        latencies = {node_id: [] for node_id in self.execution_order}\n";
+        code += "        samples = {node_id: 0 for node_id in self.execution_order}\n";
+        code += "        allocated = {node_id: 0 for node_id in self.execution_order}\n";
+        code += "        runs = []\n";
+        code += "        tracemalloc.start()\n";
+        code += "        for iteration in range(warmup + iterations):\n";
+        code += "            recording = iteration >= warmup\n";
+        code += "            run_start = time.perf_counter_ns()\n";
+        code += "            results = {}\n";
+        code += "            for node_id in self.execution_order:\n";
+        code += "                node = self.nodes[node_id]\n";
+        code += "                inputs = self.gather(node_id, results)\n";
+        code += "                tracemalloc.reset_peak()\n";
+        code += "                before = tracemalloc.get_traced_memory()[0]\n";
+        code += "                start = time.perf_counter_ns()\n";
+        code += "                results[node_id] = node.process(inputs)\n";
+        code += "                elapsed = time.perf_counter_ns() - start\n";
+        code += "                peak = tracemalloc.get_traced_memory()[1]\n";
+        code += "                if recording:\n";
+        code += "                    latencies[node_id].append(elapsed)\n";
+        code += "                    allocated[node_id] += max(0, peak - before)\n";
+        code += "                    result = results[node_id]\n";
+        code += "                    if result is None:\n";
+        code += "                        # 汇节点取主输入的采样点数，与C++一致\n";
+        code += "                        result = inputs[0] if inputs else ()\n";
+        code += "                    samples[node_id] = len(result)\n";
+        code += "            if recording:\n";
+        code += "                runs.append(time.perf_counter_ns() - run_start)\n";
+        code += "        tracemalloc.stop()\n\n";
+        code += "        def percentile(values, fraction):\n";
+        code += "            # 最近秩法\n";
+        code += "            if not values:\n";
+        code += "                return 0.0\n";
+        code += "            ordered = sorted(values)\n";
+        code += "            rank = max(1, math.ceil(fraction * len(ordered)))\n";
+        code += "            return float(ordered[min(len(ordered), rank) - 1])\n\n";
+        code += "        report = {'format': 'dagflow-profile', 'version': 1,\n";
+        code += "                  'iterations': iterations, 'warmup': warmup,\n";
+        code += "                  'run_median_ns': percentile(runs, 0.5), 'nodes': []}\n";
+        code += "        for node_id in self.execution_order:\n";
+        code += "            node = self.nodes[node_id]\n";
+        code += "            values = latencies[node_id]\n";
+        code += "            median = percentile(values, 0.5)\n";
+        code += "            report['nodes'].append({\n";
+        code += "                'id': node_id, 'name': node.name, 'type': node.type,\n";
+        code += "                'executions': len(values), 'samples': samples[node_id],\n";
+        code += "                'min_ns': percentile(values, 0.0), 'median_ns': median,\n";
+        code += "                'p99_ns': percentile(values, 0.99),\n";
+        code += "                'throughput_samples_per_s': samples[node_id] * 1e9 / median if median > 0 else 0.0,\n";
+        code += "                'output_bytes': samples[node_id] * 8,\n";
+        code += "                'bytes_allocated': allocated[node_id] // len(values) if values else 0,\n";
+        code += "            })\n";
+        code += "        with open(report_path, 'w', encoding='utf-8') as f:\n";
+        code += "            json.dump(report, f, ensure_ascii=False, indent=2)\n";
+        code += "        print(f'性能报告已写入 {report_path}')\n";
+        code += "        return report\n\n";
+    }
     
     // 主程序
     code += "# 创建流程图\n";
@@ -663,18 +2349,18 @@ QString CodeGenerator::generatePythonCode(const QJsonObject &flowData)
     for (const QJsonValue &nodeValue : nodes) {
         QJsonObject node = nodeValue.toObject();
         QString nodeId = node["id"].toString();
-        QString nodeType = node["type"].toString();
-        QString nodeName = node["name"].toString();
+        const int index = scheduler.indexOf(nodeId);
+        const bool inPlace = index >= 0 && planner.outputMode(index) == BufferPlanner::InPlace;
         
-        double x = 0, y = 0;
+        // 位置和缓冲区模式不参与节点哈希，作为片段上下文
+        QString context = inPlace ? "in-place|" : "fresh|";
         if (node.contains("position")) {
             QJsonObject pos = node["position"].toObject();
-            x = pos["x"].toDouble();
-            y = pos["y"].toDouble();
+            context += QString("%1,%2").arg(pos["x"].toDouble()).arg(pos["y"].toDouble());
         }
-        
-        code += QString("graph.add_node(Node('%1', '%2', '%3', {'x': %4, 'y': %5}))\n")
-            .arg(nodeId).arg(nodeType).arg(nodeName).arg(x).arg(y);
+        code += cachedFragment("py-node", nodeId, context, [&]() {
+            return QString("graph.add_node(%1)\n").arg(pythonNodeExpression(node, inPlace));
+        });
     }
     
     code += "\n# 添加连接\n";
@@ -686,14 +2372,45 @@ QString CodeGenerator::generatePythonCode(const QJsonObject &flowData)
         int fromPort = conn["fromPort"].toInt(0);
         int toPort = conn["toPort"].toInt(0);
         
-        code += QString("graph.add_connection('%1', '%2', %3, %4)\n")
-            .arg(fromId).arg(toId).arg(fromPort).arg(toPort);
+        code += QString("graph.add_connection(%1, %2, %3, %4)\n")
+            .arg(cStringLiteral(fromId), cStringLiteral(toId)).arg(fromPort).arg(toPort);
+    }
+    
+    // 执行顺序与依赖层级（由流程调度器计算）
+    QStringList orderItems;
+    for (const QString &nodeId : scheduler.executionOrder()) {
+        orderItems.append(cStringLiteral(nodeId));
+    }
+    code += "\n# 执行顺序\n";
+    if (scheduler.hasCycle()) {
+        code += QString("# 警告: 检测到循环依赖 %1\n").arg(scheduler.describeCycle());
+        code += QString("# 以下节点无法调度: %1\n").arg(scheduler.unscheduledNodes().join(", "));
+    }
+    code += QString("graph.execution_order = [%1]\n").arg(orderItems.join(", "));
+    if (parallel) {
+        QStringList levelItems;
+        for (const QVector<int> &level : scheduler.levels()) {
+            QStringList ids;
+            for (int index : level) {
+                ids.append(cStringLiteral(scheduler.nodeId(index)));
+            }
+            levelItems.append(QString("    [%1],\n").arg(ids.join(", ")));
+        }
+        code += QString("\n# 依赖层级（共 %1 层，最大并行度 %2），与C++并行执行计划相同\n")
+            .arg(scheduler.levels().size()).arg(scheduler.maxLevelWidth());
+        code += QString("graph.levels = [\n%1]\n").arg(levelItems.join(""));
     }
     
     code += "\n# 执行流程\n";
     code += "if __name__ == '__main__':\n";
-    code += "    graph.execute()\n";
+    if (m_instrumentation) {
+        code += "    import sys\n";
+        code += "    graph.benchmark(report_path=sys.argv[1] if len(sys.argv) > 1 else 'profile_report.json')\n";
+    } else {
+        code += "    graph.execute()\n";
+    }
     
+    endGeneration();
     return code;
 }
 
@@ -704,11 +2421,12 @@ QString CodeGenerator::generatePythonCode(const QJsonObject &flowData)
  */
 QString CodeGenerator::generateConfigFile(const QJsonObject &flowData)
 {
+    beginGeneration(flowData);
     QString config;
     
     // YAML头
     config += "# 节点流程图配置文件\n";
-    config += QString("# 生成时间: %1\n\n").arg(QDateTime::currentDateTime().toString(Qt::ISODate));
+    config += QString("# 生成时间: %1\n\n").arg(generationTimestamp());
     
     // 元数据
     config += "metadata:\n";
@@ -761,5 +2479,22 @@ QString CodeGenerator::generateConfigFile(const QJsonObject &flowData)
         config += "\n";
     }
     
+    // 执行顺序
+    FlowScheduler scheduler(analyzeDependencies(flowData));
+    if (scheduler.hasCycle()) {
+        config += QString("# 警告: 检测到循环依赖 %1\n").arg(scheduler.describeCycle());
+    }
+    config += "execution_order:\n";
+    for (const QString &nodeId : scheduler.executionOrder()) {
+        config += QString("  - %1\n").arg(nodeId);
+    }
+    if (scheduler.hasCycle()) {
+        config += "unscheduled_nodes:\n";
+        for (const QString &nodeId : scheduler.unscheduledNodes()) {
+            config += QString("  - %1\n").arg(nodeId);
+        }
+    }
+    
+    endGeneration();
     return config;
 }
@@ -11,6 +11,13 @@
 
 #include <QString>       // Qt字符串类
 #include <QJsonObject>   // JSON对象类
+#include <QMap>          // Qt映射类
+#include <QStringList>   // Qt字符串列表类
+#include <QHash>         // Qt哈希表类
+#include <QJsonArray>    // JSON数组类
+#include <QByteArray>    // 字节数组类
+#include <functional>    // 函数对象
+#include "BufferPlanner.h" // 缓冲区规划器类
 
 /**
  * @class CodeGenerator
@@ -18,6 +25,8 @@
  * 
  * 该类负责将节点编辑器中的流程图数据转换为可执行的代码。
  * 支持生成完整的C++代码文件，包括头文件、主函数等。
+ * 生成的主函数按依赖层级（波前）组织，同一层级内互不依赖的节点可并发执行；
+ * 也可以选择模板流水线后端，把线性链生成为编译期组合的流水线类型。
  */
 class CodeGenerator
 {
@@ -34,6 +43,171 @@ public:
      */
     QString generateCode(const QJsonObject &flowData);
     
+    /**
+     * @brief 生成完整的C++源文件
+     * @param flowData 标准流程图的JSON数据
+     * @return 生成的C++代码字符串
+     */
+    QString generateCppCode(const QJsonObject &flowData);
+    
+    /**
+     * @brief 生成多文件C++工程
+     * @param flowData 标准流程图的JSON数据
+     * @return 相对文件名到文件内容的映射
+     *
+     * 每个节点（组节点连同其内部子图）生成一个独立的编译单元 stage_<节点>.cpp，
+     * stages.h 只包含与节点无关的公共类型和常量，各阶段接口声明在 main.cpp 中，
+     * 增删或重命名节点时只有受影响的阶段和 main.cpp 需要重新编译；main.cpp 按执行计划调用各阶段，
+     * 并附带 CMakeLists.txt 和 DspKernels.h，可直接用 make -j 并行编译。
+     * 工程导出总是使用默认后端（不支持模板流水线）。
+     */
+    QMap<QString, QString> generateCppProject(const QJsonObject &flowData);
+    
+    /**
+     * @brief 设置是否按依赖层级并行执行生成的节点
+     * @param enabled 为true时同一层级的节点在多个线程中并发执行
+     */
+    void setParallelExecution(bool enabled) { m_parallelExecution = enabled; }
+    
+    /**
+     * @brief 获取是否启用并行执行
+     * @return 启用返回true
+     */
+    bool parallelExecution() const { return m_parallelExecution; }
+    
+    /**
+     * @brief 设置生成代码使用的最大工作线程数
+     * @param maxWorkers 最大工作线程数，0表示运行时使用 std::thread::hardware_concurrency()
+     */
+    void setMaxWorkers(int maxWorkers) { m_maxWorkers = qMax(0, maxWorkers); }
+    
+    /**
+     * @brief 获取最大工作线程数
+     * @return 最大工作线程数，0表示自动
+     */
+    int maxWorkers() const { return m_maxWorkers; }
+    
+    /**
+     * @brief 设置是否使用模板流水线后端生成C++代码
+     * @param enabled 为true时每条线性链生成一个编译期组合的 pipeline::Pipeline<...> 类型
+     *
+     * 节点参数作为 constexpr 模板参数传入，编译器可以跨阶段内联、展开定长循环并在编译期
+     * 计算滤波器系数；该模式按执行顺序单线程运行，不使用并行层级。
+     */
+    void setTemplatePipeline(bool enabled) { m_templatePipeline = enabled; }
+    
+    /**
+     * @brief 获取是否使用模板流水线后端
+     * @return 启用返回true
+     */
+    bool templatePipeline() const { return m_templatePipeline; }
+    
+    /**
+     * @brief 设置是否生成带性能测量的代码
+     * @param enabled 为true时生成的C++/Python代码为每个节点计时，
+     *                预热后重复执行整个流程，并写出JSON格式的性能报告
+     *
+     * 报告包含每个节点的最小/中位数/P99耗时、吞吐量（采样点/秒）和堆内存申请量，
+     * 节点ID与 NodeScene::getFlowData() 一致，可以载回编辑器。
+     * 模板流水线后端合并了各节点的处理循环，不支持逐节点测量。
+     */
+    void setInstrumentation(bool enabled) { m_instrumentation = enabled; }
+    
+    /**
+     * @brief 获取是否生成带性能测量的代码
+     * @return 启用返回true
+     */
+    bool instrumentation() const { return m_instrumentation; }
+    
+    /**
+     * @brief 设置性能测量的运行次数
+     * @param iterations 计入统计的运行次数
+     * @param warmup 预热次数（不计入统计）
+     */
+    void setBenchmarkIterations(int iterations, int warmup)
+    {
+        m_benchmarkIterations = qMax(1, iterations);
+        m_benchmarkWarmup = qMax(0, warmup);
+    }
+    
+    /**
+     * @brief 获取计入统计的运行次数
+     * @return 运行次数
+     */
+    int benchmarkIterations() const { return m_benchmarkIterations; }
+    
+    /**
+     * @brief 获取预热次数
+     * @return 预热次数
+     */
+    int benchmarkWarmup() const { return m_benchmarkWarmup; }
+    
+    /**
+     * @brief 设置是否启用增量生成
+     * @param enabled 为true时缓存每个节点生成的代码片段，并且不在输出中写入生成时间
+     *
+     * 同一个 CodeGenerator 对象多次生成时，内容哈希未变的节点直接复用上次的片段；
+     * 输出中不含时间戳，因此图没有变化时生成的文本逐字节相同，配合 writeFileIfChanged()
+     * 可以让下游构建系统保持增量编译。
+     */
+    void setIncremental(bool enabled);
+    
+    /**
+     * @brief 获取是否启用增量生成
+     * @return 启用返回true
+     */
+    bool incremental() const { return m_incremental; }
+    
+    /**
+     * @brief 获取上一次生成中复用的缓存片段数
+     * @return 复用的片段数
+     */
+    int reusedFragmentCount() const { return m_reusedFragments; }
+    
+    /**
+     * @brief 获取上一次生成中重新生成的片段数
+     * @return 重新生成的片段数
+     */
+    int emittedFragmentCount() const { return m_emittedFragments; }
+    
+    /**
+     * @brief 计算每个节点的内容哈希
+     * @param flowData 标准流程图的JSON数据
+     * @return 节点ID到哈希值的映射
+     *
+     * 哈希覆盖节点类型、名称、参数以及所有输入连接（源节点和端口），
+     * 任何一项变化都会使该节点的缓存片段失效。
+     */
+    static QHash<QString, QByteArray> nodeHashes(const QJsonObject &flowData);
+    
+    /**
+     * @brief 建立节点ID到节点数据的索引
+     * @param flowData 标准流程图的JSON数据
+     * @return 节点ID（Node::idString）到节点JSON对象的映射
+     *
+     * 各生成器按ID取节点数据时共用，避免对节点数组做线性扫描。
+     */
+    static QHash<QString, QJsonObject> nodeTable(const QJsonObject &flowData);
+    
+    /**
+     * @brief 仅在内容变化时写入文件
+     * @param fileName 文件路径
+     * @param content 文件内容
+     * @param written 输出参数，实际写入了文件时为true
+     * @return 成功（包括内容相同而跳过写入）返回true，无法写入返回false
+     *
+     * 内容相同时不打开文件写入，文件的修改时间保持不变。
+     */
+    static bool writeFileIfChanged(const QString &fileName, const QString &content, bool *written = nullptr);
+    
+    /**
+     * @brief 删除导出目录中已不属于工程的阶段编译单元（节点被删除或重命名后遗留的 stage_*.cpp）
+     * @param dirName 导出目录
+     * @param files 本次导出的文件，见 generateCppProject()
+     * @return 被删除的文件名列表
+     */
+    static QStringList removeStaleStageFiles(const QString &dirName, const QMap<QString, QString> &files);
+    
     /**
      * @brief 生成连接状态的JSON表示
      * @param flowData 标准流程图的JSON数据
@@ -59,6 +233,8 @@ public:
      * @brief 根据标准JSON格式生成Python代码
      * @param flowData 标准流程图的JSON数据
      * @return 生成的Python代码字符串
+     *
+     * 内置节点映射为 NumPy/SciPy 向量化调用；启用并行执行时按依赖层级使用线程池。
      */
     QString generatePythonCode(const QJsonObject &flowData);
     
@@ -72,9 +248,41 @@ public:
 private:
     /**
      * @brief 生成代码文件头部
+     * @param fileName 写入文件注释的文件名
      * @return 头部代码字符串
      */
-    QString generateHeader();
+    QString generateHeader(const QString &fileName = QString("generated_code.cpp"));
+    
+    /**
+     * @brief 生成内置节点使用的向量化信号处理内核库
+     * @return 内核库代码字符串
+     */
+    QString generateKernelLibrary();
+    
+    /**
+     * @brief 生成按层级并行执行所需的运行时辅助代码
+     * @return 运行时辅助代码字符串
+     */
+    QString generateParallelRuntime();
+    
+    /**
+     * @brief 生成性能测量模式所需的运行时辅助代码
+     * @return 运行时辅助代码字符串
+     */
+    QString generateBenchmarkRuntime();
+    
+    /**
+     * @brief 生成模板流水线后端使用的阶段模板库
+     * @return 阶段模板库代码字符串
+     */
+    QString generatePipelineLibrary();
+    
+    /**
+     * @brief 生成模板流水线的类型定义和主函数
+     * @param flowData 流程图的JSON数据
+     * @return 流水线类型定义和主函数代码字符串
+     */
+    QString generatePipelineMain(const QJsonObject &flowData);
     
     /**
      * @brief 生成单个节点的代码
@@ -115,10 +323,103 @@ private:
      * @brief 生成节点处理代码
      * @param nodeName 节点名称
      * @param nodeType 节点类型
-     * @param dependencies 依赖列表
+     * @param inputs 输入缓冲区列表，第一个为主输入
+     * @param mode 输出缓冲区的来源
      * @return 处理代码字符串
      */
-    QString generateNodeProcessingCode(const QString &nodeName, const QString &nodeType, const QStringList &dependencies);
+    QString generateNodeProcessingCode(const QString &nodeName, const QString &nodeType,
+                                       const QStringList &inputs, BufferPlanner::OutputMode mode);
+    
+    /**
+     * @brief 生成单个节点的编译单元（工程导出），并返回主函数中的调用语句
+     * @param node 节点的JSON数据
+     * @param hasOutput 节点是否产生输出缓冲区
+     * @param inputs 输入缓冲区列表，第一个为主输入
+     * @param body 节点处理代码，见 generateNodeProcessingCode()
+     * @return 主函数中调用该阶段的代码
+     */
+    QString generateStageUnit(const QJsonObject &node, bool hasOutput,
+                              const QStringList &inputs, const QString &body);
+    
+    /**
+     * @brief 确定流式处理的块大小
+     * @param flowData 标准流程图的JSON数据
+     * @return 块大小（采样点数），0表示整段处理
+     */
+    int resolveBlockSize(const QJsonObject &flowData) const;
+    
+    /**
+     * @brief 是否按依赖层级并行执行（流式处理时块内串行执行）
+     * @return 并行执行返回true
+     */
+    bool useParallelLevels() const { return m_parallelExecution && m_blockSize == 0 && !m_templatePipeline; }
+    
+    /**
+     * @brief 为所有节点分配合法且唯一的C++标识符
+     * @param nodes 节点数组
+     */
+    void buildIdentifiers(const QJsonArray &nodes);
+    
+    /**
+     * @brief 获取节点对应的C++标识符
+     * @param nodeId 节点ID
+     * @return C++标识符
+     */
+    QString identifierFor(const QString &nodeId) const;
+    
+    /**
+     * @brief 开始一次生成：计算节点哈希并重置片段统计
+     * @param flowData 标准流程图的JSON数据
+     */
+    void beginGeneration(const QJsonObject &flowData);
+    
+    /**
+     * @brief 结束一次生成：丢弃已删除节点的缓存片段
+     */
+    void endGeneration();
+    
+    /**
+     * @brief 获取节点的缓存片段，哈希变化或未缓存时重新生成
+     * @param slot 片段位置（同一节点在不同位置的片段互相独立）
+     * @param nodeId 节点ID
+     * @param context 影响片段内容的其他因素（如输入缓冲区、生成模式）
+     * @param generate 生成片段的函数
+     * @return 片段代码字符串
+     */
+    QString cachedFragment(const QString &slot, const QString &nodeId, const QString &context,
+                           const std::function<QString()> &generate);
+    
+    /**
+     * @brief 获取写入生成代码的时间戳
+     * @return 当前时间，增量生成时返回固定文本
+     */
+    QString generationTimestamp() const;
+    
+    bool m_parallelExecution;  ///< 是否按依赖层级并行执行
+    int m_maxWorkers;          ///< 最大工作线程数（0表示自动）
+    int m_blockSize;           ///< 当前生成使用的流式块大小（0表示整段处理）
+    bool m_templatePipeline;   ///< 是否使用模板流水线后端
+    bool m_projectLayout;      ///< 当前是否在生成多文件工程
+    QMap<QString, QString> m_projectFiles; ///< 工程导出时生成的各阶段编译单元
+    QStringList m_stageInterfaces;         ///< 工程导出时各阶段的接口声明
+    bool m_instrumentation;    ///< 是否生成带性能测量的代码
+    int m_benchmarkIterations; ///< 性能测量计入统计的运行次数
+    int m_benchmarkWarmup;     ///< 性能测量的预热次数
+    bool m_incremental;        ///< 是否启用增量生成
+    int m_reusedFragments;     ///< 本次生成复用的片段数
+    int m_emittedFragments;    ///< 本次生成重新生成的片段数
+    QHash<QString, QString> m_identifiers; ///< 节点ID到C++标识符的映射
+    QHash<QString, QByteArray> m_nodeHashes; ///< 本次生成的节点内容哈希
+    
+    /**
+     * @brief 缓存的代码片段
+     */
+    struct Fragment {
+        QString nodeId;   ///< 所属节点ID
+        QByteArray hash;  ///< 生成片段时的内容哈希
+        QString code;     ///< 片段代码
+    };
+    QHash<QString, Fragment> m_fragments;  ///< 片段位置到缓存片段的映射
 };
 
 #endif // CODEGENERATOR_H
\ No newline at end of file
@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -8,11 +8,21 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# 发布版在编译期去掉调试日志（qCDebug 和 DAGFLOW_DEBUG_ENABLED 代码块），见 Logging.h
+CONFIG(release, debug|release): DEFINES += QT_NO_DEBUG_OUTPUT
+# 以 CONFIG += no_trace 构建时连交互跟踪点一并去掉
+no_trace: DEFINES += DAGFLOW_NO_TRACE
+
 SOURCES += \
+    AutoLayout.cpp \
+    BinaryProject.cpp \
+    BufferPlanner.cpp \
     CodeGenerator.cpp \
     Connection.cpp \
     DraggableNodeTree.cpp \
+    FlowScheduler.cpp \
     GroupNode.cpp \
+    Logging.cpp \
     MiniMapWidget.cpp \
     Node.cpp \
     NodeEditDialog.cpp \
@@ -20,15 +30,24 @@ SOURCES += \
     NodeScene.cpp \
     NodeTemplate.cpp \
     NodeView.cpp \
+    PortIndex.cpp \
+    ProjectIO.cpp \
+    SceneNodeModel.cpp \
+    TopologyIndex.cpp \
     UndoCommands.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
+    AutoLayout.h \
+    BinaryProject.h \
+    BufferPlanner.h \
     CodeGenerator.h \
     Connection.h \
     DraggableNodeTree.h \
+    FlowScheduler.h \
     GroupNode.h \
+    Logging.h \
     MiniMapWidget.h \
     Node.h \
     NodeEditDialog.h \
@@ -36,12 +55,47 @@ HEADERS += \
     NodeScene.h \
     NodeTemplate.h \
     NodeView.h \
+    PortIndex.h \
+    ProjectIO.h \
+    SceneNodeModel.h \
+    TopologyIndex.h \
     UndoCommands.h \
     mainwindow.h
 
 FORMS += \
     mainwindow.ui
 
+# 以 CONFIG += headless 构建命令行代码生成工具（只依赖 QtCore，不含界面和场景），见 cli_main.cpp
+headless {
+    TARGET = dagflow-codegen
+    QT = core
+    CONFIG += console
+    CONFIG -= app_bundle
+
+    SOURCES = \
+        BatchGenerator.cpp \
+        BufferPlanner.cpp \
+        CodeGenerator.cpp \
+        FlowScheduler.cpp \
+        cli_main.cpp
+
+    HEADERS = \
+        BatchGenerator.h \
+        BufferPlanner.h \
+        CodeGenerator.h \
+        FlowScheduler.h
+
+    FORMS =
+}
+
+# 嵌入生成代码的信号处理内核库和流水线阶段模板（不参与本程序编译）
+RESOURCES += \
+    resources.qrc
+
+DISTFILES += \
+    DspKernels.h \
+    PipelineStages.h
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
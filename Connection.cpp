@@ -8,6 +8,12 @@
 
 #include "Connection.h"
 #include "Node.h"
+#include "NodeScene.h"
+#include "Logging.h"
+#include <QPen>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
 
 /**
  * @brief 构造函数，创建两个节点之间的连接（兼容旧版本，使用第一个端口）
@@ -41,16 +47,38 @@ Connection::Connection(Node *fromNode, int fromPortIndex, Node *toNode, int toPo
     initConnection();
 }
 
+/**
+ * @brief 构造函数，批量导入时使用，不计算路径
+ * @param fromNode 源节点
+ * @param fromPortIndex 源节点的输出端口索引
+ * @param toNode 目标节点
+ * @param toPortIndex 目标节点的输入端口索引
+ * @param lineType 连线类型
+ * 
+ * 路径由调用方在所有连接加入场景后统一调用 updatePath 计算（见 NodeScene::importFlowItems），
+ * 设置线型也不会先按贝塞尔曲线算一次路径。
+ */
+Connection::Connection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex, LineType lineType)
+    : m_fromNode(fromNode)
+    , m_toNode(toNode)
+    , m_fromPortIndex(fromPortIndex)
+    , m_toPortIndex(toPortIndex)
+    , m_lineType(lineType)
+{
+    initConnection(false);
+}
+
 /**
  * @brief 初始化连接
+ * @param computePath 是否立即计算路径
  */
-void Connection::initConnection()
+void Connection::initConnection(bool computePath)
 {
-    if (DEBUG_CONNECTION_PATH) {
-        qDebug() << "=== Connection构造函数 ===";
-        qDebug() << "源节点:" << (m_fromNode ? m_fromNode->getName() : "nullptr")
+    if (DAGFLOW_DEBUG_ENABLED(lcConnection)) {
+        qCDebug(lcConnection) << "=== Connection构造函数 ===";
+        qCDebug(lcConnection) << "源节点:" << (m_fromNode ? m_fromNode->getName() : "nullptr")
                  << "端口:" << m_fromPortIndex;
-        qDebug() << "目标节点:" << (m_toNode ? m_toNode->getName() : "nullptr")
+        qCDebug(lcConnection) << "目标节点:" << (m_toNode ? m_toNode->getName() : "nullptr")
                  << "端口:" << m_toPortIndex;
     }
     
@@ -65,7 +93,9 @@ void Connection::initConnection()
     if (m_toNode) m_toNode->addConnection(this);
     
     // 初始化连接线路径
-    updatePath();
+    if (computePath) {
+        updatePath();
+    }
 }
 
 /**
@@ -76,6 +106,11 @@ Connection::~Connection()
     // 从两个节点的连接列表中移除此连接线
     if (m_fromNode) m_fromNode->removeConnection(this);
     if (m_toNode) m_toNode->removeConnection(this);
+    
+    // 析构时不会收到 ItemSceneChange，需要主动从场景的待更新集合中移除
+    if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+        nodeScene->discardConnectionUpdate(this);
+    }
 }
 
 /**
@@ -90,6 +125,26 @@ void Connection::setLineType(LineType type)
     }
 }
 
+/**
+ * @brief 按性能报告设置连线粗细
+ * @param weight 传输数据量权重（0 ~ 1），小于0表示恢复默认样式
+ * @param critical 是否位于关键路径上
+ * 
+ * 线宽在3到15像素之间按数据量的平方根变化，避免小数据量的连线细到看不见；
+ * 关键路径上的连线改用橙色。
+ */
+void Connection::setProfileWeight(qreal weight, bool critical)
+{
+    if (weight < 0.0) {
+        setPen(QPen(Qt::yellow, 3));  // 恢复默认样式
+        return;
+    }
+    
+    const qreal width = 3.0 + 12.0 * qSqrt(qBound(0.0, weight, 1.0));
+    setPen(QPen(critical ? QColor(255, 140, 0) : QColor(Qt::yellow), width,
+                Qt::SolidLine, Qt::RoundCap));
+}
+
 /**
  * @brief 获取线型的显示名称
  * @param type 线型枚举值
@@ -115,13 +170,14 @@ QString Connection::lineTypeName(LineType type)
  */
 void Connection::updatePath()
 {
-    if (DEBUG_CONNECTION_PATH) {
-        qDebug() << "=== updatePath ===";
+    DAGFLOW_TRACE("connection.updatePath", this);
+    if (DAGFLOW_DEBUG_ENABLED(lcConnection)) {
+        qCDebug(lcConnection) << "=== updatePath ===";
     }
     
     // 检查节点有效性
     if (!m_fromNode || !m_toNode) {
-        if (DEBUG_CONNECTION_PATH) qDebug() << "节点无效，无法更新路径";
+        qCDebug(lcConnection) << "节点无效，无法更新路径";
         return;
     }
     
@@ -129,12 +185,12 @@ void Connection::updatePath()
     QPointF startPos = m_fromNode->getOutputPortPos(m_fromPortIndex);
     QPointF endPos = m_toNode->getInputPortPos(m_toPortIndex);
     
-    if (DEBUG_CONNECTION_PATH) {
-        qDebug() << "源节点:" << m_fromNode->getName() 
+    if (DAGFLOW_DEBUG_ENABLED(lcConnection)) {
+        qCDebug(lcConnection) << "源节点:" << m_fromNode->getName() 
                  << "端口:" << m_fromPortIndex << "位置:" << startPos;
-        qDebug() << "目标节点:" << m_toNode->getName() 
+        qCDebug(lcConnection) << "目标节点:" << m_toNode->getName() 
                  << "端口:" << m_toPortIndex << "位置:" << endPos;
-        qDebug() << "线型:" << lineTypeName(m_lineType);
+        qCDebug(lcConnection) << "线型:" << lineTypeName(m_lineType);
     }
     
     // 创建路径
@@ -176,10 +232,10 @@ void Connection::updatePath()
             // 第二个控制点：从终点回退
             QPointF ctrl2(endPos.x() - ctrlOffset, endPos.y());
             
-            if (DEBUG_CONNECTION_PATH) {
-                qDebug() << "距离 dx:" << dx;
-                qDebug() << "控制点1:" << ctrl1;
-                qDebug() << "控制点2:" << ctrl2;
+            if (DAGFLOW_DEBUG_ENABLED(lcConnection)) {
+                qCDebug(lcConnection) << "距离 dx:" << dx;
+                qCDebug(lcConnection) << "控制点1:" << ctrl1;
+                qCDebug(lcConnection) << "控制点2:" << ctrl2;
             }
             
             // 创建三次贝塞尔曲线
@@ -188,11 +244,76 @@ void Connection::updatePath()
         break;
     }
     
+    // 路径使用场景坐标，之前 refreshPath 平移过的偏移在这里归零
+    setPos(0, 0);
     setPath(path);
     
-    if (DEBUG_CONNECTION_PATH) {
-        qDebug() << "路径更新完成，起点:" << startPos << "终点:" << endPos;
+    if (DAGFLOW_DEBUG_ENABLED(lcConnection)) {
+        qCDebug(lcConnection) << "路径更新完成，起点:" << startPos << "终点:" << endPos;
+    }
+}
+
+/**
+ * @brief 按端点的当前位置刷新连接线
+ * 
+ * 比较端点新位置与当前路径起点、终点（场景坐标）的偏移：两者一致说明连线整体平移，
+ * 只需移动图形项，不必重建 QPainterPath；否则重新计算路径。
+ */
+void Connection::refreshPath()
+{
+    if (!m_fromNode || !m_toNode || path().isEmpty()) {
+        updatePath();
+        return;
+    }
+    
+    const QPointF startPos = m_fromNode->getOutputPortPos(m_fromPortIndex);
+    const QPointF endPos = m_toNode->getInputPortPos(m_toPortIndex);
+    const QPointF startDelta = startPos - mapToScene(QPointF(path().elementAt(0)));
+    const QPointF endDelta = endPos - mapToScene(path().currentPosition());
+    
+    if ((startDelta - endDelta).manhattanLength() > 1e-6) {
+        updatePath();
+    } else if (!startDelta.isNull()) {
+        DAGFLOW_TRACE("connection.translate", this, startDelta.x(), startDelta.y());
+        moveBy(startDelta.x(), startDelta.y());
+    }
+}
+
+/**
+ * @brief 绘制连接线
+ * @param painter 绘制器对象
+ * @param option 样式选项
+ * @param widget 父控件指针
+ */
+void Connection::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    if (lod >= Node::LOD_SIMPLE || path().isEmpty()) {
+        QGraphicsPathItem::paint(painter, option, widget);
+        return;
+    }
+    
+    // 低细节层次：直线代替曲线，装饰笔保持1像素宽，选中时改为白色
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(QPen(isSelected() ? QColor(Qt::white) : pen().color(), 0));
+    painter->drawLine(QPointF(path().elementAt(0)), path().currentPosition());
+}
+
+/**
+ * @brief 图形项属性变化事件处理
+ * @param change 变化类型
+ * @param value 新值
+ * @return 变化后的值
+ */
+QVariant Connection::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (change == ItemSceneChange) {
+        // 即将离开当前场景，从其待更新集合中移除
+        if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+            nodeScene->discardConnectionUpdate(this);
+        }
     }
+    return QGraphicsPathItem::itemChange(change, value);
 }
 
 /**
@@ -200,18 +321,18 @@ void Connection::updatePath()
  */
 void Connection::printStatus() const
 {
-    if (DEBUG_CONNECTION_PATH) {
-        qDebug() << "=== Connection状态 ===";
-        qDebug() << "源节点:" << (m_fromNode ? m_fromNode->getName() : "nullptr")
+    if (DAGFLOW_DEBUG_ENABLED(lcConnection)) {
+        qCDebug(lcConnection) << "=== Connection状态 ===";
+        qCDebug(lcConnection) << "源节点:" << (m_fromNode ? m_fromNode->getName() : "nullptr")
                  << "端口:" << m_fromPortIndex;
-        qDebug() << "目标节点:" << (m_toNode ? m_toNode->getName() : "nullptr")
+        qCDebug(lcConnection) << "目标节点:" << (m_toNode ? m_toNode->getName() : "nullptr")
                  << "端口:" << m_toPortIndex;
         if (m_fromNode && m_toNode) {
-            qDebug() << "当前起点:" << m_fromNode->getOutputPortPos(m_fromPortIndex);
-            qDebug() << "当前终点:" << m_toNode->getInputPortPos(m_toPortIndex);
+            qCDebug(lcConnection) << "当前起点:" << m_fromNode->getOutputPortPos(m_fromPortIndex);
+            qCDebug(lcConnection) << "当前终点:" << m_toNode->getInputPortPos(m_toPortIndex);
         }
-        qDebug() << "Z值:" << zValue();
-        qDebug() << "可见:" << isVisible();
+        qCDebug(lcConnection) << "Z值:" << zValue();
+        qCDebug(lcConnection) << "可见:" << isVisible();
     }
 }
 
@@ -222,9 +343,9 @@ void Connection::printStatus() const
 QJsonObject Connection::toJson() const
 {
     QJsonObject json;
-    // 使用节点指针作为唯一标识符
-    json["fromNode"] = QString::number(reinterpret_cast<quintptr>(m_fromNode));
-    json["toNode"] = QString::number(reinterpret_cast<quintptr>(m_toNode));
+    // 使用节点持久ID标识端点
+    json["fromNode"] = m_fromNode->idString();
+    json["toNode"] = m_toNode->idString();
     // 记录端口索引
     json["fromPortIndex"] = m_fromPortIndex;
     json["toPortIndex"] = m_toPortIndex;
@@ -15,9 +15,6 @@
 // 前向声明
 class Node;                            // 节点类
 
-// 调试开关：设置为true启用连接线调试输出
-static const bool DEBUG_CONNECTION_PATH = true;
-
 /**
  * @class Connection
  * @brief 连接线类，继承自QGraphicsPathItem
@@ -62,6 +59,18 @@ public:
      */
     Connection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex);
     
+    /**
+     * @brief 构造函数，批量导入时使用：只建立与节点的关联，不计算路径
+     * @param fromNode 源节点（输出端）
+     * @param fromPortIndex 源节点的输出端口索引
+     * @param toNode 目标节点（输入端）
+     * @param toPortIndex 目标节点的输入端口索引
+     * @param lineType 连线类型
+     * 
+     * 创建后需调用 updatePath 设置路径
+     */
+    Connection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex, LineType lineType);
+    
     /**
      * @brief 析构函数，清理相关资源
      */
@@ -99,6 +108,21 @@ public:
      */
     void updatePath();
     
+    /**
+     * @brief 按端点的当前位置刷新连接线
+     * 
+     * 两个端点的平移量相同（例如两端节点一起被拖动）时只平移图形项，
+     * 否则调用 updatePath 重新计算路径。由 NodeScene 在合并后的批量更新中调用。
+     */
+    void refreshPath();
+    
+    /**
+     * @brief 按性能报告设置连线粗细
+     * @param weight 传输数据量权重（0 ~ 1，按场景中数据量最大的连线归一化），小于0表示恢复默认样式
+     * @param critical 是否位于关键路径上
+     */
+    void setProfileWeight(qreal weight, bool critical);
+    
     /**
      * @brief 打印连接线状态信息（仅在调试模式下有效）
      */
@@ -110,11 +134,31 @@ public:
      */
     QJsonObject toJson() const;
     
+protected:
+    /**
+     * @brief 图形项属性变化事件处理
+     * @param change 变化类型
+     * @param value 新值
+     * @return 变化后的值
+     */
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+    
+    /**
+     * @brief 绘制连接线
+     * @param painter 绘制器对象
+     * @param option 样式选项
+     * @param widget 父控件指针
+     * 
+     * 缩放比例低于 Node::LOD_SIMPLE 时不使用抗锯齿，以1像素直线连接两个端点
+     */
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+    
 private:
     /**
      * @brief 初始化连接
+     * @param computePath 是否立即计算路径
      */
-    void initConnection();
+    void initConnection(bool computePath = true);
     
     Node *m_fromNode;       ///< 源节点指针
     Node *m_toNode;         ///< 目标节点指针
@@ -0,0 +1,520 @@
+/**
+ * @file DspKernels.h
+ * @brief 向量化信号处理内核库，由代码生成器嵌入到生成的C++代码中
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ *
+ * 该文件只依赖标准库和编译器内建指令集头文件，不依赖Qt。
+ * 内置节点类型对应的内核：
+ * - filter      : FirFilter   FIR滤波（保留跨块历史，支持流式处理）
+ * - fft         : Fft         基2迭代FFT
+ * - modulator   : Mixer       载波混频
+ * - demodulator : Demodulator 相干解调（混频 + 低通）
+ *
+ * 运行时根据CPU选择实现：x86上支持AVX2+FMA时使用AVX2，aarch64上使用NEON，
+ * 否则使用标量实现，因此同一个可执行文件可以在所有机器上运行。
+ */
+
+#ifndef DSPKERNELS_H
+#define DSPKERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DSP_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DSP_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang 需要按函数开启AVX2，MSVC 可以直接使用内建指令
+#if defined(DSP_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define DSP_KERNELS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define DSP_KERNELS_TARGET_AVX2
+#endif
+
+namespace dsp {
+
+typedef std::complex<double> Complex;
+
+namespace detail {
+
+/**
+ * @brief FIR内核：y[i] = sum(h[k] * x[i + k])，x 的长度为 count + tapCount - 1
+ */
+typedef void (*FirKernel)(const double *x, const double *h, std::size_t tapCount, double *y, std::size_t count);
+
+/**
+ * @brief 蝶形内核：t = b[j] * w[j]; b[j] = a[j] - t; a[j] = a[j] + t
+ */
+typedef void (*ButterflyKernel)(Complex *a, Complex *b, const Complex *w, std::size_t count);
+
+/**
+ * @brief 混频内核：y[i] = x[i] * Re(phasor * step^i)，返回后 phasor 推进 count 步
+ */
+typedef void (*MixKernel)(double *x, std::size_t count, Complex &phasor, Complex step);
+
+// ==================== 标量实现 ====================
+
+inline void firScalar(const double *x, const double *h, std::size_t tapCount, double *y, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        double acc = 0.0;
+        for (std::size_t k = 0; k < tapCount; ++k) {
+            acc += h[k] * x[i + k];
+        }
+        y[i] = acc;
+    }
+}
+
+inline void butterflyScalar(Complex *a, Complex *b, const Complex *w, std::size_t count)
+{
+    for (std::size_t j = 0; j < count; ++j) {
+        const Complex t = b[j] * w[j];
+        b[j] = a[j] - t;
+        a[j] = a[j] + t;
+    }
+}
+
+inline void mixScalar(double *x, std::size_t count, Complex &phasor, Complex step)
+{
+    Complex p = phasor;
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] *= p.real();
+        p *= step;
+    }
+    phasor = p;
+}
+
+// ==================== AVX2 实现 ====================
+
+#if defined(DSP_KERNELS_X86)
+
+DSP_KERNELS_TARGET_AVX2
+inline void firAvx2(const double *x, const double *h, std::size_t tapCount, double *y, std::size_t count)
+{
+    std::size_t i = 0;
+    // 每次计算8个输出，两个累加器隐藏FMA延迟
+    for (; i + 8 <= count; i += 8) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        for (std::size_t k = 0; k < tapCount; ++k) {
+            const __m256d tap = _mm256_broadcast_sd(h + k);
+            acc0 = _mm256_fmadd_pd(tap, _mm256_loadu_pd(x + i + k), acc0);
+            acc1 = _mm256_fmadd_pd(tap, _mm256_loadu_pd(x + i + k + 4), acc1);
+        }
+        _mm256_storeu_pd(y + i, acc0);
+        _mm256_storeu_pd(y + i + 4, acc1);
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m256d acc = _mm256_setzero_pd();
+        for (std::size_t k = 0; k < tapCount; ++k) {
+            acc = _mm256_fmadd_pd(_mm256_broadcast_sd(h + k), _mm256_loadu_pd(x + i + k), acc);
+        }
+        _mm256_storeu_pd(y + i, acc);
+    }
+    firScalar(x + i, h, tapCount, y + i, count - i);
+}
+
+DSP_KERNELS_TARGET_AVX2
+inline __m256d complexMulAvx2(__m256d a, __m256d w)
+{
+    // a = [ar0 ai0 ar1 ai1], w = [wr0 wi0 wr1 wi1]
+    const __m256d wr = _mm256_movedup_pd(w);        // [wr0 wr0 wr1 wr1]
+    const __m256d wi = _mm256_permute_pd(w, 0xF);   // [wi0 wi0 wi1 wi1]
+    const __m256d as = _mm256_permute_pd(a, 0x5);   // [ai0 ar0 ai1 ar1]
+    return _mm256_addsub_pd(_mm256_mul_pd(a, wr), _mm256_mul_pd(as, wi));
+}
+
+DSP_KERNELS_TARGET_AVX2
+inline void butterflyAvx2(Complex *a, Complex *b, const Complex *w, std::size_t count)
+{
+    std::size_t j = 0;
+    for (; j + 2 <= count; j += 2) {
+        double *pa = reinterpret_cast<double *>(a + j);
+        double *pb = reinterpret_cast<double *>(b + j);
+        const __m256d va = _mm256_loadu_pd(pa);
+        const __m256d t = complexMulAvx2(_mm256_loadu_pd(reinterpret_cast<double *>(b + j)),
+                                         _mm256_loadu_pd(reinterpret_cast<const double *>(w + j)));
+        _mm256_storeu_pd(pb, _mm256_sub_pd(va, t));
+        _mm256_storeu_pd(pa, _mm256_add_pd(va, t));
+    }
+    butterflyScalar(a + j, b + j, w + j, count - j);
+}
+
+DSP_KERNELS_TARGET_AVX2
+inline void mixAvx2(double *x, std::size_t count, Complex &phasor, Complex step)
+{
+    if (count < 8) {
+        mixScalar(x, count, phasor, step);
+        return;
+    }
+
+    // 4路相量依次相差一步，每次迭代整体旋转 step^4
+    const Complex p1 = phasor * step;
+    const Complex p2 = p1 * step;
+    const Complex p3 = p2 * step;
+    const Complex step2 = step * step;
+    const Complex step4 = step2 * step2;
+    __m256d pr = _mm256_setr_pd(phasor.real(), p1.real(), p2.real(), p3.real());
+    __m256d pi = _mm256_setr_pd(phasor.imag(), p1.imag(), p2.imag(), p3.imag());
+    const __m256d sr = _mm256_set1_pd(step4.real());
+    const __m256d si = _mm256_set1_pd(step4.imag());
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), pr));
+        const __m256d nr = _mm256_fmsub_pd(pr, sr, _mm256_mul_pd(pi, si));
+        const __m256d ni = _mm256_fmadd_pd(pr, si, _mm256_mul_pd(pi, sr));
+        pr = nr;
+        pi = ni;
+    }
+
+    double lr[4];
+    double li[4];
+    _mm256_storeu_pd(lr, pr);
+    _mm256_storeu_pd(li, pi);
+    Complex p(lr[0], li[0]);
+    mixScalar(x + i, count - i, p, step);
+    phasor = p;
+}
+
+#endif // DSP_KERNELS_X86
+
+// ==================== NEON 实现 ====================
+
+#if defined(DSP_KERNELS_NEON)
+
+inline void firNeon(const double *x, const double *h, std::size_t tapCount, double *y, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float64x2_t acc0 = vdupq_n_f64(0.0);
+        float64x2_t acc1 = vdupq_n_f64(0.0);
+        for (std::size_t k = 0; k < tapCount; ++k) {
+            const float64x2_t tap = vdupq_n_f64(h[k]);
+            acc0 = vfmaq_f64(acc0, vld1q_f64(x + i + k), tap);
+            acc1 = vfmaq_f64(acc1, vld1q_f64(x + i + k + 2), tap);
+        }
+        vst1q_f64(y + i, acc0);
+        vst1q_f64(y + i + 2, acc1);
+    }
+    firScalar(x + i, h, tapCount, y + i, count - i);
+}
+
+inline void butterflyNeon(Complex *a, Complex *b, const Complex *w, std::size_t count)
+{
+    const double signs[2] = {-1.0, 1.0};
+    const float64x2_t sign = vld1q_f64(signs);
+    for (std::size_t j = 0; j < count; ++j) {
+        double *pa = reinterpret_cast<double *>(a + j);
+        double *pb = reinterpret_cast<double *>(b + j);
+        const float64x2_t va = vld1q_f64(pa);
+        const float64x2_t vb = vld1q_f64(pb);
+        const float64x2_t vw = vld1q_f64(reinterpret_cast<const double *>(w + j));
+        // t = [br*wr - bi*wi, bi*wr + br*wi]
+        const float64x2_t t1 = vmulq_laneq_f64(vb, vw, 0);
+        const float64x2_t t2 = vmulq_laneq_f64(vextq_f64(vb, vb, 1), vw, 1);
+        const float64x2_t t = vfmaq_f64(t1, t2, sign);
+        vst1q_f64(pb, vsubq_f64(va, t));
+        vst1q_f64(pa, vaddq_f64(va, t));
+    }
+}
+
+inline void mixNeon(double *x, std::size_t count, Complex &phasor, Complex step)
+{
+    if (count < 4) {
+        mixScalar(x, count, phasor, step);
+        return;
+    }
+
+    // 2路相量依次相差一步，每次迭代整体旋转 step^2
+    const Complex p1 = phasor * step;
+    const Complex step2 = step * step;
+    const double initialReal[2] = {phasor.real(), p1.real()};
+    const double initialImag[2] = {phasor.imag(), p1.imag()};
+    float64x2_t pr = vld1q_f64(initialReal);
+    float64x2_t pi = vld1q_f64(initialImag);
+    const float64x2_t sr = vdupq_n_f64(step2.real());
+    const float64x2_t si = vdupq_n_f64(step2.imag());
+
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        vst1q_f64(x + i, vmulq_f64(vld1q_f64(x + i), pr));
+        const float64x2_t nr = vfmsq_f64(vmulq_f64(pr, sr), pi, si);
+        const float64x2_t ni = vfmaq_f64(vmulq_f64(pr, si), pi, sr);
+        pr = nr;
+        pi = ni;
+    }
+
+    Complex p(vgetq_lane_f64(pr, 0), vgetq_lane_f64(pi, 0));
+    mixScalar(x + i, count - i, p, step);
+    phasor = p;
+}
+
+#endif // DSP_KERNELS_NEON
+
+// ==================== 运行时分派 ====================
+
+/**
+ * @brief 检测CPU是否支持AVX2和FMA
+ */
+inline bool cpuHasAvx2()
+{
+#if defined(DSP_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(DSP_KERNELS_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief 当前CPU使用的内核函数表
+ */
+struct KernelTable {
+    FirKernel fir;
+    ButterflyKernel butterfly;
+    MixKernel mix;
+    const char *name;
+};
+
+inline KernelTable selectKernels()
+{
+#if defined(DSP_KERNELS_X86)
+    if (cpuHasAvx2()) {
+        return KernelTable{firAvx2, butterflyAvx2, mixAvx2, "avx2"};
+    }
+#elif defined(DSP_KERNELS_NEON)
+    return KernelTable{firNeon, butterflyNeon, mixNeon, "neon"};
+#endif
+    return KernelTable{firScalar, butterflyScalar, mixScalar, "scalar"};
+}
+
+inline const KernelTable &kernels()
+{
+    static const KernelTable table = selectKernels();
+    return table;
+}
+
+} // namespace detail
+
+/**
+ * @brief 获取当前使用的指令集名称（avx2 / neon / scalar）
+ */
+inline const char *kernelIsa()
+{
+    return detail::kernels().name;
+}
+
+/**
+ * @brief 生成汉明窗加窗的sinc低通滤波器系数
+ * @param tapCount 系数个数
+ * @param cutoff 截止频率（相对采样率，0 ~ 0.5）
+ * @param gain 通带增益
+ */
+inline std::vector<double> lowpassTaps(std::size_t tapCount, double cutoff, double gain = 1.0)
+{
+    const double pi = 3.14159265358979323846;
+    tapCount = std::max<std::size_t>(tapCount, 1);
+    cutoff = std::min(std::max(cutoff, 1e-6), 0.5);
+
+    std::vector<double> taps(tapCount);
+    const double center = 0.5 * static_cast<double>(tapCount - 1);
+    double sum = 0.0;
+    for (std::size_t k = 0; k < tapCount; ++k) {
+        const double n = static_cast<double>(k) - center;
+        const double sinc = n == 0.0 ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * n) / (pi * n);
+        const double window = tapCount == 1 ? 1.0 : 0.54 - 0.46 * std::cos(2.0 * pi * k / (tapCount - 1));
+        taps[k] = sinc * window;
+        sum += taps[k];
+    }
+    for (double &tap : taps) {
+        tap *= gain / sum;
+    }
+    return taps;
+}
+
+/**
+ * @class FirFilter
+ * @brief FIR滤波器，原地处理并在调用之间保留延迟线，适合分块流式处理
+ */
+class FirFilter
+{
+public:
+    explicit FirFilter(const std::vector<double> &taps)
+        : m_reversed(taps.rbegin(), taps.rend())
+        , m_history(taps.empty() ? 0 : taps.size() - 1, 0.0)
+    {
+    }
+
+    void process(std::vector<double> &signal)
+    {
+        if (m_reversed.empty() || signal.empty()) {
+            return;
+        }
+        const std::size_t historyLength = m_history.size();
+        m_scratch.resize(historyLength + signal.size());
+        std::copy(m_history.begin(), m_history.end(), m_scratch.begin());
+        std::copy(signal.begin(), signal.end(), m_scratch.begin() + historyLength);
+
+        detail::kernels().fir(m_scratch.data(), m_reversed.data(), m_reversed.size(),
+                              signal.data(), signal.size());
+
+        std::copy(m_scratch.end() - historyLength, m_scratch.end(), m_history.begin());
+    }
+
+    void reset()
+    {
+        std::fill(m_history.begin(), m_history.end(), 0.0);
+    }
+
+private:
+    std::vector<double> m_reversed; // 逆序系数，内核按正序访问输入
+    std::vector<double> m_history;  // 上一块末尾的 tapCount - 1 个输入
+    std::vector<double> m_scratch;  // 历史 + 当前块，只在块变大时重新分配
+};
+
+/**
+ * @class Fft
+ * @brief 基2迭代FFT，按长度缓存位反转表和每一级连续存放的旋转因子
+ */
+class Fft
+{
+public:
+    /**
+     * @brief 计算实信号的频谱，长度不足2的幂时补零
+     */
+    void forward(const std::vector<double> &input, std::vector<Complex> &spectrum)
+    {
+        std::size_t size = 1;
+        while (size < input.size()) {
+            size <<= 1;
+        }
+        prepare(size);
+
+        spectrum.assign(size, Complex(0.0, 0.0));
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            spectrum[m_bitReverse[i]] = Complex(input[i], 0.0);
+        }
+
+        const detail::ButterflyKernel butterfly = detail::kernels().butterfly;
+        const Complex *twiddles = m_twiddles.data();
+        for (std::size_t half = 1; half < size; half <<= 1) {
+            for (std::size_t start = 0; start < size; start += 2 * half) {
+                butterfly(&spectrum[start], &spectrum[start + half], twiddles, half);
+            }
+            twiddles += half;
+        }
+    }
+
+private:
+    void prepare(std::size_t size)
+    {
+        if (size == m_size) {
+            return;
+        }
+        m_size = size;
+
+        unsigned bits = 0;
+        while ((std::size_t(1) << bits) < size) {
+            ++bits;
+        }
+        m_bitReverse.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            std::size_t reversed = 0;
+            for (unsigned b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            m_bitReverse[i] = reversed;
+        }
+
+        const double pi = 3.14159265358979323846;
+        m_twiddles.clear();
+        for (std::size_t half = 1; half < size; half <<= 1) {
+            for (std::size_t j = 0; j < half; ++j) {
+                m_twiddles.push_back(std::polar(1.0, -pi * static_cast<double>(j) / static_cast<double>(half)));
+            }
+        }
+    }
+
+    std::size_t m_size = 0;
+    std::vector<std::size_t> m_bitReverse;
+    std::vector<Complex> m_twiddles;
+};
+
+/**
+ * @class Mixer
+ * @brief 载波混频器：x[n] *= cos(2π f n + φ)，相位在调用之间连续
+ */
+class Mixer
+{
+public:
+    /**
+     * @param frequency 载波频率（相对采样率）
+     * @param phase 初始相位（弧度）
+     */
+    explicit Mixer(double frequency, double phase = 0.0)
+        : m_phasor(std::polar(1.0, phase))
+        , m_step(std::polar(1.0, 2.0 * 3.14159265358979323846 * frequency))
+    {
+    }
+
+    void process(std::vector<double> &signal)
+    {
+        detail::kernels().mix(signal.data(), signal.size(), m_phasor, m_step);
+        m_phasor /= std::abs(m_phasor); // 消除递推累积的幅度误差
+    }
+
+private:
+    Complex m_phasor;
+    Complex m_step;
+};
+
+/**
+ * @class Demodulator
+ * @brief 相干解调器：与本地载波混频后低通滤除倍频分量
+ */
+class Demodulator
+{
+public:
+    Demodulator(double frequency, std::size_t tapCount, double cutoff)
+        : m_mixer(frequency)
+        , m_lowpass(lowpassTaps(tapCount, cutoff, 2.0))
+    {
+    }
+
+    void process(std::vector<double> &signal)
+    {
+        m_mixer.process(signal);
+        m_lowpass.process(signal);
+    }
+
+private:
+    Mixer m_mixer;
+    FirFilter m_lowpass;
+};
+
+} // namespace dsp
+
+#endif // DSPKERNELS_H
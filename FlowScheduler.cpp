@@ -0,0 +1,310 @@
+/**
+ * @file FlowScheduler.cpp
+ * @brief 流程调度器类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "FlowScheduler.h"
+#include <algorithm>
+
+/**
+ * @brief 构造函数，根据依赖关系图构建邻接表并完成调度
+ * @param dependencies 依赖关系图
+ *
+ * 依赖列表中出现但不是键的节点ID（例如指向已删除节点的连接）也会被分配索引，
+ * 这样它们不会让下游节点因入度永远不为0而被静默丢弃。
+ */
+FlowScheduler::FlowScheduler(const QMap<QString, QStringList> &dependencies)
+{
+    // 收集所有节点ID并按字典序分配索引
+    m_nodeIds = dependencies.keys();
+    QStringList danglingIds;
+    for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
+        for (const QString &dep : it.value()) {
+            if (!dependencies.contains(dep)) {
+                danglingIds.append(dep);
+            }
+        }
+    }
+    if (!danglingIds.isEmpty()) {
+        m_nodeIds.append(danglingIds);
+        std::sort(m_nodeIds.begin(), m_nodeIds.end());
+        m_nodeIds.erase(std::unique(m_nodeIds.begin(), m_nodeIds.end()), m_nodeIds.end());
+    }
+
+    const int count = m_nodeIds.size();
+    m_indexById.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        m_indexById.insert(m_nodeIds.at(i), i);
+    }
+
+    // 构建邻接表（每条连接对应一条边，重复连接不会导致入度计算错误）
+    m_predecessors.resize(count);
+    m_successors.resize(count);
+    for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
+        const int to = m_indexById.value(it.key());
+        for (const QString &dep : it.value()) {
+            const int from = m_indexById.value(dep);
+            m_predecessors[to].append(from);
+            m_successors[from].append(to);
+        }
+    }
+
+    schedule();
+    isolateCycles();
+}
+
+/**
+ * @brief 执行Kahn拓扑排序
+ *
+ * 使用数组加头指针实现队列，避免 QList::takeFirst 的移动开销，整体复杂度O(V+E)。
+ * 排序过程中顺带计算每个节点的依赖层级。
+ */
+void FlowScheduler::schedule()
+{
+    const int count = m_nodeIds.size();
+    QVector<int> inDegree(count);
+    for (int i = 0; i < count; ++i) {
+        inDegree[i] = m_predecessors.at(i).size();
+    }
+
+    m_order.clear();
+    m_order.reserve(count);
+    m_levelOf.fill(0, count);
+
+    // 找到所有入度为0的节点
+    for (int i = 0; i < count; ++i) {
+        if (inDegree.at(i) == 0) {
+            m_order.append(i);
+        }
+    }
+
+    // m_order 同时作为队列使用
+    for (int head = 0; head < m_order.size(); ++head) {
+        const int current = m_order.at(head);
+        for (int next : m_successors.at(current)) {
+            m_levelOf[next] = qMax(m_levelOf.at(next), m_levelOf.at(current) + 1);
+            if (--inDegree[next] == 0) {
+                m_order.append(next);
+            }
+        }
+    }
+
+    // 按层级分组（拓扑序保证层内节点仍按执行顺序排列）
+    m_levels.clear();
+    for (int index : m_order) {
+        const int level = m_levelOf.at(index);
+        if (level >= m_levels.size()) {
+            m_levels.resize(level + 1);
+        }
+        m_levels[level].append(index);
+    }
+
+    // 无法调度的节点没有有效层级
+    for (int i = 0; i < count; ++i) {
+        if (inDegree.at(i) > 0) {
+            m_levelOf[i] = -1;
+        }
+    }
+}
+
+/**
+ * @brief 获取最宽一层的节点数
+ */
+int FlowScheduler::maxLevelWidth() const
+{
+    int width = 0;
+    for (const QVector<int> &level : m_levels) {
+        width = qMax(width, level.size());
+    }
+    return width;
+}
+
+/**
+ * @brief 在未调度的节点中找出真正位于循环上的节点
+ *
+ * 对未调度节点构成的子图运行迭代版Tarjan强连通分量算法，
+ * 大小大于1或带自环的分量即为循环。
+ */
+void FlowScheduler::isolateCycles()
+{
+    const int count = m_nodeIds.size();
+    m_cycleComponent.fill(-1, count);
+    if (!hasCycle()) {
+        return;
+    }
+
+    QVector<bool> scheduled(count, false);
+    for (int index : m_order) {
+        scheduled[index] = true;
+    }
+
+    QVector<int> order(count, -1);   // 访问序号
+    QVector<int> low(count, 0);      // 可回溯到的最小序号
+    QVector<bool> onStack(count, false);
+    QVector<int> stack;
+    int counter = 0;
+    int componentId = 0;
+
+    struct Frame {
+        int node;
+        int edge;
+    };
+    QVector<Frame> frames;
+
+    for (int root = 0; root < count; ++root) {
+        if (scheduled.at(root) || order.at(root) != -1) {
+            continue;
+        }
+
+        order[root] = low[root] = counter++;
+        stack.append(root);
+        onStack[root] = true;
+        frames.append(Frame{root, 0});
+
+        while (!frames.isEmpty()) {
+            const int u = frames.last().node;
+            const QVector<int> &succ = m_successors.at(u);
+
+            if (frames.last().edge < succ.size()) {
+                const int w = succ.at(frames.last().edge++);
+                if (scheduled.at(w)) {
+                    continue;
+                }
+                if (order.at(w) == -1) {
+                    order[w] = low[w] = counter++;
+                    stack.append(w);
+                    onStack[w] = true;
+                    frames.append(Frame{w, 0});
+                } else if (onStack.at(w)) {
+                    low[u] = qMin(low.at(u), order.at(w));
+                }
+                continue;
+            }
+
+            frames.removeLast();
+            if (!frames.isEmpty()) {
+                const int parent = frames.last().node;
+                low[parent] = qMin(low.at(parent), low.at(u));
+            }
+
+            if (low.at(u) == order.at(u)) {
+                // 弹出一个强连通分量
+                QVector<int> component;
+                int w;
+                do {
+                    w = stack.takeLast();
+                    onStack[w] = false;
+                    component.append(w);
+                } while (w != u);
+
+                const bool selfLoop = m_successors.at(u).contains(u);
+                if (component.size() > 1 || selfLoop) {
+                    for (int member : component) {
+                        m_cycleComponent[member] = componentId;
+                    }
+                    ++componentId;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 获取按执行顺序排列的节点ID
+ */
+QStringList FlowScheduler::executionOrder() const
+{
+    QStringList result;
+    result.reserve(m_order.size());
+    for (int index : m_order) {
+        result.append(m_nodeIds.at(index));
+    }
+    return result;
+}
+
+/**
+ * @brief 获取参与循环的节点ID
+ */
+QStringList FlowScheduler::cycleNodes() const
+{
+    QStringList result;
+    for (int i = 0; i < m_cycleComponent.size(); ++i) {
+        if (m_cycleComponent.at(i) >= 0) {
+            result.append(m_nodeIds.at(i));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 获取因循环而无法调度的全部节点ID
+ */
+QStringList FlowScheduler::unscheduledNodes() const
+{
+    QVector<bool> scheduled(m_nodeIds.size(), false);
+    for (int index : m_order) {
+        scheduled[index] = true;
+    }
+
+    QStringList result;
+    for (int i = 0; i < scheduled.size(); ++i) {
+        if (!scheduled.at(i)) {
+            result.append(m_nodeIds.at(i));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 给出一条具体的循环路径
+ *
+ * 从第一个位于循环上的节点出发，在同一强连通分量内广度优先搜索回到起点的最短路径
+ */
+QString FlowScheduler::describeCycle() const
+{
+    int start = -1;
+    for (int i = 0; i < m_cycleComponent.size(); ++i) {
+        if (m_cycleComponent.at(i) >= 0) {
+            start = i;
+            break;
+        }
+    }
+    if (start < 0) {
+        return QString();
+    }
+
+    const int component = m_cycleComponent.at(start);
+    QVector<int> parent(m_nodeIds.size(), -1);
+    QVector<int> queue;
+    queue.append(start);
+    int last = -1;
+
+    for (int head = 0; head < queue.size() && last < 0; ++head) {
+        const int u = queue.at(head);
+        for (int w : m_successors.at(u)) {
+            if (m_cycleComponent.at(w) != component) {
+                continue;
+            }
+            if (w == start) {
+                last = u;
+                break;
+            }
+            if (parent.at(w) == -1) {
+                parent[w] = u;
+                queue.append(w);
+            }
+        }
+    }
+
+    // 从终点回溯到起点，得到 start -> ... -> last 的路径
+    QStringList path;
+    for (int v = last; v != start && v >= 0; v = parent.at(v)) {
+        path.prepend(m_nodeIds.at(v));
+    }
+    path.prepend(m_nodeIds.at(start));
+    path.append(m_nodeIds.at(start));
+    return path.join(" -> ");
+}
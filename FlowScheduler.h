@@ -0,0 +1,153 @@
+/**
+ * @file FlowScheduler.h
+ * @brief 流程调度器类头文件，负责节点依赖图的拓扑排序和循环检测
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef FLOWSCHEDULER_H
+#define FLOWSCHEDULER_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QHash>
+#include <QVector>
+
+/**
+ * @class FlowScheduler
+ * @brief 流程调度器类
+ *
+ * 该类由 CodeGenerator::analyzeDependencies 的结果一次性构建整数索引的邻接表，
+ * 供C++、Python和YAML生成器共享：
+ * - 使用Kahn算法在O(V+E)时间内生成执行顺序
+ * - 按依赖层级划分可并行执行的节点组
+ * - 检测循环依赖并给出参与循环的节点
+ * - 提供按索引访问前驱/后继节点的接口
+ *
+ * 节点索引按节点ID的字典序分配，因此无循环时的执行顺序与旧实现保持一致。
+ */
+class FlowScheduler
+{
+public:
+    /**
+     * @brief 构造函数，根据依赖关系图构建邻接表并完成调度
+     * @param dependencies 依赖关系图（节点ID -> 该节点依赖的节点ID列表）
+     */
+    explicit FlowScheduler(const QMap<QString, QStringList> &dependencies);
+
+    /**
+     * @brief 获取节点数量
+     * @return 参与调度的节点数量
+     */
+    int nodeCount() const { return m_nodeIds.size(); }
+
+    /**
+     * @brief 根据节点ID获取索引
+     * @param nodeId 节点ID
+     * @return 节点索引，不存在返回-1
+     */
+    int indexOf(const QString &nodeId) const { return m_indexById.value(nodeId, -1); }
+
+    /**
+     * @brief 根据索引获取节点ID
+     * @param index 节点索引
+     * @return 节点ID
+     */
+    QString nodeId(int index) const { return m_nodeIds.at(index); }
+
+    /**
+     * @brief 获取节点的前驱（依赖的节点），每条连接对应一项
+     * @param index 节点索引
+     * @return 前驱节点索引列表
+     */
+    const QVector<int>& predecessors(int index) const { return m_predecessors.at(index); }
+
+    /**
+     * @brief 获取节点的后继（依赖该节点的节点），每条连接对应一项
+     * @param index 节点索引
+     * @return 后继节点索引列表
+     */
+    const QVector<int>& successors(int index) const { return m_successors.at(index); }
+
+    /**
+     * @brief 获取按执行顺序排列的节点索引
+     * @return 节点索引列表（存在循环时不包含无法调度的节点）
+     */
+    const QVector<int>& orderIndices() const { return m_order; }
+
+    /**
+     * @brief 获取按执行顺序排列的节点ID
+     * @return 节点ID列表（存在循环时不包含无法调度的节点）
+     */
+    QStringList executionOrder() const;
+
+    /**
+     * @brief 获取依赖层级（波前）划分
+     * @return 每一层的节点索引列表，同一层内的节点互不依赖，可以并行执行
+     *
+     * 第0层为所有入口节点，其余节点所在层为其所有前驱层级的最大值加1，
+     * 因此层数即关键路径上的节点数。
+     */
+    const QVector<QVector<int>>& levels() const { return m_levels; }
+
+    /**
+     * @brief 获取节点所在的层级
+     * @param index 节点索引
+     * @return 层级编号，无法调度的节点返回-1
+     */
+    int levelOf(int index) const { return m_levelOf.at(index); }
+
+    /**
+     * @brief 获取最宽一层的节点数，即可利用的最大并行度
+     * @return 最大层宽度
+     */
+    int maxLevelWidth() const;
+
+    /**
+     * @brief 是否存在循环依赖
+     * @return 存在循环返回true
+     */
+    bool hasCycle() const { return m_order.size() < m_nodeIds.size(); }
+
+    /**
+     * @brief 获取参与循环的节点ID
+     * @return 位于循环上的节点ID列表（不含仅位于循环下游的节点）
+     */
+    QStringList cycleNodes() const;
+
+    /**
+     * @brief 获取因循环而无法调度的全部节点ID（包括循环下游的节点）
+     * @return 未进入执行顺序的节点ID列表
+     */
+    QStringList unscheduledNodes() const;
+
+    /**
+     * @brief 给出一条具体的循环路径，用于错误提示
+     * @return 形如 "A -> B -> C -> A" 的字符串，无循环时返回空字符串
+     */
+    QString describeCycle() const;
+
+private:
+    /**
+     * @brief 执行Kahn拓扑排序
+     */
+    void schedule();
+
+    /**
+     * @brief 在未调度的节点中找出真正位于循环上的节点
+     */
+    void isolateCycles();
+
+    QStringList m_nodeIds;                  ///< 索引 -> 节点ID
+    QHash<QString, int> m_indexById;        ///< 节点ID -> 索引
+    QVector<QVector<int>> m_predecessors;   ///< 前驱邻接表
+    QVector<QVector<int>> m_successors;     ///< 后继邻接表
+    QVector<int> m_order;                   ///< 拓扑序（节点索引）
+    QVector<int> m_levelOf;                 ///< 节点所在层级
+    QVector<QVector<int>> m_levels;         ///< 按层级分组的节点索引
+    QVector<int> m_cycleComponent;          ///< 节点所在循环的强连通分量编号，不在循环上为-1
+};
+
+#endif // FLOWSCHEDULER_H
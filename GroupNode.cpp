@@ -13,10 +13,12 @@
 #include <QRadialGradient>
 #include <QFontMetrics>
 #include <QSet>
+#include <QHash>
 
 GroupNode::GroupNode(const QString &name, const QPointF &position)
     : Node("group", name, position)
     , m_groupLevel(1)  // 默认1级
+    , m_deferredNodeCount(0)
 {
     // 设置组节点特有的颜色
     setCustomColor(QColor(100, 149, 237));  // 康乃馨蓝
@@ -36,6 +38,12 @@ void GroupNode::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     // 先调用基类绘制（基类会调用虚函数 drawPorts，自动调用 GroupNode::drawPorts）
     Node::paint(painter, option, widget);
     
+    // 组标识（虚线边框和图标）属于完整绘制层级：低于 LOD_SIMPLE 时基类已绘制为纯色矩形，
+    // 与普通节点一样不再绘制装饰（内部节点已移出场景，整个组只占一个图形项）
+    if (levelOfDetail(option, painter) < LOD_SIMPLE) {
+        return;
+    }
+    
     // 在节点上绘制组标识（双层边框效果）
     painter->setRenderHint(QPainter::Antialiasing);
     
@@ -111,16 +119,12 @@ void GroupNode::drawPorts(QPainter *painter)
     labelFont.setBold(true);
     painter->setFont(labelFont);
     
-    // 计算输入端口数量
-    int inputCount = m_inputPortMappings.size();
-    if (inputCount == 0) inputCount = 1;  // 至少显示一个端口
-    
-    // 计算输出端口数量
-    int outputCount = m_outputPortMappings.size();
-    if (outputCount == 0) outputCount = 1;
+    // 内部子图延迟加载时使用文件中保存的标签，绘制不触发加载
+    const QStringList inputLabels = inputPortLabels();
+    const QStringList outputLabels = outputPortLabels();
     
     // 绘制输入端口及标签
-    for (int i = 0; i < m_inputPortMappings.size(); ++i) {
+    for (int i = 0; i < inputLabels.size(); ++i) {
         // 使用与 Node::getInputPortPos 相同的计算方式
         QPointF portPos = getInputPortPos(i);
         QPointF portCenter = portPos - pos();  // 转换为本地坐标
@@ -135,7 +139,7 @@ void GroupNode::drawPorts(QPainter *painter)
         painter->drawEllipse(portCenter, PORT_RADIUS, PORT_RADIUS);
         
         // 绘制端口来源标签（在端口右侧，带背景框）
-        QString label = m_inputPortMappings[i].portLabel;
+        QString label = inputLabels[i];
         QFontMetrics fm(labelFont);
         int textWidth = fm.horizontalAdvance(label) + 6;
         int textHeight = fm.height() + 2;
@@ -155,7 +159,7 @@ void GroupNode::drawPorts(QPainter *painter)
     }
     
     // 绘制输出端口及标签
-    for (int i = 0; i < m_outputPortMappings.size(); ++i) {
+    for (int i = 0; i < outputLabels.size(); ++i) {
         // 使用与 Node::getOutputPortPos 相同的计算方式
         QPointF portPos = getOutputPortPos(i);
         QPointF portCenter = portPos - pos();  // 转换为本地坐标
@@ -170,7 +174,7 @@ void GroupNode::drawPorts(QPainter *painter)
         painter->drawEllipse(portCenter, PORT_RADIUS, PORT_RADIUS);
         
         // 绘制端口来源标签（在端口左侧，带背景框）
-        QString label = m_outputPortMappings[i].portLabel;
+        QString label = outputLabels[i];
         QFontMetrics fm(labelFont);
         int textWidth = fm.horizontalAdvance(label) + 6;
         int textHeight = fm.height() + 2;
@@ -194,6 +198,7 @@ void GroupNode::drawPorts(QPainter *painter)
 
 void GroupNode::setInternalNodes(const QList<Node*> &nodes)
 {
+    m_interiorLoader = nullptr;  // 显式设置的内部子图优先于尚未加载的数据
     m_internalNodes = nodes;
 }
 
@@ -223,22 +228,15 @@ void GroupNode::calculatePortMappings()
         internalNodeSet.insert(node);
     }
     
-    // 记录已经有连接的端口（内部连接）
-    // key: (node, portIndex, isInput)
-    QSet<QString> connectedPorts;
+    // 记录已经有连接的端口（内部连接），key: (节点ID, 端口索引)
+    using PortKey = QPair<quint64, int>;
+    QSet<PortKey> connectedInputs;
+    QSet<PortKey> connectedOutputs;
     
-    // 遍历内部连接，标记已连接的端口
+    // 遍历内部连接，标记输出端口和输入端口为已连接
     for (Connection *conn : m_internalConnections) {
-        Node *fromNode = conn->getFromNode();
-        Node *toNode = conn->getToNode();
-        int fromPort = conn->getFromPortIndex();
-        int toPort = conn->getToPortIndex();
-        
-        // 标记输出端口和输入端口为已连接
-        QString fromKey = QString("%1_%2_out").arg(reinterpret_cast<quintptr>(fromNode)).arg(fromPort);
-        QString toKey = QString("%1_%2_in").arg(reinterpret_cast<quintptr>(toNode)).arg(toPort);
-        connectedPorts.insert(fromKey);
-        connectedPorts.insert(toKey);
+        connectedOutputs.insert(PortKey(conn->getFromNode()->getId(), conn->getFromPortIndex()));
+        connectedInputs.insert(PortKey(conn->getToNode()->getId(), conn->getToPortIndex()));
     }
     
     // 遍历外部连接，添加到端口映射并标记
@@ -251,25 +249,21 @@ void GroupNode::calculatePortMappings()
                                               .arg(extConn.internalPortIndex);
         
         // 标记端口为已连接
-        QString key;
+        const PortKey key(extConn.internalNode->getId(), extConn.internalPortIndex);
         if (extConn.isInput) {
-            key = QString("%1_%2_in").arg(reinterpret_cast<quintptr>(extConn.internalNode))
-                                     .arg(extConn.internalPortIndex);
+            connectedInputs.insert(key);
             m_inputPortMappings.append(mapping);
         } else {
-            key = QString("%1_%2_out").arg(reinterpret_cast<quintptr>(extConn.internalNode))
-                                      .arg(extConn.internalPortIndex);
+            connectedOutputs.insert(key);
             m_outputPortMappings.append(mapping);
         }
-        connectedPorts.insert(key);
     }
     
     // 遍历所有内部节点，找出完全悬空的端口（没有任何连接）
     for (Node *node : m_internalNodes) {
         // 检查输入端口
         for (int i = 0; i < node->getInputPortCount(); ++i) {
-            QString key = QString("%1_%2_in").arg(reinterpret_cast<quintptr>(node)).arg(i);
-            if (!connectedPorts.contains(key)) {
+            if (!connectedInputs.contains(PortKey(node->getId(), i))) {
                 // 这是一个悬空的输入端口
                 PortMapping mapping;
                 mapping.internalNode = node;
@@ -282,8 +276,7 @@ void GroupNode::calculatePortMappings()
         
         // 检查输出端口
         for (int i = 0; i < node->getOutputPortCount(); ++i) {
-            QString key = QString("%1_%2_out").arg(reinterpret_cast<quintptr>(node)).arg(i);
-            if (!connectedPorts.contains(key)) {
+            if (!connectedOutputs.contains(PortKey(node->getId(), i))) {
                 // 这是一个悬空的输出端口
                 PortMapping mapping;
                 mapping.internalNode = node;
@@ -295,9 +288,19 @@ void GroupNode::calculatePortMappings()
         }
     }
     
-    // 更新端口数量
-    int inputCount = qMax(1, m_inputPortMappings.size());
-    int outputCount = qMax(1, m_outputPortMappings.size());
+    updatePortLayout(m_inputPortMappings.size(), m_outputPortMappings.size());
+}
+
+/**
+ * @brief 按端口数量设置组节点的端口和尺寸
+ * @param inputCount 输入端口映射数量
+ * @param outputCount 输出端口映射数量
+ */
+void GroupNode::updatePortLayout(int inputCount, int outputCount)
+{
+    // 更新端口数量（至少一个）
+    inputCount = qMax(1, inputCount);
+    outputCount = qMax(1, outputCount);
     setInputPortCount(inputCount);
     setOutputPortCount(outputCount);
     
@@ -316,8 +319,136 @@ void GroupNode::calculatePortMappings()
     }
 }
 
+/**
+ * @brief 从JSON恢复内部子图（内部节点、内部连接和原始位置）并计算端口映射
+ * @param json 包含 internalNodes、internalConnections 和 originalPositions 的JSON对象
+ */
+void GroupNode::restoreInterior(const QJsonObject &json)
+{
+    // 恢复内部节点
+    QJsonArray internalNodesArray = json["internalNodes"].toArray();
+    QList<Node*> internalNodes;
+    QHash<QString, Node*> internalNodeById;    // 内部连接按节点ID引用端点
+    QHash<QString, Node*> internalNodeByName;  // 原始位置按名称引用节点
+    
+    for (const QJsonValue &internalValue : internalNodesArray) {
+        QJsonObject internalObj = internalValue.toObject();
+        Node *internalNode = Node::fromJson(internalObj);
+        internalNode->setId(Node::idFromString(internalObj["id"].toString()));
+        internalNodes.append(internalNode);
+        internalNodeById[internalObj["id"].toString()] = internalNode;
+        internalNodeByName[internalObj["name"].toString()] = internalNode;
+        // 内部节点不添加到场景，只保存在组节点中
+    }
+    setInternalNodes(internalNodes);
+    
+    // 恢复内部连接
+    QJsonArray internalConnsArray = json["internalConnections"].toArray();
+    QList<Connection*> internalConnections;
+    
+    for (const QJsonValue &connValue : internalConnsArray) {
+        QJsonObject connObj = connValue.toObject();
+        Node *fromNode = internalNodeById.value(connObj["fromNode"].toString());
+        Node *toNode = internalNodeById.value(connObj["toNode"].toString());
+        
+        if (fromNode && toNode) {
+            int fromPort = connObj.contains("fromPortIndex") ?
+                connObj["fromPortIndex"].toInt(0) : connObj["fromPort"].toInt(0);
+            int toPort = connObj.contains("toPortIndex") ?
+                connObj["toPortIndex"].toInt(0) : connObj["toPort"].toInt(0);
+            Connection *conn = new Connection(fromNode, fromPort, toNode, toPort);
+            internalConnections.append(conn);
+        }
+    }
+    setInternalConnections(internalConnections);
+    
+    // 恢复原始位置
+    QJsonArray origPosArray = json["originalPositions"].toArray();
+    QMap<Node*, QPointF> originalPositions;
+    for (const QJsonValue &posValue : origPosArray) {
+        QJsonObject posObj = posValue.toObject();
+        Node *internalNode = internalNodeByName.value(posObj["nodeName"].toString());
+        if (internalNode) {
+            originalPositions[internalNode] = QPointF(posObj["x"].toDouble(), posObj["y"].toDouble());
+        }
+    }
+    setOriginalPositions(originalPositions);
+    
+    // 计算端口映射
+    calculatePortMappings();
+}
+
+/**
+ * @brief 设置延迟加载的内部子图
+ * @param loader 加载内部子图的函数
+ * @param internalNodeCount 内部节点数量（用于显示）
+ * @param inputLabels 输入端口标签
+ * @param outputLabels 输出端口标签
+ */
+void GroupNode::setDeferredInterior(const InteriorLoader &loader, int internalNodeCount,
+                                    const QStringList &inputLabels, const QStringList &outputLabels)
+{
+    m_interiorLoader = loader;
+    m_deferredNodeCount = internalNodeCount;
+    m_deferredInputLabels = inputLabels;
+    m_deferredOutputLabels = outputLabels;
+    updatePortLayout(inputLabels.size(), outputLabels.size());
+}
+
+/**
+ * @brief 构建延迟加载的内部子图（如果有）
+ * 
+ * 访问器是 const 的，内部子图对外表现为一直存在，因此这里去掉 const 完成一次性构建。
+ */
+void GroupNode::ensureInterior() const
+{
+    if (!m_interiorLoader) {
+        return;
+    }
+    GroupNode *self = const_cast<GroupNode*>(this);
+    InteriorLoader loader;
+    loader.swap(self->m_interiorLoader);  // 先取出，避免 restoreInterior 中的访问器重入
+    self->restoreInterior(loader());
+    self->m_deferredInputLabels.clear();
+    self->m_deferredOutputLabels.clear();
+}
+
+/**
+ * @brief 获取输入端口标签，不触发延迟加载
+ * @return 每个输入端口的来源标签
+ */
+QStringList GroupNode::inputPortLabels() const
+{
+    if (hasDeferredInterior()) {
+        return m_deferredInputLabels;
+    }
+    QStringList labels;
+    for (const PortMapping &pm : m_inputPortMappings) {
+        labels.append(pm.portLabel);
+    }
+    return labels;
+}
+
+/**
+ * @brief 获取输出端口标签，不触发延迟加载
+ * @return 每个输出端口的来源标签
+ */
+QStringList GroupNode::outputPortLabels() const
+{
+    if (hasDeferredInterior()) {
+        return m_deferredOutputLabels;
+    }
+    QStringList labels;
+    for (const PortMapping &pm : m_outputPortMappings) {
+        labels.append(pm.portLabel);
+    }
+    return labels;
+}
+
 QJsonObject GroupNode::toJson() const
 {
+    ensureInterior();
+
     QJsonObject json = Node::toJson();
     json["isGroup"] = true;
     json["groupLevel"] = m_groupLevel;  // 保存组件等级
@@ -13,6 +13,8 @@
 #include "Connection.h"
 #include <QList>
 #include <QMap>
+#include <QStringList>
+#include <functional>
 
 /**
  * @struct PortMapping
@@ -47,10 +49,19 @@ struct ExternalConnection {
  * - 内部连接列表
  * - 端口映射（悬空端口到组端口的映射）
  * - 支持拆分还原
+ * 
+ * 从二进制项目文件加载的组节点可以延迟构建内部子图：加载时只设置端口数量和标签，
+ * 第一次访问内部节点、连接或端口映射时（拆分、在场景节点树中展开等）才从文件中解码。
  */
 class GroupNode : public Node
 {
 public:
+    /**
+     * @brief 延迟加载内部子图的函数，返回包含 internalNodes、internalConnections
+     *        和 originalPositions 的JSON对象（格式与 NodeScene::getFlowData 相同）
+     */
+    using InteriorLoader = std::function<QJsonObject()>;
+    
     /**
      * @brief 自定义类型标识符
      * 注意：Node=UserType+1, Connection=UserType+2, GroupNode=UserType+3
@@ -107,31 +118,31 @@ public:
      * @brief 获取内部节点列表
      * @return 内部节点列表
      */
-    QList<Node*> getInternalNodes() const { return m_internalNodes; }
+    QList<Node*> getInternalNodes() const { ensureInterior(); return m_internalNodes; }
     
     /**
      * @brief 获取内部连接列表
      * @return 内部连接列表
      */
-    QList<Connection*> getInternalConnections() const { return m_internalConnections; }
+    QList<Connection*> getInternalConnections() const { ensureInterior(); return m_internalConnections; }
     
     /**
      * @brief 获取外部连接信息
      * @return 外部连接信息列表
      */
-    QList<ExternalConnection> getExternalConnections() const { return m_externalConnections; }
+    QList<ExternalConnection> getExternalConnections() const { ensureInterior(); return m_externalConnections; }
     
     /**
      * @brief 获取输入端口映射
      * @return 输入端口映射列表
      */
-    QList<PortMapping> getInputPortMappings() const { return m_inputPortMappings; }
+    QList<PortMapping> getInputPortMappings() const { ensureInterior(); return m_inputPortMappings; }
     
     /**
      * @brief 获取输出端口映射
      * @return 输出端口映射列表
      */
-    QList<PortMapping> getOutputPortMappings() const { return m_outputPortMappings; }
+    QList<PortMapping> getOutputPortMappings() const { ensureInterior(); return m_outputPortMappings; }
     
     /**
      * @brief 计算并设置端口映射
@@ -143,7 +154,7 @@ public:
      * @brief 获取内部节点的原始位置
      * @return 节点到位置的映射
      */
-    QMap<Node*, QPointF> getOriginalPositions() const { return m_originalPositions; }
+    QMap<Node*, QPointF> getOriginalPositions() const { ensureInterior(); return m_originalPositions; }
     
     /**
      * @brief 设置内部节点的原始位置
@@ -151,6 +162,59 @@ public:
      */
     void setOriginalPositions(const QMap<Node*, QPointF> &positions);
     
+    /**
+     * @brief 从JSON恢复内部子图（内部节点、内部连接和原始位置）并计算端口映射
+     * @param json 包含 internalNodes、internalConnections 和 originalPositions 的JSON对象
+     * 
+     * 只创建不在场景中的图形项，可以在工作线程中对尚未加入场景的组节点调用。
+     */
+    void restoreInterior(const QJsonObject &json);
+    
+    /**
+     * @brief 设置延迟加载的内部子图
+     * @param loader 加载内部子图的函数
+     * @param internalNodeCount 内部节点数量（用于显示）
+     * @param inputLabels 输入端口标签
+     * @param outputLabels 输出端口标签
+     */
+    void setDeferredInterior(const InteriorLoader &loader, int internalNodeCount,
+                             const QStringList &inputLabels, const QStringList &outputLabels);
+    
+    /**
+     * @brief 内部子图是否尚未构建
+     * @return 尚未构建返回true
+     */
+    bool hasDeferredInterior() const { return static_cast<bool>(m_interiorLoader); }
+    
+    /**
+     * @brief 不构建图形项，直接取出延迟加载的内部子图JSON（保存和代码生成时使用）
+     * @return 内部子图JSON，没有延迟数据时返回空对象
+     */
+    QJsonObject deferredInteriorJson() const { return m_interiorLoader ? m_interiorLoader() : QJsonObject(); }
+    
+    /**
+     * @brief 构建延迟加载的内部子图（如果有）
+     */
+    void ensureInterior() const;
+    
+    /**
+     * @brief 获取内部节点数量，不触发延迟加载
+     * @return 内部节点数量
+     */
+    int internalNodeCount() const { return hasDeferredInterior() ? m_deferredNodeCount : m_internalNodes.size(); }
+    
+    /**
+     * @brief 获取输入端口标签，不触发延迟加载
+     * @return 每个输入端口的来源标签
+     */
+    QStringList inputPortLabels() const;
+    
+    /**
+     * @brief 获取输出端口标签，不触发延迟加载
+     * @return 每个输出端口的来源标签
+     */
+    QStringList outputPortLabels() const;
+    
     /**
      * @brief 检查是否为组节点
      * @return 始终返回true
@@ -184,6 +248,13 @@ public:
     static GroupNode* fromJson(const QJsonObject &json, const QMap<QString, Node*> &allNodes);
 
 private:
+    /**
+     * @brief 按端口数量设置组节点的端口和尺寸
+     * @param inputCount 输入端口映射数量
+     * @param outputCount 输出端口映射数量
+     */
+    void updatePortLayout(int inputCount, int outputCount);
+    
     QList<Node*> m_internalNodes;              ///< 内部节点列表
     QList<Connection*> m_internalConnections;  ///< 内部连接列表
     QList<ExternalConnection> m_externalConnections; ///< 外部连接信息
@@ -194,6 +265,11 @@ private:
     QMap<Node*, QPointF> m_originalPositions;  ///< 内部节点的原始位置
     
     int m_groupLevel;                          ///< 组件等级（默认1级）
+    
+    InteriorLoader m_interiorLoader;           ///< 延迟加载内部子图的函数，已构建时为空
+    int m_deferredNodeCount;                   ///< 延迟加载时的内部节点数量
+    QStringList m_deferredInputLabels;         ///< 延迟加载时的输入端口标签
+    QStringList m_deferredOutputLabels;        ///< 延迟加载时的输出端口标签
 };
 
 #endif // GROUPNODE_H
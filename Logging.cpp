@@ -0,0 +1,112 @@
+/**
+ * @file Logging.cpp
+ * @brief 日志分类和交互跟踪实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "Logging.h"
+#include <QFile>
+#include <QTextStream>
+#include <array>
+#include <chrono>
+
+// 调试日志默认只输出 info 及以上级别
+Q_LOGGING_CATEGORY(lcScene, "dagflow.scene", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcNode, "dagflow.node", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcConnection, "dagflow.connection", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcLibrary, "dagflow.library", QtInfoMsg)
+
+namespace Trace {
+
+namespace detail {
+std::atomic<bool> g_enabled(false);
+}
+
+namespace {
+
+static_assert((kCapacity & (kCapacity - 1)) == 0, "环形缓冲区容量必须是2的幂");
+
+std::array<Event, kCapacity> g_events;         // 环形缓冲区
+std::atomic<quint64> g_next(0);                // 下一条事件的序号
+
+} // namespace
+
+/**
+ * @brief 开启或关闭跟踪
+ * @param enabled 是否开启
+ */
+void setEnabled(bool enabled)
+{
+    detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 记录一条跟踪事件
+ *
+ * 只写入一个固定槽位，不分配内存也不格式化字符串。序号用原子自增分配，
+ * 因此工作线程也可以记录；导出时正在写入的槽位可能读到不完整的数据，对诊断用途可以接受。
+ */
+void record(const char *name, const void *object, double a, double b)
+{
+    const qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const quint64 index = g_next.fetch_add(1, std::memory_order_relaxed);
+    g_events[index & (kCapacity - 1)] = Event{now, name, object, a, b};
+}
+
+/**
+ * @brief 清空环形缓冲区
+ */
+void clear()
+{
+    g_next.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 按时间顺序取出缓冲区中的事件
+ * @return 最早的事件在前
+ */
+QVector<Event> snapshot()
+{
+    const quint64 end = g_next.load(std::memory_order_relaxed);
+    const quint64 begin = end > quint64(kCapacity) ? end - kCapacity : 0;
+
+    QVector<Event> events;
+    events.reserve(static_cast<int>(end - begin));
+    for (quint64 i = begin; i < end; ++i) {
+        events.append(g_events[i & (kCapacity - 1)]);
+    }
+    return events;
+}
+
+/**
+ * @brief 将缓冲区中的事件写入文本文件
+ * @param fileName 输出文件路径
+ * @return 写入成功返回true
+ */
+bool dump(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "无法写入跟踪文件:" << fileName;
+        return false;
+    }
+
+    const QVector<Event> events = snapshot();
+    const qint64 origin = events.isEmpty() ? 0 : events.first().timestampNs;
+
+    QTextStream out(&file);
+    out << "# time_ns\tevent\tobject\ta\tb\n";
+    for (const Event &event : events) {
+        out << (event.timestampNs - origin) << '\t'
+            << event.name << '\t'
+            << QString("0x%1").arg(reinterpret_cast<quintptr>(event.object), 0, 16) << '\t'
+            << event.a << '\t'
+            << event.b << '\n';
+    }
+    return true;
+}
+
+} // namespace Trace
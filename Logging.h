@@ -0,0 +1,119 @@
+/**
+ * @file Logging.h
+ * @brief 日志分类和交互跟踪头文件，替代各模块硬编码的调试开关
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ *
+ * 调试日志按模块划分为 QLoggingCategory，运行时默认关闭，可通过环境变量开启：
+ *
+ *     QT_LOGGING_RULES="dagflow.scene.debug=true;dagflow.connection.debug=true"
+ *
+ * 发布版在 CodeGenerator.pro 中定义 QT_NO_DEBUG_OUTPUT，qCDebug 和
+ * DAGFLOW_DEBUG_ENABLED 包裹的代码块在编译期被整体去掉，不留下任何格式化开销。
+ *
+ * 交互跟踪（Trace）把事件写入固定大小的环形缓冲区，只记录事件名、对象指针和两个数值，
+ * 不做字符串格式化；未启用时每个跟踪点只有一次原子读取。
+ * 以 CONFIG += no_trace 构建时跟踪点在编译期去掉。
+ */
+
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>            // Qt日志分类
+#include <QString>                     // 字符串类
+#include <QVector>                     // 向量容器
+#include <atomic>                      // 原子变量
+
+Q_DECLARE_LOGGING_CATEGORY(lcScene)       // 场景交互（dagflow.scene）
+Q_DECLARE_LOGGING_CATEGORY(lcNode)        // 节点（dagflow.node）
+Q_DECLARE_LOGGING_CATEGORY(lcConnection)  // 连接线（dagflow.connection）
+Q_DECLARE_LOGGING_CATEGORY(lcLibrary)     // 节点库（dagflow.library）
+
+/**
+ * @brief 判断某个分类的调试日志是否开启
+ *
+ * 用于包裹需要多行输出或额外计算的调试代码块；发布版中恒为false，整个代码块被编译器去掉。
+ */
+#ifdef QT_NO_DEBUG_OUTPUT
+#define DAGFLOW_DEBUG_ENABLED(category) false
+#else
+#define DAGFLOW_DEBUG_ENABLED(category) category().isDebugEnabled()
+#endif
+
+namespace Trace {
+
+/**
+ * @brief 环形缓冲区中的一条跟踪事件
+ */
+struct Event {
+    qint64 timestampNs;     ///< 单调时钟时间戳（纳秒）
+    const char *name;       ///< 事件名（必须是字符串字面量）
+    const void *object;     ///< 相关对象指针，可为nullptr
+    double a;               ///< 事件参数1（如场景X坐标、数量）
+    double b;               ///< 事件参数2（如场景Y坐标）
+};
+
+/**
+ * @brief 环形缓冲区容量（条），写满后覆盖最早的事件
+ */
+constexpr int kCapacity = 8192;
+
+namespace detail {
+extern std::atomic<bool> g_enabled;     ///< 跟踪是否开启
+}
+
+/**
+ * @brief 跟踪是否开启
+ * @return 开启返回true
+ */
+inline bool isEnabled()
+{
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 开启或关闭跟踪
+ * @param enabled 是否开启
+ */
+void setEnabled(bool enabled);
+
+/**
+ * @brief 记录一条跟踪事件（调用方应先检查 isEnabled，通常通过 DAGFLOW_TRACE 宏调用）
+ * @param name 事件名（字符串字面量）
+ * @param object 相关对象指针
+ * @param a 事件参数1
+ * @param b 事件参数2
+ */
+void record(const char *name, const void *object = nullptr, double a = 0.0, double b = 0.0);
+
+/**
+ * @brief 清空环形缓冲区
+ */
+void clear();
+
+/**
+ * @brief 按时间顺序取出缓冲区中的事件
+ * @return 最多 kCapacity 条事件，最早的在前
+ */
+QVector<Event> snapshot();
+
+/**
+ * @brief 将缓冲区中的事件写入文本文件（每行：时间戳、事件名、对象、参数1、参数2，制表符分隔）
+ * @param fileName 输出文件路径
+ * @return 写入成功返回true
+ */
+bool dump(const QString &fileName);
+
+} // namespace Trace
+
+/**
+ * @brief 跟踪点宏，参数同 Trace::record
+ */
+#ifdef DAGFLOW_NO_TRACE
+#define DAGFLOW_TRACE(...) do { } while (false)
+#else
+#define DAGFLOW_TRACE(...) do { if (Trace::isEnabled()) Trace::record(__VA_ARGS__); } while (false)
+#endif
+
+#endif // LOGGING_H
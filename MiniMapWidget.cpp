@@ -15,6 +15,13 @@
 #include <QMouseEvent>
 #include <QScrollBar>
 
+namespace {
+
+/// 小地图内容四周保留的边距（像素）
+const int kContentMargin = 5;
+
+} // namespace
+
 /**
  * @brief 构造函数
  */
@@ -23,12 +30,18 @@ MiniMapWidget::MiniMapWidget(QWidget *parent)
     , m_scene(nullptr)
     , m_mainView(nullptr)
     , m_dragging(false)
+    , m_fullRefresh(true)
 {
     setFixedSize(200, 150);
     setMouseTracking(true);
     
     // 设置背景样式
     setStyleSheet("background-color: rgba(40, 40, 50, 200); border: 1px solid #555; border-radius: 5px;");
+    
+    // 单次定时器：第一次变化启动，刷新前的后续变化只累积脏区域，不重新计时
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(REFRESH_INTERVAL_MS);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &MiniMapWidget::refreshContent);
 }
 
 /**
@@ -36,11 +49,19 @@ MiniMapWidget::MiniMapWidget(QWidget *parent)
  */
 void MiniMapWidget::setSceneAndView(QGraphicsScene *scene, NodeView *mainView)
 {
+    if (m_scene) {
+        disconnect(m_scene, nullptr, this, nullptr);
+    }
+    if (m_mainView) {
+        disconnect(m_mainView->horizontalScrollBar(), nullptr, this, nullptr);
+        disconnect(m_mainView->verticalScrollBar(), nullptr, this, nullptr);
+    }
+    
     m_scene = scene;
     m_mainView = mainView;
     
     if (m_mainView) {
-        // 连接视图变化信号
+        // 视图滚动只移动视口框，不需要重新渲染内容
         connect(m_mainView->horizontalScrollBar(), &QScrollBar::valueChanged,
                 this, &MiniMapWidget::updateMiniMap);
         connect(m_mainView->verticalScrollBar(), &QScrollBar::valueChanged,
@@ -48,21 +69,65 @@ void MiniMapWidget::setSceneAndView(QGraphicsScene *scene, NodeView *mainView)
     }
     
     if (m_scene) {
-        // 连接场景变化信号
-        connect(m_scene, &QGraphicsScene::changed, this, &MiniMapWidget::updateMiniMap);
+        // 场景变化只累积脏区域，由定时器统一刷新
+        connect(m_scene, &QGraphicsScene::changed, this, &MiniMapWidget::onSceneChanged);
+        connect(m_scene, &QGraphicsScene::sceneRectChanged, this, &MiniMapWidget::invalidateContent);
     }
     
-    updateMiniMap();
+    invalidateContent();
 }
 
 /**
- * @brief 更新小地图显示
+ * @brief 更新小地图显示（只重新叠加视口框）
  */
 void MiniMapWidget::updateMiniMap()
 {
     update();
 }
 
+/**
+ * @brief 请求完整重绘缓存的场景图像
+ */
+void MiniMapWidget::invalidateContent()
+{
+    m_fullRefresh = true;
+    m_dirtyRects.clear();
+    if (!m_refreshTimer.isActive()) {
+        m_refreshTimer.start();
+    }
+}
+
+/**
+ * @brief 场景内容变化时累积脏区域
+ * @param region 变化的场景矩形列表
+ */
+void MiniMapWidget::onSceneChanged(const QList<QRectF> &region)
+{
+    if (!m_fullRefresh) {
+        for (const QRectF &rect : region) {
+            // 脏区域超出缓存图像的边界时，边界需要重新计算，改为完整重绘
+            if (!m_sceneBounds.contains(rect)) {
+                m_fullRefresh = true;
+                m_dirtyRects.clear();
+                break;
+            }
+            m_dirtyRects.append(rect);
+        }
+    }
+    if (!m_refreshTimer.isActive()) {
+        m_refreshTimer.start();
+    }
+}
+
+/**
+ * @brief 尺寸变化事件，重建缓存图像
+ */
+void MiniMapWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    invalidateContent();
+}
+
 /**
  * @brief 获取缩放后的场景边界矩形
  */
@@ -82,28 +147,35 @@ QRectF MiniMapWidget::getSceneBounds() const
     return bounds;
 }
 
+/**
+ * @brief 计算场景坐标到小地图坐标的缩放比例和偏移
+ *
+ * 使用缓存图像对应的场景边界，而不是每次重新计算 itemsBoundingRect，
+ * 因此坐标转换和视口框绘制的开销与场景规模无关。
+ */
+void MiniMapWidget::mapping(qreal *scale, QPointF *offset) const
+{
+    const qreal scaleX = m_sceneBounds.width() / (width() - 2 * kContentMargin);
+    const qreal scaleY = m_sceneBounds.height() / (height() - 2 * kContentMargin);
+    *scale = qMax(scaleX, scaleY);
+    
+    // 计算偏移使内容居中
+    *offset = QPointF((width() - m_sceneBounds.width() / *scale) / 2,
+                      (height() - m_sceneBounds.height() / *scale) / 2);
+}
+
 /**
  * @brief 将小地图坐标转换为场景坐标
  */
 QPointF MiniMapWidget::widgetToScene(const QPointF &widgetPos) const
 {
-    QRectF sceneBounds = getSceneBounds();
-    if (sceneBounds.isEmpty()) return QPointF();
-    
-    // 计算缩放比例
-    qreal scaleX = sceneBounds.width() / (width() - 10);
-    qreal scaleY = sceneBounds.height() / (height() - 10);
-    qreal scale = qMax(scaleX, scaleY);
+    if (m_sceneBounds.isEmpty()) return QPointF();
     
-    // 计算偏移
-    qreal offsetX = (width() - sceneBounds.width() / scale) / 2;
-    qreal offsetY = (height() - sceneBounds.height() / scale) / 2;
+    qreal scale;
+    QPointF offset;
+    mapping(&scale, &offset);
     
-    // 转换坐标
-    qreal sceneX = (widgetPos.x() - offsetX) * scale + sceneBounds.left();
-    qreal sceneY = (widgetPos.y() - offsetY) * scale + sceneBounds.top();
-    
-    return QPointF(sceneX, sceneY);
+    return (widgetPos - offset) * scale + m_sceneBounds.topLeft();
 }
 
 /**
@@ -111,86 +183,125 @@ QPointF MiniMapWidget::widgetToScene(const QPointF &widgetPos) const
  */
 QPointF MiniMapWidget::sceneToWidget(const QPointF &scenePos) const
 {
-    QRectF sceneBounds = getSceneBounds();
-    if (sceneBounds.isEmpty()) return QPointF();
-    
-    // 计算缩放比例
-    qreal scaleX = sceneBounds.width() / (width() - 10);
-    qreal scaleY = sceneBounds.height() / (height() - 10);
-    qreal scale = qMax(scaleX, scaleY);
-    
-    // 计算偏移
-    qreal offsetX = (width() - sceneBounds.width() / scale) / 2;
-    qreal offsetY = (height() - sceneBounds.height() / scale) / 2;
+    if (m_sceneBounds.isEmpty()) return QPointF();
     
-    // 转换坐标
-    qreal widgetX = (scenePos.x() - sceneBounds.left()) / scale + offsetX;
-    qreal widgetY = (scenePos.y() - sceneBounds.top()) / scale + offsetY;
+    qreal scale;
+    QPointF offset;
+    mapping(&scale, &offset);
     
-    return QPointF(widgetX, widgetY);
+    return (scenePos - m_sceneBounds.topLeft()) / scale + offset;
 }
 
 /**
- * @brief 绘制事件
+ * @brief 定时刷新缓存图像中的脏区域
+ *
+ * 完整重绘时重新计算场景边界并重绘整张图像；否则只清除并重绘各脏区域，
+ * 通过场景的空间索引查询与脏区域相交的图形项，耗时与变化区域内的图形项数有关。
  */
-void MiniMapWidget::paintEvent(QPaintEvent *)
+void MiniMapWidget::refreshContent()
 {
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    if (!m_scene) {
+        m_content = QImage();
+        m_sceneBounds = QRectF();
+        m_dirtyRects.clear();
+        update();
+        return;
+    }
     
-    // 绘制背景
-    painter.fillRect(rect(), QColor(40, 40, 50, 220));
-    painter.setPen(QPen(QColor(80, 80, 90), 1));
-    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+    const qreal dpr = devicePixelRatioF();
+    const QSize imageSize = size() * dpr;
+    if (m_content.size() != imageSize) {
+        m_content = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+        m_content.setDevicePixelRatio(dpr);
+        m_fullRefresh = true;
+    }
     
-    if (!m_scene || !m_mainView) return;
+    if (m_fullRefresh) {
+        m_sceneBounds = getSceneBounds();
+    }
+    if (m_sceneBounds.isEmpty()) {
+        m_content.fill(Qt::transparent);
+        m_fullRefresh = false;
+        m_dirtyRects.clear();
+        update();
+        return;
+    }
     
-    QRectF sceneBounds = getSceneBounds();
-    if (sceneBounds.isEmpty()) return;
+    qreal scale;
+    QPointF offset;
+    mapping(&scale, &offset);
     
-    // 计算缩放比例
-    qreal scaleX = sceneBounds.width() / (width() - 10);
-    qreal scaleY = sceneBounds.height() / (height() - 10);
-    qreal scale = qMax(scaleX, scaleY);
+    if (m_fullRefresh) {
+        m_content.fill(Qt::transparent);
+    }
     
-    // 计算偏移使内容居中
-    qreal offsetX = (width() - sceneBounds.width() / scale) / 2;
-    qreal offsetY = (height() - sceneBounds.height() / scale) / 2;
+    QPainter painter(&m_content);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(offset);
+    painter.scale(1.0 / scale, 1.0 / scale);
+    painter.translate(-m_sceneBounds.topLeft());
+    
+    if (m_fullRefresh) {
+        renderRegion(painter, m_sceneBounds, scale);
+    } else {
+        // 画笔宽度和抗锯齿会超出图形项的边界，向外扩展约两个像素
+        const qreal margin = 2 * scale;
+        for (const QRectF &rect : m_dirtyRects) {
+            renderRegion(painter, rect.adjusted(-margin, -margin, margin, margin), scale);
+        }
+    }
+    
+    m_fullRefresh = false;
+    m_dirtyRects.clear();
+    update();
+}
+
+/**
+ * @brief 在缓存图像中重绘指定场景区域
+ */
+void MiniMapWidget::renderRegion(QPainter &painter, const QRectF &sceneRect, qreal scale)
+{
+    const QRectF rect = sceneRect.intersected(m_sceneBounds);
+    if (rect.isEmpty()) return;
     
-    // 设置变换
     painter.save();
-    painter.translate(offsetX, offsetY);
-    painter.scale(1.0 / scale, 1.0 / scale);
-    painter.translate(-sceneBounds.left(), -sceneBounds.top());
+    painter.setClipRect(rect);
+    
+    // 清除区域并绘制网格背景
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(rect, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
     
-    // 绘制网格背景
     painter.setPen(QPen(QColor(60, 60, 70, 100), scale));
     qreal gridSize = 100;
-    qreal left = qFloor(sceneBounds.left() / gridSize) * gridSize;
-    qreal top = qFloor(sceneBounds.top() / gridSize) * gridSize;
-    for (qreal x = left; x < sceneBounds.right(); x += gridSize) {
-        painter.drawLine(QPointF(x, sceneBounds.top()), QPointF(x, sceneBounds.bottom()));
+    qreal left = qFloor(rect.left() / gridSize) * gridSize;
+    qreal top = qFloor(rect.top() / gridSize) * gridSize;
+    for (qreal x = left; x < rect.right(); x += gridSize) {
+        painter.drawLine(QPointF(x, rect.top()), QPointF(x, rect.bottom()));
     }
-    for (qreal y = top; y < sceneBounds.bottom(); y += gridSize) {
-        painter.drawLine(QPointF(sceneBounds.left(), y), QPointF(sceneBounds.right(), y));
+    for (qreal y = top; y < rect.bottom(); y += gridSize) {
+        painter.drawLine(QPointF(rect.left(), y), QPointF(rect.right(), y));
     }
     
+    // 只取与区域相交的图形项（由场景的BSP索引查询）
+    const QList<QGraphicsItem*> items = m_scene->items(rect, Qt::IntersectsItemBoundingRect);
+    
     // 绘制场景中的项（简化版本）
     // 先绘制连线（在节点下方）
-    for (QGraphicsItem *item : m_scene->items()) {
+    for (QGraphicsItem *item : items) {
         if (item->type() == QGraphicsItem::UserType + 2) {
             // Connection类型 - 绘制为细线
             QGraphicsPathItem *pathItem = dynamic_cast<QGraphicsPathItem*>(item);
             if (pathItem) {
                 painter.setBrush(Qt::NoBrush);
                 painter.setPen(QPen(QColor(255, 200, 50, 200), scale * 1.5));
-                painter.drawPath(pathItem->path());
+                painter.drawPath(pathItem->sceneTransform().map(pathItem->path()));  // 连线平移后路径带有图形项偏移
             }
         }
     }
     
     // 再绘制节点（在连线上方）
-    for (QGraphicsItem *item : m_scene->items()) {
+    for (QGraphicsItem *item : items) {
         if (item->type() == QGraphicsItem::UserType + 1) {
             // Node类型 - 绘制为小矩形（绿色）
             QRectF itemBounds = item->sceneBoundingRect();
@@ -213,6 +324,30 @@ void MiniMapWidget::paintEvent(QPaintEvent *)
     }
     
     painter.restore();
+}
+
+/**
+ * @brief 绘制事件
+ *
+ * 只绘制背景、缓存的场景图像和视口框，不遍历场景中的图形项。
+ */
+void MiniMapWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    
+    // 绘制背景
+    painter.fillRect(rect(), QColor(40, 40, 50, 220));
+    painter.setPen(QPen(QColor(80, 80, 90), 1));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+    
+    if (!m_scene || !m_mainView) return;
+    
+    if (!m_content.isNull()) {
+        painter.drawImage(QPointF(0, 0), m_content);
+    }
+    
+    if (m_sceneBounds.isEmpty()) return;
     
     // 绘制当前视口区域
     QRectF viewportRect = m_mainView->mapToScene(m_mainView->viewport()->rect()).boundingRect();
@@ -11,6 +11,8 @@
 
 #include <QWidget>
 #include <QGraphicsView>
+#include <QImage>
+#include <QTimer>
 
 // 前向声明
 class QGraphicsScene;
@@ -25,6 +27,9 @@ class NodeView;
  * - 高亮显示当前视口区域
  * - 点击小地图快速导航到对应位置
  * - 拖拽视口框移动视图
+ *
+ * 场景内容渲染到离屏图像中缓存：场景变化只累积脏区域，由定时器按固定频率
+ * 重绘脏区域内的图形项；视图滚动只重新叠加视口框，不重新渲染内容。
  */
 class MiniMapWidget : public QWidget
 {
@@ -45,9 +50,19 @@ public:
     void setSceneAndView(QGraphicsScene *scene, NodeView *mainView);
 
     /**
-     * @brief 更新小地图显示
+     * @brief 更新小地图显示（只重新叠加视口框）
      */
     void updateMiniMap();
+    
+    /**
+     * @brief 请求完整重绘缓存的场景图像（场景边界或小地图尺寸变化时使用）
+     */
+    void invalidateContent();
+    
+    /**
+     * @brief 内容刷新间隔（毫秒），即小地图内容的最高刷新频率
+     */
+    static const int REFRESH_INTERVAL_MS = 100;
 
 protected:
     /**
@@ -73,8 +88,41 @@ protected:
      * @param event 鼠标事件对象
      */
     void mouseReleaseEvent(QMouseEvent *event) override;
+    
+    /**
+     * @brief 尺寸变化事件，重建缓存图像
+     * @param event 尺寸变化事件对象
+     */
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    /**
+     * @brief 场景内容变化时累积脏区域
+     * @param region 变化的场景矩形列表
+     */
+    void onSceneChanged(const QList<QRectF> &region);
+    
+    /**
+     * @brief 定时刷新缓存图像中的脏区域
+     */
+    void refreshContent();
 
 private:
+    /**
+     * @brief 计算场景坐标到小地图坐标的缩放比例和偏移
+     * @param scale 输出：每个小地图像素对应的场景单位
+     * @param offset 输出：内容居中的偏移
+     */
+    void mapping(qreal *scale, QPointF *offset) const;
+    
+    /**
+     * @brief 在缓存图像中重绘指定场景区域
+     * @param painter 已设置好场景变换的绘制器
+     * @param sceneRect 需要重绘的场景矩形
+     * @param scale 每个小地图像素对应的场景单位
+     */
+    void renderRegion(QPainter &painter, const QRectF &sceneRect, qreal scale);
+
     /**
      * @brief 将小地图坐标转换为场景坐标
      * @param widgetPos 小地图坐标
@@ -99,6 +147,12 @@ private:
     NodeView *m_mainView;        ///< 主视图指针
     bool m_dragging;             ///< 是否正在拖拽
     QPointF m_dragStartPos;      ///< 拖拽起始位置
+    
+    QImage m_content;            ///< 缓存的场景内容图像
+    QRectF m_sceneBounds;        ///< 缓存图像对应的场景边界
+    QList<QRectF> m_dirtyRects;  ///< 尚未重绘的脏区域（场景坐标）
+    bool m_fullRefresh;          ///< 下次刷新是否需要完整重绘
+    QTimer m_refreshTimer;       ///< 内容刷新节流定时器
 };
 
 #endif // MINIMAPWIDGET_H
@@ -11,6 +11,7 @@
 #include "NodeLibrary.h"
 #include "NodeScene.h"
 #include "UndoCommands.h"
+#include "Logging.h"
 #include "qgraphicssceneevent.h"
 #include <QStyleOptionGraphicsItem>   // 图形项样式选项
 #include <QJsonArray>                // JSON数组类
@@ -18,6 +19,12 @@
 #include <QRadialGradient>           // 径向渐变类
 #include <QPainter>                  // 绘制器类
 #include <QTimer>                    // 定时器类
+#include <atomic>                    // 原子计数器
+
+namespace {
+// 下一个可分配的节点ID（从1开始，0表示无效ID）；节点可能在线程池中并行构造，因此使用原子操作
+std::atomic<quint64> s_nextNodeId{1};
+}
 
 /**
  * @brief 构造函数
@@ -26,7 +33,8 @@
  * @param position 节点位置
  */
 Node::Node(const QString &type, const QString &name, const QPointF &position)
-    : m_type(type)                    // 初始化节点类型
+    : m_id(s_nextNodeId.fetch_add(1))  // 分配新的节点ID
+    , m_type(type)                    // 初始化节点类型
     , m_name(name)                    // 初始化节点名称
     , m_dragStartPos(0, 0)            // 初始化拖拽起始位置
     , m_inputPortHighlighted(false)   // 初始化输入端口高亮状态
@@ -36,6 +44,8 @@ Node::Node(const QString &type, const QString &name, const QPointF &position)
     , m_displayTypeName("")           // 初始化显示类型名称
     , m_inputPortCount(1)             // 默认1个输入端口
     , m_outputPortCount(1)            // 默认1个输出端口
+    , m_profileHeat(-1.0)             // 默认没有性能数据
+    , m_profileCritical(false)        // 默认不在关键路径上
     , m_width(DEFAULT_WIDTH)          // 初始化宽度
     , m_height(DEFAULT_HEIGHT)        // 初始化高度
     , m_resizing(false)               // 初始化调整大小状态
@@ -71,6 +81,11 @@ Node::~Node()
     // 注意：不在这里删除连接，由 NodeScene::deleteSelected 统一管理
     // 只需清空连接列表，避免悬空指针
     m_connections.clear();
+    
+    // 析构时不会收到 ItemSceneChange，需要主动从端口索引中移除
+    if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+        nodeScene->removeFromPortIndex(this);
+    }
 }
 
 /**
@@ -97,10 +112,9 @@ QRectF Node::boundingRect() const
  * @param option 样式选项（未使用）
  * @param widget 父控件（未使用）
  */
-void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
 {
-    // 启用抗锯齿以提高绘制质量
-    painter->setRenderHint(QPainter::Antialiasing);
+    const qreal lod = levelOfDetail(option, painter);
     
     // 获取节点颜色：优先使用自定义颜色，否则使用内置颜色
     QColor color;
@@ -116,6 +130,15 @@ void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
         else color = QColor(255, 107, 107);                               // 红色 - 输出
     }
     
+    // 缩小到文字无法辨认时改用简化绘制
+    if (lod < LOD_SIMPLE) {
+        paintSimplified(painter, color, lod);
+        return;
+    }
+    
+    // 启用抗锯齿以提高绘制质量
+    painter->setRenderHint(QPainter::Antialiasing);
+    
     // 节点主体矩形（不包含端口区域）
     QRectF nodeRect(-m_width/2, -m_height/2, m_width, m_height);
     
@@ -157,6 +180,22 @@ void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
     
     painter->drawText(QRectF(-m_width/2, -m_height/2 + 25, m_width, 30), Qt::AlignCenter, typeText);
     
+    // 绘制性能报告叠加：按耗时占比由浅到深染红，关键路径加橙色描边
+    if (m_profileHeat >= 0.0) {
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(QColor(255, 40, 0, 30 + qRound(170 * m_profileHeat)));
+        painter->drawRoundedRect(nodeRect, 10, 10);
+        
+        if (m_profileCritical) {
+            painter->setBrush(Qt::NoBrush);
+            painter->setPen(QPen(QColor(255, 140, 0), 4));
+            painter->drawRoundedRect(nodeRect.adjusted(-3, -3, 3, 3), 12, 12);
+        }
+        
+        painter->setPen(Qt::white);
+        painter->drawText(QRectF(-m_width/2, m_height/2 - 22, m_width, 20), Qt::AlignCenter, m_profileLabel);
+    }
+    
     // 绘制调整大小把手（仅在选中时显示）
     if (isSelected()) {
         drawResizeHandles(painter);
@@ -167,6 +206,55 @@ void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 }
 
 
+/**
+ * @brief 计算当前绘制的细节层次
+ * @param option 样式选项
+ * @param painter 绘制器
+ * @return 细节层次
+ */
+qreal Node::levelOfDetail(const QStyleOptionGraphicsItem *option, const QPainter *painter)
+{
+    return option ? option->levelOfDetailFromTransform(painter->worldTransform()) : 1.0;
+}
+
+/**
+ * @brief 低缩放比例下的简化绘制
+ * @param painter 绘制器
+ * @param color 节点颜色
+ * @param lod 当前细节层次
+ * 
+ * 不使用抗锯齿、渐变和圆角：
+ * - LOD_IMPOSTOR 以下只做一到两次 fillRect（节点颜色，性能叠加时再覆盖一层热度色）
+ * - LOD_SIMPLE 以下绘制纯色矩形，选中和关键路径用1像素的装饰笔描边
+ */
+void Node::paintSimplified(QPainter *painter, const QColor &color, qreal lod)
+{
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    const QRectF nodeRect(-m_width/2, -m_height/2, m_width, m_height);
+    const QColor heatColor(255, 40, 0, 30 + qRound(170 * qMax(m_profileHeat, 0.0)));
+    
+    if (lod < LOD_IMPOSTOR) {
+        painter->fillRect(nodeRect, isSelected() ? QColor(Qt::yellow) : color);
+        if (m_profileHeat >= 0.0) {
+            painter->fillRect(nodeRect, heatColor);
+        }
+        return;
+    }
+    
+    painter->setPen(isSelected() ? QPen(Qt::yellow, 0) : QPen(Qt::NoPen));
+    painter->setBrush(color);
+    painter->drawRect(nodeRect);
+    
+    if (m_profileHeat >= 0.0) {
+        painter->fillRect(nodeRect, heatColor);
+        if (m_profileCritical) {
+            painter->setPen(QPen(QColor(255, 140, 0), 0));
+            painter->setBrush(Qt::NoBrush);
+            painter->drawRect(nodeRect);
+        }
+    }
+}
+
 /**
  * @brief 设置节点类型
  * @param type 新的节点类型
@@ -176,8 +264,14 @@ void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
 void Node::setType(const QString &type)
 {
     if (m_type != type) {
+        const QString oldType = m_type;
         m_type = type;
         
+        // 场景按类型索引节点
+        if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+            nodeScene->updateNodeTypeIndex(this, oldType);
+        }
+        
         // 从节点库获取新类型的模板信息
         NodeTemplate tmpl = NodeLibrary::instance()->getTemplate(type);
         if (tmpl.isValid()) {
@@ -190,7 +284,8 @@ void Node::setType(const QString &type)
             m_inputPortCount = tmpl.getInputPortCount();
             m_outputPortCount = tmpl.getOutputPortCount();
             
-            // 更新所有相关连接线的位置
+            // 刷新端口索引并更新所有相关连接线的位置
+            updatePortIndex();
             for (Connection *conn : m_connections) {
                 conn->updatePath();
             }
@@ -245,6 +340,20 @@ void Node::setDisplayTypeName(const QString &name)
     }
 }
 
+/**
+ * @brief 设置性能报告叠加数据
+ * @param heat 热度（0 ~ 1），小于0表示清除叠加
+ * @param label 叠加显示的文字
+ * @param critical 是否位于关键路径上
+ */
+void Node::setProfileOverlay(qreal heat, const QString &label, bool critical)
+{
+    m_profileHeat = heat < 0.0 ? -1.0 : qMin(heat, 1.0);
+    m_profileLabel = label;
+    m_profileCritical = critical && heat >= 0.0;
+    update();  // 触发重绘
+}
+
 /**
  * @brief 设置输入端口数量
  * @param count 新的端口数量
@@ -256,7 +365,8 @@ void Node::setInputPortCount(int count)
         prepareGeometryChange();  // 边界可能改变
         m_inputPortCount = newCount;
         
-        // 更新所有相关连接线的位置
+        // 刷新端口索引并更新所有相关连接线的位置
+        updatePortIndex();
         for (Connection *conn : m_connections) {
             conn->updatePath();
         }
@@ -276,7 +386,8 @@ void Node::setOutputPortCount(int count)
         prepareGeometryChange();  // 边界可能改变
         m_outputPortCount = newCount;
         
-        // 更新所有相关连接线的位置
+        // 刷新端口索引并更新所有相关连接线的位置
+        updatePortIndex();
         for (Connection *conn : m_connections) {
             conn->updatePath();
         }
@@ -394,7 +505,7 @@ QPointF Node::getOutputPortPos(int portIndex) const
 QJsonObject Node::toJson() const
 {
     QJsonObject json;
-    json["id"] = QString::number(reinterpret_cast<quintptr>(this));  // 使用对象指针作为唯一标识符
+    json["id"] = idString();                                          // 节点持久ID
     json["type"] = m_type;                                            // 节点类型
     json["name"] = m_name;                                            // 节点名称
     json["x"] = x();                                                  // 节点X坐标
@@ -426,6 +537,54 @@ QJsonObject Node::toJson() const
     return json;
 }
 
+/**
+ * @brief 设置节点ID（加载项目时恢复保存的ID）
+ * @param id 节点ID，为0时保持原ID不变
+ */
+void Node::setId(quint64 id)
+{
+    if (id == 0) {
+        return;
+    }
+    m_id = id;
+    reserveIds(id + 1);  // 保证之后分配的ID不与已加载的ID重复
+}
+
+/**
+ * @brief 获取下一个将要分配的节点ID
+ * @return 下一个节点ID
+ */
+quint64 Node::nextId()
+{
+    return s_nextNodeId.load();
+}
+
+/**
+ * @brief 保证之后分配的节点ID不小于 next
+ * @param next 下一个可分配的节点ID
+ */
+void Node::reserveIds(quint64 next)
+{
+    quint64 current = s_nextNodeId.load();
+    while (current < next && !s_nextNodeId.compare_exchange_weak(current, next)) {
+    }
+}
+
+/**
+ * @brief 解析节点ID字符串
+ * @param text 节点ID字符串
+ * @return 节点ID，格式不符时返回0
+ */
+quint64 Node::idFromString(const QString &text)
+{
+    if (!text.startsWith('n')) {
+        return 0;
+    }
+    bool ok = false;
+    const quint64 id = QStringView(text).mid(1).toULongLong(&ok);
+    return ok ? id : 0;
+}
+
 /**
  * @brief 从JSON对象创建节点实例
  * @param json 包含节点信息的JSON对象
@@ -559,12 +718,7 @@ void Node::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
         return;
     }
     
-    QGraphicsItem::mouseMoveEvent(event);  // 调用基类处理拖拽
-    
-    // 更新所有相关连接线的位置
-    for (Connection *conn : m_connections) {
-        conn->updatePath();
-    }
+    QGraphicsItem::mouseMoveEvent(event);  // 调用基类处理拖拽（连接线由 itemChange 标记后统一刷新）
 }
 
 /**
@@ -649,26 +803,52 @@ QVariant Node::itemChange(GraphicsItemChange change, const QVariant &value)
     if (change == ItemPositionChange && scene()) {
         // 位置即将改变时，更新所有连接线
         // 这个调用在位置实际改变之前发生
-        if (DEBUG_PORTS) {
-            qDebug() << "节点" << m_name << "位置即将改变";
+        if (DAGFLOW_DEBUG_ENABLED(lcNode)) {
+            qCDebug(lcNode) << "节点" << m_name << "位置即将改变";
+        }
+    }
+    else if (change == ItemSceneChange && scene()) {
+        // 即将离开当前场景，从其端口索引中移除
+        if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+            nodeScene->removeFromPortIndex(this);
         }
     }
+    else if (change == ItemSceneHasChanged && scene()) {
+        // 加入新场景后登记全部端口
+        updatePortIndex();
+    }
     else if (change == ItemPositionHasChanged && scene()) {
-        // 位置已经改变后，立即更新所有连接线
-        for (Connection *conn : m_connections) {
-            conn->updatePath();
-            if (DEBUG_PORTS) {
-                conn->printStatus();  // 打印连接线状态
+        DAGFLOW_TRACE("node.moved", this, pos().x(), pos().y());
+        updatePortIndex();
+        
+        // 位置已经改变后，把连接线交给场景合并刷新；不在 NodeScene 中时直接更新
+        if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+            nodeScene->markConnectionsDirty(this);
+        } else {
+            for (Connection *conn : m_connections) {
+                conn->updatePath();
             }
         }
-        if (DEBUG_PORTS) {
-            qDebug() << "节点" << m_name << "位置已改变到" << pos() << "，更新了" << m_connections.size() << "条连接线";
+        if (DAGFLOW_DEBUG_ENABLED(lcNode)) {
+            qCDebug(lcNode) << "节点" << m_name << "位置已改变到" << pos() << "，标记了" << m_connections.size() << "条连接线";
         }
     }
     
     return QGraphicsItem::itemChange(change, value);
 }
 
+/**
+ * @brief 刷新该节点在所属场景端口索引中的条目
+ * 
+ * 节点位置、尺寸或端口数量变化后调用；不在 NodeScene 中时不做任何事。
+ */
+void Node::updatePortIndex()
+{
+    if (NodeScene *nodeScene = qobject_cast<NodeScene*>(scene())) {
+        nodeScene->updatePortIndex(this);
+    }
+}
+
 /**
  * @brief 检查点是否在任意输入端口的连接范围内
  * @param point 要检查的点（场景坐标）
@@ -705,10 +885,10 @@ int Node::getInputPortIndexAt(const QPointF &point) const
         QPointF portPos = getInputPortPos(i);
         qreal distance = QLineF(point, portPos).length();
         if (distance <= PORT_CAPTURE_RADIUS) {
-            if (DEBUG_PORTS) {
-                qDebug() << "--- getInputPortIndexAt ---";
-                qDebug() << "节点:" << m_name << "端口索引:" << i;
-                qDebug() << "端口位置:" << portPos << "距离:" << distance;
+            if (DAGFLOW_DEBUG_ENABLED(lcNode)) {
+                qCDebug(lcNode) << "--- getInputPortIndexAt ---";
+                qCDebug(lcNode) << "节点:" << m_name << "端口索引:" << i;
+                qCDebug(lcNode) << "端口位置:" << portPos << "距离:" << distance;
             }
             return i;
         }
@@ -732,10 +912,10 @@ int Node::getOutputPortIndexAt(const QPointF &point) const
         QPointF portPos = getOutputPortPos(i);
         qreal distance = QLineF(point, portPos).length();
         if (distance <= PORT_CAPTURE_RADIUS) {
-            if (DEBUG_PORTS) {
-                qDebug() << "--- getOutputPortIndexAt ---";
-                qDebug() << "节点:" << m_name << "端口索引:" << i;
-                qDebug() << "端口位置:" << portPos << "距离:" << distance;
+            if (DAGFLOW_DEBUG_ENABLED(lcNode)) {
+                qCDebug(lcNode) << "--- getOutputPortIndexAt ---";
+                qCDebug(lcNode) << "节点:" << m_name << "端口索引:" << i;
+                qCDebug(lcNode) << "端口位置:" << portPos << "距离:" << distance;
             }
             return i;
         }
@@ -881,7 +1061,8 @@ void Node::setSize(qreal width, qreal height)
     m_width = qBound((qreal)MIN_WIDTH, width, (qreal)MAX_WIDTH);
     m_height = qBound((qreal)MIN_HEIGHT, height, (qreal)MAX_HEIGHT);
     
-    // 更新所有连接线
+    // 刷新端口索引并更新所有连接线
+    updatePortIndex();
     for (Connection *conn : m_connections) {
         conn->updatePath();
     }
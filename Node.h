@@ -15,9 +15,6 @@
 #include <QDebug>                    // 调试输出类
 #include <QColor>                    // 颜色类
 
-// 调试开关：设置为true启用端口调试输出
-static const bool DEBUG_PORTS = true;
-
 // 前向声明
 class Connection;                     // 连接线类
 
@@ -73,6 +70,54 @@ public:
      */
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr)  override;
     
+    /**
+     * @brief 获取节点的持久ID
+     * @return 创建时按递增顺序分配的ID，保存和加载后保持不变
+     */
+    quint64 getId() const { return m_id; }
+    
+    /**
+     * @brief 获取节点ID的字符串形式（"n" + 数字），用于项目文件和生成代码
+     * @return 节点ID字符串
+     */
+    QString idString() const { return idToString(m_id); }
+    
+    /**
+     * @brief 设置节点ID（加载项目时恢复保存的ID）
+     * @param id 节点ID，为0时保持原ID不变
+     * 
+     * 之后新建的节点ID都大于已设置的ID，可以在工作线程中调用。
+     */
+    void setId(quint64 id);
+    
+    /**
+     * @brief 获取下一个将要分配的节点ID
+     * @return 下一个节点ID
+     */
+    static quint64 nextId();
+    
+    /**
+     * @brief 保证之后分配的节点ID不小于 next
+     * @param next 下一个可分配的节点ID
+     * 
+     * 加载项目时调用，延迟加载的组节点内部ID尚未出现时也不会被新节点占用。
+     */
+    static void reserveIds(quint64 next);
+    
+    /**
+     * @brief 把节点ID格式化为字符串
+     * @param id 节点ID
+     * @return 形如 "n42" 的字符串
+     */
+    static QString idToString(quint64 id) { return QStringLiteral("n%1").arg(id); }
+    
+    /**
+     * @brief 解析节点ID字符串
+     * @param text 节点ID字符串
+     * @return 节点ID，不是 idToString 格式（例如旧版本以指针生成的ID）时返回0
+     */
+    static quint64 idFromString(const QString &text);
+    
     // 节点属性访问器
     QString getType() const { return m_type; }           // 获取节点类型
     QString getName() const { return m_name; }           // 获取节点名称
@@ -180,6 +225,25 @@ public:
      */
     void setOutputPortHighlighted(bool highlighted);
     
+    /**
+     * @brief 设置性能报告叠加数据
+     * @param heat 热度（0 ~ 1，按场景中最耗时的节点归一化），小于0表示清除叠加
+     * @param label 叠加显示的文字（如耗时占比和中位数耗时）
+     * @param critical 是否位于关键路径上
+     */
+    void setProfileOverlay(qreal heat, const QString &label, bool critical);
+    
+    /**
+     * @brief 清除性能报告叠加
+     */
+    void clearProfileOverlay() { setProfileOverlay(-1.0, QString(), false); }
+    
+    /**
+     * @brief 是否显示性能报告叠加
+     * @return 已加载该节点的性能数据返回true
+     */
+    bool hasProfileOverlay() const { return m_profileHeat >= 0.0; }
+    
     /**
      * @brief 绘制端口（单独绘制以确保在节点框之上）
      * @param painter 绘制器对象
@@ -198,6 +262,8 @@ public:
      * @brief 从JSON对象创建节点实例
      * @param json 包含节点信息的JSON对象
      * @return 新创建的节点指针
+     * 
+     * 新节点总是分配新的ID（粘贴等场合不能与原节点重复），加载项目时由调用方用 setId 恢复。
      */
     static Node* fromJson(const QJsonObject &json);
     
@@ -228,7 +294,16 @@ protected:
      */
     QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
     
+    /**
+     * @brief 计算当前绘制的细节层次
+     * @param option 样式选项
+     * @param painter 绘制器
+     * @return 细节层次（1.0为原始大小，缩小时小于1）
+     */
+    static qreal levelOfDetail(const QStyleOptionGraphicsItem *option, const QPainter *painter);
+    
 private:
+    quint64 m_id;                         // 节点持久ID
     QString m_type;                       // 节点类型
     QString m_name;                       // 节点显示名称
     QStringList m_parameters;             // 节点参数列表
@@ -246,6 +321,10 @@ private:
     int m_inputPortCount;                 // 输入端口数量
     int m_outputPortCount;                // 输出端口数量
     
+    qreal m_profileHeat;                  // 性能热度（小于0表示无性能数据）
+    QString m_profileLabel;               // 性能叠加文字
+    bool m_profileCritical;               // 是否位于关键路径上
+    
     /**
      * @brief 调整大小区域枚举
      */
@@ -279,6 +358,10 @@ public:
     static const int PORT_CAPTURE_RADIUS = 12; // 端点捕获范围
     static const int HANDLE_SIZE = 8;       // 调整把手大小
     
+    // 细节层次阈值（QStyleOptionGraphicsItem::levelOfDetailFromTransform，1.0为原始大小）
+    static constexpr qreal LOD_SIMPLE = 0.4;    // 低于该值：节点绘制为纯色矩形，不绘制文字、端口、把手和组标识，连线绘制为直线
+    static constexpr qreal LOD_IMPOSTOR = 0.15; // 低于该值：节点（包括组节点）只用一次填充绘制
+    
     // 兼容旧代码的静态常量
     static const int WIDTH = DEFAULT_WIDTH;
     static const int HEIGHT = DEFAULT_HEIGHT;
@@ -297,6 +380,19 @@ private:
      */
     void drawResizeHandles(QPainter *painter);
     
+    /**
+     * @brief 刷新该节点在所属场景端口索引中的条目
+     */
+    void updatePortIndex();
+    
+    /**
+     * @brief 低缩放比例下的简化绘制
+     * @param painter 绘制器
+     * @param color 节点颜色
+     * @param lod 当前细节层次
+     */
+    void paintSimplified(QPainter *painter, const QColor &color, qreal lod);
+    
     qreal m_width;                        // 节点当前宽度
     qreal m_height;                       // 节点当前高度
     bool m_resizing;                      // 是否正在调整大小
@@ -7,13 +7,26 @@
  */
 
 #include "NodeLibrary.h"
+#include "Logging.h"
+#include <QCoreApplication>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDir>
+#include <QSaveFile>
 #include <QStandardPaths>
+#include <QTimer>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+
+/// 最后一次修改后延迟保存的时间（毫秒），期间的修改合并为一次写入
+const int kSaveDelayMs = 500;
+
+} // namespace
 
 // 静态成员初始化
 NodeLibrary* NodeLibrary::s_instance = nullptr;
@@ -34,7 +47,20 @@ NodeLibrary* NodeLibrary::instance()
  */
 NodeLibrary::NodeLibrary(QObject *parent)
     : QObject(parent)
+    , m_batchDepth(0)
+    , m_batchChanged(false)
+    , m_saveDirty(false)
+    , m_saveTimer(new QTimer(this))
 {
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(kSaveDelayMs);
+    connect(m_saveTimer, &QTimer::timeout, this, &NodeLibrary::startBackgroundSave);
+    
+    // 退出前写出防抖窗口内尚未保存的修改
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &NodeLibrary::flushPendingSave);
+    }
+    
     QString libraryPath = getDefaultLibraryPath();
     
     // 如果节点库文件存在，从文件加载
@@ -47,7 +73,7 @@ NodeLibrary::NodeLibrary(QObject *parent)
         }
     } else {
         // 节点库文件不存在，初始化默认节点并自动生成文件
-        qDebug() << "节点库文件不存在，生成默认节点库:" << libraryPath;
+        qCDebug(lcLibrary) << "节点库文件不存在，生成默认节点库:" << libraryPath;
         initBuiltInTemplates();
         saveToFile(libraryPath);
     }
@@ -101,6 +127,8 @@ void NodeLibrary::initBuiltInTemplates()
     sink.setInputPortCount(1);
     sink.setOutputPortCount(0);
     m_templates.insert(sink.getTypeId(), sink);
+
+    rebuildCategoryIndex();
 }
 
 /**
@@ -119,16 +147,23 @@ NodeTemplate NodeLibrary::getTemplate(const QString &typeId) const
     return m_templates.value(typeId, NodeTemplate());
 }
 
+/**
+ * @brief 按类型ID查找节点模板（不复制）
+ */
+const NodeTemplate* NodeLibrary::findTemplate(const QString &typeId) const
+{
+    auto it = m_templates.constFind(typeId);
+    return it != m_templates.constEnd() ? &it.value() : nullptr;
+}
+
 /**
  * @brief 获取所有分类
+ * 
+ * 直接取分类索引的键，按名称排序
  */
 QStringList NodeLibrary::getCategories() const
 {
-    QSet<QString> categories;
-    for (const NodeTemplate &tmpl : m_templates) {
-        categories.insert(tmpl.getCategory());
-    }
-    return categories.values();
+    return m_categoryIndex.keys();
 }
 
 /**
@@ -137,10 +172,10 @@ QStringList NodeLibrary::getCategories() const
 QList<NodeTemplate> NodeLibrary::getTemplatesByCategory(const QString &category) const
 {
     QList<NodeTemplate> result;
-    for (const NodeTemplate &tmpl : m_templates) {
-        if (tmpl.getCategory() == category) {
-            result.append(tmpl);
-        }
+    const QStringList typeIds = m_categoryIndex.value(category);
+    result.reserve(typeIds.size());
+    for (const QString &typeId : typeIds) {
+        result.append(m_templates.value(typeId));
     }
     return result;
 }
@@ -155,11 +190,12 @@ bool NodeLibrary::addTemplate(const NodeTemplate &tmpl)
     }
 
     m_templates.insert(tmpl.getTypeId(), tmpl);
+    indexTemplate(tmpl);
     emit templateAdded(tmpl.getTypeId());
-    emit libraryChanged();
+    markChanged();
     
-    // 自动保存到文件
-    saveToFile(getDefaultLibraryPath());
+    // 延迟自动保存到文件
+    scheduleSave();
     
     return true;
 }
@@ -175,12 +211,17 @@ bool NodeLibrary::updateTemplate(const NodeTemplate &tmpl)
         return false;
     }
 
-    m_templates[tmpl.getTypeId()] = tmpl;
+    NodeTemplate &current = m_templates[tmpl.getTypeId()];
+    if (current.getCategory() != tmpl.getCategory()) {
+        unindexTemplate(tmpl.getTypeId(), current.getCategory());
+        indexTemplate(tmpl);
+    }
+    current = tmpl;
     emit templateUpdated(tmpl.getTypeId());  // 发出模板更新信号
-    emit libraryChanged();
+    markChanged();
     
-    // 自动保存到文件
-    saveToFile(getDefaultLibraryPath());
+    // 延迟自动保存到文件
+    scheduleSave();
     
     return true;
 }
@@ -196,12 +237,13 @@ bool NodeLibrary::removeTemplate(const QString &typeId)
         return false;
     }
 
+    unindexTemplate(typeId, m_templates.value(typeId).getCategory());
     m_templates.remove(typeId);
     emit templateRemoved(typeId);
-    emit libraryChanged();
+    markChanged();
     
-    // 自动保存到文件
-    saveToFile(getDefaultLibraryPath());
+    // 延迟自动保存到文件
+    scheduleSave();
     
     return true;
 }
@@ -218,18 +260,31 @@ bool NodeLibrary::hasTemplate(const QString &typeId) const
  * @brief 将节点库保存到文件
  */
 bool NodeLibrary::saveToFile(const QString &filePath) const
+{
+    return writeTemplates(filePath, m_templates, "节点库配置文件", false);
+}
+
+/**
+ * @brief 把模板写入节点库文件
+ * 
+ * 先写入临时文件再替换目标文件，写入失败或程序中途退出时原文件保持完整。
+ */
+bool NodeLibrary::writeTemplates(const QString &filePath, const QMap<QString, NodeTemplate> &templates,
+                                 const QString &description, bool customOnly)
 {
     QJsonObject root;
     root["version"] = "1.0";
-    root["description"] = "节点库配置文件";
+    root["description"] = description;
 
     QJsonArray templatesArray;
-    for (const NodeTemplate &tmpl : m_templates) {
-        templatesArray.append(tmpl.toJson());
+    for (const NodeTemplate &tmpl : templates) {
+        if (!customOnly || !tmpl.isBuiltIn()) {
+            templatesArray.append(tmpl.toJson());
+        }
     }
     root["templates"] = templatesArray;
 
-    QFile file(filePath);
+    QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly)) {
         qWarning() << "无法打开文件保存节点库:" << filePath;
         return false;
@@ -237,7 +292,10 @@ bool NodeLibrary::saveToFile(const QString &filePath) const
 
     QJsonDocument doc(root);
     file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    if (!file.commit()) {
+        qWarning() << "无法写入节点库文件:" << filePath << file.errorString();
+        return false;
+    }
     return true;
 }
 
@@ -270,8 +328,9 @@ bool NodeLibrary::loadFromFile(const QString &filePath)
             m_templates.insert(tmpl.getTypeId(), tmpl);
         }
     }
+    rebuildCategoryIndex();
 
-    emit libraryChanged();
+    markChanged();
     return true;
 }
 
@@ -280,33 +339,14 @@ bool NodeLibrary::loadFromFile(const QString &filePath)
  */
 bool NodeLibrary::saveCustomToFile(const QString &filePath) const
 {
-    QJsonObject root;
-    root["version"] = "1.0";
-    root["description"] = "自定义节点库配置文件";
-
-    QJsonArray templatesArray;
-    for (const NodeTemplate &tmpl : m_templates) {
-        // 只保存自定义节点
-        if (!tmpl.isBuiltIn()) {
-            templatesArray.append(tmpl.toJson());
-        }
-    }
-    root["templates"] = templatesArray;
-
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "无法打开文件保存自定义节点库:" << filePath;
-        return false;
-    }
-
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
-    return true;
+    // 只保存自定义节点
+    return writeTemplates(filePath, m_templates, "自定义节点库配置文件", true);
 }
 
 /**
  * @brief 从文件加载自定义节点
+ * 
+ * 整个导入是一次批量修改：逐个模板发出添加/更新信号，结束时只发出一次 libraryChanged 并保存一次。
  */
 bool NodeLibrary::loadCustomFromFile(const QString &filePath)
 {
@@ -327,19 +367,19 @@ bool NodeLibrary::loadCustomFromFile(const QString &filePath)
     QJsonObject root = doc.object();
     QJsonArray templatesArray = root["templates"].toArray();
 
+    BatchGuard batch(this);
     for (const QJsonValue &value : templatesArray) {
         NodeTemplate tmpl = NodeTemplate::fromJson(value.toObject());
         if (tmpl.isValid() && !tmpl.isBuiltIn()) {
             // 如果已存在则更新，否则添加
             if (m_templates.contains(tmpl.getTypeId())) {
-                m_templates[tmpl.getTypeId()] = tmpl;
+                updateTemplate(tmpl);
             } else {
-                m_templates.insert(tmpl.getTypeId(), tmpl);
+                addTemplate(tmpl);
             }
         }
     }
 
-    emit libraryChanged();
     return true;
 }
 
@@ -350,7 +390,7 @@ void NodeLibrary::resetToDefaults()
 {
     m_templates.clear();
     initBuiltInTemplates();
-    emit libraryChanged();
+    markChanged();
 }
 
 /**
@@ -363,3 +403,131 @@ QString NodeLibrary::getDefaultLibraryPath() const
     return QDir::currentPath() + "/node_library.json";
 }
 
+/**
+ * @brief 开始批量修改
+ */
+void NodeLibrary::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+/**
+ * @brief 结束批量修改
+ */
+void NodeLibrary::endBatch()
+{
+    if (m_batchDepth <= 0 || --m_batchDepth > 0) {
+        return;
+    }
+    if (m_batchChanged) {
+        m_batchChanged = false;
+        emit libraryChanged();
+    }
+    if (m_saveDirty) {
+        m_saveTimer->start();
+    }
+}
+
+/**
+ * @brief 记录节点库已变化
+ */
+void NodeLibrary::markChanged()
+{
+    if (m_batchDepth > 0) {
+        m_batchChanged = true;
+    } else {
+        emit libraryChanged();
+    }
+}
+
+/**
+ * @brief 安排把节点库保存到默认路径
+ * 
+ * 每次调用都重新开始计时，连续编辑时只在最后一次修改后写入一次。
+ */
+void NodeLibrary::scheduleSave()
+{
+    m_saveDirty = true;
+    if (m_batchDepth == 0) {
+        m_saveTimer->start();
+    }
+}
+
+/**
+ * @brief 防抖时间到后在工作线程中保存节点库
+ * 
+ * 模板表按值复制（隐式共享，不复制数据）后交给工作线程序列化和写入，界面线程之后的修改不影响这次写入。
+ * 上一次后台保存尚未结束时推迟到下一个防抖周期，保证写入按顺序进行。
+ */
+void NodeLibrary::startBackgroundSave()
+{
+    if (!m_saveDirty || m_batchDepth > 0) {
+        return;
+    }
+    if (m_saveFuture.isRunning()) {
+        m_saveTimer->start();
+        return;
+    }
+    
+    m_saveDirty = false;
+    const QMap<QString, NodeTemplate> templates = m_templates;
+    const QString filePath = getDefaultLibraryPath();
+    qCDebug(lcLibrary) << "后台保存节点库:" << filePath << templates.size() << "个模板";
+    m_saveFuture = QtConcurrent::run([filePath, templates]() {
+        return writeTemplates(filePath, templates, "节点库配置文件", false);
+    });
+}
+
+/**
+ * @brief 立即写出尚未保存的修改
+ */
+void NodeLibrary::flushPendingSave()
+{
+    m_saveTimer->stop();
+    m_saveFuture.waitForFinished();
+    if (m_saveDirty) {
+        m_saveDirty = false;
+        saveToFile(getDefaultLibraryPath());
+    }
+}
+
+/**
+ * @brief 把模板加入分类索引
+ * 
+ * 同一分类下的类型ID保持有序，与 m_templates 的遍历顺序一致
+ */
+void NodeLibrary::indexTemplate(const NodeTemplate &tmpl)
+{
+    QStringList &typeIds = m_categoryIndex[tmpl.getCategory()];
+    auto it = std::lower_bound(typeIds.begin(), typeIds.end(), tmpl.getTypeId());
+    if (it == typeIds.end() || *it != tmpl.getTypeId()) {
+        typeIds.insert(it, tmpl.getTypeId());
+    }
+}
+
+/**
+ * @brief 从分类索引中移除模板
+ */
+void NodeLibrary::unindexTemplate(const QString &typeId, const QString &category)
+{
+    auto it = m_categoryIndex.find(category);
+    if (it == m_categoryIndex.end()) {
+        return;
+    }
+    it->removeOne(typeId);
+    if (it->isEmpty()) {
+        m_categoryIndex.erase(it);
+    }
+}
+
+/**
+ * @brief 按模板映射表重建分类索引
+ */
+void NodeLibrary::rebuildCategoryIndex()
+{
+    m_categoryIndex.clear();
+    // m_templates 按类型ID有序遍历，追加后每个分类内自然有序
+    for (const NodeTemplate &tmpl : m_templates) {
+        m_categoryIndex[tmpl.getCategory()].append(tmpl.getTypeId());
+    }
+}
@@ -10,11 +10,14 @@
 #define NODELIBRARY_H
 
 #include <QObject>
+#include <QFuture>
 #include <QMap>
 #include <QList>
 #include <QString>
 #include "NodeTemplate.h"
 
+class QTimer;
+
 /**
  * @class NodeLibrary
  * @brief 节点库类，管理所有可用的节点模板
@@ -23,12 +26,31 @@
  * - 管理内置和自定义节点模板
  * - 节点库的保存和加载
  * - 按分类组织节点
+ *
+ * 添加、更新和删除模板后不立即写文件，而是在最后一次修改约半秒后于工作线程中
+ * 经 QSaveFile 写入默认节点库文件；批量修改时用 BatchGuard 包住，期间只发出逐个模板的信号，
+ * 结束时发出一次 libraryChanged 并安排一次保存。程序退出时未写出的修改会同步写入。
  */
 class NodeLibrary : public QObject
 {
     Q_OBJECT
 
 public:
+    /**
+     * @class BatchGuard
+     * @brief 批量修改期间合并 libraryChanged 信号和自动保存的作用域守卫
+     */
+    class BatchGuard
+    {
+    public:
+        explicit BatchGuard(NodeLibrary *library) : m_library(library) { if (m_library) m_library->beginBatch(); }
+        ~BatchGuard() { if (m_library) m_library->endBatch(); }
+        BatchGuard(const BatchGuard &) = delete;
+        BatchGuard &operator=(const BatchGuard &) = delete;
+    private:
+        NodeLibrary *m_library;
+    };
+
     /**
      * @brief 获取单例实例
      * @return 节点库单例指针
@@ -41,6 +63,25 @@ public:
      */
     QList<NodeTemplate> getAllTemplates() const;
 
+    /**
+     * @brief 获取节点模板映射表（类型ID到模板，不复制）
+     * @return 模板映射表的常量引用，节点库修改后失效
+     */
+    const QMap<QString, NodeTemplate>& templates() const { return m_templates; }
+
+    /**
+     * @brief 按类型ID查找节点模板（不复制）
+     * @param typeId 节点类型ID
+     * @return 模板指针，不存在时返回nullptr；节点库修改后失效
+     */
+    const NodeTemplate* findTemplate(const QString &typeId) const;
+
+    /**
+     * @brief 获取分类索引（分类名称到该分类下按类型ID排序的模板ID列表）
+     * @return 分类索引的常量引用，节点库修改后失效
+     */
+    const QMap<QString, QStringList>& categoryIndex() const { return m_categoryIndex; }
+
     /**
      * @brief 根据类型ID获取节点模板
      * @param typeId 节点类型ID
@@ -128,6 +169,32 @@ public:
      */
     QString getDefaultLibraryPath() const;
 
+    /**
+     * @brief 开始批量修改（可嵌套）
+     *
+     * 批量修改期间不发出 libraryChanged，也不安排自动保存，通常通过 BatchGuard 使用。
+     */
+    void beginBatch();
+
+    /**
+     * @brief 结束批量修改
+     *
+     * 最外层结束时，如果期间有修改则发出一次 libraryChanged 并安排一次保存。
+     */
+    void endBatch();
+
+    /**
+     * @brief 安排把节点库保存到默认路径
+     *
+     * 延迟一段时间后在工作线程中写入，期间的多次调用合并为一次。
+     */
+    void scheduleSave();
+
+    /**
+     * @brief 立即写出尚未保存的修改（等待正在进行的后台保存）
+     */
+    void flushPendingSave();
+
 signals:
     /**
      * @brief 节点库发生变化时发出的信号
@@ -163,8 +230,55 @@ private:
      */
     void initBuiltInTemplates();
 
+    /**
+     * @brief 记录节点库已变化：不在批量修改中时立即发出 libraryChanged，批量修改中推迟到 endBatch()
+     *
+     * 不安排保存；需要写回文件的修改由调用者另外调用 scheduleSave()（从文件加载和重置不保存）。
+     */
+    void markChanged();
+
+    /**
+     * @brief 把模板加入分类索引
+     * @param tmpl 节点模板
+     */
+    void indexTemplate(const NodeTemplate &tmpl);
+
+    /**
+     * @brief 从分类索引中移除模板
+     * @param typeId 节点类型ID
+     * @param category 模板所在的分类
+     */
+    void unindexTemplate(const QString &typeId, const QString &category);
+
+    /**
+     * @brief 按模板映射表重建分类索引
+     */
+    void rebuildCategoryIndex();
+
+    /**
+     * @brief 防抖时间到后在工作线程中保存节点库
+     */
+    void startBackgroundSave();
+
+    /**
+     * @brief 把模板写入节点库文件（经 QSaveFile 原子替换），可在工作线程中调用
+     * @param filePath 文件路径
+     * @param templates 节点模板映射表
+     * @param description 写入文件的描述
+     * @param customOnly 是否只写入自定义节点
+     * @return 如果保存成功返回true
+     */
+    static bool writeTemplates(const QString &filePath, const QMap<QString, NodeTemplate> &templates,
+                               const QString &description, bool customOnly);
+
     static NodeLibrary *s_instance;           ///< 单例实例
     QMap<QString, NodeTemplate> m_templates;  ///< 节点模板映射表
+    QMap<QString, QStringList> m_categoryIndex;  ///< 分类到模板类型ID的索引（ID有序）
+    int m_batchDepth;                         ///< 批量修改嵌套层数
+    bool m_batchChanged;                      ///< 批量修改期间是否有变化
+    bool m_saveDirty;                         ///< 是否有尚未写出的修改
+    QTimer *m_saveTimer;                      ///< 自动保存防抖定时器
+    QFuture<bool> m_saveFuture;               ///< 正在进行的后台保存
 };
 
 #endif // NODELIBRARY_H
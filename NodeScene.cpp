@@ -1,13 +1,35 @@
 #include "NodeScene.h"
 #include "Node.h"
 #include "Connection.h"
+#include "FlowScheduler.h"
 #include "GroupNode.h"
+#include "Logging.h"
 #include "NodeLibrary.h"
 #include "NodeTemplate.h"
 #include "UndoCommands.h"
+#include <QFile>
 #include <QGraphicsSceneMouseEvent>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtMath>
+
+namespace {
+
+/// 场景边界的最小范围（空场景或小图时使用）
+const QRectF kMinimumSceneRect(-2000, -2000, 4000, 4000);
+
+/// 场景边界在图形项范围外保留的边距
+const qreal kSceneMargin = 1000.0;
+
+/// BSP树每个叶子期望的图形项数量
+const int kItemsPerBspLeaf = 8;
+
+/// 进入批量模式的最少图形项数，更小的修改逐项更新索引
+const int kBulkUpdateMinItems = 256;
+
+} // namespace
 
 NodeScene::NodeScene(QObject *parent)
     : QGraphicsScene(parent)
@@ -15,14 +37,114 @@ NodeScene::NodeScene(QObject *parent)
     , m_tempFromNode(nullptr)
     , m_tempFromPortIndex(0)
     , m_tempLine(nullptr)
+    , m_highlightedInputNode(nullptr)
+    , m_highlightedOutputNode(nullptr)
+    , m_connectionFlushPending(false)
+    , m_synchronousFlushPending(false)
+    , m_bulkUpdateDepth(0)
+    , m_indexedItemCount(0)
+    , m_undoMemoryBudget(DEFAULT_UNDO_MEMORY_BUDGET)
+    , m_undoFloor(0)
+    , m_undoUsage(0)
+    , m_lastUndoIndex(0)
+    , m_blockSize(0)
 {
-    setSceneRect(-2000, -2000, 4000, 4000);
+    setSceneRect(kMinimumSceneRect);
+    
+    // 每次压入、撤销或重做后检查撤销历史的内存预算
+    connect(&m_undoStack, &QUndoStack::indexChanged, this, &NodeScene::enforceUndoBudget);
     
     // 连接节点库模板更新信号，当模板更新时同步更新场景中的节点
     connect(NodeLibrary::instance(), &NodeLibrary::templateUpdated,
             this, &NodeScene::onTemplateUpdated);
 }
 
+void NodeScene::undo()
+{
+    if (m_undoStack.index() > m_undoFloor) {
+        m_undoStack.undo();
+    }
+}
+
+void NodeScene::redo()
+{
+    m_undoStack.redo();
+}
+
+void NodeScene::setUndoMemoryBudget(qint64 bytes)
+{
+    m_undoMemoryBudget = qMax<qint64>(0, bytes);
+    enforceUndoBudget();
+}
+
+/**
+ * @brief 撤销栈变化后更新各命令的内存估算和合计值
+ * 
+ * 栈顶以下、撤销位置没有经过的命令状态不变，不需要重新估算，每次变化的开销与历史长度无关。
+ */
+void NodeScene::syncUndoCosts()
+{
+    const int count = m_undoStack.count();
+    const int index = m_undoStack.index();
+    
+    // 撤销栈被清空或丢弃了可重做的命令
+    while (m_undoCosts.size() > count) {
+        m_undoUsage -= m_undoCosts.takeLast().cost;
+    }
+    const int previousSize = m_undoCosts.size();
+    m_undoCosts.resize(count);
+    
+    // 撤销位置经过的命令（所有权可能变化），以及位置前一条（新压入、替换或合并的命令）
+    const int first = qMax(0, qMin(m_lastUndoIndex, index) - 1);
+    const int last = qMin(qMax(m_lastUndoIndex, index), previousSize - 1);
+    for (int i = first; i <= last; ++i) {
+        refreshUndoCost(i);
+    }
+    for (int i = qMax(previousSize, first); i < count; ++i) {
+        refreshUndoCost(i);
+    }
+    m_lastUndoIndex = index;
+}
+
+/**
+ * @brief 重新估算一条命令的内存并更新合计值
+ * @param index 命令在撤销栈中的下标
+ */
+void NodeScene::refreshUndoCost(int index)
+{
+    UndoCost &entry = m_undoCosts[index];
+    entry.command = m_undoStack.command(index);
+    const SceneUndoCommand *cmd = dynamic_cast<const SceneUndoCommand*>(entry.command);
+    const qint64 cost = (cmd && index >= m_undoFloor) ? cmd->memoryCost() : 0;
+    m_undoUsage += cost - entry.cost;
+    entry.cost = cost;
+}
+
+/**
+ * @brief 撤销栈变化后检查内存预算，超出时释放最旧的命令
+ * 
+ * QUndoStack 不能删除栈底的命令，所以超出预算的命令留在栈中，只释放其撤销状态并抬高撤销下限。
+ * 下限以下的命令都已执行且不会再被撤销，之后的命令也不会引用它们删除的图形项。
+ */
+void NodeScene::enforceUndoBudget()
+{
+    // 撤销栈被清空后下限随之回退
+    m_undoFloor = qMin(m_undoFloor, m_undoStack.index());
+    syncUndoCosts();
+    if (m_undoMemoryBudget <= 0) {
+        return;
+    }
+    
+    while (m_undoUsage > m_undoMemoryBudget && m_undoFloor < m_undoStack.index() - 1) {
+        QUndoCommand *command = const_cast<QUndoCommand*>(m_undoStack.command(m_undoFloor));
+        if (SceneUndoCommand *cmd = dynamic_cast<SceneUndoCommand*>(command)) {
+            cmd->release();
+        }
+        ++m_undoFloor;
+        refreshUndoCost(m_undoFloor - 1);
+    }
+}
+
 void NodeScene::addNode(const QString &type, const QPointF &position)
 {
     AddNodeCommand *cmd = new AddNodeCommand(this, type, position);
@@ -40,6 +162,10 @@ Node* NodeScene::createNode(const QString &type, const QPointF &position)
     Node *node = new Node(type, name, position);
     addItem(node);
     m_nodes.append(node);
+    m_nodeIndex.insert(node->getId(), node);
+    m_typeIndex[node->getType()].append(node);
+    m_topology.insertNode(node);
+    emit nodesInserted({node});
     
     return node;
 }
@@ -50,7 +176,11 @@ Node* NodeScene::createNode(const QString &type, const QPointF &position)
 void NodeScene::removeNodeFromScene(Node *node)
 {
     m_nodes.removeAll(node);
+    m_nodeIndex.remove(node->getId());
+    removeFromTypeIndex(node, node->getType());
+    m_topology.removeNode(node);
     removeItem(node);
+    emit nodeRemoved(node);
 }
 
 /**
@@ -60,6 +190,10 @@ void NodeScene::restoreNodeToScene(Node *node)
 {
     addItem(node);
     m_nodes.append(node);
+    m_nodeIndex.insert(node->getId(), node);
+    m_typeIndex[node->getType()].append(node);
+    m_topology.insertNode(node);
+    emit nodesInserted({node});
 }
 
 /**
@@ -68,12 +202,21 @@ void NodeScene::restoreNodeToScene(Node *node)
 Connection* NodeScene::createConnection(Node *fromNode, int fromPort, Node *toNode, int toPort)
 {
     Connection *connection = new Connection(fromNode, fromPort, toNode, toPort);
-    addItem(connection);
-    m_connections.append(connection);
+    insertConnectionToScene(connection);
     emit connectionCreated();
     return connection;
 }
 
+/**
+ * @brief 将新建的连接加入场景（端点已由 Connection 构造函数登记）
+ */
+void NodeScene::insertConnectionToScene(Connection *conn)
+{
+    addItem(conn);
+    m_connections.append(conn);
+    m_topology.insertEdge(conn->getFromNode(), conn->getToNode());
+}
+
 /**
  * @brief 从场景移除连接（不删除，供撤销系统使用）
  */
@@ -86,6 +229,7 @@ void NodeScene::removeConnectionFromScene(Connection *conn)
         conn->getToNode()->removeConnection(conn);
     }
     m_connections.removeAll(conn);
+    m_topology.removeEdge(conn->getFromNode(), conn->getToNode());
     removeItem(conn);
 }
 
@@ -102,6 +246,7 @@ void NodeScene::restoreConnectionToScene(Connection *conn)
     }
     addItem(conn);
     m_connections.append(conn);
+    m_topology.insertEdge(conn->getFromNode(), conn->getToNode());
 }
 
 void NodeScene::addConnection(Node *fromNode, Node *toNode)
@@ -110,29 +255,56 @@ void NodeScene::addConnection(Node *fromNode, Node *toNode)
     addConnection(fromNode, 0, toNode, 0);
 }
 
-void NodeScene::addConnection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex)
+/**
+ * @brief 在两个节点的指定端口之间创建连接
+ *
+ * 会形成环路的连接不进入撤销栈，发出 connectionRejected 说明原因。
+ */
+bool NodeScene::addConnection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex)
 {
-    if (DEBUG_CONNECTION) {
-        qDebug() << "=== addConnection ===";
-        qDebug() << "源节点:" << (fromNode ? fromNode->getName() : "nullptr")
+    if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+        qCDebug(lcScene) << "=== addConnection ===";
+        qCDebug(lcScene) << "源节点:" << (fromNode ? fromNode->getName() : "nullptr")
                  << "端口:" << fromPortIndex;
-        qDebug() << "目标节点:" << (toNode ? toNode->getName() : "nullptr")
+        qCDebug(lcScene) << "目标节点:" << (toNode ? toNode->getName() : "nullptr")
                  << "端口:" << toPortIndex;
     }
     
+    if (m_topology.wouldCreateCycle(fromNode, toNode)) {
+        QString reason = QString("连接 %1 → %2 会形成环路，已取消")
+            .arg(fromNode->getName()).arg(toNode->getName());
+        // 拒绝是正常的交互结果（已通过 connectionRejected 提示用户），按信息级别记录到场景分类
+        qCInfo(lcScene) << reason;
+        emit connectionRejected(reason);
+        return false;
+    }
+    
     AddConnectionCommand *cmd = new AddConnectionCommand(this, fromNode, fromPortIndex, toNode, toPortIndex);
     m_undoStack.push(cmd);
     
-    if (DEBUG_CONNECTION) {
-        qDebug() << "连接创建完成，当前连接总数:" << m_connections.size();
+    if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+        qCDebug(lcScene) << "连接创建完成，当前连接总数:" << m_connections.size();
     }
+    return true;
 }
 
+/**
+ * @brief 验证当前流程图的有效性
+ *
+ * 环路状态由拓扑序索引随连接增删实时维护，直接读取；
+ * 端点检查按节点ID查哈希表，总耗时与连接数成线性关系。
+ */
 bool NodeScene::validateFlow() const
 {
+    if (!m_topology.isAcyclic()) {
+        return false;
+    }
+    
     // 检查连接有效性
     for (Connection *conn : m_connections) {
-        if (!m_nodes.contains(conn->getFromNode()) || !m_nodes.contains(conn->getToNode())) {
+        Node *fromNode = conn->getFromNode();
+        Node *toNode = conn->getToNode();
+        if (!fromNode || !toNode || nodeById(fromNode->getId()) != fromNode || nodeById(toNode->getId()) != toNode) {
             return false;
         }
     }
@@ -149,14 +321,20 @@ QJsonObject NodeScene::getFlowData() const
     flowData["metadata"] = QJsonObject{
         {"title", "可视化节点编辑器流程图"},
         {"created", QDateTime::currentDateTime().toString(Qt::ISODate)},
-        {"version", "1.2"}  // 版本升级以支持组节点
+        {"version", "1.3"},  // 1.2 支持组节点，1.3 使用持久节点ID
+        {"nextNodeId", static_cast<qint64>(Node::nextId())}  // 组节点内部的ID也不会被新节点重复使用
     };
+    if (m_blockSize > 0) {
+        QJsonObject metadata = flowData["metadata"].toObject();
+        metadata["blockSize"] = m_blockSize;  // 流式处理块大小
+        flowData["metadata"] = metadata;
+    }
     
     // 生成标准节点数组
     QJsonArray nodesArray;
     for (Node *node : m_nodes) {
         QJsonObject nodeObj;
-        nodeObj["id"] = QString("node_%1").arg(reinterpret_cast<quintptr>(node));
+        nodeObj["id"] = node->idString();
         nodeObj["type"] = node->getType();
         nodeObj["name"] = node->getName();
         nodeObj["position"] = QJsonObject{
@@ -173,11 +351,25 @@ QJsonObject NodeScene::getFlowData() const
         if (!node->getDisplayTypeName().isEmpty()) {
             nodeObj["displayTypeName"] = node->getDisplayTypeName();
         }
-        nodeObj["parameters"] = QJsonObject();  // 暂时为空对象
+        nodeObj["parameters"] = QJsonArray::fromStringList(node->getParameters());
         
         // 检查是否为组节点
         if (GroupNode *groupNode = dynamic_cast<GroupNode*>(node)) {
             nodeObj["isGroup"] = true;
+            // 端口标签用于二进制项目文件中延迟加载的组节点，不展开内部子图即可绘制
+            nodeObj["inputPortLabels"] = QJsonArray::fromStringList(groupNode->inputPortLabels());
+            nodeObj["outputPortLabels"] = QJsonArray::fromStringList(groupNode->outputPortLabels());
+            
+            // 内部子图尚未加载时直接写回文件中的数据，不构造图形项
+            if (groupNode->hasDeferredInterior()) {
+                const QJsonObject interior = groupNode->deferredInteriorJson();
+                for (auto it = interior.begin(); it != interior.end(); ++it) {
+                    nodeObj[it.key()] = it.value();
+                }
+                nodesArray.append(nodeObj);
+                continue;
+            }
+            
             // 保存内部节点
             QJsonArray internalNodesArray;
             for (Node *internalNode : groupNode->getInternalNodes()) {
@@ -212,8 +404,8 @@ QJsonObject NodeScene::getFlowData() const
     // 生成标准连接数组（包含端口信息和线型）
     QJsonArray connectionsArray;
     for (Connection *conn : m_connections) {
-        QString fromNodeId = QString("node_%1").arg(reinterpret_cast<quintptr>(conn->getFromNode()));
-        QString toNodeId = QString("node_%1").arg(reinterpret_cast<quintptr>(conn->getToNode()));
+        QString fromNodeId = conn->getFromNode()->idString();
+        QString toNodeId = conn->getToNode()->idString();
         
         QJsonObject connObj;
         connObj["from"] = fromNodeId;
@@ -230,95 +422,184 @@ QJsonObject NodeScene::getFlowData() const
 
 void NodeScene::loadFlowData(const QJsonObject &data)
 {
+    BulkUpdateGuard bulkUpdate(this);
+    
+    clearFlow();
+    
+    // 流程级设置
+    m_blockSize = data["metadata"].toObject()["blockSize"].toInt(0);
+    Node::reserveIds(data["metadata"].toObject()["nextNodeId"].toInteger(0));
+    
+    importFlowItems(data["nodes"].toArray(), data["connections"].toArray());
+}
+
+/**
+ * @brief 清空流程图（节点、连接和撤销记录）
+ * 
+ * 旧的撤销记录不再有效；先于清空场景释放，使命令持有的连接线在其端点节点析构前删除。
+ * 正在进行的分块导入中已加入的图形项一并删除，之后调用 endImport 不会再访问它们。
+ */
+void NodeScene::clearFlow()
+{
+    m_undoStack.clear();
+    m_undoFloor = 0;
     clear();
     m_nodes.clear();
+    m_nodeIndex.clear();
+    m_typeIndex.clear();
+    m_topology.clear();
     m_connections.clear();
+    m_importNodeMap.clear();
+    m_importConnections.clear();
+    emit nodesCleared();
+}
+
+/**
+ * @brief 从JSON创建一个节点（包括组节点及其内部子图）
+ * @param nodeObj 节点JSON对象
+ * @return 新建的节点，尚未加入场景
+ * 
+ * 只创建不在场景中的图形项，不访问场景状态，可以在工作线程中并行调用。
+ */
+Node* NodeScene::nodeFromJson(const QJsonObject &nodeObj)
+{
+    Node *node = nullptr;
     
-    QJsonArray nodesArray = data["nodes"].toArray();
-    QMap<QString, Node*> nodeMap;
-    
-    // 首先创建所有节点（包括组节点）
-    for (const QJsonValue &nodeValue : nodesArray) {
-        QJsonObject nodeObj = nodeValue.toObject();
-        Node *node = nullptr;
+    // 检查是否为组节点
+    if (nodeObj["isGroup"].toBool(false)) {
+        // 创建组节点
+        QString name = nodeObj["name"].toString();
+        QJsonObject posObj = nodeObj["position"].toObject();
+        QPointF position(posObj["x"].toDouble(), posObj["y"].toDouble());
         
-        // 检查是否为组节点
-        if (nodeObj["isGroup"].toBool(false)) {
-            // 创建组节点
-            QString name = nodeObj["name"].toString();
-            QJsonObject posObj = nodeObj["position"].toObject();
-            QPointF position(posObj["x"].toDouble(), posObj["y"].toDouble());
-            
-            GroupNode *groupNode = new GroupNode(name, position);
-            
-            // 恢复内部节点
-            QJsonArray internalNodesArray = nodeObj["internalNodes"].toArray();
-            QList<Node*> internalNodes;
-            QMap<QString, Node*> internalNodeMap;
-            
-            for (const QJsonValue &internalValue : internalNodesArray) {
-                QJsonObject internalObj = internalValue.toObject();
-                Node *internalNode = Node::fromJson(internalObj);
-                internalNodes.append(internalNode);
-                internalNodeMap[internalObj["name"].toString()] = internalNode;
-                // 内部节点不添加到场景，只保存在组节点中
-            }
-            groupNode->setInternalNodes(internalNodes);
-            
-            // 恢复内部连接
-            QJsonArray internalConnsArray = nodeObj["internalConnections"].toArray();
-            QList<Connection*> internalConnections;
-            
-            for (const QJsonValue &connValue : internalConnsArray) {
-                QJsonObject connObj = connValue.toObject();
-                QString fromName = connObj["fromNode"].toString();
-                QString toName = connObj["toNode"].toString();
-                
-                Node *fromNode = internalNodeMap.value(fromName);
-                Node *toNode = internalNodeMap.value(toName);
-                
-                if (fromNode && toNode) {
-                    int fromPort = connObj["fromPort"].toInt(0);
-                    int toPort = connObj["toPort"].toInt(0);
-                    Connection *conn = new Connection(fromNode, fromPort, toNode, toPort);
-                    internalConnections.append(conn);
-                }
-            }
-            groupNode->setInternalConnections(internalConnections);
-            
-            // 恢复原始位置
-            QJsonArray origPosArray = nodeObj["originalPositions"].toArray();
-            QMap<Node*, QPointF> originalPositions;
-            for (const QJsonValue &posValue : origPosArray) {
-                QJsonObject posObj = posValue.toObject();
-                QString nodeName = posObj["nodeName"].toString();
-                Node *internalNode = internalNodeMap.value(nodeName);
-                if (internalNode) {
-                    originalPositions[internalNode] = QPointF(posObj["x"].toDouble(), posObj["y"].toDouble());
-                }
-            }
-            groupNode->setOriginalPositions(originalPositions);
-            
-            // 计算端口映射
-            groupNode->calculatePortMappings();
-            
-            node = groupNode;
-        } else {
-            // 普通节点
-            node = Node::fromJson(nodeObj);
-        }
+        GroupNode *groupNode = new GroupNode(name, position);
+        groupNode->restoreInterior(nodeObj);
+        groupNode->setId(Node::idFromString(nodeObj["id"].toString()));
         
-        if (node) {
-            addItem(node);
-            m_nodes.append(node);
-            nodeMap[nodeObj["id"].toString()] = node;
+        node = groupNode;
+    } else {
+        // 普通节点
+        node = Node::fromJson(nodeObj);
+        node->setId(Node::idFromString(nodeObj["id"].toString()));
+    }
+    
+    return node;
+}
+
+/**
+ * @brief 批量导入节点和连接
+ */
+int NodeScene::importFlowItems(const QJsonArray &nodesArray, const QJsonArray &connectionsArray)
+{
+    beginImport();
+    const int count = importNodes(nodesArray, 0, nodesArray.size());
+    importConnections(connectionsArray, 0, connectionsArray.size());
+    endImport();
+    return count;
+}
+
+/**
+ * @brief 开始分块导入
+ * 
+ * 导入分三个阶段进行：
+ * 1. importNodes 在线程池中并行解析JSON并构造节点（此时节点都不在场景中），
+ *    再在GUI线程中按顺序加入场景，节点ID登记到哈希表
+ * 2. importConnections 按哈希表查找端点创建连接，此时不计算路径
+ * 3. endImport 统一计算一次连接线路径并重建场景索引
+ * 
+ * 两个导入函数都可以按区间多次调用，调用方可以在分块之间回到事件循环。
+ */
+void NodeScene::beginImport()
+{
+    beginBulkUpdate();
+    m_importNodeMap.clear();
+    m_importConnections.clear();
+    DAGFLOW_TRACE("scene.importBegin", this);
+}
+
+/**
+ * @brief 导入一段节点
+ * @param nodesArray 节点JSON数组
+ * @param begin 起始下标
+ * @param count 导入的个数
+ * @return 导入的节点数
+ */
+int NodeScene::importNodes(const QJsonArray &nodesArray, int begin, int count)
+{
+    const int end = qMin(nodesArray.size(), begin + count);
+    if (begin >= end) {
+        return 0;
+    }
+    
+    // 并行构造节点，结果顺序与输入一致
+    QList<QJsonObject> nodeObjects;
+    nodeObjects.reserve(end - begin);
+    for (int i = begin; i < end; ++i) {
+        nodeObjects.append(nodesArray.at(i).toObject());
+    }
+    const QList<Node*> nodes = QtConcurrent::blockingMapped<QList<Node*>>(nodeObjects, &NodeScene::nodeFromJson);
+    
+    QStringList ids;
+    ids.reserve(nodeObjects.size());
+    for (const QJsonObject &nodeObj : nodeObjects) {
+        ids.append(nodeObj["id"].toString());
+    }
+    return importBuiltNodes(nodes, ids);
+}
+
+/**
+ * @brief 导入一批已构造好的节点
+ * @param nodes 尚未加入场景的节点，空指针会被跳过
+ * @param ids 与 nodes 一一对应的文件中的节点ID
+ * @return 导入的节点数
+ */
+int NodeScene::importBuiltNodes(const QList<Node*> &nodes, const QStringList &ids)
+{
+    m_importNodeMap.reserve(m_importNodeMap.size() + nodes.size());
+    m_nodes.reserve(m_nodes.size() + nodes.size());
+    m_nodeIndex.reserve(m_nodeIndex.size() + nodes.size());
+    
+    const int first = m_nodes.size();
+    int imported = 0;
+    {
+        // 加入过程中不逐个发出选择变化等信号；场景的 changed 信号在回到事件循环后合并发出一次
+        QSignalBlocker blocker(this);
+        for (int i = 0; i < nodes.size(); ++i) {
+            Node *node = nodes[i];
+            if (node) {
+                addItem(node);
+                m_nodes.append(node);
+                m_nodeIndex.insert(node->getId(), node);
+                m_typeIndex[node->getType()].append(node);
+                m_topology.insertNode(node);
+                m_importNodeMap.insert(ids.at(i), node);
+                ++imported;
+            }
         }
     }
     
-    // 然后创建连接（支持新旧格式）
-    QJsonArray connectionsArray = data["connections"].toArray();
-    for (const QJsonValue &connValue : connectionsArray) {
-        QJsonObject connObj = connValue.toObject();
+    // 整批节点只通知一次
+    if (imported > 0) {
+        emit nodesInserted(m_nodes.mid(first));
+    }
+    return imported;
+}
+
+/**
+ * @brief 导入一段连接（端点节点须已由 importNodes 导入）
+ * @param connectionsArray 连接JSON数组
+ * @param begin 起始下标
+ * @param count 导入的个数
+ * @return 导入的连接数
+ */
+int NodeScene::importConnections(const QJsonArray &connectionsArray, int begin, int count)
+{
+    const int end = qMin(connectionsArray.size(), begin + count);
+    
+    QSignalBlocker blocker(this);
+    int imported = 0;
+    for (int i = begin; i < end; ++i) {
+        QJsonObject connObj = connectionsArray.at(i).toObject();
         
         // 支持两种格式的节点ID字段
         QString fromNodeId = connObj.contains("from") ? 
@@ -326,26 +607,58 @@ void NodeScene::loadFlowData(const QJsonObject &data)
         QString toNodeId = connObj.contains("to") ? 
             connObj["to"].toString() : connObj["toNode"].toString();
         
-        Node *fromNode = nodeMap[fromNodeId];
-        Node *toNode = nodeMap[toNodeId];
-        
-        if (fromNode && toNode) {
-            // 获取端口索引（如果存在），默认为0
-            int fromPort = connObj["fromPort"].toInt(0);
-            int toPort = connObj["toPort"].toInt(0);
-            
-            // 创建连接
-            Connection *connection = new Connection(fromNode, fromPort, toNode, toPort);
-            
-            // 加载连线类型（如果存在）
-            if (connObj.contains("lineType")) {
-                connection->setLineType(static_cast<Connection::LineType>(connObj["lineType"].toInt(0)));
-            }
-            
-            addItem(connection);
-            m_connections.append(connection);
+        // 获取端口索引（如果存在），默认为0；加载连线类型（如果存在）
+        if (importConnection(fromNodeId, connObj["fromPort"].toInt(0), toNodeId, connObj["toPort"].toInt(0),
+                             connObj["lineType"].toInt(0))) {
+            ++imported;
         }
     }
+    return imported;
+}
+
+/**
+ * @brief 导入一条连接（端点节点须已在本次导入中导入）
+ * @param fromNodeId 源节点在文件中的ID
+ * @param fromPort 源节点输出端口索引
+ * @param toNodeId 目标节点在文件中的ID
+ * @param toPort 目标节点输入端口索引
+ * @param lineType 连线类型
+ * @return 端点存在并创建了连接返回true
+ */
+bool NodeScene::importConnection(const QString &fromNodeId, int fromPort, const QString &toNodeId, int toPort,
+                                 int lineType)
+{
+    Node *fromNode = m_importNodeMap.value(fromNodeId);
+    Node *toNode = m_importNodeMap.value(toNodeId);
+    if (!fromNode || !toNode) {
+        return false;
+    }
+    
+    // 路径在 endImport 中统一计算
+    Connection *connection = new Connection(fromNode, fromPort, toNode, toPort,
+                                            static_cast<Connection::LineType>(lineType));
+    insertConnectionToScene(connection);
+    m_importConnections.append(connection);
+    return true;
+}
+
+/**
+ * @brief 结束分块导入：统一计算连接线路径并重建场景索引
+ */
+void NodeScene::endImport()
+{
+    // 所有端点就位后统一计算路径
+    for (Connection *connection : m_importConnections) {
+        connection->updatePath();
+    }
+    
+    DAGFLOW_TRACE("scene.importEnd", this, m_importNodeMap.size(), m_importConnections.size());
+    qCDebug(lcScene) << "批量导入" << m_importNodeMap.size() << "个节点和" 
+             << m_importConnections.size() << "条连接";
+    
+    m_importNodeMap.clear();
+    m_importConnections.clear();
+    endBulkUpdate();
 }
 
 void NodeScene::deleteSelected()
@@ -398,54 +711,38 @@ QGraphicsItem* NodeScene::getSelectedNode() const
 
 void NodeScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
-    if (DEBUG_CONNECTION) {
-        qDebug() << "=== NodeScene::mousePressEvent ===";
-        qDebug() << "鼠标位置:" << event->scenePos();
-        qDebug() << "当前连接状态:" << m_connectionState;
+    DAGFLOW_TRACE("scene.mousePress", this, event->scenePos().x(), event->scenePos().y());
+    if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+        qCDebug(lcScene) << "=== NodeScene::mousePressEvent ===";
+        qCDebug(lcScene) << "鼠标位置:" << event->scenePos();
+        qCDebug(lcScene) << "当前连接状态:" << m_connectionState;
     }
     
     if (event->button() == Qt::LeftButton) {
-        // 获取所有在点击位置的项
-        QList<QGraphicsItem*> items = this->items(event->scenePos());
-        Node* clickedNode = nullptr;
-        
-        // 遍历所有图形项，查找节点
-        for (QGraphicsItem* graphicsItem : items) {
-            if (Node *node = dynamic_cast<Node*>(graphicsItem)) {
-                clickedNode = node;
-                if (DEBUG_CONNECTION) {
-                    qDebug() << "找到节点:" << node->getName();
-                }
-                break;
-            }
-        }
+        // 通过端口索引查找点击位置的输出端口
+        PortIndex::Hit hit = m_portIndex.outputPortAt(event->scenePos(), Node::PORT_CAPTURE_RADIUS);
         
-        if (clickedNode) {
-            // 检查是否点击了输出端口，开始拖拽连线
-            int outputPortIndex = clickedNode->getOutputPortIndexAt(event->scenePos());
+        if (hit.node) {
+            qCDebug(lcScene) << "开始拖拽连线 - 从节点" << hit.node->getName() << "输出端口" << hit.port;
+            m_tempFromNode = hit.node;
+            m_tempFromPortIndex = hit.port;
+            m_connectionState = FromNodeClicked;
             
-            if (outputPortIndex >= 0) {
-                if (DEBUG_CONNECTION) qDebug() << "开始拖拽连线 - 从输出端口" << outputPortIndex;
-                m_tempFromNode = clickedNode;
-                m_tempFromPortIndex = outputPortIndex;
-                m_connectionState = FromNodeClicked;
-                
-                // 创建临时连接线（从指定端口开始）
-                QPointF startPos = clickedNode->getOutputPortPos(outputPortIndex);
-                m_tempLine = new QGraphicsLineItem(QLineF(startPos, event->scenePos()));
-                m_tempLine->setPen(QPen(Qt::cyan, 3, Qt::DashLine));
-                addItem(m_tempLine);
-                if (DEBUG_CONNECTION) qDebug() << "创建临时连接线完成";
-                return; // 阻止默认处理，开始拖拽连线
-            }
+            // 创建临时连接线（从指定端口开始）
+            QPointF startPos = hit.node->getOutputPortPos(hit.port);
+            m_tempLine = new QGraphicsLineItem(QLineF(startPos, event->scenePos()));
+            m_tempLine->setPen(QPen(Qt::cyan, 3, Qt::DashLine));
+            addItem(m_tempLine);
+            qCDebug(lcScene) << "创建临时连接线完成";
+            return; // 阻止默认处理，开始拖拽连线
         }
         
         // 如果不是从输出端口开始，则进行正常的节点选择操作
-        if (DEBUG_CONNECTION) qDebug() << "进行正常节点选择操作";
+        qCDebug(lcScene) << "进行正常节点选择操作";
         QGraphicsScene::mousePressEvent(event);
         emit selectionChanged(selectedItems().isEmpty() ? nullptr : selectedItems().first());
     } else if (event->button() == Qt::RightButton) {
-        if (DEBUG_CONNECTION) qDebug() << "右键点击 - 取消连接操作";
+        qCDebug(lcScene) << "右键点击 - 取消连接操作";
         // 右键取消连接操作
         if (m_connectionState != None) {
             cancelConnection();
@@ -455,11 +752,12 @@ void NodeScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
 
 void NodeScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
-    if (DEBUG_CONNECTION && (m_connectionState != None || m_tempLine)) {
-        qDebug() << "=== mouseMoveEvent ===";
-        qDebug() << "鼠标位置:" << event->scenePos();
-        qDebug() << "连接状态:" << m_connectionState;
-        qDebug() << "临时线存在:" << (m_tempLine != nullptr);
+    DAGFLOW_TRACE("scene.mouseMove", this, event->scenePos().x(), event->scenePos().y());
+    if (DAGFLOW_DEBUG_ENABLED(lcScene) && (m_connectionState != None || m_tempLine)) {
+        qCDebug(lcScene) << "=== mouseMoveEvent ===";
+        qCDebug(lcScene) << "鼠标位置:" << event->scenePos();
+        qCDebug(lcScene) << "连接状态:" << m_connectionState;
+        qCDebug(lcScene) << "临时线存在:" << (m_tempLine != nullptr);
     }
     
     // 更新临时连接线位置（如果在连接过程中）
@@ -467,87 +765,65 @@ void NodeScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
         QPointF startPos = m_tempFromNode->getOutputPortPos(m_tempFromPortIndex);
         QPointF endPos = event->scenePos();
         
-        // 检查是否靠近某个输入端口，如果是则吸附到该端口
-        QList<QGraphicsItem*> items = this->items(event->scenePos());
-        for (QGraphicsItem* graphicsItem : items) {
-            if (Node *node = dynamic_cast<Node*>(graphicsItem)) {
-                if (node != m_tempFromNode) {
-                    int inputPort = node->getInputPortIndexAt(event->scenePos());
-                    if (inputPort >= 0) {
-                        // 吸附到输入端口位置
-                        endPos = node->getInputPortPos(inputPort);
-                        // 改变临时线颜色表示可以连接
-                        m_tempLine->setPen(QPen(Qt::green, 3, Qt::DashLine));
-                        break;
-                    }
-                }
-            }
-        }
-        
-        // 如果没有吸附，恢复默认颜色
-        if (endPos == event->scenePos()) {
+        // 检查是否靠近某个输入端口，如果是则吸附到该端口并改变颜色表示可以连接
+        PortIndex::Hit hit = m_portIndex.inputPortAt(endPos, Node::PORT_CAPTURE_RADIUS, m_tempFromNode);
+        if (hit.node) {
+            endPos = hit.node->getInputPortPos(hit.port);
+            m_tempLine->setPen(QPen(Qt::green, 3, Qt::DashLine));
+        } else {
             m_tempLine->setPen(QPen(Qt::cyan, 3, Qt::DashLine));
         }
         
         QLineF newLine(startPos, endPos);
         m_tempLine->setLine(newLine);
-        if (DEBUG_CONNECTION) qDebug() << "更新临时连接线位置，从端口" << m_tempFromPortIndex;
+        qCDebug(lcScene) << "更新临时连接线位置，从端口" << m_tempFromPortIndex;
     }
     
     // 始终更新端口高亮状态
     updatePortHighlights(event->scenePos());
     
+    // 拖动产生的连接线更新在本次事件内合并完成，避免等到下一轮事件循环
+    m_synchronousFlushPending = true;
     QGraphicsScene::mouseMoveEvent(event);
+    m_synchronousFlushPending = false;
+    flushConnectionUpdates();
 }
 
 void NodeScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
-    if (DEBUG_CONNECTION) {
-        qDebug() << "=== NodeScene::mouseReleaseEvent ===";
-        qDebug() << "鼠标位置:" << event->scenePos();
-        qDebug() << "连接状态:" << m_connectionState;
+    DAGFLOW_TRACE("scene.mouseRelease", this, event->scenePos().x(), event->scenePos().y());
+    if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+        qCDebug(lcScene) << "=== NodeScene::mouseReleaseEvent ===";
+        qCDebug(lcScene) << "鼠标位置:" << event->scenePos();
+        qCDebug(lcScene) << "连接状态:" << m_connectionState;
     }
     
     // 处理拖拽连线的释放
     if (event->button() == Qt::LeftButton && m_connectionState == FromNodeClicked) {
-        // 查找释放位置附近的输入端口
-        Node* targetNode = nullptr;
-        int targetPortIndex = -1;
-        
-        // 获取释放位置附近的所有节点
-        QList<QGraphicsItem*> items = this->items(event->scenePos());
-        for (QGraphicsItem* graphicsItem : items) {
-            if (Node *node = dynamic_cast<Node*>(graphicsItem)) {
-                // 不能连接到自己
-                if (node != m_tempFromNode) {
-                    int inputPort = node->getInputPortIndexAt(event->scenePos());
-                    if (inputPort >= 0) {
-                        targetNode = node;
-                        targetPortIndex = inputPort;
-                        break;
-                    }
-                }
-            }
-        }
+        // 查找释放位置附近的输入端口（不能连接到自己）
+        PortIndex::Hit hit = m_portIndex.inputPortAt(event->scenePos(), Node::PORT_CAPTURE_RADIUS, m_tempFromNode);
+        Node* targetNode = hit.node;
+        int targetPortIndex = hit.port;
         
         // 如果找到了有效的目标端口，完成连线
         if (targetNode && targetPortIndex >= 0) {
-            if (DEBUG_CONNECTION) {
-                qDebug() << "完成连线 - 吸附到输入端口";
-                qDebug() << "源节点:" << m_tempFromNode->getName() << "端口:" << m_tempFromPortIndex;
-                qDebug() << "目标节点:" << targetNode->getName() << "端口:" << targetPortIndex;
+            if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+                qCDebug(lcScene) << "完成连线 - 吸附到输入端口";
+                qCDebug(lcScene) << "源节点:" << m_tempFromNode->getName() << "端口:" << m_tempFromPortIndex;
+                qCDebug(lcScene) << "目标节点:" << targetNode->getName() << "端口:" << targetPortIndex;
             }
             
-            // 创建连接
-            addConnection(m_tempFromNode, m_tempFromPortIndex, targetNode, targetPortIndex);
-            
-            // 清理临时状态
-            cleanupTempConnection();
-            
-            if (DEBUG_CONNECTION) qDebug() << "连线创建成功";
+            // 创建连接；会形成环路的连接被拒绝
+            if (addConnection(m_tempFromNode, m_tempFromPortIndex, targetNode, targetPortIndex)) {
+                // 清理临时状态
+                cleanupTempConnection();
+                qCDebug(lcScene) << "连线创建成功";
+            } else {
+                cancelConnection();
+            }
         } else {
             // 没有找到有效目标，取消连线
-            if (DEBUG_CONNECTION) qDebug() << "未找到有效目标端口，取消连线";
+            qCDebug(lcScene) << "未找到有效目标端口，取消连线";
             cancelConnection();
         }
         
@@ -563,7 +839,7 @@ void NodeScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
  */
 void NodeScene::cancelConnection()
 {
-    if (DEBUG_CONNECTION) qDebug() << "取消连线操作";
+    qCDebug(lcScene) << "取消连线操作";
     
     cleanupTempConnection();
     clearPortHighlights();
@@ -585,64 +861,230 @@ void NodeScene::cleanupTempConnection()
 }
 
 /**
- * @brief 清除所有端口高亮
+ * @brief 清除端口高亮（只重绘当前处于高亮状态的节点）
  */
 void NodeScene::clearPortHighlights()
 {
-    for (Node *node : m_nodes) {
-        node->setInputPortHighlighted(false);
-        node->setOutputPortHighlighted(false);
+    if (m_highlightedInputNode) {
+        m_highlightedInputNode->setInputPortHighlighted(false);
+        m_highlightedInputNode = nullptr;
+    }
+    if (m_highlightedOutputNode) {
+        m_highlightedOutputNode->setOutputPortHighlighted(false);
+        m_highlightedOutputNode = nullptr;
     }
 }
 
 /**
  * @brief 更新端口高亮状态
  * @param mousePos 鼠标当前位置
+ * 
+ * 通过端口索引只查询鼠标附近的端口；高亮目标没有变化时不触发任何重绘，
+ * 变化时只重绘失去和获得高亮的两个节点。
  */
 void NodeScene::updatePortHighlights(const QPointF &mousePos)
 {
-    if (DEBUG_CONNECTION) {
-        qDebug() << "=== updatePortHighlights ===";
-        qDebug() << "鼠标位置:" << mousePos;
-        qDebug() << "节点总数:" << m_nodes.size();
-    }
-    
-    // 首先清除所有高亮
-    clearPortHighlights();
+    Node *inputNode = nullptr;
+    Node *outputNode = nullptr;
     
     // 根据当前连接状态决定高亮哪些端口
     if (m_connectionState == FromNodeClicked) {
-        if (DEBUG_CONNECTION) qDebug() << "连接模式：高亮输入端口";
-        // 如果已点击源节点，高亮所有节点的输入端口
-        for (Node *node : m_nodes) {
-            if (node != m_tempFromNode) {  // 不能连接到自己
-                bool isAtInputPort = node->isPointAtInputPort(mousePos);
-                if (DEBUG_CONNECTION) {
-                    qDebug() << "检查节点" << node->getName() << "输入端口:" << isAtInputPort;
-                }
-                if (isAtInputPort) {
-                    node->setInputPortHighlighted(true);
-                    if (DEBUG_CONNECTION) qDebug() << "高亮输入端口:" << node->getName();
-                }
-            }
-        }
+        // 连接模式：高亮鼠标附近的输入端口（不能连接到自己）
+        inputNode = m_portIndex.inputPortAt(mousePos, Node::PORT_CAPTURE_RADIUS, m_tempFromNode).node;
     } else {
-        if (DEBUG_CONNECTION) qDebug() << "空闲模式：高亮输出端口";
-        // 检查鼠标是否在某个节点的输出端口附近
-        for (Node *node : m_nodes) {
-            bool isAtOutputPort = node->isPointAtOutputPort(mousePos);
-            if (DEBUG_CONNECTION) {
-                qDebug() << "检查节点" << node->getName() << "输出端口:" << isAtOutputPort;
-            }
-            if (isAtOutputPort) {
-                node->setOutputPortHighlighted(true);
-                if (DEBUG_CONNECTION) qDebug() << "高亮输出端口:" << node->getName();
-                break;  // 一次只高亮一个输出端口
-            }
+        // 空闲模式：高亮鼠标附近的输出端口
+        outputNode = m_portIndex.outputPortAt(mousePos, Node::PORT_CAPTURE_RADIUS).node;
+    }
+    
+    if (inputNode != m_highlightedInputNode) {
+        if (m_highlightedInputNode) m_highlightedInputNode->setInputPortHighlighted(false);
+        if (inputNode) inputNode->setInputPortHighlighted(true);
+        m_highlightedInputNode = inputNode;
+        DAGFLOW_TRACE("scene.inputHighlight", inputNode);
+        qCDebug(lcScene) << "高亮输入端口:" << (inputNode ? inputNode->getName() : "无");
+    }
+    if (outputNode != m_highlightedOutputNode) {
+        if (m_highlightedOutputNode) m_highlightedOutputNode->setOutputPortHighlighted(false);
+        if (outputNode) outputNode->setOutputPortHighlighted(true);
+        m_highlightedOutputNode = outputNode;
+        DAGFLOW_TRACE("scene.outputHighlight", outputNode);
+        qCDebug(lcScene) << "高亮输出端口:" << (outputNode ? outputNode->getName() : "无");
+    }
+}
+
+/**
+ * @brief 标记节点的所有连接线需要刷新
+ * @param node 节点指针
+ */
+void NodeScene::markConnectionsDirty(Node *node)
+{
+    for (Connection *conn : node->getConnections()) {
+        m_dirtyConnections.insert(conn);
+    }
+    
+    // 鼠标拖动时由 mouseMoveEvent 在事件结束前同步刷新；其他移动（撤销、粘贴等）
+    // 由排队调用在下一次绘制前统一刷新，已排队的调用还未执行时不再重复投递
+    if (m_synchronousFlushPending || m_connectionFlushPending || m_dirtyConnections.isEmpty()) {
+        return;
+    }
+    m_connectionFlushPending = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_connectionFlushPending = false;
+        flushConnectionUpdates();
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief 立即刷新所有待更新的连接线
+ * 
+ * 两端节点一起移动的连接线只做平移，其余连接线重新计算路径。
+ */
+void NodeScene::flushConnectionUpdates()
+{
+    if (m_dirtyConnections.isEmpty()) {
+        return;
+    }
+    
+    QSet<Connection*> dirty;
+    dirty.swap(m_dirtyConnections);
+    DAGFLOW_TRACE("scene.flushConnections", this, dirty.size());
+    for (Connection *conn : dirty) {
+        conn->refreshPath();
+    }
+}
+
+/**
+ * @brief 刷新节点在端口索引中的条目
+ * @param node 节点指针
+ */
+void NodeScene::updatePortIndex(Node *node)
+{
+    m_portIndex.update(node);
+    ensureSceneRectContains(node->sceneBoundingRect());
+}
+
+/**
+ * @brief 开始批量操作
+ */
+void NodeScene::beginBulkUpdate()
+{
+    if (m_bulkUpdateDepth++ == 0) {
+        DAGFLOW_TRACE("scene.bulkBegin", this, items().size());
+        setItemIndexMethod(QGraphicsScene::NoIndex);
+    }
+}
+
+/**
+ * @brief 一次修改的图形项是否多到值得进入批量模式
+ * @param itemCount 要添加或移除的节点和连接数量
+ * @return 值得时返回true
+ */
+bool NodeScene::isLargeBatch(int itemCount) const
+{
+    const int sceneItems = m_nodes.size() + m_connections.size();
+    return itemCount >= kBulkUpdateMinItems && itemCount * 4 >= sceneItems;
+}
+
+/**
+ * @brief 结束批量操作
+ * 
+ * 场景边界在这里按图形项范围重新计算，因此删除或重新加载后也可以收缩。
+ */
+void NodeScene::endBulkUpdate()
+{
+    if (m_bulkUpdateDepth == 0 || --m_bulkUpdateDepth > 0) {
+        return;
+    }
+    
+    m_occupiedBounds = itemsBoundingRect();
+    QRectF bounds = m_occupiedBounds.isEmpty()
+        ? kMinimumSceneRect
+        : m_occupiedBounds.adjusted(-kSceneMargin, -kSceneMargin, kSceneMargin, kSceneMargin)
+                          .united(kMinimumSceneRect);
+    if (bounds != sceneRect()) {
+        setSceneRect(bounds);
+    }
+    
+    // BSP索引在下一次查询时才构建，切回后立即设置深度不会按旧深度多建一次
+    setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+    rebalanceIndex();
+    DAGFLOW_TRACE("scene.bulkEnd", this, items().size(), bspTreeDepth());
+}
+
+/**
+ * @brief 确保场景边界包含给定矩形
+ * @param rect 场景坐标矩形
+ * 
+ * 扩展时按当前尺寸的一半向外留出余量，连续把节点拖出边界时只会触发少数几次索引重建。
+ */
+void NodeScene::ensureSceneRectContains(const QRectF &rect)
+{
+    m_occupiedBounds = m_occupiedBounds.isEmpty() ? rect : m_occupiedBounds.united(rect);
+    if (m_bulkUpdateDepth > 0) {
+        return;
+    }
+    
+    const QRectF current = sceneRect();
+    if (!current.contains(rect)) {
+        const qreal marginX = qMax(current.width() * 0.5, kSceneMargin);
+        const qreal marginY = qMax(current.height() * 0.5, kSceneMargin);
+        setSceneRect(current.united(rect.adjusted(-marginX, -marginY, marginX, marginY)));
+        qCDebug(lcScene) << "场景边界扩展为" << sceneRect();
+        rebalanceIndex();
+    } else {
+        // 图形项数量变化一倍以上时重新选择深度
+        const int count = m_nodes.size() + m_connections.size();
+        if (count > 2 * m_indexedItemCount || count < m_indexedItemCount / 2) {
+            rebalanceIndex();
         }
     }
 }
 
+/**
+ * @brief 按图形项数量和占用区域重新选择BSP树深度
+ * 
+ * 深度为d的BSP树把场景边界划分为2^d个叶子，其中落在已占用区域内的约占
+ * 占用面积/场景面积。选择最小的d，使占用区域内每个叶子平均不超过 kItemsPerBspLeaf 个图形项。
+ * 场景边界留有较大余量时，只按项数估计会得到过浅的树。
+ */
+void NodeScene::rebalanceIndex()
+{
+    if (itemIndexMethod() != QGraphicsScene::BspTreeIndex) {
+        return;
+    }
+    
+    const int count = m_nodes.size() + m_connections.size();
+    m_indexedItemCount = count;
+    
+    const QRectF bounds = sceneRect();
+    const qreal sceneArea = bounds.width() * bounds.height();
+    const QRectF occupied = m_occupiedBounds.intersected(bounds);
+    qreal occupiedFraction = 1.0;
+    if (sceneArea > 0 && !occupied.isEmpty()) {
+        occupiedFraction = qBound(qreal(1e-4), occupied.width() * occupied.height() / sceneArea, qreal(1.0));
+    }
+    
+    const qreal leaves = qMax(qreal(1.0), count / (kItemsPerBspLeaf * occupiedFraction));
+    const int depth = qBound(2, qCeil(std::log2(leaves)), 18);
+    if (depth != bspTreeDepth()) {
+        qCDebug(lcScene) << "BSP深度" << bspTreeDepth() << "->" << depth << "图形项:" << count;
+        setBspTreeDepth(depth);
+    }
+}
+
+/**
+ * @brief 从端口索引中移除节点
+ * @param node 节点指针
+ * 
+ * 同时清除指向该节点的高亮记录，避免之后访问已离开场景或已析构的节点。
+ */
+void NodeScene::removeFromPortIndex(Node *node)
+{
+    m_portIndex.remove(node);
+    if (m_highlightedInputNode == node) m_highlightedInputNode = nullptr;
+    if (m_highlightedOutputNode == node) m_highlightedOutputNode = nullptr;
+}
+
 /**
  * @brief 当节点模板更新时更新场景中的相应节点
  * @param typeId 更新的模板类型ID
@@ -651,33 +1093,59 @@ void NodeScene::updatePortHighlights(const QPointF &mousePos)
  */
 void NodeScene::onTemplateUpdated(const QString &typeId)
 {
-    // 获取更新后的模板
-    NodeTemplate tmpl = NodeLibrary::instance()->getTemplate(typeId);
-    if (!tmpl.isValid()) {
+    // 获取更新后的模板（不复制）
+    const NodeTemplate *tmpl = NodeLibrary::instance()->findTemplate(typeId);
+    if (!tmpl || !tmpl->isValid()) {
         return;
     }
     
-    // 遍历所有节点，更新匹配类型的节点
-    for (Node *node : m_nodes) {
-        if (node->getType() == typeId) {
-            // 更新节点的显示属性
-            node->setCustomColor(tmpl.getColor());
-            node->setDisplayTypeName(tmpl.getDisplayName());
-            node->setInputPortCount(tmpl.getInputPortCount());
-            node->setOutputPortCount(tmpl.getOutputPortCount());
-            
-            if (DEBUG_CONNECTION) {
-                qDebug() << "更新节点:" << node->getName() 
-                         << "类型:" << typeId
-                         << "颜色:" << tmpl.getColor().name()
-                         << "输入端口:" << tmpl.getInputPortCount()
-                         << "输出端口:" << tmpl.getOutputPortCount();
-            }
+    // 只处理该类型的节点；各节点只重绘自身区域，回到事件循环后合并为一次绘制
+    const QList<Node*> nodes = m_typeIndex.value(typeId);
+    for (Node *node : nodes) {
+        // 更新节点的显示属性
+        node->setCustomColor(tmpl->getColor());
+        node->setDisplayTypeName(tmpl->getDisplayName());
+        node->setInputPortCount(tmpl->getInputPortCount());
+        node->setOutputPortCount(tmpl->getOutputPortCount());
+        emit nodeChanged(node);
+        
+        if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+            qCDebug(lcScene) << "更新节点:" << node->getName() 
+                     << "类型:" << typeId
+                     << "颜色:" << tmpl->getColor().name()
+                     << "输入端口:" << tmpl->getInputPortCount()
+                     << "输出端口:" << tmpl->getOutputPortCount();
         }
     }
-    
-    // 更新场景显示
-    update();
+}
+
+/**
+ * @brief 节点类型改变后更新类型索引
+ */
+void NodeScene::updateNodeTypeIndex(Node *node, const QString &oldType)
+{
+    if (m_nodeIndex.value(node->getId()) != node) {
+        return;  // 不在场景顶层的节点（如组节点内部节点）不建索引
+    }
+    removeFromTypeIndex(node, oldType);
+    m_typeIndex[node->getType()].append(node);
+}
+
+/**
+ * @brief 从类型索引中移除节点
+ * @param node 节点
+ * @param typeId 节点在索引中的类型ID
+ */
+void NodeScene::removeFromTypeIndex(Node *node, const QString &typeId)
+{
+    auto it = m_typeIndex.find(typeId);
+    if (it == m_typeIndex.end()) {
+        return;
+    }
+    it->removeOne(node);
+    if (it->isEmpty()) {
+        m_typeIndex.erase(it);
+    }
 }
 
 /**
@@ -747,7 +1215,7 @@ void NodeScene::copySelected()
     m_clipboard["nodes"] = nodesArray;
     m_clipboard["connections"] = connectionsArray;
     
-    qDebug() << "复制了" << selectedNodes.size() << "个节点和" 
+    qCDebug(lcScene) << "复制了" << selectedNodes.size() << "个节点和" 
              << connectionsArray.size() << "条连接";
 }
 
@@ -910,8 +1378,8 @@ bool NodeScene::groupSelected()
         cmd->getGroupNode()->setSelected(true);
     }
     
-    qDebug() << "打包了" << nodesToGroup.size() << "个节点";
-    qDebug() << "内部连接:" << internalConnections.size() << "外部连接:" << externalConnections.size();
+    qCDebug(lcScene) << "打包了" << nodesToGroup.size() << "个节点";
+    qCDebug(lcScene) << "内部连接:" << internalConnections.size() << "外部连接:" << externalConnections.size();
     
     return true;
 }
@@ -953,7 +1421,168 @@ bool NodeScene::ungroupSelected()
         node->setSelected(true);
     }
     
-    qDebug() << "拆分组节点，恢复了" << groupNode->getInternalNodes().size() << "个节点";
+    qCDebug(lcScene) << "拆分组节点，恢复了" << groupNode->getInternalNodes().size() << "个节点";
     
     return true;
 }
+
+/**
+ * @brief 将纳秒耗时格式化为便于阅读的字符串
+ * @param ns 纳秒数
+ * @return 带单位的耗时字符串
+ */
+static QString formatDuration(double ns)
+{
+    if (ns >= 1e9) return QString("%1 s").arg(ns / 1e9, 0, 'f', 2);
+    if (ns >= 1e6) return QString("%1 ms").arg(ns / 1e6, 0, 'f', 2);
+    if (ns >= 1e3) return QString("%1 us").arg(ns / 1e3, 0, 'f', 1);
+    return QString("%1 ns").arg(ns, 0, 'f', 0);
+}
+
+/**
+ * @brief 从文件加载性能报告并叠加到画布上
+ */
+bool NodeScene::loadProfileReport(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "无法打开性能报告:" << fileName;
+        return false;
+    }
+    
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "性能报告解析失败:" << parseError.errorString();
+        return false;
+    }
+    return applyProfileReport(doc.object());
+}
+
+/**
+ * @brief 将性能报告叠加到画布上
+ */
+bool NodeScene::applyProfileReport(const QJsonObject &report)
+{
+    if (report["format"].toString() != "dagflow-profile") {
+        qWarning() << "不是有效的性能报告，format字段为:" << report["format"].toString();
+        return false;
+    }
+    
+    // 报告条目按ID和名称建立索引
+    QHash<QString, QJsonObject> entriesById;
+    QHash<QString, QJsonObject> entriesByName;
+    for (const QJsonValue &value : report["nodes"].toArray()) {
+        QJsonObject entry = value.toObject();
+        entriesById.insert(entry["id"].toString(), entry);
+        entriesByName.insert(entry["name"].toString(), entry);
+    }
+    
+    // 匹配场景中的节点
+    QHash<Node*, QJsonObject> matched;
+    double totalNs = 0.0;
+    double maxNs = 0.0;
+    double maxBytes = 0.0;
+    for (Node *node : m_nodes) {
+        QJsonObject entry = entriesById.value(node->idString());
+        if (entry.isEmpty()) {
+            entry = entriesByName.value(node->getName());
+        }
+        if (entry.isEmpty()) {
+            continue;
+        }
+        matched.insert(node, entry);
+        double ns = entry["median_ns"].toDouble();
+        totalNs += ns;
+        maxNs = qMax(maxNs, ns);
+        maxBytes = qMax(maxBytes, entry["output_bytes"].toDouble());
+    }
+    
+    if (matched.isEmpty()) {
+        qWarning() << "性能报告中没有与当前画布匹配的节点";
+        return false;
+    }
+    
+    // 以中位数耗时为权重求最长路径（关键路径）
+    QMap<QString, QStringList> dependencies;
+    for (Node *node : m_nodes) {
+        dependencies[node->idString()];
+    }
+    for (Connection *conn : m_connections) {
+        dependencies[conn->getToNode()->idString()].append(conn->getFromNode()->idString());
+    }
+    
+    FlowScheduler scheduler(dependencies);
+    QVector<double> pathCost(scheduler.nodeCount(), 0.0);
+    QVector<int> pathPrev(scheduler.nodeCount(), -1);
+    int pathEnd = -1;
+    for (int index : scheduler.orderIndices()) {
+        double best = 0.0;
+        for (int pred : scheduler.predecessors(index)) {
+            if (pathPrev[index] < 0 || pathCost[pred] > best) {
+                best = pathCost[pred];
+                pathPrev[index] = pred;
+            }
+        }
+        Node *node = nodeById(Node::idFromString(scheduler.nodeId(index)));
+        pathCost[index] = best + matched.value(node)["median_ns"].toDouble();
+        if (pathEnd < 0 || pathCost[index] > pathCost[pathEnd]) {
+            pathEnd = index;
+        }
+    }
+    
+    QSet<Node*> criticalNodes;
+    QSet<QPair<Node*, Node*>> criticalEdges;
+    for (int index = pathEnd; index >= 0; index = pathPrev[index]) {
+        Node *node = nodeById(Node::idFromString(scheduler.nodeId(index)));
+        criticalNodes.insert(node);
+        if (pathPrev[index] >= 0) {
+            Node *prev = nodeById(Node::idFromString(scheduler.nodeId(pathPrev[index])));
+            criticalEdges.insert(qMakePair(prev, node));
+        }
+    }
+    
+    // 更新节点和连线的显示
+    for (Node *node : m_nodes) {
+        auto it = matched.constFind(node);
+        if (it == matched.constEnd()) {
+            node->clearProfileOverlay();
+            continue;
+        }
+        double ns = it.value()["median_ns"].toDouble();
+        double share = totalNs > 0.0 ? ns / totalNs : 0.0;
+        QString label = QString("%1% · %2").arg(share * 100.0, 0, 'f', 1).arg(formatDuration(ns));
+        node->setProfileOverlay(maxNs > 0.0 ? ns / maxNs : 0.0, label, criticalNodes.contains(node));
+    }
+    
+    for (Connection *conn : m_connections) {
+        auto it = matched.constFind(conn->getFromNode());
+        if (it == matched.constEnd()) {
+            conn->setProfileWeight(-1.0, false);
+            continue;
+        }
+        double bytes = it.value()["output_bytes"].toDouble();
+        conn->setProfileWeight(maxBytes > 0.0 ? bytes / maxBytes : 0.0,
+                               criticalEdges.contains(qMakePair(conn->getFromNode(), conn->getToNode())));
+    }
+    
+    if (DAGFLOW_DEBUG_ENABLED(lcScene)) {
+        qCDebug(lcScene) << "性能报告已加载，匹配节点数:" << matched.size()
+                 << "关键路径节点数:" << criticalNodes.size()
+                 << "关键路径耗时:" << formatDuration(pathEnd >= 0 ? pathCost[pathEnd] : 0.0);
+    }
+    return true;
+}
+
+/**
+ * @brief 清除画布上的性能报告叠加
+ */
+void NodeScene::clearProfile()
+{
+    for (Node *node : m_nodes) {
+        node->clearProfileOverlay();
+    }
+    for (Connection *conn : m_connections) {
+        conn->setProfileWeight(-1.0, false);
+    }
+}
@@ -11,12 +11,15 @@
 
 #include "qjsonobject.h"
 #include <QGraphicsScene>              // Qt图形场景基类
+#include <QJsonArray>                  // JSON数组类
 #include <QObject>                     // Qt对象基类
 #include <QDebug>                      // 调试输出类
 #include <QUndoStack>                  // 撤销栈类
-
-// 调试开关：设置为true启用连线调试输出
-static const bool DEBUG_CONNECTION = true;
+#include <QSet>                        // 集合类
+#include <QHash>                       // 哈希表类
+#include <QVector>                     // 向量类
+#include "PortIndex.h"                 // 端口空间索引类
+#include "TopologyIndex.h"             // 拓扑序索引类
 
 // 前向声明
 class Node;                            // 节点类
@@ -33,6 +36,9 @@ class GroupNode;                       // 组节点类
  * - 场景的交互模式管理
  * - 数据的序列化和反序列化
  * - 流程图的验证
+ * 
+ * 场景边界随节点位置自动扩展，BSP索引深度按图形项数量和实际占用区域调整；
+ * 批量操作期间关闭索引，结束后一次性重建。
  */
 class NodeScene : public QGraphicsScene
 {
@@ -47,6 +53,26 @@ public:
         FromNodeClicked  // 已点击源节点，等待目标节点
     };
     
+    /**
+     * @class BulkUpdateGuard
+     * @brief 批量操作守卫，构造时调用 beginBulkUpdate，析构时调用 endBulkUpdate
+     *
+     * 给出图形项数量时只在 isLargeBatch() 成立时进入批量模式；
+     * 小批量修改逐项更新BSP索引，不付出重建整个索引的代价。
+     */
+    class BulkUpdateGuard
+    {
+    public:
+        explicit BulkUpdateGuard(NodeScene *scene) : m_scene(scene) { if (m_scene) m_scene->beginBulkUpdate(); }
+        BulkUpdateGuard(NodeScene *scene, int itemCount)
+            : m_scene(scene && scene->isLargeBatch(itemCount) ? scene : nullptr) { if (m_scene) m_scene->beginBulkUpdate(); }
+        ~BulkUpdateGuard() { if (m_scene) m_scene->endBulkUpdate(); }
+        BulkUpdateGuard(const BulkUpdateGuard &) = delete;
+        BulkUpdateGuard &operator=(const BulkUpdateGuard &) = delete;
+    private:
+        NodeScene *m_scene;
+    };
+    
     /**
      * @brief 构造函数
      * @param parent 父对象指针，默认为nullptr
@@ -62,6 +88,52 @@ public:
      */
     QUndoStack* undoStack() { return &m_undoStack; }
     
+    /**
+     * @brief 通知节点的显示属性已变化（发出 nodeChanged 信号）
+     * @param node 变化的节点
+     */
+    void notifyNodeChanged(Node *node) { emit nodeChanged(node); }
+    
+    /**
+     * @brief 撤销历史的默认内存预算（字节）
+     */
+    static constexpr qint64 DEFAULT_UNDO_MEMORY_BUDGET = 64 * 1024 * 1024;
+    
+    /**
+     * @brief 撤销一步
+     * 
+     * 因超出内存预算而被释放的命令不能撤销，撤销到它们之前时不做任何操作。
+     */
+    void undo();
+    
+    /**
+     * @brief 重做一步
+     */
+    void redo();
+    
+    /**
+     * @brief 设置撤销历史的内存预算
+     * @param bytes 字节数，0表示不限制
+     * 
+     * 超出预算时从最旧的命令开始释放其撤销状态（删除命令持有的已删除节点和连接等），
+     * 被释放的命令留在栈中但不能再撤销；最近执行的一条命令总是可以撤销。
+     */
+    void setUndoMemoryBudget(qint64 bytes);
+    
+    /**
+     * @brief 获取撤销历史的内存预算
+     * @return 字节数，0表示不限制
+     */
+    qint64 undoMemoryBudget() const { return m_undoMemoryBudget; }
+    
+    /**
+     * @brief 估算撤销历史当前占用的内存
+     * @return 未释放的命令占用的字节数（见 SceneUndoCommand::memoryCost）
+     *
+     * 返回随撤销栈变化增量维护的合计值，不遍历撤销历史。
+     */
+    qint64 undoMemoryUsage() const { return m_undoUsage; }
+    
     /**
      * @brief 在指定位置添加新节点
      * @param type 节点类型
@@ -110,6 +182,27 @@ public:
      */
     QList<Node*>& getNodes() { return m_nodes; }
     
+    /**
+     * @brief 按持久ID查找场景中的节点
+     * @param id 节点ID（Node::getId）
+     * @return 找到的节点，不在场景中返回nullptr
+     */
+    Node* nodeById(quint64 id) const { return m_nodeIndex.value(id, nullptr); }
+    
+    /**
+     * @brief 获取场景中指定类型的节点
+     * @param typeId 节点类型ID
+     * @return 该类型的节点（按加入场景的顺序），不遍历全部节点
+     */
+    QList<Node*> nodesOfType(const QString &typeId) const { return m_typeIndex.value(typeId); }
+    
+    /**
+     * @brief 节点类型改变后更新类型索引（由 Node::setType 调用）
+     * @param node 节点
+     * @param oldType 原来的类型ID
+     */
+    void updateNodeTypeIndex(Node *node, const QString &oldType);
+    
     /**
      * @brief 获取连接列表（供撤销系统使用）
      * @return 连接列表的引用
@@ -129,12 +222,35 @@ public:
      * @param fromPortIndex 源节点的输出端口索引
      * @param toNode 目标节点
      * @param toPortIndex 目标节点的输入端口索引
+     * @return 创建了连接返回true；连接会形成环路时拒绝并返回false
+     */
+    bool addConnection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex);
+    
+    /**
+     * @brief 将新建的连接加入场景（端点已由 Connection 构造函数登记，供撤销系统使用）
+     * @param conn 连接线
      */
-    void addConnection(Node *fromNode, int fromPortIndex, Node *toNode, int toPortIndex);
+    void insertConnectionToScene(Connection *conn);
+    
+    /**
+     * @brief 在两个节点之间加入连接是否会形成环路
+     * @param fromNode 源节点
+     * @param toNode 目标节点
+     * @return 会形成环路返回true
+     *
+     * 只搜索拓扑序位于两节点之间的受影响区域，不遍历整个图。
+     */
+    bool wouldCreateCycle(Node *fromNode, Node *toNode) const { return m_topology.wouldCreateCycle(fromNode, toNode); }
+    
+    /**
+     * @brief 获取随连接增删增量维护的拓扑序索引
+     * @return 拓扑序索引
+     */
+    const TopologyIndex& topology() const { return m_topology; }
     
     /**
      * @brief 验证当前流程图的有效性
-     * @return 验证是否通过
+     * @return 验证是否通过（连接端点都在场景中且没有环路）
      */
     bool validateFlow() const;
     
@@ -150,6 +266,108 @@ public:
      */
     void loadFlowData(const QJsonObject &data);
     
+    /**
+     * @brief 清空流程图（节点、连接和撤销记录）
+     */
+    void clearFlow();
+    
+    /**
+     * @brief 批量导入节点和连接（追加到当前场景，不记录撤销命令）
+     * @param nodesArray 节点JSON数组，格式与 getFlowData 的 "nodes" 相同
+     * @param connectionsArray 连接JSON数组，格式与 getFlowData 的 "connections" 相同
+     * @return 导入的节点数
+     * 
+     * 节点在线程池中并行构造，ID用哈希表查找，加入场景期间关闭索引并屏蔽信号，
+     * 连接线路径在全部连接创建后统一计算一次。等价于依次调用
+     * beginImport、importNodes、importConnections 和 endImport。
+     */
+    int importFlowItems(const QJsonArray &nodesArray, const QJsonArray &connectionsArray);
+    
+    /**
+     * @brief 开始分块导入（可在分块之间回到事件循环，见 ProjectIO）
+     */
+    void beginImport();
+    
+    /**
+     * @brief 导入一段节点
+     * @param nodesArray 节点JSON数组
+     * @param begin 起始下标
+     * @param count 导入的个数
+     * @return 导入的节点数
+     */
+    int importNodes(const QJsonArray &nodesArray, int begin, int count);
+    
+    /**
+     * @brief 导入一段连接（端点节点须已在本次导入中由 importNodes 导入）
+     * @param connectionsArray 连接JSON数组
+     * @param begin 起始下标
+     * @param count 导入的个数
+     * @return 导入的连接数
+     */
+    int importConnections(const QJsonArray &connectionsArray, int begin, int count);
+    
+    /**
+     * @brief 导入一批已构造好的节点（例如从二进制项目文件在工作线程中构造的节点）
+     * @param nodes 尚未加入场景的节点，空指针会被跳过
+     * @param ids 与 nodes 一一对应的文件中的节点ID，供 importConnection 查找端点
+     * @return 导入的节点数
+     */
+    int importBuiltNodes(const QList<Node*> &nodes, const QStringList &ids);
+    
+    /**
+     * @brief 导入一条连接（端点节点须已在本次导入中导入）
+     * @param fromNodeId 源节点在文件中的ID
+     * @param fromPort 源节点输出端口索引
+     * @param toNodeId 目标节点在文件中的ID
+     * @param toPort 目标节点输入端口索引
+     * @param lineType 连线类型（Connection::LineType 的值）
+     * @return 端点存在并创建了连接返回true
+     */
+    bool importConnection(const QString &fromNodeId, int fromPort, const QString &toNodeId, int toPort,
+                          int lineType);
+    
+    /**
+     * @brief 结束分块导入：统一计算连接线路径并重建场景索引
+     */
+    void endImport();
+    
+    /**
+     * @brief 设置流式处理的块大小（保存在流程元数据中）
+     * @param blockSize 每块采样点数，0表示生成代码按整段信号处理
+     */
+    void setBlockSize(int blockSize) { m_blockSize = qMax(0, blockSize); }
+    
+    /**
+     * @brief 获取流式处理的块大小
+     * @return 每块采样点数，0表示不使用流式处理
+     */
+    int blockSize() const { return m_blockSize; }
+    
+    /**
+     * @brief 从文件加载生成代码写出的性能报告并叠加到画布上
+     * @param fileName 性能报告文件路径（profile_report.json）
+     * @return 加载成功返回true
+     */
+    bool loadProfileReport(const QString &fileName);
+    
+    /**
+     * @brief 将性能报告叠加到画布上
+     * @param report 格式为 "dagflow-profile" 的性能报告
+     * @return 至少匹配到一个节点返回true
+     * 
+     * 报告中的节点先按ID匹配（与getFlowData生成的ID一致），再按名称匹配，
+     * 因此重新打开项目后仍可加载之前导出代码生成的报告：
+     * - 节点按中位数耗时占总耗时的比例着色
+     * - 连线按源节点每次执行输出的数据量加粗
+     * - 以中位数耗时为权重的最长路径（关键路径）用橙色标出
+     */
+    bool applyProfileReport(const QJsonObject &report);
+    
+    /**
+     * @brief 清除画布上的性能报告叠加
+     */
+    void clearProfile();
+    
     /**
      * @brief 删除当前选中的所有元素
      */
@@ -162,7 +380,7 @@ public:
     QGraphicsItem* getSelectedNode() const;
     
     /**
-     * @brief 清除所有端口高亮
+     * @brief 清除端口高亮（只重绘当前处于高亮状态的节点）
      */
     void clearPortHighlights();
     
@@ -172,6 +390,81 @@ public:
      */
     void updatePortHighlights(const QPointF &mousePos);
     
+    /**
+     * @brief 刷新节点在端口索引中的条目（节点加入场景、移动或几何变化时由节点调用）
+     * @param node 节点指针
+     */
+    void updatePortIndex(Node *node);
+    
+    /**
+     * @brief 从端口索引中移除节点（节点离开场景或析构时由节点调用）
+     * @param node 节点指针
+     */
+    void removeFromPortIndex(Node *node);
+    
+    /**
+     * @brief 标记节点的所有连接线需要刷新（节点移动时由节点调用）
+     * @param node 节点指针
+     * 
+     * 连接线不会立即重算，而是合并到待更新集合中：同一批移动里被两端节点重复标记的
+     * 连接线只刷新一次，刷新在当前事件处理完后、下一次绘制前进行。
+     */
+    void markConnectionsDirty(Node *node);
+    
+    /**
+     * @brief 立即刷新所有待更新的连接线
+     */
+    void flushConnectionUpdates();
+    
+    /**
+     * @brief 从待更新集合中移除连接线（连接线离开场景或析构时由连接线调用）
+     * @param conn 连接线指针
+     */
+    void discardConnectionUpdate(Connection *conn) { m_dirtyConnections.remove(conn); }
+    
+    /**
+     * @brief 开始批量操作（可嵌套）
+     * 
+     * 最外层调用时关闭场景的BSP索引，期间大量添加、移除图形项不再逐个更新索引，
+     * 场景边界也暂不扩展。
+     */
+    void beginBulkUpdate();
+    
+    /**
+     * @brief 结束批量操作
+     * 
+     * 最外层调用时按图形项的实际范围重新计算场景边界，选择BSP深度并一次性重建索引。
+     */
+    void endBulkUpdate();
+    
+    /**
+     * @brief 一次修改的图形项是否多到值得进入批量模式
+     * @param itemCount 要添加或移除的节点和连接数量
+     * @return 数量达到 kBulkUpdateMinItems 且不少于场景现有图形项的四分之一时返回true
+     *
+     * 结束批量操作要重新计算全部图形项的范围并重建BSP索引，代价与场景规模成正比；
+     * 只有大批量修改时才比逐项更新索引更快。
+     */
+    bool isLargeBatch(int itemCount) const;
+    
+    /**
+     * @brief 是否处于批量操作中
+     * @return 批量操作中返回true
+     */
+    bool isBulkUpdating() const { return m_bulkUpdateDepth > 0; }
+    
+    /**
+     * @brief 确保场景边界包含给定矩形，必要时向外扩展（节点加入场景或移动时调用）
+     * @param rect 场景坐标矩形
+     */
+    void ensureSceneRectContains(const QRectF &rect);
+    
+    /**
+     * @brief 获取端口空间索引
+     * @return 端口索引的常量引用
+     */
+    const PortIndex& portIndex() const { return m_portIndex; }
+    
     /**
      * @brief 取消当前连线操作
      */
@@ -244,6 +537,35 @@ signals:
      * @brief 连接创建完成时发出的信号
      */
     void connectionCreated();
+    
+    /**
+     * @brief 连接因会形成环路被拒绝时发出的信号
+     * @param reason 拒绝原因
+     */
+    void connectionRejected(const QString &reason);
+    
+    /**
+     * @brief 节点加入场景后发出的信号（节点追加在 getNodes 的末尾）
+     * @param nodes 新加入的节点，批量导入时整批发出一次
+     */
+    void nodesInserted(const QList<Node*> &nodes);
+    
+    /**
+     * @brief 节点移出场景后发出的信号（节点未被删除）
+     * @param node 被移出的节点
+     */
+    void nodeRemoved(Node *node);
+    
+    /**
+     * @brief 节点的名称、等级等显示属性变化时发出的信号
+     * @param node 变化的节点
+     */
+    void nodeChanged(Node *node);
+    
+    /**
+     * @brief 流程图被清空后发出的信号（节点已被删除）
+     */
+    void nodesCleared();
 
 public slots:
     /**
@@ -278,10 +600,80 @@ private:
     QGraphicsLineItem *m_tempLine;  ///< 临时连接线（用于可视化连接过程）
     
     QList<Node*> m_nodes;            ///< 场景中所有节点的列表
+    QHash<quint64, Node*> m_nodeIndex;  ///< 节点ID到场景中节点的映射
+    QHash<QString, QList<Node*>> m_typeIndex;  ///< 节点类型ID到场景中该类型节点的映射
     QList<Connection*> m_connections; ///< 场景中所有连接线的列表
     
+    PortIndex m_portIndex;           ///< 端口空间索引（用于悬停高亮和连线吸附）
+    TopologyIndex m_topology;        ///< 拓扑序索引（用于环路检测和流程验证）
+    Node *m_highlightedInputNode;    ///< 当前高亮输入端口的节点
+    Node *m_highlightedOutputNode;   ///< 当前高亮输出端口的节点
+    
+    QSet<Connection*> m_dirtyConnections; ///< 待刷新路径的连接线
+    bool m_connectionFlushPending;   ///< 是否已投递批量刷新
+    bool m_synchronousFlushPending;  ///< 是否正在处理鼠标移动（事件结束前同步刷新，不需要排队）
+    
+    /**
+     * @brief 从JSON创建一个节点（包括组节点及其内部子图），可在工作线程中调用
+     * @param nodeObj 节点JSON对象
+     * @return 新建的节点，尚未加入场景
+     */
+    static Node* nodeFromJson(const QJsonObject &nodeObj);
+    
+    /**
+     * @brief 按图形项数量和占用区域重新选择BSP树深度
+     */
+    void rebalanceIndex();
+    
+    /**
+     * @brief 撤销栈变化后检查内存预算，超出时释放最旧的命令
+     */
+    void enforceUndoBudget();
+    
+    /**
+     * @brief 撤销栈变化后更新各命令的内存估算和合计值
+     * 
+     * 只重新估算这次变化可能影响的命令：新压入或被替换的命令、合并后的栈顶命令，
+     * 以及撤销位置移动经过的命令；被丢弃的可重做命令从合计中减去。
+     */
+    void syncUndoCosts();
+    
+    /**
+     * @brief 重新估算一条命令的内存并更新合计值
+     * @param index 命令在撤销栈中的下标
+     */
+    void refreshUndoCost(int index);
+    
+    /**
+     * @brief 从类型索引中移除节点
+     * @param node 节点
+     * @param typeId 节点在索引中的类型ID
+     */
+    void removeFromTypeIndex(Node *node, const QString &typeId);
+    
+    int m_bulkUpdateDepth;           ///< 批量操作嵌套层数
+    QRectF m_occupiedBounds;         ///< 节点实际占用的区域（只增不减，批量操作结束时重新计算）
+    int m_indexedItemCount;          ///< 上次选择BSP深度时的图形项数量
+    
+    QHash<QString, Node*> m_importNodeMap;   ///< 导入期间文件中的节点ID到节点的映射
+    QList<Connection*> m_importConnections;  ///< 导入期间新建、尚未计算路径的连接线
+    
     QJsonObject m_clipboard;         ///< 剪贴板数据（存储复制的节点和连接）
+    qint64 m_undoMemoryBudget;       ///< 撤销历史的内存预算（字节，0表示不限制）
+    int m_undoFloor;                 ///< 撤销下限：此下标之前的命令已被释放（先于撤销栈声明，栈析构清空时仍有效）
+    
+    /**
+     * @brief 一条撤销命令的内存估算
+     */
+    struct UndoCost {
+        const QUndoCommand *command = nullptr;  ///< 估算时该下标上的命令
+        qint64 cost = 0;                        ///< 估算的字节数（已释放的命令为0）
+    };
+    QVector<UndoCost> m_undoCosts;   ///< 撤销栈各下标上命令的内存估算（同样先于撤销栈声明）
+    qint64 m_undoUsage;              ///< 未释放命令的内存合计
+    int m_lastUndoIndex;             ///< 上次同步时的撤销位置
     QUndoStack m_undoStack;          ///< 撤销/重做栈
+    int m_blockSize;                 ///< 流式处理块大小（0表示整段处理）
 };
 
 #endif // NODESCENE_H
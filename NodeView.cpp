@@ -25,6 +25,8 @@
 #include <QMenu>           // 菜单类
 #include <QContextMenuEvent> // 上下文菜单事件类
 #include <QMessageBox>     // 消息框类
+#include <QPixmap>         // 网格纹理位图
+#include <QtMath>          // 数学函数
 
 /**
  * @brief 构造函数
@@ -36,6 +38,8 @@ NodeView::NodeView(NodeScene *scene, QWidget *parent)
     , m_scene(scene)            // 保存场景指针
     , m_miniMap(nullptr)        // 初始化小地图指针
     , m_isPanning(false)        // 初始化拖动状态
+    , m_gridScale(-1.0)         // 网格纹理在首次绘制时生成
+    , m_gridDpr(0.0)
 {
     // 设置关联的场景
     setScene(scene);
@@ -80,29 +84,57 @@ void NodeView::wheelEvent(QWheelEvent *event)
  * @param painter 绘制器对象
  * @param rect 需要重绘的矩形区域
  * 
- * 绘制深色背景和网格线，提供更好的视觉参考
+ * 整个暴露区域只做一次纹理填充，不再逐条绘制网格线。
+ * 纹理画刷的原点固定在场景原点，网格线始终落在网格纹理尺寸的整数倍上。
+ * 缩放比例或设备像素比（窗口移到另一块屏幕）变化时重新生成纹理。
  */
 void NodeView::drawBackground(QPainter *painter, const QRectF &rect)
 {
-    // 绘制深色背景
-    painter->fillRect(rect, QColor(30, 30, 40));
-    
-    // 绘制网格线
-    painter->setPen(QPen(QColor(60, 60, 70), 1));
+    const qreal scale = transform().m11();
+    if (!qFuzzyCompare(scale, m_gridScale) || !qFuzzyCompare(devicePixelRatioF(), m_gridDpr)) {
+        updateGridBrush(scale);
+    }
     
-    // 计算网格起始位置，确保网格对齐
-    qreal left = int(rect.left()) - (int(rect.left()) % 20);
-    qreal top = int(rect.top()) - (int(rect.top()) % 20);
+    painter->save();
+    painter->setBrushOrigin(0, 0);
+    painter->fillRect(rect, m_gridBrush);
+    painter->restore();
+}
+
+/**
+ * @brief 按缩放比例重新生成网格纹理画刷
+ * @param scale 当前视图缩放比例
+ * 
+ * 网格间距从20个场景单位开始，屏幕上相邻网格线不足8像素时按5倍放大间距，
+ * 因此缩小时次级网格线会被去掉，只保留较稀疏的网格。
+ * 纹理按设备像素生成（一个网格单元、左边和上边各一条1像素线），
+ * 画刷变换抵消视图缩放和设备像素比，使纹理的每个像素恰好对应一个设备像素：
+ * 网格单元的边长取整到整数个设备像素（与网格间距相差不到半个像素），
+ * 不再把取整后的纹理拉伸回网格间距，避免非整数缩放时网格线被丢掉或画成两条。
+ */
+void NodeView::updateGridBrush(qreal scale)
+{
+    m_gridScale = scale;
+    m_gridDpr = devicePixelRatioF();
     
-    // 绘制垂直网格线
-    for (qreal x = left; x < rect.right(); x += 20) {
-        painter->drawLine(x, rect.top(), x, rect.bottom());
+    qreal step = 20.0;
+    while (step * scale < 8.0) {
+        step *= 5.0;
     }
     
-    // 绘制水平网格线
-    for (qreal y = top; y < rect.bottom(); y += 20) {
-        painter->drawLine(rect.left(), y, rect.right(), y);
+    const qreal devicePixelsPerUnit = scale * m_gridDpr;
+    const int tilePixels = qMax(2, qRound(step * devicePixelsPerUnit));
+    QPixmap tile(tilePixels, tilePixels);
+    tile.fill(QColor(30, 30, 40));     // 深色背景
+    {
+        QPainter tilePainter(&tile);
+        tilePainter.setPen(QColor(60, 60, 70));  // 网格线
+        tilePainter.drawLine(0, 0, tilePixels - 1, 0);
+        tilePainter.drawLine(0, 0, 0, tilePixels - 1);
     }
+    
+    m_gridBrush = QBrush(tile);
+    m_gridBrush.setTransform(QTransform::fromScale(1.0 / devicePixelsPerUnit, 1.0 / devicePixelsPerUnit));
 }
 
 /**
@@ -141,10 +173,10 @@ void NodeView::keyPressEvent(QKeyEvent *event)
             m_scene->selectAll();
             return;
         case Qt::Key_Z:  // Ctrl+Z: 撤销
-            m_scene->undoStack()->undo();
+            m_scene->undo();
             return;
         case Qt::Key_Y:  // Ctrl+Y: 重做
-            m_scene->undoStack()->redo();
+            m_scene->redo();
             return;
         default:
             break;
@@ -154,7 +186,7 @@ void NodeView::keyPressEvent(QKeyEvent *event)
     // Ctrl+Shift+Z 也作为重做
     if ((event->modifiers() & Qt::ControlModifier) && (event->modifiers() & Qt::ShiftModifier)) {
         if (event->key() == Qt::Key_Z) {
-            m_scene->undoStack()->redo();
+            m_scene->redo();
             return;
         }
     }
@@ -10,6 +10,7 @@
 #define NODEVIEW_H
 
 #include <QGraphicsView>               // Qt图形视图基类
+#include <QBrush>                      // 画刷类（网格纹理）
 
 // 前向声明
 class NodeScene;                       // 节点场景类
@@ -51,7 +52,7 @@ protected:
      * @param painter 绘制器对象
      * @param rect 需要重绘的矩形区域
      * 
-     * 绘制深色背景和网格线，提供更好的视觉效果
+     * 用缓存的网格纹理画刷一次填充，只在缩放比例变化时重新生成纹理
      */
     void drawBackground(QPainter *painter, const QRectF &rect) override;
     
@@ -136,11 +137,21 @@ private:
      * @brief 更新小地图位置
      */
     void updateMiniMapPosition();
+    
+    /**
+     * @brief 按缩放比例重新生成网格纹理画刷
+     * @param scale 当前视图缩放比例
+     */
+    void updateGridBrush(qreal scale);
 
     NodeScene *m_scene;          ///< 关联的节点场景指针
     MiniMapWidget *m_miniMap;    ///< 导航小地图组件
     
     bool m_isPanning;            ///< 是否正在拖动画布
+    
+    QBrush m_gridBrush;          ///< 网格纹理画刷（一个网格单元的纹理）
+    qreal m_gridScale;           ///< 生成网格纹理时的缩放比例（小于0表示尚未生成）
+    qreal m_gridDpr;             ///< 生成网格纹理时的设备像素比
     QPoint m_panStartPos;        ///< 拖动起始位置
 };
 
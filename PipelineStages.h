@@ -0,0 +1,396 @@
+/**
+ * @file PipelineStages.h
+ * @brief 编译期组合的流水线阶段模板库，由代码生成器的模板流水线后端嵌入生成代码
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ *
+ * 节点参数通过参数结构体的 static constexpr 成员传入模板，例如：
+ *
+ *     struct lp_params { static constexpr std::size_t taps = 31; static constexpr double cutoff = 0.1; };
+ *     using Chain = Pipeline<Source<src_params>, Fused<Filter<lp_params>, Mixer<mix_params>>, Fft<fft_params>>;
+ *
+ * 滤波器系数、载波步进和FFT旋转因子都在编译期计算；Fused 把相邻的逐采样阶段
+ * 合并成一个循环，编译器可以跨阶段内联并展开定长的内层循环。
+ * 该文件只依赖标准库（C++17），不依赖Qt。
+ */
+
+#ifndef PIPELINESTAGES_H
+#define PIPELINESTAGES_H
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace pipeline {
+
+typedef std::vector<double> Signal;
+
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 编译期计算FFT表的最大长度，更长时 constexpr 求值会超出编译器的运算次数限制（clang 默认约100万步）
+constexpr std::size_t kConstexprFftSize = 1024;
+
+/**
+ * @brief 将角度归约到 [-π, π]
+ */
+constexpr double reduceAngle(double x)
+{
+    const double twoPi = 2.0 * kPi;
+    x -= static_cast<double>(static_cast<long long>(x / twoPi)) * twoPi;
+    if (x > kPi) {
+        x -= twoPi;
+    } else if (x < -kPi) {
+        x += twoPi;
+    }
+    return x;
+}
+
+/**
+ * @brief 编译期正弦（泰勒级数，|x| <= π 时误差在双精度舍入范围内）
+ */
+constexpr double sin(double x)
+{
+    x = reduceAngle(x);
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 30; ++n) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief 编译期余弦
+ */
+constexpr double cos(double x)
+{
+    x = reduceAngle(x);
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 30; ++n) {
+        term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief 编译期设计汉明窗sinc低通滤波器
+ * @tparam N 系数个数
+ * @param cutoff 截止频率（相对采样率，0 ~ 0.5）
+ */
+template <std::size_t N>
+constexpr std::array<double, N> lowpass(double cutoff)
+{
+    std::array<double, N> taps{};
+    const double center = 0.5 * static_cast<double>(N - 1);
+    double sum = 0.0;
+    for (std::size_t k = 0; k < N; ++k) {
+        const double n = static_cast<double>(k) - center;
+        const double sinc = n == 0.0 ? 2.0 * cutoff : sin(2.0 * kPi * cutoff * n) / (kPi * n);
+        const double window = N == 1 ? 1.0 : 0.54 - 0.46 * cos(2.0 * kPi * static_cast<double>(k) / static_cast<double>(N - 1));
+        taps[k] = sinc * window;
+        sum += taps[k];
+    }
+    for (std::size_t k = 0; k < N; ++k) {
+        taps[k] /= sum;
+    }
+    return taps;
+}
+
+} // namespace detail
+
+// ==================== 逐采样阶段（可被 Fused 合并） ====================
+
+/**
+ * @class Filter
+ * @brief FIR低通滤波器，系数在编译期确定
+ * @tparam Params 需提供 taps（系数个数）和 cutoff（截止频率）
+ */
+template <class Params>
+class Filter
+{
+public:
+    static constexpr std::size_t N = Params::taps;
+    static_assert(N > 0, "滤波器系数个数必须大于0");
+    static constexpr std::array<double, N> coefficients = detail::lowpass<N>(Params::cutoff);
+
+    double operator()(double x)
+    {
+        // 延迟线存两份，避免在内层循环中取模
+        m_pos = (m_pos == 0 ? N : m_pos) - 1;
+        m_delay[m_pos] = x;
+        m_delay[m_pos + N] = x;
+        double acc = 0.0;
+        for (std::size_t k = 0; k < N; ++k) {
+            acc += coefficients[k] * m_delay[m_pos + k];
+        }
+        return acc;
+    }
+
+private:
+    std::array<double, 2 * N> m_delay{};
+    std::size_t m_pos = 0;
+};
+
+/**
+ * @class Mixer
+ * @brief 载波混频：x[n] * gain * cos(2π f n + φ)，载波步进在编译期确定
+ * @tparam Params 需提供 frequency 和 phase，可选提供 gain
+ */
+template <class Params>
+class Mixer
+{
+public:
+    double operator()(double x)
+    {
+        const double y = x * m_re;
+        const double re = m_re * kStepRe - m_im * kStepIm;
+        m_im = m_re * kStepIm + m_im * kStepRe;
+        m_re = re;
+        if (++m_count == 4096) {
+            // 定期消除递推累积的幅度误差
+            const double scale = 1.0 / std::sqrt(m_re * m_re + m_im * m_im);
+            m_re *= scale;
+            m_im *= scale;
+            m_count = 0;
+        }
+        return y * gain();
+    }
+
+private:
+    template <class P>
+    static constexpr auto gainOf(int) -> decltype(P::gain) { return P::gain; }
+    template <class P>
+    static constexpr double gainOf(long) { return 1.0; }
+    static constexpr double gain() { return gainOf<Params>(0); }
+
+    static constexpr double kStepRe = detail::cos(2.0 * detail::kPi * Params::frequency);
+    static constexpr double kStepIm = detail::sin(2.0 * detail::kPi * Params::frequency);
+
+    double m_re = detail::cos(Params::phase);
+    double m_im = detail::sin(Params::phase);
+    int m_count = 0;
+};
+
+/**
+ * @class Demodulator
+ * @brief 相干解调：与本地载波混频（增益2）后低通
+ * @tparam Params 需提供 frequency、phase、taps、cutoff
+ */
+template <class Params>
+class Demodulator
+{
+public:
+    double operator()(double x)
+    {
+        return m_lowpass(2.0 * m_mixer(x));
+    }
+
+private:
+    Mixer<Params> m_mixer;
+    Filter<Params> m_lowpass;
+};
+
+/**
+ * @class Identity
+ * @brief 自定义节点的占位阶段，原样输出
+ */
+template <class Params>
+class Identity
+{
+public:
+    double operator()(double x)
+    {
+        // TODO: 实现自定义节点的处理逻辑
+        return x;
+    }
+};
+
+/**
+ * @class Fused
+ * @brief 把若干逐采样阶段合并成一个循环
+ */
+template <class... Stages>
+class Fused
+{
+public:
+    void process(Signal &signal)
+    {
+        for (double &sample : signal) {
+            sample = apply(sample, std::index_sequence_for<Stages...>{});
+        }
+    }
+
+    template <std::size_t I>
+    auto &stage() { return std::get<I>(m_stages); }
+
+private:
+    template <std::size_t... I>
+    double apply(double sample, std::index_sequence<I...>)
+    {
+        ((sample = std::get<I>(m_stages)(sample)), ...);
+        return sample;
+    }
+
+    std::tuple<Stages...> m_stages;
+};
+
+// ==================== 整块阶段 ====================
+
+/**
+ * @class Source
+ * @brief 信号源：把主函数分配好的缓冲区填满采样点
+ * @tparam Params 需提供 length（整段处理时的采样点数）
+ */
+template <class Params>
+class Source
+{
+public:
+    static constexpr std::size_t length = Params::length;
+
+    void process(Signal &signal)
+    {
+        // TODO: 实现信号源生成逻辑，m_offset 为本块第一个采样点的序号
+        for (double &sample : signal) {
+            sample = 0.0;
+        }
+        m_offset += signal.size();
+    }
+
+private:
+    std::size_t m_offset = 0;
+};
+
+/**
+ * @class Fft
+ * @brief 定长基2 FFT，只读取信号
+ * @tparam Params 需提供 size（2的幂）
+ *
+ * 长度不超过 detail::kConstexprFftSize 时位反转表和旋转因子在编译期计算；
+ * 更长的FFT在编译期求值会超出编译器的 constexpr 运算次数限制，改为首次执行时计算一次。
+ */
+template <class Params>
+class Fft
+{
+public:
+    static constexpr std::size_t N = Params::size;
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "FFT长度必须是2的幂");
+
+    void process(Signal &signal)
+    {
+        const Tables &kTables = tables();
+        for (std::size_t i = 0; i < N; ++i) {
+            const double value = i < signal.size() ? signal[i] : 0.0;
+            m_spectrum[kTables.bitReverse[i]] = std::complex<double>(value, 0.0);
+        }
+        for (std::size_t half = 1; half < N; half <<= 1) {
+            const std::size_t stride = N / (2 * half);
+            for (std::size_t start = 0; start < N; start += 2 * half) {
+                for (std::size_t j = 0; j < half; ++j) {
+                    const std::complex<double> w(kTables.cosine[j * stride], kTables.sine[j * stride]);
+                    const std::complex<double> t = m_spectrum[start + half + j] * w;
+                    m_spectrum[start + half + j] = m_spectrum[start + j] - t;
+                    m_spectrum[start + j] += t;
+                }
+            }
+        }
+    }
+
+    const std::array<std::complex<double>, N> &spectrum() const { return m_spectrum; }
+
+private:
+    struct Tables {
+        std::array<std::size_t, N> bitReverse{};
+        std::array<double, N / 2> cosine{};
+        std::array<double, N / 2> sine{};
+    };
+
+    static constexpr Tables makeTables()
+    {
+        Tables tables{};
+        std::size_t bits = 0;
+        while ((std::size_t(1) << bits) < N) {
+            ++bits;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t reversed = 0;
+            for (std::size_t b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            tables.bitReverse[i] = reversed;
+        }
+        for (std::size_t j = 0; j < N / 2; ++j) {
+            const double angle = -2.0 * detail::kPi * static_cast<double>(j) / static_cast<double>(N);
+            tables.cosine[j] = detail::cos(angle);
+            tables.sine[j] = detail::sin(angle);
+        }
+        return tables;
+    }
+
+    static const Tables &tables()
+    {
+        if constexpr (N <= detail::kConstexprFftSize) {
+            static constexpr Tables kTables = makeTables();
+            return kTables;
+        } else {
+            static const Tables kTables = makeTables();
+            return kTables;
+        }
+    }
+
+    std::array<std::complex<double>, N> m_spectrum{};
+};
+
+/**
+ * @class Sink
+ * @brief 输出节点：统计接收的采样点数
+ */
+template <class Params>
+class Sink
+{
+public:
+    void process(Signal &signal)
+    {
+        m_samples += signal.size();
+    }
+
+    std::size_t samples() const { return m_samples; }
+
+private:
+    std::size_t m_samples = 0;
+};
+
+// ==================== 流水线 ====================
+
+/**
+ * @class Pipeline
+ * @brief 按顺序执行的阶段组合，每个阶段需提供 process(Signal&)
+ */
+template <class... Segments>
+class Pipeline
+{
+public:
+    void process(Signal &signal)
+    {
+        std::apply([&signal](auto &... segment) { (segment.process(signal), ...); }, m_segments);
+    }
+
+    template <std::size_t I>
+    auto &segment() { return std::get<I>(m_segments); }
+
+private:
+    std::tuple<Segments...> m_segments;
+};
+
+} // namespace pipeline
+
+#endif // PIPELINESTAGES_H
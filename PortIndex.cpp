@@ -0,0 +1,173 @@
+/**
+ * @file PortIndex.cpp
+ * @brief 端口空间索引类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "PortIndex.h"
+#include "Node.h"
+#include <QLineF>
+#include <QtMath>
+#include <algorithm>
+
+/**
+ * @brief 构造函数
+ * @param cellSize 网格边长
+ */
+PortIndex::PortIndex(qreal cellSize)
+    : m_cellSize(qMax(cellSize, qreal(1.0)))
+{
+}
+
+/**
+ * @brief 计算网格坐标对应的键
+ * @param cx 网格X坐标
+ * @param cy 网格Y坐标
+ * @return 64位网格键（高32位为X，低32位为Y）
+ */
+quint64 PortIndex::cellKey(qint64 cx, qint64 cy)
+{
+    return (static_cast<quint64>(static_cast<quint32>(cx)) << 32) | static_cast<quint32>(cy);
+}
+
+/**
+ * @brief 计算场景坐标所在的网格坐标
+ * @param value 场景坐标分量
+ * @return 网格坐标分量
+ */
+qint64 PortIndex::cellCoord(qreal value) const
+{
+    return static_cast<qint64>(qFloor(value / m_cellSize));
+}
+
+/**
+ * @brief 添加一个端口条目
+ * @param entry 端口条目
+ */
+void PortIndex::insertEntry(const Entry &entry)
+{
+    const quint64 key = cellKey(cellCoord(entry.pos.x()), cellCoord(entry.pos.y()));
+    m_cells[key].append(entry);
+
+    QVector<quint64> &cells = m_cellsByNode[entry.node];
+    if (!cells.contains(key)) {
+        cells.append(key);
+    }
+}
+
+/**
+ * @brief 插入或刷新节点的全部端口
+ * @param node 节点指针
+ *
+ * 先移除旧条目再按节点当前的位置、尺寸和端口数量重新插入，
+ * 耗时只与该节点的端口数有关。
+ */
+void PortIndex::update(Node *node)
+{
+    if (!node) {
+        return;
+    }
+    remove(node);
+
+    // 没有端口的节点也登记一个空列表，便于 contains 判断
+    m_cellsByNode.insert(node, QVector<quint64>());
+    for (int i = 0; i < node->getInputPortCount(); ++i) {
+        insertEntry(Entry{node, i, true, node->getInputPortPos(i)});
+    }
+    for (int i = 0; i < node->getOutputPortCount(); ++i) {
+        insertEntry(Entry{node, i, false, node->getOutputPortPos(i)});
+    }
+}
+
+/**
+ * @brief 移除节点的全部端口
+ * @param node 节点指针
+ */
+void PortIndex::remove(Node *node)
+{
+    auto it = m_cellsByNode.find(node);
+    if (it == m_cellsByNode.end()) {
+        return;
+    }
+
+    for (quint64 key : it.value()) {
+        auto cell = m_cells.find(key);
+        if (cell == m_cells.end()) {
+            continue;
+        }
+        QVector<Entry> &entries = cell.value();
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [node](const Entry &entry) { return entry.node == node; }),
+                      entries.end());
+        if (entries.isEmpty()) {
+            m_cells.erase(cell);
+        }
+    }
+    m_cellsByNode.erase(it);
+}
+
+/**
+ * @brief 清空索引
+ */
+void PortIndex::clear()
+{
+    m_cells.clear();
+    m_cellsByNode.clear();
+}
+
+/**
+ * @brief 查找距离给定点最近的输入端口
+ */
+PortIndex::Hit PortIndex::inputPortAt(const QPointF &pos, qreal radius, const Node *exclude) const
+{
+    return nearest(pos, radius, true, exclude);
+}
+
+/**
+ * @brief 查找距离给定点最近的输出端口
+ */
+PortIndex::Hit PortIndex::outputPortAt(const QPointF &pos, qreal radius, const Node *exclude) const
+{
+    return nearest(pos, radius, false, exclude);
+}
+
+/**
+ * @brief 在给定点附近的网格中查找最近的端口
+ * @param pos 场景坐标
+ * @param radius 捕获半径
+ * @param input true查找输入端口，false查找输出端口
+ * @param exclude 需要跳过的节点
+ * @return 命中结果，多个端口都在范围内时取距离最近的一个
+ */
+PortIndex::Hit PortIndex::nearest(const QPointF &pos, qreal radius, bool input, const Node *exclude) const
+{
+    Hit hit;
+    qreal bestDistance = radius;
+
+    const qint64 x0 = cellCoord(pos.x() - radius);
+    const qint64 x1 = cellCoord(pos.x() + radius);
+    const qint64 y0 = cellCoord(pos.y() - radius);
+    const qint64 y1 = cellCoord(pos.y() + radius);
+    for (qint64 cx = x0; cx <= x1; ++cx) {
+        for (qint64 cy = y0; cy <= y1; ++cy) {
+            auto cell = m_cells.constFind(cellKey(cx, cy));
+            if (cell == m_cells.constEnd()) {
+                continue;
+            }
+            for (const Entry &entry : cell.value()) {
+                if (entry.input != input || entry.node == exclude) {
+                    continue;
+                }
+                const qreal distance = QLineF(pos, entry.pos).length();
+                if (distance <= bestDistance) {
+                    bestDistance = distance;
+                    hit.node = entry.node;
+                    hit.port = entry.port;
+                }
+            }
+        }
+    }
+    return hit;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file PortIndex.h
+ * @brief 端口空间索引类头文件，按场景坐标网格组织所有节点的端口
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef PORTINDEX_H
+#define PORTINDEX_H
+
+#include <QHash>
+#include <QPointF>
+#include <QVector>
+
+// 前向声明
+class Node;                            // 节点类
+
+/**
+ * @class PortIndex
+ * @brief 端口空间索引类
+ *
+ * 将场景划分为边长固定的正方形网格，每个网格记录圆心落在其中的端口。
+ * 查询半径不超过网格边长时，一次命中测试最多检查4个网格，
+ * 耗时只与鼠标附近的端口数有关，与场景中的节点总数无关。
+ *
+ * 索引由 NodeScene 持有，节点加入/离开场景、移动、改变尺寸或端口数量时
+ * 由 Node 主动刷新自己的条目。
+ */
+class PortIndex
+{
+public:
+    /**
+     * @brief 命中测试结果
+     */
+    struct Hit {
+        Node *node = nullptr;   ///< 命中的节点，未命中为nullptr
+        int port = -1;          ///< 命中的端口索引，未命中为-1
+    };
+
+    /**
+     * @brief 构造函数
+     * @param cellSize 网格边长（场景坐标），应不小于端口捕获半径的两倍
+     */
+    explicit PortIndex(qreal cellSize = 64.0);
+
+    /**
+     * @brief 插入或刷新节点的全部端口
+     * @param node 节点指针
+     */
+    void update(Node *node);
+
+    /**
+     * @brief 移除节点的全部端口
+     * @param node 节点指针
+     */
+    void remove(Node *node);
+
+    /**
+     * @brief 清空索引
+     */
+    void clear();
+
+    /**
+     * @brief 节点是否已加入索引
+     * @param node 节点指针
+     * @return 已加入返回true
+     */
+    bool contains(Node *node) const { return m_cellsByNode.contains(node); }
+
+    /**
+     * @brief 查找距离给定点最近的输入端口
+     * @param pos 场景坐标
+     * @param radius 捕获半径
+     * @param exclude 需要跳过的节点（如连线的源节点），可为nullptr
+     * @return 命中结果
+     */
+    Hit inputPortAt(const QPointF &pos, qreal radius, const Node *exclude = nullptr) const;
+
+    /**
+     * @brief 查找距离给定点最近的输出端口
+     * @param pos 场景坐标
+     * @param radius 捕获半径
+     * @param exclude 需要跳过的节点，可为nullptr
+     * @return 命中结果
+     */
+    Hit outputPortAt(const QPointF &pos, qreal radius, const Node *exclude = nullptr) const;
+
+private:
+    /**
+     * @brief 索引中的端口条目
+     */
+    struct Entry {
+        Node *node;         ///< 所属节点
+        int port;           ///< 端口索引
+        bool input;         ///< 是否为输入端口
+        QPointF pos;        ///< 端口圆心的场景坐标
+    };
+
+    /**
+     * @brief 计算网格坐标对应的键
+     */
+    static quint64 cellKey(qint64 cx, qint64 cy);
+
+    /**
+     * @brief 计算场景坐标所在的网格坐标
+     */
+    qint64 cellCoord(qreal value) const;
+
+    /**
+     * @brief 在给定点附近的网格中查找最近的端口
+     */
+    Hit nearest(const QPointF &pos, qreal radius, bool input, const Node *exclude) const;
+
+    /**
+     * @brief 添加一个端口条目
+     */
+    void insertEntry(const Entry &entry);
+
+    qreal m_cellSize;                               ///< 网格边长
+    QHash<quint64, QVector<Entry>> m_cells;         ///< 网格键 -> 端口条目
+    QHash<Node*, QVector<quint64>> m_cellsByNode;   ///< 节点 -> 其端口所在的网格键（不重复）
+};
+
+#endif // PORTINDEX_H
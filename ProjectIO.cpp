@@ -0,0 +1,405 @@
+/**
+ * @file ProjectIO.cpp
+ * @brief 项目文件异步读写类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "ProjectIO.h"
+#include "NodeScene.h"
+#include "Node.h"
+#include "GroupNode.h"
+#include "BinaryProject.h"
+#include "Logging.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+/**
+ * @brief 构造函数
+ * @param scene 节点场景
+ * @param parent 父对象指针
+ */
+ProjectIO::ProjectIO(NodeScene *scene, QObject *parent)
+    : QObject(parent)
+    , m_scene(scene)
+    , m_busy(false)
+    , m_canceled(false)
+    , m_nextNode(0)
+    , m_nextConnection(0)
+{
+    // 读取阶段占总进度的前一半，其余由GUI线程构造场景时报告
+    connect(&m_readWatcher, &QFutureWatcherBase::progressValueChanged, this, [this](int value) {
+        emit progressChanged(value / 2, m_readWatcher.progressText());
+    });
+    connect(&m_readWatcher, &QFutureWatcherBase::finished, this, &ProjectIO::onReadFinished);
+
+    connect(&m_writeWatcher, &QFutureWatcherBase::progressValueChanged, this, [this](int value) {
+        emit progressChanged(value, m_writeWatcher.progressText());
+    });
+    connect(&m_writeWatcher, &QFutureWatcherBase::finished, this, &ProjectIO::onWriteFinished);
+}
+
+/**
+ * @brief 开始异步打开项目文件
+ * @param fileName 项目文件路径
+ * @return 已有任务在进行时返回false
+ */
+bool ProjectIO::open(const QString &fileName)
+{
+    if (m_busy) {
+        return false;
+    }
+    m_busy = true;
+    m_canceled = false;
+    m_fileName = fileName;
+
+    emit progressChanged(0, "正在读取文件");
+    m_readWatcher.setFuture(QtConcurrent::run(&ProjectIO::readProject, fileName));
+    return true;
+}
+
+/**
+ * @brief 开始异步保存项目文件
+ * @param fileName 项目文件路径
+ * @return 已有任务在进行时返回false
+ */
+bool ProjectIO::save(const QString &fileName)
+{
+    if (m_busy) {
+        return false;
+    }
+    m_busy = true;
+    m_canceled = false;
+    m_fileName = fileName;
+
+    // 图形项只能在GUI线程中访问，流程数据在这里取出，序列化和写入交给工作线程
+    emit progressChanged(0, "正在收集流程数据");
+    releaseMappedFile(fileName);
+    const QJsonObject flowData = m_scene->getFlowData();
+    m_writeWatcher.setFuture(QtConcurrent::run(&ProjectIO::writeProject, flowData, fileName));
+    return true;
+}
+
+/**
+ * @brief 取消当前任务
+ *
+ * 工作线程在下一次检查时退出；构造场景阶段在下一块开始前停止。
+ */
+void ProjectIO::cancel()
+{
+    if (!m_busy) {
+        return;
+    }
+    m_canceled = true;
+    m_readWatcher.cancel();
+    m_writeWatcher.cancel();
+}
+
+/**
+ * @brief 在工作线程中读取并解析项目文件
+ * @param promise 任务结果与进度
+ * @param fileName 项目文件路径
+ */
+void ProjectIO::readProject(QPromise<ReadResult> &promise, const QString &fileName)
+{
+    ReadResult result;
+    promise.setProgressRange(0, 100);
+
+    // 二进制项目文件只映射并校验结构，节点在构造场景时直接从映射内存解码
+    if (BinaryProject::isBinaryProject(fileName)) {
+        promise.setProgressValueAndText(0, "正在映射文件");
+        QString error;
+        result.binary = BinaryProject::open(fileName, &error);
+        if (!result.binary) {
+            result.error = QString("二进制项目文件格式错误: %1").arg(error);
+            promise.addResult(result);
+            return;
+        }
+        result.metadata = result.binary->metadata();
+        promise.setProgressValueAndText(100, "正在构造场景");
+        promise.addResult(result);
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.error = QString("无法打开项目文件: %1").arg(file.errorString());
+        promise.addResult(result);
+        return;
+    }
+
+    // 分块读取以便报告进度和响应取消
+    const qint64 total = file.size();
+    QByteArray data;
+    data.reserve(total);
+    while (!file.atEnd()) {
+        if (promise.isCanceled()) {
+            return;
+        }
+        const QByteArray block = file.read(IO_BLOCK_SIZE);
+        if (block.isEmpty()) {
+            if (file.error() != QFileDevice::NoError) {
+                result.error = QString("读取项目文件失败: %1").arg(file.errorString());
+                promise.addResult(result);
+                return;
+            }
+            break;
+        }
+        data.append(block);
+        if (total > 0) {
+            promise.setProgressValueAndText(static_cast<int>(80 * data.size() / total), "正在读取文件");
+        }
+    }
+    file.close();
+
+    promise.setProgressValueAndText(80, "正在解析项目文件");
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    data = QByteArray();  // 尽早释放原始文本
+    if (promise.isCanceled()) {
+        return;
+    }
+    if (!doc.isObject()) {
+        result.error = QString("项目文件格式错误: %1（位置 %2）")
+            .arg(parseError.errorString()).arg(parseError.offset);
+        promise.addResult(result);
+        return;
+    }
+
+    const QJsonObject flowData = doc.object();
+    result.metadata = flowData["metadata"].toObject();
+    result.nodes = flowData["nodes"].toArray();
+    result.connections = flowData["connections"].toArray();
+    promise.setProgressValueAndText(100, "正在构造场景");
+    promise.addResult(result);
+}
+
+/**
+ * @brief 在工作线程中序列化并写出项目文件
+ * @param promise 任务结果（错误信息，成功时为空）与进度
+ * @param flowData 流程数据
+ * @param fileName 项目文件路径
+ *
+ * 扩展名为 .dagb 时保存为二进制格式，否则保存为JSON。
+ * 写入 QSaveFile，只有全部写完才替换原文件；取消或失败时原文件保持不变。
+ */
+void ProjectIO::writeProject(QPromise<QString> &promise, const QJsonObject &flowData, const QString &fileName)
+{
+    promise.setProgressRange(0, 100);
+    promise.setProgressValueAndText(0, "正在序列化");
+    const QByteArray data = fileName.endsWith(".dagb", Qt::CaseInsensitive)
+        ? BinaryProject::encode(flowData)
+        : QJsonDocument(flowData).toJson();
+    if (promise.isCanceled()) {
+        return;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        promise.addResult(QString("无法写入项目文件: %1").arg(file.errorString()));
+        return;
+    }
+
+    qint64 written = 0;
+    while (written < data.size()) {
+        if (promise.isCanceled()) {
+            file.cancelWriting();
+            return;
+        }
+        const qint64 count = file.write(data.constData() + written, qMin<qint64>(IO_BLOCK_SIZE, data.size() - written));
+        if (count < 0) {
+            promise.addResult(QString("写入项目文件失败: %1").arg(file.errorString()));
+            return;
+        }
+        written += count;
+        promise.setProgressValueAndText(static_cast<int>(20 + 80 * written / data.size()), "正在写入文件");
+    }
+
+    if (!file.commit()) {
+        promise.addResult(QString("保存项目文件失败: %1").arg(file.errorString()));
+        return;
+    }
+    promise.addResult(QString());
+}
+
+/**
+ * @brief 工作线程读取和解析完成
+ *
+ * 解析成功后才清空旧场景，之后按块构造新场景。
+ */
+void ProjectIO::onReadFinished()
+{
+    const QFuture<ReadResult> future = m_readWatcher.future();
+    if (m_canceled || future.resultCount() == 0) {
+        finish(false, "已取消打开项目");
+        return;
+    }
+
+    const ReadResult result = future.result();
+    m_readWatcher.setFuture(QFuture<ReadResult>());  // 释放监视器持有的解析结果
+    if (!result.error.isEmpty()) {
+        qWarning() << result.error;
+        finish(false, result.error);
+        return;
+    }
+
+    m_nodes = result.nodes;
+    m_connections = result.connections;
+    m_binary = result.binary;
+    m_mappedFileName = m_binary ? m_fileName : QString();
+    m_nextNode = 0;
+    m_nextConnection = 0;
+
+    // 先关闭索引再清空旧场景，删除大量图形项时也不逐个更新索引
+    m_scene->beginImport();
+    m_scene->clearFlow();
+    m_scene->setBlockSize(result.metadata["blockSize"].toInt(0));
+    Node::reserveIds(result.metadata["nextNodeId"].toInteger(0));
+
+    emit progressChanged(50, "正在构造场景");
+    QTimer::singleShot(0, this, &ProjectIO::importNextChunk);
+}
+
+/**
+ * @brief 在GUI线程中构造下一块场景内容
+ *
+ * 先导入全部节点再导入连接，每次最多 CHUNK_SIZE 个，块之间回到事件循环处理绘制和取消按钮。
+ */
+void ProjectIO::importNextChunk()
+{
+    if (m_canceled) {
+        // 已加入的部分不完整，清空后结束导入
+        m_scene->clearFlow();
+        m_scene->endImport();
+        finish(false, "已取消打开项目，画布已清空");
+        return;
+    }
+
+    if (m_binary) {
+        if (!importNextBinaryChunk()) {
+            emit progressChanged(99, "正在计算连接线");
+            m_scene->endImport();
+            finish(true, "项目加载成功");
+            return;
+        }
+    } else if (m_nextNode < m_nodes.size()) {
+        m_scene->importNodes(m_nodes, m_nextNode, CHUNK_SIZE);
+        m_nextNode = qMin(m_nextNode + CHUNK_SIZE, static_cast<int>(m_nodes.size()));
+    } else if (m_nextConnection < m_connections.size()) {
+        m_scene->importConnections(m_connections, m_nextConnection, CHUNK_SIZE);
+        m_nextConnection = qMin(m_nextConnection + CHUNK_SIZE, static_cast<int>(m_connections.size()));
+    } else {
+        emit progressChanged(99, "正在计算连接线");
+        m_scene->endImport();
+        finish(true, "项目加载成功");
+        return;
+    }
+
+    const qint64 total = m_binary
+        ? qMax<qint64>(1, m_binary->nodeCount() + m_binary->edgeCount())
+        : qMax<qint64>(1, m_nodes.size() + m_connections.size());
+    const qint64 done = m_nextNode + m_nextConnection;
+    emit progressChanged(50 + static_cast<int>(49 * done / total), "正在构造场景");
+    QTimer::singleShot(0, this, &ProjectIO::importNextChunk);
+}
+
+/**
+ * @brief 从二进制项目文件构造下一块节点或连接
+ * @return 全部构造完成返回false
+ *
+ * 节点在线程池中并行解码（只读映射内存），节点ID使用记录下标。
+ */
+bool ProjectIO::importNextBinaryChunk()
+{
+    if (m_nextNode < m_binary->nodeCount()) {
+        const int end = qMin(m_nextNode + CHUNK_SIZE, m_binary->nodeCount());
+        QList<int> indices;
+        QStringList ids;
+        indices.reserve(end - m_nextNode);
+        ids.reserve(end - m_nextNode);
+        for (int i = m_nextNode; i < end; ++i) {
+            indices.append(i);
+            ids.append(QString::number(i));
+        }
+        const BinaryProject *binary = m_binary.data();
+        const QList<Node*> nodes = QtConcurrent::blockingMapped<QList<Node*>>(
+            indices, [binary](int index) { return binary->createNode(index); });
+        m_scene->importBuiltNodes(nodes, ids);
+        m_nextNode = end;
+        return true;
+    }
+
+    if (m_nextConnection < m_binary->edgeCount()) {
+        const int end = qMin(m_nextConnection + CHUNK_SIZE, m_binary->edgeCount());
+        for (int i = m_nextConnection; i < end; ++i) {
+            const BinaryProject::Edge edge = m_binary->edge(i);
+            m_scene->importConnection(QString::number(edge.fromNode), edge.fromPort,
+                                      QString::number(edge.toNode), edge.toPort, edge.lineType);
+        }
+        m_nextConnection = end;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 构建仍映射着 fileName 的组节点内部子图，使文件可以被覆盖
+ * @param fileName 即将写入的文件路径
+ *
+ * 延迟加载的组节点持有文件映射；覆盖同一个文件前先把内部子图全部加载到内存，释放映射。
+ */
+void ProjectIO::releaseMappedFile(const QString &fileName)
+{
+    if (m_mappedFileName.isEmpty() || QFileInfo(fileName) != QFileInfo(m_mappedFileName)) {
+        return;
+    }
+    for (Node *node : m_scene->getNodes()) {
+        if (GroupNode *groupNode = dynamic_cast<GroupNode*>(node)) {
+            groupNode->ensureInterior();
+        }
+    }
+    m_mappedFileName.clear();
+}
+
+/**
+ * @brief 工作线程写入完成
+ */
+void ProjectIO::onWriteFinished()
+{
+    const QFuture<QString> future = m_writeWatcher.future();
+    if (future.resultCount() == 0) {
+        finish(false, "已取消保存项目");
+        return;
+    }
+
+    const QString error = future.result();
+    m_writeWatcher.setFuture(QFuture<QString>());
+    if (!error.isEmpty()) {
+        qWarning() << error;
+        finish(false, error);
+        return;
+    }
+    finish(true, "项目保存成功");
+}
+
+/**
+ * @brief 结束当前任务并发出 finished 信号
+ * @param success 是否成功
+ * @param message 结果说明
+ */
+void ProjectIO::finish(bool success, const QString &message)
+{
+    m_busy = false;
+    m_canceled = false;
+    m_nodes = QJsonArray();
+    m_connections = QJsonArray();
+    m_binary.reset();
+    qCDebug(lcScene) << "项目文件" << m_fileName << ":" << message;
+    emit finished(success, message);
+}
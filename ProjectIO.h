@@ -0,0 +1,181 @@
+/**
+ * @file ProjectIO.h
+ * @brief 项目文件异步读写类头文件，在工作线程中读取、解析和写出项目文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef PROJECTIO_H
+#define PROJECTIO_H
+
+#include <QObject>                     // Qt对象基类
+#include <QFutureWatcher>              // 异步任务监视器
+#include <QJsonArray>                  // JSON数组类
+#include <QJsonObject>                 // JSON对象类
+#include <QPromise>                    // 异步任务结果
+#include <QSharedPointer>              // 共享指针类
+#include <QString>                     // 字符串类
+
+// 前向声明
+class NodeScene;                       // 节点场景类
+class BinaryProject;                   // 二进制项目文件类
+
+/**
+ * @class ProjectIO
+ * @brief 项目文件异步读写类
+ *
+ * 打开项目分两段进行：
+ * - 工作线程分块读取文件并解析JSON（进度 0% ~ 50%）
+ * - GUI线程按 CHUNK_SIZE 个节点/连接一块构造场景，每块之间回到事件循环（进度 50% ~ 100%）
+ *
+ * 保存项目时在GUI线程取出流程数据，序列化和分块写入在工作线程中进行，
+ * 写入 QSaveFile，取消或失败时不会破坏原文件。
+ *
+ * 任何阶段都可以调用 cancel：读取和解析阶段取消时场景保持不变；
+ * 构造场景阶段取消时场景被清空。
+ *
+ * 二进制项目文件（.dagb，见 BinaryProject）不经过JSON解析：工作线程只映射文件并校验结构，
+ * 构造场景时按块在线程池中直接从映射内存解码节点，组节点的内部子图延迟加载。
+ * 保存时按扩展名选择格式，.dagb 保存为二进制格式，其余保存为JSON。
+ */
+class ProjectIO : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief GUI线程每次构造的节点或连接个数
+     */
+    static constexpr int CHUNK_SIZE = 2000;
+
+    /**
+     * @brief 工作线程每次读写的字节数
+     */
+    static constexpr qint64 IO_BLOCK_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * @brief 构造函数
+     * @param scene 节点场景
+     * @param parent 父对象指针
+     */
+    explicit ProjectIO(NodeScene *scene, QObject *parent = nullptr);
+
+    /**
+     * @brief 开始异步打开项目文件
+     * @param fileName 项目文件路径
+     * @return 已有任务在进行时返回false
+     */
+    bool open(const QString &fileName);
+
+    /**
+     * @brief 开始异步保存项目文件
+     * @param fileName 项目文件路径
+     * @return 已有任务在进行时返回false
+     */
+    bool save(const QString &fileName);
+
+    /**
+     * @brief 取消当前任务
+     */
+    void cancel();
+
+    /**
+     * @brief 是否有任务正在进行
+     * @return 正在进行返回true
+     */
+    bool isBusy() const { return m_busy; }
+
+signals:
+    /**
+     * @brief 进度变化
+     * @param percent 进度百分比（0 ~ 100）
+     * @param stage 当前阶段的说明
+     */
+    void progressChanged(int percent, const QString &stage);
+
+    /**
+     * @brief 任务结束（成功、失败或取消）
+     * @param success 成功返回true
+     * @param message 结果说明
+     */
+    void finished(bool success, const QString &message);
+
+private slots:
+    /**
+     * @brief 工作线程读取和解析完成
+     */
+    void onReadFinished();
+
+    /**
+     * @brief 工作线程写入完成
+     */
+    void onWriteFinished();
+
+    /**
+     * @brief 在GUI线程中构造下一块场景内容
+     */
+    void importNextChunk();
+
+private:
+    /**
+     * @brief 工作线程的读取结果
+     */
+    struct ReadResult {
+        QJsonObject metadata;          ///< 流程元数据
+        QJsonArray nodes;              ///< 节点数组
+        QJsonArray connections;        ///< 连接数组
+        QSharedPointer<BinaryProject> binary;  ///< 二进制项目文件（打开的是JSON文件时为空）
+        QString error;                 ///< 错误信息，成功时为空
+    };
+
+    /**
+     * @brief 在工作线程中读取并解析项目文件
+     * @param promise 任务结果与进度
+     * @param fileName 项目文件路径
+     */
+    static void readProject(QPromise<ReadResult> &promise, const QString &fileName);
+
+    /**
+     * @brief 在工作线程中序列化并写出项目文件
+     * @param promise 任务结果（错误信息，成功时为空）与进度
+     * @param flowData 流程数据
+     * @param fileName 项目文件路径
+     */
+    static void writeProject(QPromise<QString> &promise, const QJsonObject &flowData, const QString &fileName);
+    
+    /**
+     * @brief 从二进制项目文件构造下一块节点或连接
+     * @return 全部构造完成返回false
+     */
+    bool importNextBinaryChunk();
+    
+    /**
+     * @brief 构建仍映射着 fileName 的组节点内部子图，使文件可以被覆盖
+     * @param fileName 即将写入的文件路径
+     */
+    void releaseMappedFile(const QString &fileName);
+
+    /**
+     * @brief 结束当前任务并发出 finished 信号
+     * @param success 是否成功
+     * @param message 结果说明
+     */
+    void finish(bool success, const QString &message);
+
+    NodeScene *m_scene;                           ///< 节点场景
+    QFutureWatcher<ReadResult> m_readWatcher;     ///< 读取任务监视器
+    QFutureWatcher<QString> m_writeWatcher;       ///< 写入任务监视器（结果为错误信息）
+    bool m_busy;                                  ///< 是否有任务正在进行
+    bool m_canceled;                              ///< 构造场景阶段是否已请求取消
+    QString m_fileName;                           ///< 当前任务的文件路径
+
+    QJsonArray m_nodes;                           ///< 待构造的节点
+    QJsonArray m_connections;                     ///< 待构造的连接
+    QSharedPointer<BinaryProject> m_binary;       ///< 待构造的二进制项目文件
+    QString m_mappedFileName;                     ///< 最近打开的二进制项目文件（组节点可能仍映射着它）
+    int m_nextNode;                               ///< 下一个待构造节点的下标
+    int m_nextConnection;                         ///< 下一个待构造连接的下标
+};
+
+#endif // PROJECTIO_H
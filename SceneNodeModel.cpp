@@ -0,0 +1,325 @@
+/**
+ * @file SceneNodeModel.cpp
+ * @brief 场景节点树模型类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SceneNodeModel.h"
+#include "NodeScene.h"
+#include "Node.h"
+#include "GroupNode.h"
+#include <QColor>
+
+/**
+ * @brief 构造函数
+ */
+SceneNodeModel::SceneNodeModel(NodeScene *scene, QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_scene(scene)
+{
+    m_root.fetched = true;
+    m_root.depth = -1;
+    rebuildTopLevel();
+
+    connect(m_scene, &NodeScene::nodesInserted, this, &SceneNodeModel::onNodesInserted);
+    connect(m_scene, &NodeScene::nodeRemoved, this, &SceneNodeModel::onNodeRemoved);
+    connect(m_scene, &NodeScene::nodeChanged, this, &SceneNodeModel::onNodeChanged);
+    connect(m_scene, &NodeScene::nodesCleared, this, &SceneNodeModel::onNodesCleared);
+}
+
+/**
+ * @brief 析构函数
+ */
+SceneNodeModel::~SceneNodeModel()
+{
+    deleteChildren(&m_root);
+}
+
+QModelIndex SceneNodeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    Item *parentItem = itemAt(parent);
+    if (column != 0 || row < 0 || row >= parentItem->children.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, parentItem->children.at(row));
+}
+
+QModelIndex SceneNodeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    Item *parentItem = static_cast<Item*>(child.internalPointer())->parent;
+    if (parentItem == &m_root) {
+        return QModelIndex();
+    }
+    return createIndex(parentItem->row, 0, parentItem);
+}
+
+int SceneNodeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    return itemAt(parent)->children.size();
+}
+
+int SceneNodeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 1;
+}
+
+/**
+ * @brief 是否有子行
+ *
+ * 子行尚未创建的组节点按内部节点数量判断，不需要解码延迟加载的内部子图，视图据此显示展开箭头。
+ */
+bool SceneNodeModel::hasChildren(const QModelIndex &parent) const
+{
+    Item *item = itemAt(parent);
+    if (item->fetched) {
+        return !item->children.isEmpty();
+    }
+    return item->group && item->group->internalNodeCount() > 0;
+}
+
+bool SceneNodeModel::canFetchMore(const QModelIndex &parent) const
+{
+    Item *item = itemAt(parent);
+    return !item->fetched && item->group;
+}
+
+/**
+ * @brief 创建组节点的子行
+ *
+ * 视图第一次展开组节点时调用；延迟加载的组节点在这里解码内部子图。
+ */
+void SceneNodeModel::fetchMore(const QModelIndex &parent)
+{
+    Item *item = itemAt(parent);
+    if (item->fetched || !item->group) {
+        return;
+    }
+    item->fetched = true;
+
+    const QList<Node*> internalNodes = item->group->getInternalNodes();
+    if (internalNodes.isEmpty()) {
+        return;
+    }
+    beginInsertRows(parent, 0, internalNodes.size() - 1);
+    item->children.reserve(internalNodes.size());
+    for (int i = 0; i < internalNodes.size(); ++i) {
+        item->children.append(createItem(internalNodes[i], item, i));
+    }
+    endInsertRows();
+}
+
+QVariant SceneNodeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const Item *item = static_cast<Item*>(index.internalPointer());
+    Node *node = item->node;
+    GroupNode *groupNode = item->group;
+
+    switch (role) {
+    case Qt::DisplayRole: {
+        // 内部节点带缩进前缀
+        QString indent;
+        if (item->depth > 0) {
+            indent = QString(item->depth * 2, ' ') + "├─ ";
+        }
+        if (groupNode) {
+            return QString("%1📦 %2 [Lv.%3]").arg(indent).arg(node->getName()).arg(groupNode->getGroupLevel());
+        }
+        return QString("%1● %2").arg(indent).arg(node->getName());
+    }
+    case Qt::ToolTipRole:
+        if (groupNode) {
+            QString toolTip = QString("组合节点: %1\n组件等级: %2\n包含 %3 个内部节点")
+                .arg(node->getName())
+                .arg(groupNode->getGroupLevel())
+                .arg(groupNode->internalNodeCount());
+            if (item->depth > 0) {
+                toolTip += QString("\n嵌套深度: %1").arg(item->depth);
+            }
+            return toolTip;
+        } else {
+            QString displayType = node->getDisplayTypeName();
+            if (displayType.isEmpty()) {
+                displayType = node->getType();
+            }
+            return QString("节点: %1\n类型: %2").arg(node->getName()).arg(displayType);
+        }
+    case Qt::ForegroundRole:
+        if (groupNode) {
+            return QColor(100, 149, 237);  // 蓝色
+        }
+        // 根据深度设置颜色：顶层绿色，内部浅绿色
+        return item->depth == 0 ? QColor(81, 207, 102) : QColor(150, 180, 150);
+    case NodePointerRole:
+        return QVariant::fromValue(reinterpret_cast<quintptr>(node));
+    case InternalNodeRole:
+        return item->depth > 0;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant SceneNodeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return QString("绘图中的节点 (%1)").arg(m_root.children.size());
+    }
+    return QVariant();
+}
+
+/**
+ * @brief 获取顶层节点的索引
+ */
+QModelIndex SceneNodeModel::indexOf(Node *node) const
+{
+    Item *item = m_topLevelItems.value(node);
+    return item ? createIndex(item->row, 0, item) : QModelIndex();
+}
+
+/**
+ * @brief 获取索引对应的节点
+ */
+Node* SceneNodeModel::nodeAt(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Item*>(index.internalPointer())->node : nullptr;
+}
+
+/**
+ * @brief 节点加入场景后追加顶层行
+ */
+void SceneNodeModel::onNodesInserted(const QList<Node*> &nodes)
+{
+    QList<Node*> added;
+    added.reserve(nodes.size());
+    for (Node *node : nodes) {
+        if (node && !m_topLevelItems.contains(node)) {
+            added.append(node);
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    const int first = m_root.children.size();
+    beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+    m_root.children.reserve(first + added.size());
+    m_topLevelItems.reserve(first + added.size());
+    for (int i = 0; i < added.size(); ++i) {
+        Item *item = createItem(added[i], &m_root, first + i);
+        m_root.children.append(item);
+        m_topLevelItems.insert(added[i], item);
+    }
+    endInsertRows();
+    emit headerDataChanged(Qt::Horizontal, 0, 0);
+}
+
+/**
+ * @brief 节点移出场景后删除对应的顶层行
+ *
+ * 只需重新编号被删除行之后的兄弟行。
+ */
+void SceneNodeModel::onNodeRemoved(Node *node)
+{
+    Item *item = m_topLevelItems.value(node);
+    if (!item) {
+        return;
+    }
+
+    const int row = item->row;
+    beginRemoveRows(QModelIndex(), row, row);
+    m_topLevelItems.remove(node);
+    m_root.children.removeAt(row);
+    for (int i = row; i < m_root.children.size(); ++i) {
+        m_root.children[i]->row = i;
+    }
+    deleteChildren(item);
+    delete item;
+    endRemoveRows();
+    emit headerDataChanged(Qt::Horizontal, 0, 0);
+}
+
+/**
+ * @brief 节点显示属性变化后刷新对应行
+ */
+void SceneNodeModel::onNodeChanged(Node *node)
+{
+    const QModelIndex index = indexOf(node);
+    if (index.isValid()) {
+        emit dataChanged(index, index);
+    }
+}
+
+/**
+ * @brief 场景清空后重置模型
+ *
+ * 此时节点已被删除，只释放行结构，不访问节点。
+ */
+void SceneNodeModel::onNodesCleared()
+{
+    beginResetModel();
+    deleteChildren(&m_root);
+    m_topLevelItems.clear();
+    rebuildTopLevel();
+    endResetModel();
+}
+
+/**
+ * @brief 创建一行
+ */
+SceneNodeModel::Item* SceneNodeModel::createItem(Node *node, Item *parent, int row) const
+{
+    Item *item = new Item;
+    item->node = node;
+    item->group = dynamic_cast<GroupNode*>(node);
+    item->parent = parent;
+    item->row = row;
+    item->depth = parent->depth + 1;
+    item->fetched = !item->group;
+    return item;
+}
+
+/**
+ * @brief 删除一行的所有子行
+ */
+void SceneNodeModel::deleteChildren(Item *item)
+{
+    for (Item *child : item->children) {
+        deleteChildren(child);
+        delete child;
+    }
+    item->children.clear();
+}
+
+/**
+ * @brief 获取索引对应的行
+ */
+SceneNodeModel::Item* SceneNodeModel::itemAt(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Item*>(index.internalPointer()) : &m_root;
+}
+
+/**
+ * @brief 从场景的节点列表重建所有顶层行
+ */
+void SceneNodeModel::rebuildTopLevel()
+{
+    const QList<Node*> &nodes = m_scene->getNodes();
+    m_root.children.reserve(nodes.size());
+    m_topLevelItems.reserve(nodes.size());
+    for (Node *node : nodes) {
+        Item *item = createItem(node, &m_root, m_root.children.size());
+        m_root.children.append(item);
+        m_topLevelItems.insert(node, item);
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * @file SceneNodeModel.h
+ * @brief 场景节点树模型类头文件，为场景节点停靠窗口提供增量更新的树形数据
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef SCENENODEMODEL_H
+#define SCENENODEMODEL_H
+
+#include <QAbstractItemModel>          // 数据模型基类
+#include <QHash>                       // 哈希表类
+#include <QList>                       // 列表类
+
+// 前向声明
+class NodeScene;                       // 节点场景类
+class Node;                            // 节点类
+class GroupNode;                       // 组节点类
+
+/**
+ * @class SceneNodeModel
+ * @brief 场景节点树模型
+ *
+ * 顶层行是场景中的节点，顺序与 NodeScene::getNodes 相同；组节点的子行是其内部节点。
+ * 模型跟随 NodeScene 的 nodesInserted/nodeRemoved/nodeChanged/nodesCleared 信号逐行插入、删除和刷新，
+ * 不再在每次场景变化时重建整棵树，视图的展开状态和滚动位置自然保留。
+ * 组节点的子行在视图第一次展开时通过 fetchMore 才创建，延迟加载的组节点此时才解码内部子图。
+ * 每个顶层节点到其行的映射保存在哈希表中，按节点查找索引（用于与画布同步选择）是常数时间。
+ */
+class SceneNodeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 自定义数据角色
+     */
+    enum Role {
+        NodePointerRole = Qt::UserRole,   ///< 节点指针（quintptr）
+        InternalNodeRole                  ///< 是否为组节点的内部节点（bool）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param scene 节点场景
+     * @param parent 父对象指针
+     */
+    explicit SceneNodeModel(NodeScene *scene, QObject *parent = nullptr);
+
+    /**
+     * @brief 析构函数
+     */
+    ~SceneNodeModel() override;
+
+    // QAbstractItemModel 接口
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief 获取顶层节点的索引
+     * @param node 场景中的节点
+     * @return 模型索引，节点不在顶层时返回无效索引
+     */
+    QModelIndex indexOf(Node *node) const;
+
+    /**
+     * @brief 获取索引对应的节点
+     * @param index 模型索引
+     * @return 节点指针，无效索引返回空指针
+     */
+    Node* nodeAt(const QModelIndex &index) const;
+
+private slots:
+    /**
+     * @brief 节点加入场景后追加顶层行
+     * @param nodes 新加入的节点
+     */
+    void onNodesInserted(const QList<Node*> &nodes);
+
+    /**
+     * @brief 节点移出场景后删除对应的顶层行（连同已创建的子行）
+     * @param node 被移出的节点
+     */
+    void onNodeRemoved(Node *node);
+
+    /**
+     * @brief 节点名称、等级等显示属性变化后刷新对应行
+     * @param node 变化的节点
+     */
+    void onNodeChanged(Node *node);
+
+    /**
+     * @brief 场景清空后重置模型
+     */
+    void onNodesCleared();
+
+private:
+    /**
+     * @brief 树中的一行
+     */
+    struct Item {
+        Node *node = nullptr;          ///< 节点
+        GroupNode *group = nullptr;    ///< 节点为组节点时的指针
+        Item *parent = nullptr;        ///< 父行（顶层行的父行是根）
+        int row = 0;                   ///< 在父行中的行号
+        int depth = 0;                 ///< 嵌套深度（顶层为0）
+        bool fetched = false;          ///< 组节点的子行是否已创建
+        QList<Item*> children;         ///< 子行
+    };
+
+    /**
+     * @brief 创建一行
+     * @param node 节点
+     * @param parent 父行
+     * @param row 行号
+     * @return 新建的行
+     */
+    Item* createItem(Node *node, Item *parent, int row) const;
+
+    /**
+     * @brief 删除一行的所有子行
+     * @param item 行
+     */
+    void deleteChildren(Item *item);
+
+    /**
+     * @brief 获取索引对应的行
+     * @param index 模型索引，无效索引表示根
+     * @return 行指针
+     */
+    Item* itemAt(const QModelIndex &index) const;
+
+    /**
+     * @brief 从场景的节点列表重建所有顶层行
+     */
+    void rebuildTopLevel();
+
+    NodeScene *m_scene;                        ///< 节点场景
+    mutable Item m_root;                        ///< 根（不对应任何节点）
+    QHash<Node*, Item*> m_topLevelItems;       ///< 顶层节点到行的映射
+};
+
+#endif // SCENENODEMODEL_H
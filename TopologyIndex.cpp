@@ -0,0 +1,333 @@
+/**
+ * @file TopologyIndex.cpp
+ * @brief 拓扑序索引类实现文件
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "TopologyIndex.h"
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+
+/**
+ * @brief 加入节点，序号排在所有已有节点之后
+ * @param node 节点指针
+ *
+ * 新节点没有任何边，排在末尾不违反已有顺序。
+ */
+void TopologyIndex::insertNode(Node *node)
+{
+    if (!node || m_vertices.contains(node)) {
+        return;
+    }
+    m_vertices[node].order = m_nextOrder++;
+}
+
+/**
+ * @brief 移除节点及其所有关联边
+ * @param node 节点指针
+ */
+void TopologyIndex::removeNode(Node *node)
+{
+    auto it = m_vertices.find(node);
+    if (it == m_vertices.end()) {
+        return;
+    }
+
+    for (auto s = it->successors.cbegin(); s != it->successors.cend(); ++s) {
+        auto succ = m_vertices.find(s.key());
+        if (succ != m_vertices.end()) {
+            succ->predecessors.remove(node);
+        }
+    }
+    for (auto p = it->predecessors.cbegin(); p != it->predecessors.cend(); ++p) {
+        auto pred = m_vertices.find(p.key());
+        if (pred != m_vertices.end()) {
+            pred->successors.remove(node);
+        }
+    }
+    m_vertices.erase(it);
+
+    for (auto c = m_cyclicEdges.begin(); c != m_cyclicEdges.end();) {
+        if (c.key().first == node || c.key().second == node) {
+            c = m_cyclicEdges.erase(c);
+        } else {
+            ++c;
+        }
+    }
+
+    // 移除节点可能打断了环路
+    if (!m_cyclicEdges.isEmpty()) {
+        retryCyclicEdges();
+    }
+}
+
+/**
+ * @brief 加入一条边
+ * @param from 源节点
+ * @param to 目标节点
+ * @return 边加入了拓扑序返回true；边会形成环路时记为环路边并返回false
+ *
+ * 端点不在索引中的边不记录（视为加入成功）。
+ */
+bool TopologyIndex::insertEdge(Node *from, Node *to)
+{
+    auto fromIt = m_vertices.find(from);
+    auto toIt = m_vertices.find(to);
+    if (fromIt == m_vertices.end() || toIt == m_vertices.end()) {
+        return true;
+    }
+
+    const Edge edge(from, to);
+    auto cyclic = m_cyclicEdges.find(edge);
+    if (cyclic != m_cyclicEdges.end()) {
+        ++cyclic.value();
+        return false;
+    }
+
+    // 已有的边只增加重数
+    auto existing = fromIt->successors.find(to);
+    if (existing != fromIt->successors.end()) {
+        ++existing.value();
+        ++toIt->predecessors[from];
+        return true;
+    }
+
+    if (from == to) {
+        m_cyclicEdges.insert(edge, 1);
+        return false;
+    }
+
+    const int lowerBound = toIt->order;
+    const int upperBound = fromIt->order;
+    if (lowerBound < upperBound) {
+        // 顺序相反：只在两端点序号之间搜索受影响区域
+        QList<Node*> forward;
+        if (collectForward(to, upperBound, from, forward)) {
+            m_cyclicEdges.insert(edge, 1);
+            return false;
+        }
+        QList<Node*> backward;
+        collectBackward(from, lowerBound, backward);
+        reorder(backward, forward);
+    }
+
+    // reorder 不增删条目，迭代器仍然有效
+    fromIt->successors.insert(to, 1);
+    toIt->predecessors.insert(from, 1);
+    return true;
+}
+
+/**
+ * @brief 移除一条边
+ * @param from 源节点
+ * @param to 目标节点
+ *
+ * 删除边不会破坏拓扑序；最后一条 from→to 连接被删除时重新尝试加入环路边。
+ */
+void TopologyIndex::removeEdge(Node *from, Node *to)
+{
+    const Edge edge(from, to);
+    auto cyclic = m_cyclicEdges.find(edge);
+    if (cyclic != m_cyclicEdges.end()) {
+        if (--cyclic.value() == 0) {
+            m_cyclicEdges.erase(cyclic);
+        }
+        return;
+    }
+
+    auto fromIt = m_vertices.find(from);
+    auto toIt = m_vertices.find(to);
+    if (fromIt == m_vertices.end() || toIt == m_vertices.end()) {
+        return;
+    }
+    auto succ = fromIt->successors.find(to);
+    if (succ == fromIt->successors.end()) {
+        return;
+    }
+    if (--succ.value() > 0) {
+        --toIt->predecessors[from];
+        return;
+    }
+    fromIt->successors.erase(succ);
+    toIt->predecessors.remove(from);
+
+    if (!m_cyclicEdges.isEmpty()) {
+        retryCyclicEdges();
+    }
+}
+
+/**
+ * @brief 清空索引
+ */
+void TopologyIndex::clear()
+{
+    m_vertices.clear();
+    m_cyclicEdges.clear();
+    m_nextOrder = 0;
+}
+
+/**
+ * @brief 加入一条边是否会形成环路（不修改索引）
+ * @param from 源节点
+ * @param to 目标节点
+ * @return 会形成环路返回true
+ *
+ * 目标序号大于源序号时一定无环，常数时间返回；
+ * 否则只搜索从目标出发、序号小于源节点的后继节点。
+ */
+bool TopologyIndex::wouldCreateCycle(Node *from, Node *to) const
+{
+    if (from == to) {
+        return from != nullptr;
+    }
+    auto fromIt = m_vertices.constFind(from);
+    auto toIt = m_vertices.constFind(to);
+    if (fromIt == m_vertices.cend() || toIt == m_vertices.cend()) {
+        return false;
+    }
+    if (toIt->order > fromIt->order || fromIt->successors.contains(to)) {
+        return false;
+    }
+    QList<Node*> visited;
+    return collectForward(to, fromIt->order, from, visited);
+}
+
+/**
+ * @brief 获取节点的拓扑序号
+ * @param node 节点指针
+ * @return 序号，节点不在索引中返回-1
+ */
+int TopologyIndex::order(Node *node) const
+{
+    auto it = m_vertices.constFind(node);
+    return it == m_vertices.cend() ? -1 : it->order;
+}
+
+/**
+ * @brief 获取按拓扑序排列的全部节点
+ * @return 节点列表
+ */
+QList<Node*> TopologyIndex::sortedNodes() const
+{
+    QVector<QPair<int, Node*>> entries;
+    entries.reserve(m_vertices.size());
+    for (auto it = m_vertices.cbegin(); it != m_vertices.cend(); ++it) {
+        entries.append(qMakePair(it->order, it.key()));
+    }
+    std::sort(entries.begin(), entries.end(), [](const QPair<int, Node*> &a, const QPair<int, Node*> &b) {
+        return a.first < b.first;
+    });
+
+    QList<Node*> nodes;
+    nodes.reserve(entries.size());
+    for (const auto &entry : entries) {
+        nodes.append(entry.second);
+    }
+    return nodes;
+}
+
+/**
+ * @brief 从起点沿后继方向搜索序号小于上界的节点
+ */
+bool TopologyIndex::collectForward(Node *start, int upperBound, Node *target, QList<Node*> &visited) const
+{
+    QSet<Node*> seen;
+    QList<Node*> stack;
+    seen.insert(start);
+    stack.append(start);
+
+    while (!stack.isEmpty()) {
+        Node *node = stack.takeLast();
+        visited.append(node);
+        const Vertex &vertex = *m_vertices.constFind(node);
+        for (auto it = vertex.successors.cbegin(); it != vertex.successors.cend(); ++it) {
+            Node *succ = it.key();
+            if (succ == target) {
+                return true;
+            }
+            // 序号不小于上界的节点不可能到达目标，也不需要重排
+            if (m_vertices.constFind(succ)->order < upperBound && !seen.contains(succ)) {
+                seen.insert(succ);
+                stack.append(succ);
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 从起点沿前驱方向搜索序号大于下界的节点
+ */
+void TopologyIndex::collectBackward(Node *start, int lowerBound, QList<Node*> &visited) const
+{
+    QSet<Node*> seen;
+    QList<Node*> stack;
+    seen.insert(start);
+    stack.append(start);
+
+    while (!stack.isEmpty()) {
+        Node *node = stack.takeLast();
+        visited.append(node);
+        const Vertex &vertex = *m_vertices.constFind(node);
+        for (auto it = vertex.predecessors.cbegin(); it != vertex.predecessors.cend(); ++it) {
+            Node *pred = it.key();
+            if (m_vertices.constFind(pred)->order > lowerBound && !seen.contains(pred)) {
+                seen.insert(pred);
+                stack.append(pred);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 重排受影响区域的序号
+ *
+ * 两个区域原来占用的序号集合排序后依次分配给“前驱区域 + 后继区域”，
+ * 区域外节点的序号不变。
+ */
+void TopologyIndex::reorder(QList<Node*> &backward, QList<Node*> &forward)
+{
+    auto byOrder = [this](Node *a, Node *b) {
+        return m_vertices.constFind(a)->order < m_vertices.constFind(b)->order;
+    };
+    std::sort(backward.begin(), backward.end(), byOrder);
+    std::sort(forward.begin(), forward.end(), byOrder);
+
+    QVector<int> orders;
+    orders.reserve(backward.size() + forward.size());
+    for (Node *node : backward) {
+        orders.append(m_vertices.constFind(node)->order);
+    }
+    for (Node *node : forward) {
+        orders.append(m_vertices.constFind(node)->order);
+    }
+    std::sort(orders.begin(), orders.end());
+
+    int i = 0;
+    for (Node *node : backward) {
+        m_vertices[node].order = orders[i++];
+    }
+    for (Node *node : forward) {
+        m_vertices[node].order = orders[i++];
+    }
+}
+
+/**
+ * @brief 重新尝试把环路边加入拓扑序
+ */
+void TopologyIndex::retryCyclicEdges()
+{
+    const QList<Edge> edges = m_cyclicEdges.keys();
+    for (const Edge &edge : edges) {
+        if (wouldCreateCycle(edge.first, edge.second)) {
+            continue;
+        }
+        const int count = m_cyclicEdges.take(edge);
+        for (int i = 0; i < count; ++i) {
+            insertEdge(edge.first, edge.second);
+        }
+    }
+}
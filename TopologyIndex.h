@@ -0,0 +1,155 @@
+/**
+ * @file TopologyIndex.h
+ * @brief 拓扑序索引类头文件，随连接的增删增量维护场景节点图的拓扑序
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#ifndef TOPOLOGYINDEX_H
+#define TOPOLOGYINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+
+// 前向声明
+class Node;                            // 节点类
+
+/**
+ * @class TopologyIndex
+ * @brief 拓扑序索引类
+ *
+ * 为每个节点保存一个整数序号，保证每条边的源节点序号小于目标节点序号（Pearce–Kelly 动态拓扑排序）。
+ * 插入一条与当前顺序一致的边只需常数时间；顺序相反时只搜索序号落在两端点之间、
+ * 且与两端点相连的节点（受影响区域），在同一次搜索中判断是否成环，并只重排这些节点的序号。
+ * 删除边或节点不会破坏已有顺序，无需重排。
+ *
+ * 会形成环路的边（如从旧文件加载的环）单独记录，不参与排序；
+ * 之后删除任意边时重新尝试把它们加入排序，环被打断后索引自动恢复无环状态。
+ *
+ * 索引由 NodeScene 持有，节点和连接加入/离开场景时同步更新。
+ */
+class TopologyIndex
+{
+public:
+    /**
+     * @brief 加入节点，序号排在所有已有节点之后
+     * @param node 节点指针
+     */
+    void insertNode(Node *node);
+
+    /**
+     * @brief 移除节点及其所有关联边
+     * @param node 节点指针
+     */
+    void removeNode(Node *node);
+
+    /**
+     * @brief 加入一条边（同一对节点之间的多条连接按重数计数）
+     * @param from 源节点
+     * @param to 目标节点
+     * @return 边加入了拓扑序返回true；边会形成环路时记为环路边并返回false
+     */
+    bool insertEdge(Node *from, Node *to);
+
+    /**
+     * @brief 移除一条边
+     * @param from 源节点
+     * @param to 目标节点
+     */
+    void removeEdge(Node *from, Node *to);
+
+    /**
+     * @brief 清空索引
+     */
+    void clear();
+
+    /**
+     * @brief 加入一条边是否会形成环路（不修改索引）
+     * @param from 源节点
+     * @param to 目标节点
+     * @return 会形成环路返回true
+     */
+    bool wouldCreateCycle(Node *from, Node *to) const;
+
+    /**
+     * @brief 节点是否已加入索引
+     * @param node 节点指针
+     * @return 已加入返回true
+     */
+    bool contains(Node *node) const { return m_vertices.contains(node); }
+
+    /**
+     * @brief 获取节点的拓扑序号
+     * @param node 节点指针
+     * @return 序号，节点不在索引中返回-1
+     */
+    int order(Node *node) const;
+
+    /**
+     * @brief 图中是否没有环路边
+     * @return 无环返回true
+     */
+    bool isAcyclic() const { return m_cyclicEdges.isEmpty(); }
+
+    /**
+     * @brief 获取形成环路而未参与排序的边数（同一对节点只计一次）
+     * @return 环路边数
+     */
+    int cyclicEdgeCount() const { return m_cyclicEdges.size(); }
+
+    /**
+     * @brief 获取按拓扑序排列的全部节点（环路边不参与排序）
+     * @return 节点列表
+     */
+    QList<Node*> sortedNodes() const;
+
+private:
+    /**
+     * @brief 索引中的一个节点
+     */
+    struct Vertex {
+        int order = 0;                     ///< 拓扑序号
+        QHash<Node*, int> successors;      ///< 后继节点及连接重数
+        QHash<Node*, int> predecessors;    ///< 前驱节点及连接重数
+    };
+
+    typedef QPair<Node*, Node*> Edge;      ///< 边（源节点, 目标节点）
+
+    /**
+     * @brief 从起点沿后继方向搜索序号小于上界的节点
+     * @param start 起点
+     * @param upperBound 序号上界（不含）
+     * @param target 要检测的节点，搜索到它即表示成环
+     * @param visited 输出：访问到的节点
+     * @return 搜索到目标节点返回true
+     */
+    bool collectForward(Node *start, int upperBound, Node *target, QList<Node*> &visited) const;
+
+    /**
+     * @brief 从起点沿前驱方向搜索序号大于下界的节点
+     * @param start 起点
+     * @param lowerBound 序号下界（不含）
+     * @param visited 输出：访问到的节点
+     */
+    void collectBackward(Node *start, int lowerBound, QList<Node*> &visited) const;
+
+    /**
+     * @brief 重排受影响区域的序号：前驱区域整体排在后继区域之前，区域内保持原有相对顺序
+     * @param backward 前驱区域节点
+     * @param forward 后继区域节点
+     */
+    void reorder(QList<Node*> &backward, QList<Node*> &forward);
+
+    /**
+     * @brief 重新尝试把环路边加入拓扑序
+     */
+    void retryCyclicEdges();
+
+    QHash<Node*, Vertex> m_vertices;       ///< 节点到索引条目的映射
+    QHash<Edge, int> m_cyclicEdges;        ///< 形成环路的边及连接重数
+    int m_nextOrder = 0;                   ///< 下一个新节点的序号
+};
+
+#endif // TOPOLOGYINDEX_H
@@ -12,12 +12,64 @@
 #include "Connection.h"
 #include "GroupNode.h"
 #include <QJsonArray>
+#include <QJsonDocument>
+
+/**
+ * @brief 立即刷新节点所在场景中待更新的连接线
+ * @param node 刚被移动的节点
+ * 
+ * 节点移动时连接线只被标记，撤销/重做移动后立即刷新，
+ * 多节点移动中两端都被移动的连接线只处理一次。
+ */
+static void flushConnectionUpdates(Node *node)
+{
+    // 不在 NodeScene 中的节点在 itemChange 里已直接更新了连接线
+    if (NodeScene *nodeScene = qobject_cast<NodeScene*>(node->scene())) {
+        nodeScene->flushConnectionUpdates();
+    }
+}
+
+/**
+ * @brief 估算节点占用的内存
+ * @param node 节点
+ * @return 字节数（组节点包括内部节点）
+ */
+static qint64 nodeCost(const Node *node)
+{
+    qint64 cost = sizeof(Node) + (node->getType().size() + node->getName().size()) * qint64(sizeof(QChar));
+    for (const QString &param : node->getParameters()) {
+        cost += sizeof(QString) + param.size() * qint64(sizeof(QChar));
+    }
+    if (const GroupNode *group = dynamic_cast<const GroupNode*>(node)) {
+        cost += group->internalNodeCount() * qint64(sizeof(Node));
+    }
+    return cost;
+}
+
+/**
+ * @brief 估算一组节点和连接占用的内存
+ * @param nodes 节点
+ * @param connections 连接
+ * @param owned 命令是否持有它们的所有权，不持有时只计算指针
+ * @return 字节数
+ */
+static qint64 itemsCost(const QList<Node*> &nodes, const QList<Connection*> &connections, bool owned)
+{
+    qint64 cost = (nodes.size() + connections.size()) * qint64(sizeof(void*));
+    if (owned) {
+        for (const Node *node : nodes) {
+            cost += nodeCost(node);
+        }
+        cost += connections.size() * qint64(sizeof(Connection));
+    }
+    return cost;
+}
 
 // ==================== AddNodeCommand ====================
 
 AddNodeCommand::AddNodeCommand(NodeScene *scene, const QString &type, const QPointF &pos,
                                QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_scene(scene)
     , m_type(type)
     , m_pos(pos)
@@ -54,33 +106,31 @@ void AddNodeCommand::redo()
     m_ownsNode = false;  // 场景拥有节点
 }
 
+qint64 AddNodeCommand::memoryCost() const
+{
+    return sizeof(*this) + m_type.size() * qint64(sizeof(QChar))
+        + (m_ownsNode && m_node ? nodeCost(m_node) : 0);
+}
+
+void AddNodeCommand::release()
+{
+    // 已执行的添加命令不持有节点，节点留在场景中
+    m_node = nullptr;
+    m_ownsNode = false;
+}
+
 // ==================== DeleteCommand ====================
 
 DeleteCommand::DeleteCommand(NodeScene *scene, const QList<Node*> &nodes,
                              const QList<Connection*> &connections, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_scene(scene)
     , m_deletedNodes(nodes)
     , m_deletedConnections(connections)
     , m_ownsItems(false)
 {
+    // 被删除的节点和连接对象本身保留到命令析构，撤销时原样放回场景，不需要另存快照
     setText(QString("删除 %1 个项目").arg(nodes.size() + connections.size()));
-    
-    // 保存节点数据
-    for (Node *node : nodes) {
-        m_nodeData.append(node->toJson());
-    }
-    
-    // 保存连接数据
-    for (Connection *conn : connections) {
-        QJsonObject connData;
-        connData["fromNodePtr"] = QString::number(reinterpret_cast<quintptr>(conn->getFromNode()));
-        connData["toNodePtr"] = QString::number(reinterpret_cast<quintptr>(conn->getToNode()));
-        connData["fromPort"] = conn->getFromPortIndex();
-        connData["toPort"] = conn->getToPortIndex();
-        connData["lineType"] = static_cast<int>(conn->getLineType());
-        m_connectionData.append(connData);
-    }
 }
 
 DeleteCommand::~DeleteCommand()
@@ -97,6 +147,8 @@ DeleteCommand::~DeleteCommand()
 
 void DeleteCommand::undo()
 {
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, m_deletedNodes.size() + m_deletedConnections.size());
+    
     // 恢复节点
     for (Node *node : m_deletedNodes) {
         m_scene->restoreNodeToScene(node);
@@ -112,6 +164,8 @@ void DeleteCommand::undo()
 
 void DeleteCommand::redo()
 {
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, m_deletedNodes.size() + m_deletedConnections.size());
+    
     // 移除连接
     for (Connection *conn : m_deletedConnections) {
         m_scene->removeConnectionFromScene(conn);
@@ -125,11 +179,28 @@ void DeleteCommand::redo()
     m_ownsItems = true;  // 我们拥有项目
 }
 
+qint64 DeleteCommand::memoryCost() const
+{
+    return sizeof(*this) + itemsCost(m_deletedNodes, m_deletedConnections, m_ownsItems);
+}
+
+void DeleteCommand::release()
+{
+    // 已执行的删除命令持有被删除的项目，不会再撤销时直接删除
+    if (m_ownsItems) {
+        qDeleteAll(m_deletedConnections);
+        qDeleteAll(m_deletedNodes);
+    }
+    m_deletedConnections.clear();
+    m_deletedNodes.clear();
+    m_ownsItems = false;
+}
+
 // ==================== MoveNodeCommand ====================
 
 MoveNodeCommand::MoveNodeCommand(Node *node, const QPointF &oldPos, const QPointF &newPos,
                                  QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_node(node)
     , m_oldPos(oldPos)
     , m_newPos(newPos)
@@ -140,19 +211,13 @@ MoveNodeCommand::MoveNodeCommand(Node *node, const QPointF &oldPos, const QPoint
 void MoveNodeCommand::undo()
 {
     m_node->setPos(m_oldPos);
-    // 更新所有连接线
-    for (Connection *conn : m_node->getConnections()) {
-        conn->updatePath();
-    }
+    flushConnectionUpdates(m_node);
 }
 
 void MoveNodeCommand::redo()
 {
     m_node->setPos(m_newPos);
-    // 更新所有连接线
-    for (Connection *conn : m_node->getConnections()) {
-        conn->updatePath();
-    }
+    flushConnectionUpdates(m_node);
 }
 
 bool MoveNodeCommand::mergeWith(const QUndoCommand *other)
@@ -170,11 +235,21 @@ bool MoveNodeCommand::mergeWith(const QUndoCommand *other)
     return true;
 }
 
+qint64 MoveNodeCommand::memoryCost() const
+{
+    return sizeof(*this);
+}
+
+void MoveNodeCommand::release()
+{
+    m_node = nullptr;
+}
+
 // ==================== MoveNodesCommand ====================
 
 MoveNodesCommand::MoveNodesCommand(const QList<Node*> &nodes, const QList<QPointF> &oldPositions,
                                    const QList<QPointF> &newPositions, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_nodes(nodes)
     , m_oldPositions(oldPositions)
     , m_newPositions(newPositions)
@@ -186,10 +261,9 @@ void MoveNodesCommand::undo()
 {
     for (int i = 0; i < m_nodes.size(); ++i) {
         m_nodes[i]->setPos(m_oldPositions[i]);
-        // 更新所有连接线
-        for (Connection *conn : m_nodes[i]->getConnections()) {
-            conn->updatePath();
-        }
+    }
+    if (!m_nodes.isEmpty()) {
+        flushConnectionUpdates(m_nodes.first());
     }
 }
 
@@ -197,18 +271,49 @@ void MoveNodesCommand::redo()
 {
     for (int i = 0; i < m_nodes.size(); ++i) {
         m_nodes[i]->setPos(m_newPositions[i]);
-        // 更新所有连接线
-        for (Connection *conn : m_nodes[i]->getConnections()) {
-            conn->updatePath();
-        }
+    }
+    if (!m_nodes.isEmpty()) {
+        flushConnectionUpdates(m_nodes.first());
     }
 }
 
+/**
+ * @brief 合并连续移动同一组节点的命令
+ *
+ * 与 MoveNodeCommand::mergeWith 相同：保留最早的原位置，采用最新的目标位置。
+ */
+bool MoveNodesCommand::mergeWith(const QUndoCommand *other)
+{
+    if (other->id() != id()) {
+        return false;
+    }
+    
+    const MoveNodesCommand *moveCmd = static_cast<const MoveNodesCommand*>(other);
+    if (moveCmd->m_nodes != m_nodes) {
+        return false;
+    }
+    
+    m_newPositions = moveCmd->m_newPositions;
+    return true;
+}
+
+qint64 MoveNodesCommand::memoryCost() const
+{
+    return sizeof(*this) + m_nodes.size() * qint64(sizeof(void*) + 2 * sizeof(QPointF));
+}
+
+void MoveNodesCommand::release()
+{
+    m_nodes.clear();
+    m_oldPositions.clear();
+    m_newPositions.clear();
+}
+
 // ==================== AddConnectionCommand ====================
 
 AddConnectionCommand::AddConnectionCommand(NodeScene *scene, Node *fromNode, int fromPort,
                                            Node *toNode, int toPort, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_scene(scene)
     , m_fromNode(fromNode)
     , m_toNode(toNode)
@@ -247,11 +352,22 @@ void AddConnectionCommand::redo()
     m_ownsConnection = false;
 }
 
+qint64 AddConnectionCommand::memoryCost() const
+{
+    return sizeof(*this) + (m_ownsConnection && m_connection ? qint64(sizeof(Connection)) : 0);
+}
+
+void AddConnectionCommand::release()
+{
+    m_connection = nullptr;
+    m_ownsConnection = false;
+}
+
 // ==================== PasteCommand ====================
 
 PasteCommand::PasteCommand(NodeScene *scene, const QJsonObject &clipboardData,
                            const QPointF &offset, QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_scene(scene)
     , m_clipboardData(clipboardData)
     , m_offset(offset)
@@ -275,6 +391,8 @@ PasteCommand::~PasteCommand()
 
 void PasteCommand::undo()
 {
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, m_pastedNodes.size() + m_pastedConnections.size());
+    
     // 先移除连接
     for (Connection *conn : m_pastedConnections) {
         m_scene->removeConnectionFromScene(conn);
@@ -290,6 +408,12 @@ void PasteCommand::undo()
 
 void PasteCommand::redo()
 {
+    // 首次执行时按剪贴板中的数量判断
+    const int itemCount = m_pastedNodes.isEmpty()
+        ? m_clipboardData["nodes"].toArray().size() + m_clipboardData["connections"].toArray().size()
+        : m_pastedNodes.size() + m_pastedConnections.size();
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, itemCount);
+    
     if (m_pastedNodes.isEmpty()) {
         // 首次执行，创建节点和连接
         static int pasteCount = 1;
@@ -314,8 +438,7 @@ void PasteCommand::redo()
             // 生成新名称
             newNode->setName(newNode->getName() + QString(" (副本%1)").arg(pasteCount));
             
-            m_scene->addItem(newNode);
-            m_scene->getNodes().append(newNode);
+            m_scene->restoreNodeToScene(newNode);
             newNodeMap[copyId] = newNode;
             m_pastedNodes.append(newNode);
             
@@ -347,11 +470,13 @@ void PasteCommand::redo()
                     newConn->setLineType(static_cast<Connection::LineType>(connObj["lineType"].toInt()));
                 }
                 
-                m_scene->addItem(newConn);
-                m_scene->getConnections().append(newConn);
+                m_scene->insertConnectionToScene(newConn);
                 m_pastedConnections.append(newConn);
             }
         }
+        
+        // 之后的重做只恢复已创建的项目，不再需要剪贴板副本
+        m_clipboardData = QJsonObject();
     } else {
         // 重做，恢复节点和连接
         for (Node *node : m_pastedNodes) {
@@ -367,13 +492,30 @@ void PasteCommand::redo()
     m_ownsItems = false;
 }
 
+qint64 PasteCommand::memoryCost() const
+{
+    // 剪贴板数据按序列化后的大小近似
+    qint64 clipboardCost = m_clipboardData.isEmpty()
+        ? 0 : QJsonDocument(m_clipboardData).toJson(QJsonDocument::Compact).size();
+    return sizeof(*this) + clipboardCost + itemsCost(m_pastedNodes, m_pastedConnections, m_ownsItems);
+}
+
+void PasteCommand::release()
+{
+    // 已执行的粘贴命令不持有项目，项目留在场景中
+    m_clipboardData = QJsonObject();
+    m_pastedNodes.clear();
+    m_pastedConnections.clear();
+    m_ownsItems = false;
+}
+
 // ==================== GroupNodesCommand ====================
 
 GroupNodesCommand::GroupNodesCommand(NodeScene *scene, const QList<Node*> &nodes,
                                      const QList<Connection*> &internalConnections,
                                      const QList<ExternalConnection> &externalConnections,
                                      QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_scene(scene)
     , m_nodes(nodes)
     , m_internalConnections(internalConnections)
@@ -381,17 +523,8 @@ GroupNodesCommand::GroupNodesCommand(NodeScene *scene, const QList<Node*> &nodes
     , m_groupNode(nullptr)
     , m_firstRedo(true)
 {
+    // 节点原始位置在首次执行时交给组节点保存，撤销时从组节点读取
     setText(QString("打包 %1 个节点").arg(nodes.size()));
-    
-    // 保存原始位置
-    for (Node *node : nodes) {
-        m_originalPositions[node] = node->pos();
-    }
-    
-    // 保存外部连接指针
-    for (const ExternalConnection &ext : externalConnections) {
-        m_externalConnectionPtrs.append(ext.originalConnection);
-    }
 }
 
 GroupNodesCommand::~GroupNodesCommand()
@@ -403,6 +536,9 @@ void GroupNodesCommand::undo()
 {
     if (!m_groupNode) return;
     
+    const int itemCount = m_nodes.size() + m_internalConnections.size() + 2 * m_externalConnections.size() + 1;
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, itemCount);
+    
     // 移除组节点与外部的连接
     for (Connection *conn : m_newExternalConnections) {
         m_scene->removeConnectionFromScene(conn);
@@ -412,8 +548,9 @@ void GroupNodesCommand::undo()
     m_scene->removeNodeFromScene(m_groupNode);
     
     // 恢复原始节点
+    const QMap<Node*, QPointF> originalPositions = m_groupNode->getOriginalPositions();
     for (Node *node : m_nodes) {
-        node->setPos(m_originalPositions[node]);
+        node->setPos(originalPositions.value(node, node->pos()));
         m_scene->restoreNodeToScene(node);
     }
     
@@ -423,19 +560,24 @@ void GroupNodesCommand::undo()
     }
     
     // 恢复外部连接
-    for (Connection *conn : m_externalConnectionPtrs) {
-        m_scene->restoreConnectionToScene(conn);
+    for (const ExternalConnection &ext : m_externalConnections) {
+        m_scene->restoreConnectionToScene(ext.originalConnection);
     }
 }
 
 void GroupNodesCommand::redo()
 {
+    const int itemCount = m_nodes.size() + m_internalConnections.size() + 2 * m_externalConnections.size() + 1;
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, itemCount);
+    
     if (m_firstRedo) {
         m_firstRedo = false;
         
-        // 计算组节点位置（所有节点的中心）
+        // 计算组节点位置（所有节点的中心），保存原始位置
+        QMap<Node*, QPointF> originalPositions;
         QPointF center(0, 0);
         for (Node *node : m_nodes) {
+            originalPositions[node] = node->pos();
             center += node->pos();
         }
         center /= m_nodes.size();
@@ -445,12 +587,12 @@ void GroupNodesCommand::redo()
         m_groupNode->setInternalNodes(m_nodes);
         m_groupNode->setInternalConnections(m_internalConnections);
         m_groupNode->setExternalConnections(m_externalConnections);
-        m_groupNode->setOriginalPositions(m_originalPositions);
+        m_groupNode->setOriginalPositions(originalPositions);
         m_groupNode->calculatePortMappings();
         
         // 移除外部连接
-        for (Connection *conn : m_externalConnectionPtrs) {
-            m_scene->removeConnectionFromScene(conn);
+        for (const ExternalConnection &ext : m_externalConnections) {
+            m_scene->removeConnectionFromScene(ext.originalConnection);
         }
         
         // 移除内部连接
@@ -464,8 +606,7 @@ void GroupNodesCommand::redo()
         }
         
         // 添加组节点
-        m_scene->addItem(m_groupNode);
-        m_scene->getNodes().append(m_groupNode);
+        m_scene->restoreNodeToScene(m_groupNode);
         
         // 创建组节点与外部的新连接
         QList<PortMapping> inputMappings = m_groupNode->getInputPortMappings();
@@ -503,16 +644,15 @@ void GroupNodesCommand::redo()
             }
             
             if (newConn) {
-                m_scene->addItem(newConn);
-                m_scene->getConnections().append(newConn);
+                m_scene->insertConnectionToScene(newConn);
                 m_newExternalConnections.append(newConn);
             }
         }
     } else {
         // 重做
         // 移除外部连接
-        for (Connection *conn : m_externalConnectionPtrs) {
-            m_scene->removeConnectionFromScene(conn);
+        for (const ExternalConnection &ext : m_externalConnections) {
+            m_scene->removeConnectionFromScene(ext.originalConnection);
         }
         
         // 移除内部连接
@@ -535,13 +675,31 @@ void GroupNodesCommand::redo()
     }
 }
 
+qint64 GroupNodesCommand::memoryCost() const
+{
+    return sizeof(*this)
+        + (m_nodes.size() + m_internalConnections.size() + m_newExternalConnections.size()) * qint64(sizeof(void*))
+        + m_externalConnections.size() * qint64(sizeof(ExternalConnection));
+}
+
+void GroupNodesCommand::release()
+{
+    // 被打包的节点和连接由组节点持有，这里只丢弃引用
+    m_nodes.clear();
+    m_internalConnections.clear();
+    m_externalConnections.clear();
+    m_newExternalConnections.clear();
+    m_groupNode = nullptr;
+}
+
 // ==================== UngroupNodesCommand ====================
 
 UngroupNodesCommand::UngroupNodesCommand(NodeScene *scene, GroupNode *groupNode,
                                          QUndoCommand *parent)
-    : QUndoCommand(parent)
+    : SceneUndoCommand(parent)
     , m_scene(scene)
     , m_groupNode(groupNode)
+    , m_ownsGroup(false)
     , m_firstRedo(true)
 {
     setText(QString("拆分组节点"));
@@ -557,11 +715,34 @@ UngroupNodesCommand::UngroupNodesCommand(NodeScene *scene, GroupNode *groupNode,
 
 UngroupNodesCommand::~UngroupNodesCommand()
 {
-    // 注意：节点和连接的生命周期由场景管理
+    // 内部节点和连接由场景或组节点管理；已执行时移出场景的组节点及其外部连接只由本命令持有
+    deleteOwnedGroup();
+}
+
+/**
+ * @brief 删除已移出场景的组节点及其外部连接（仅在命令持有它们时）
+ * 
+ * 先删除连接（连接析构时从两端节点的连接列表中移除自己），再删除组节点；
+ * GroupNode 析构时不删除内部节点和连接。
+ */
+void UngroupNodesCommand::deleteOwnedGroup()
+{
+    if (!m_ownsGroup) {
+        return;
+    }
+    qDeleteAll(m_groupExternalConnections);
+    delete m_groupNode;
+    m_groupExternalConnections.clear();
+    m_groupNode = nullptr;
+    m_ownsGroup = false;
 }
 
 void UngroupNodesCommand::undo()
 {
+    const int itemCount = m_internalNodes.size() + m_internalConnections.size()
+                          + m_externalConnections.size() + m_groupExternalConnections.size() + 1;
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, itemCount);
+    
     // 移除恢复的外部连接
     for (const ExternalConnection &ext : m_externalConnections) {
         if (ext.originalConnection) {
@@ -586,10 +767,15 @@ void UngroupNodesCommand::undo()
     for (Connection *conn : m_groupExternalConnections) {
         m_scene->restoreConnectionToScene(conn);
     }
+    m_ownsGroup = false;  // 场景拥有组节点
 }
 
 void UngroupNodesCommand::redo()
 {
+    const int itemCount = m_internalNodes.size() + m_internalConnections.size()
+                          + m_externalConnections.size() + m_groupExternalConnections.size() + 1;
+    NodeScene::BulkUpdateGuard bulkUpdate(m_scene, itemCount);
+    
     // 移除组节点的外部连接
     for (Connection *conn : m_groupExternalConnections) {
         m_scene->removeConnectionFromScene(conn);
@@ -597,6 +783,7 @@ void UngroupNodesCommand::redo()
     
     // 移除组节点
     m_scene->removeNodeFromScene(m_groupNode);
+    m_ownsGroup = true;  // 组节点及其外部连接只由本命令持有
     
     // 计算位置偏移（组节点当前位置与原始中心的偏移）
     QPointF groupPos = m_groupNode->pos();
@@ -629,3 +816,23 @@ void UngroupNodesCommand::redo()
     }
 }
 
+qint64 UngroupNodesCommand::memoryCost() const
+{
+    return sizeof(*this)
+        + (m_internalNodes.size() + m_internalConnections.size() + m_groupExternalConnections.size()) * qint64(sizeof(void*))
+        + m_externalConnections.size() * qint64(sizeof(ExternalConnection))
+        + m_originalPositions.size() * qint64(sizeof(void*) + sizeof(QPointF))
+        + (m_ownsGroup ? qint64(sizeof(GroupNode)) + m_groupExternalConnections.size() * qint64(sizeof(Connection)) : 0);
+}
+
+void UngroupNodesCommand::release()
+{
+    // 已执行的拆分命令持有移出场景的组节点，不会再撤销时直接删除；内部节点和连接留在场景中
+    deleteOwnedGroup();
+    m_groupNode = nullptr;
+    m_internalNodes.clear();
+    m_internalConnections.clear();
+    m_externalConnections.clear();
+    m_groupExternalConnections.clear();
+    m_originalPositions.clear();
+}
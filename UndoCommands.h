@@ -20,11 +20,37 @@ class NodeScene;
 class Node;
 class Connection;
 
+/**
+ * @class SceneUndoCommand
+ * @brief 场景撤销命令的基类，报告命令占用的内存并可以释放撤销状态
+ *
+ * NodeScene 按 memoryCost() 统计撤销历史的内存，超过预算时从最旧的命令开始调用 release()，
+ * 被释放的命令不能再撤销（见 NodeScene::setUndoMemoryBudget）。
+ */
+class SceneUndoCommand : public QUndoCommand
+{
+public:
+    explicit SceneUndoCommand(QUndoCommand *parent = nullptr) : QUndoCommand(parent) {}
+
+    /**
+     * @brief 估算命令占用的内存
+     * @return 字节数，包括命令持有所有权的节点和连接
+     */
+    virtual qint64 memoryCost() const = 0;
+
+    /**
+     * @brief 释放撤销所需的状态（命令此后不会再被撤销或重做）
+     *
+     * 只对已执行的命令调用：场景中的图形项保持不变，命令持有所有权的图形项被删除。
+     */
+    virtual void release() = 0;
+};
+
 /**
  * @class AddNodeCommand
  * @brief 添加节点的撤销命令
  */
-class AddNodeCommand : public QUndoCommand
+class AddNodeCommand : public SceneUndoCommand
 {
 public:
     AddNodeCommand(NodeScene *scene, const QString &type, const QPointF &pos, 
@@ -33,6 +59,8 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
     
     Node* getNode() const { return m_node; }
 
@@ -48,7 +76,7 @@ private:
  * @class DeleteCommand
  * @brief 删除节点和连接的撤销命令
  */
-class DeleteCommand : public QUndoCommand
+class DeleteCommand : public SceneUndoCommand
 {
 public:
     DeleteCommand(NodeScene *scene, const QList<Node*> &nodes, 
@@ -57,11 +85,11 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
 
 private:
     NodeScene *m_scene;
-    QList<QJsonObject> m_nodeData;      // 节点的JSON数据
-    QList<QJsonObject> m_connectionData; // 连接的JSON数据
     QList<Node*> m_deletedNodes;
     QList<Connection*> m_deletedConnections;
     bool m_ownsItems;  // 是否拥有项目的所有权
@@ -71,7 +99,7 @@ private:
  * @class MoveNodeCommand
  * @brief 移动节点的撤销命令
  */
-class MoveNodeCommand : public QUndoCommand
+class MoveNodeCommand : public SceneUndoCommand
 {
 public:
     MoveNodeCommand(Node *node, const QPointF &oldPos, const QPointF &newPos,
@@ -79,6 +107,8 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
     
     int id() const override { return 1; }
     bool mergeWith(const QUndoCommand *other) override;
@@ -93,7 +123,7 @@ private:
  * @class MoveNodesCommand
  * @brief 移动多个节点的撤销命令
  */
-class MoveNodesCommand : public QUndoCommand
+class MoveNodesCommand : public SceneUndoCommand
 {
 public:
     MoveNodesCommand(const QList<Node*> &nodes, const QList<QPointF> &oldPositions,
@@ -101,6 +131,11 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
+    
+    int id() const override { return 2; }
+    bool mergeWith(const QUndoCommand *other) override;
 
 private:
     QList<Node*> m_nodes;
@@ -112,7 +147,7 @@ private:
  * @class AddConnectionCommand
  * @brief 添加连接的撤销命令
  */
-class AddConnectionCommand : public QUndoCommand
+class AddConnectionCommand : public SceneUndoCommand
 {
 public:
     AddConnectionCommand(NodeScene *scene, Node *fromNode, int fromPort,
@@ -121,6 +156,8 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
     
     Connection* getConnection() const { return m_connection; }
 
@@ -138,7 +175,7 @@ private:
  * @class PasteCommand
  * @brief 粘贴操作的撤销命令
  */
-class PasteCommand : public QUndoCommand
+class PasteCommand : public SceneUndoCommand
 {
 public:
     PasteCommand(NodeScene *scene, const QJsonObject &clipboardData, 
@@ -147,10 +184,12 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
 
 private:
     NodeScene *m_scene;
-    QJsonObject m_clipboardData;
+    QJsonObject m_clipboardData;        ///< 剪贴板数据，首次执行后释放
     QPointF m_offset;
     QList<Node*> m_pastedNodes;
     QList<Connection*> m_pastedConnections;
@@ -161,7 +200,7 @@ private:
  * @class GroupNodesCommand
  * @brief 打包节点的撤销命令
  */
-class GroupNodesCommand : public QUndoCommand
+class GroupNodesCommand : public SceneUndoCommand
 {
 public:
     GroupNodesCommand(NodeScene *scene, const QList<Node*> &nodes,
@@ -172,6 +211,8 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
     
     GroupNode* getGroupNode() const { return m_groupNode; }
 
@@ -179,9 +220,7 @@ private:
     NodeScene *m_scene;
     QList<Node*> m_nodes;                           ///< 被打包的节点
     QList<Connection*> m_internalConnections;       ///< 内部连接
-    QList<ExternalConnection> m_externalConnections;///< 外部连接信息
-    QList<Connection*> m_externalConnectionPtrs;    ///< 外部连接指针
-    QMap<Node*, QPointF> m_originalPositions;       ///< 节点原始位置
+    QList<ExternalConnection> m_externalConnections;///< 外部连接信息（含原连接指针）
     GroupNode *m_groupNode;                         ///< 创建的组节点
     QList<Connection*> m_newExternalConnections;    ///< 与组节点的新连接
     bool m_firstRedo;
@@ -191,7 +230,7 @@ private:
  * @class UngroupNodesCommand
  * @brief 拆分组节点的撤销命令
  */
-class UngroupNodesCommand : public QUndoCommand
+class UngroupNodesCommand : public SceneUndoCommand
 {
 public:
     UngroupNodesCommand(NodeScene *scene, GroupNode *groupNode,
@@ -200,8 +239,15 @@ public:
     
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override;
+    void release() override;
 
 private:
+    /**
+     * @brief 删除已移出场景的组节点及其外部连接（仅在命令持有它们时）
+     */
+    void deleteOwnedGroup();
+    
     NodeScene *m_scene;
     GroupNode *m_groupNode;
     QList<Node*> m_internalNodes;
@@ -209,6 +255,7 @@ private:
     QList<ExternalConnection> m_externalConnections;
     QList<Connection*> m_groupExternalConnections;  ///< 组节点的外部连接
     QMap<Node*, QPointF> m_originalPositions;
+    bool m_ownsGroup;                                ///< 组节点及其外部连接已移出场景，由本命令持有
     bool m_firstRedo;
 };
 
@@ -0,0 +1,123 @@
+/**
+ * @file cli_main.cpp
+ * @brief 命令行代码生成工具入口文件（以 CONFIG+=headless 构建，只依赖 QtCore）
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "BatchGenerator.h"  // 批量代码生成器类
+#include <QCommandLineParser> // 命令行解析类
+#include <QCoreApplication>   // Qt控制台应用程序类
+#include <QDir>               // 目录类
+#include <QElapsedTimer>      // 计时器类
+#include <QTextStream>        // 文本流类
+
+/**
+ * @brief 把纳秒格式化为毫秒文本
+ * @param ns 纳秒
+ * @return 毫秒文本
+ */
+static QString formatMs(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 2) + "ms";
+}
+
+/**
+ * @brief 程序主入口函数
+ * @param argc 命令行参数个数
+ * @param argv 命令行参数数组
+ * @return 全部文件成功返回0，任一文件失败返回1，参数错误返回2
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("dagflow-codegen");
+    app.setApplicationVersion("1.0.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("为流程图JSON文件批量生成代码");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("files", "流程图JSON文件", "<file.json>...");
+
+    QCommandLineOption backendOption(QStringList() << "b" << "backend",
+        "生成后端：json、cpp、python、yaml，可重复指定（默认 cpp）", "backend");
+    QCommandLineOption outputOption(QStringList() << "o" << "output-dir",
+        "输出目录（默认输出到输入文件所在目录）", "dir");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+        "同时处理的文件数（默认CPU核心数）", "n", "0");
+    QCommandLineOption pipelineOption("pipeline", "C++使用模板流水线后端");
+    QCommandLineOption workersOption("workers",
+        "生成的C++代码的工作线程数（1为顺序执行，默认0自动）", "n", "0");
+    parser.addOption(backendOption);
+    parser.addOption(outputOption);
+    parser.addOption(jobsOption);
+    parser.addOption(pipelineOption);
+    parser.addOption(workersOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList inputFiles = parser.positionalArguments();
+    if (inputFiles.isEmpty()) {
+        err << "没有输入文件\n";
+        parser.showHelp(2);
+    }
+
+    BatchGenerator::Options options;
+    if (parser.isSet(backendOption)) {
+        options.backends.clear();
+        for (const QString &name : parser.values(backendOption)) {
+            BatchGenerator::Backend backend;
+            if (!BatchGenerator::backendFromName(name, &backend)) {
+                err << "未知的后端: " << name << "\n";
+                return 2;
+            }
+            if (!options.backends.contains(backend)) {
+                options.backends.append(backend);
+            }
+        }
+    }
+    options.outputDir = parser.value(outputOption);
+    options.templatePipeline = parser.isSet(pipelineOption);
+    options.maxWorkers = parser.value(workersOption).toInt();
+
+    if (!options.outputDir.isEmpty() && !QDir().mkpath(options.outputDir)) {
+        err << "无法创建输出目录: " << options.outputDir << "\n";
+        return 2;
+    }
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    const BatchGenerator generator(options);
+    const QList<BatchGenerator::Result> results = generator.run(inputFiles, parser.value(jobsOption).toInt());
+
+    // 每个文件一行：读取耗时、各后端耗时和结果
+    int failed = 0;
+    int written = 0;
+    int unchanged = 0;
+    for (const BatchGenerator::Result &result : results) {
+        QString line = result.inputFile + "  load " + formatMs(result.loadNs);
+        for (int i = 0; i < result.backendNs.size(); ++i) {
+            line += QString("  %1 %2").arg(BatchGenerator::backendName(options.backends.at(i)),
+                                           formatMs(result.backendNs.at(i)));
+        }
+        if (result.success()) {
+            out << line << "  ok\n";
+            written += result.outputFiles.size() - result.unchangedCount;
+            unchanged += result.unchangedCount;
+        } else {
+            err << line << "  失败: " << result.error << "\n";
+            ++failed;
+        }
+    }
+
+    out << QString("%1 个文件，%2 个失败，写入 %3 个，未变化 %4 个，用时 %5\n")
+        .arg(results.size()).arg(failed).arg(written).arg(unchanged)
+        .arg(formatMs(wallTimer.nsecsElapsed()));
+
+    return failed > 0 ? 1 : 0;
+}
@@ -9,14 +9,20 @@
 #include "NodeTemplate.h"
 #include "NodeEditDialog.h"
 #include "DraggableNodeTree.h"
+#include "Logging.h"
+#include "ProjectIO.h"
+#include "AutoLayout.h"
+#include "SceneNodeModel.h"
 
 #include <QDockWidget>
 #include <QTabWidget>
 #include <QToolBar>
 #include <QMenuBar>
+#include <QAction>
 #include <QStatusBar>
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
+#include <QTreeView>
 #include <QHeaderView>
 #include <QTextEdit>
 #include <QVBoxLayout>
@@ -29,12 +35,14 @@
 #include <QSpinBox>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QDir>
+#include <QInputDialog>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QApplication>
 #include <QFormLayout>
-#include <functional>
+#include <QProgressDialog>
 #include <QTextStream>
 #include <QStringConverter>
 
@@ -42,6 +50,8 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_scene(new NodeScene(this))
     , m_view(new NodeView(m_scene, this))
+    , m_projectIO(new ProjectIO(m_scene, this))
+    , m_autoLayout(new AutoLayout(m_scene, this))
 {
     setupUI();
     createMenus();
@@ -77,7 +87,7 @@ void MainWindow::createMenus()
 {
     // 文件菜单
     QMenu *fileMenu = menuBar()->addMenu("文件");
-    fileMenu->addAction("新建项目", this, &MainWindow::onClearCanvas, QKeySequence::New);
+    m_sceneEditActions << fileMenu->addAction("新建项目", this, &MainWindow::onClearCanvas, QKeySequence::New);
     fileMenu->addAction("打开项目", this, &MainWindow::onLoadProject, QKeySequence::Open);
     fileMenu->addAction("保存项目", this, &MainWindow::onSaveProject, QKeySequence::Save);
     fileMenu->addSeparator();
@@ -85,8 +95,8 @@ void MainWindow::createMenus()
     
     // 编辑菜单
     QMenu *editMenu = menuBar()->addMenu("编辑");
-    editMenu->addAction("撤销", [this]() { m_scene->undoStack()->undo(); }, QKeySequence::Undo);
-    editMenu->addAction("重做", [this]() { m_scene->undoStack()->redo(); }, QKeySequence::Redo);
+    editMenu->addAction("撤销", [this]() { m_scene->undo(); }, QKeySequence::Undo);
+    editMenu->addAction("重做", [this]() { m_scene->redo(); }, QKeySequence::Redo);
     editMenu->addSeparator();
     editMenu->addAction("复制", [this]() { m_scene->copySelected(); }, QKeySequence::Copy);
     editMenu->addAction("剪切", [this]() { m_scene->cutSelected(); }, QKeySequence::Cut);
@@ -114,8 +124,12 @@ void MainWindow::createMenus()
             statusBar()->showMessage("请选中一个组合节点进行拆分");
         }
     }, QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_G));
+    QMenu *layoutMenu = editMenu->addMenu("自动布局");
+    layoutMenu->addAction("分层布局", [this]() { startAutoLayout(false); }, QKeySequence(Qt::CTRL | Qt::Key_L));
+    layoutMenu->addAction("力导向布局", [this]() { startAutoLayout(true); });
     editMenu->addSeparator();
     editMenu->addAction("清空画布", this, &MainWindow::onClearCanvas);
+    m_sceneEditActions << editMenu->actions() << layoutMenu->actions();
     
     // 节点库菜单
     QMenu *nodeLibraryMenu = menuBar()->addMenu("节点库");
@@ -133,21 +147,94 @@ void MainWindow::createMenus()
     generateMenu->addAction("验证流程", [this]() {
         if (m_scene->validateFlow()) {
             statusBar()->showMessage("流程验证通过");
+        } else if (!m_scene->topology().isAcyclic()) {
+            QMessageBox::warning(this, "验证失败",
+                QString("流程图存在 %1 条形成环路的连接").arg(m_scene->topology().cyclicEdgeCount()));
         } else {
             QMessageBox::warning(this, "验证失败", "流程图存在错误");
         }
     });
     generateMenu->addAction("生成代码", this, &MainWindow::onGenerateCode);
+    generateMenu->addAction("流式处理设置...", [this]() {
+        bool ok = false;
+        int blockSize = QInputDialog::getInt(this, "流式处理",
+            "每块采样点数（0 = 整段处理）:", m_scene->blockSize(), 0, 1 << 24, 256, &ok);
+        if (ok) {
+            m_scene->setBlockSize(blockSize);
+            statusBar()->showMessage(blockSize > 0
+                ? QString("生成代码将按 %1 个采样点分块流式处理").arg(blockSize)
+                : QString("生成代码将按整段信号处理"));
+        }
+    });
+    QAction *instrumentAction = generateMenu->addAction("性能测量模式");
+    instrumentAction->setCheckable(true);
+    connect(instrumentAction, &QAction::toggled, this, [this, instrumentAction](bool checked) {
+        if (checked) {
+            bool ok = false;
+            int iterations = QInputDialog::getInt(this, "性能测量",
+                "计入统计的运行次数（另加 10% 预热）:", m_codeGenerator.benchmarkIterations(), 1, 1000000, 10, &ok);
+            if (!ok) {
+                instrumentAction->setChecked(false);
+                return;
+            }
+            m_codeGenerator.setBenchmarkIterations(iterations, qMax(1, iterations / 10));
+        }
+        m_codeGenerator.setInstrumentation(checked);
+        statusBar()->showMessage(checked
+            ? QString("导出的C++/Python代码将逐节点计时并写出 profile_report.json")
+            : QString("已关闭性能测量"));
+    });
+    // 增量生成需要手动开启：开启后导出的文件不含生成时间，图未变化的节点复用上次的片段
+    QAction *incrementalAction = generateMenu->addAction("增量生成");
+    incrementalAction->setCheckable(true);
+    connect(incrementalAction, &QAction::toggled, this, [this](bool checked) {
+        m_codeGenerator.setIncremental(checked);
+        statusBar()->showMessage(checked
+            ? QString("导出的代码不再写入生成时间，内容未变化的文件保持不变")
+            : QString("已关闭增量生成"));
+    });
+    generateMenu->addAction("加载性能报告...", [this]() {
+        QString fileName = QFileDialog::getOpenFileName(this, "加载性能报告", "", "性能报告 (*.json)");
+        if (fileName.isEmpty()) {
+            return;
+        }
+        if (m_scene->loadProfileReport(fileName)) {
+            statusBar()->showMessage(QString("已叠加性能报告 %1（橙色为关键路径）").arg(fileName));
+        } else {
+            QMessageBox::warning(this, "加载失败", "无法加载性能报告，或报告中没有与当前画布匹配的节点");
+        }
+    });
+    generateMenu->addAction("清除性能叠加", [this]() {
+        m_scene->clearProfile();
+        statusBar()->showMessage("已清除性能叠加");
+    });
     generateMenu->addSeparator();
     
     // 导出子菜单
     QMenu *exportMenu = generateMenu->addMenu("导出代码");
     exportMenu->addAction("导出为 JSON...", this, &MainWindow::onExportCodeAsJson);
+    exportMenu->addAction("导出为 C++...", this, &MainWindow::onExportCodeAsCpp);
+    exportMenu->addAction("导出为 C++ 工程...", this, &MainWindow::onExportCppProject);
     exportMenu->addAction("导出为 Python...", this, &MainWindow::onExportCodeAsPython);
     exportMenu->addAction("导出为 YAML...", this, &MainWindow::onExportCodeAsYaml);
     
     // 帮助菜单
     QMenu *helpMenu = menuBar()->addMenu("帮助");
+    QAction *traceAction = helpMenu->addAction("交互跟踪");
+    traceAction->setCheckable(true);
+    connect(traceAction, &QAction::toggled, this, [this](bool checked) {
+        Trace::setEnabled(checked);
+        statusBar()->showMessage(checked
+            ? QString("已开启交互跟踪，最近 %1 条事件保存在环形缓冲区中").arg(Trace::kCapacity)
+            : QString("已关闭交互跟踪"));
+    });
+    helpMenu->addAction("导出跟踪记录...", [this]() {
+        QString fileName = QFileDialog::getSaveFileName(this, "导出跟踪记录", "trace.tsv", "跟踪记录 (*.tsv *.txt)");
+        if (!fileName.isEmpty() && Trace::dump(fileName)) {
+            statusBar()->showMessage(QString("跟踪记录已导出到 %1").arg(fileName));
+        }
+    });
+    helpMenu->addSeparator();
     helpMenu->addAction("关于", []() {
         QMessageBox::about(qApp->activeWindow(), "关于", 
             "Qt节点编辑器 v1.0\n基于Qt6的可视化节点编辑工具");
@@ -158,7 +245,7 @@ void MainWindow::createToolBars()
 {
     QToolBar *mainToolBar = addToolBar("主工具栏");
     
-    mainToolBar->addAction("新建", this, &MainWindow::onClearCanvas);
+    m_sceneEditActions << mainToolBar->addAction("新建", this, &MainWindow::onClearCanvas);
     mainToolBar->addAction("保存", this, &MainWindow::onSaveProject);
     mainToolBar->addAction("加载", this, &MainWindow::onLoadProject);
     mainToolBar->addSeparator();
@@ -215,15 +302,18 @@ void MainWindow::createDockWidgets()
     QVBoxLayout *sceneNodeLayout = new QVBoxLayout(sceneNodeWidget);
     sceneNodeLayout->setContentsMargins(5, 5, 5, 5);
     
-    m_sceneNodeTree = new QTreeWidget();
-    m_sceneNodeTree->setHeaderLabel("绘图中的节点");
+    // 模型跟随场景中节点的增减逐行更新，组节点的内部节点在展开时才加载
+    m_sceneNodeModel = new SceneNodeModel(m_scene, this);
+    m_sceneNodeTree = new QTreeView();
+    m_sceneNodeTree->setModel(m_sceneNodeModel);
     m_sceneNodeTree->setContextMenuPolicy(Qt::CustomContextMenu);
     m_sceneNodeTree->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_sceneNodeTree->setUniformRowHeights(true);
     m_sceneNodeTree->setAnimated(true);
     m_sceneNodeTree->setExpandsOnDoubleClick(true);
     
     // 连接点击信号
-    connect(m_sceneNodeTree, &QTreeWidget::itemClicked, 
+    connect(m_sceneNodeTree, &QTreeView::clicked,
             this, &MainWindow::onSceneNodeTreeItemClicked);
     
     sceneNodeLayout->addWidget(m_sceneNodeTree);
@@ -352,7 +442,7 @@ void MainWindow::createDockWidgets()
                 QGraphicsItem *item = m_scene->getSelectedNode();
                 if (GroupNode *groupNode = dynamic_cast<GroupNode*>(item)) {
                     groupNode->setGroupLevel(value);
-                    updateSceneNodeTree();  // 更新场景节点树显示
+                    m_scene->notifyNodeChanged(groupNode);  // 更新场景节点树显示
                 }
             });
     
@@ -393,15 +483,33 @@ void MainWindow::setupConnections()
     
     connect(m_scene, &NodeScene::selectionChanged, this, &MainWindow::onNodeSelected);
     connect(m_scene, &NodeScene::connectionCreated, this, &MainWindow::onConnectionCreated);
+    connect(m_scene, &NodeScene::connectionRejected, this, [this](const QString &reason) {
+        statusBar()->showMessage(reason, 3000);
+    });
     
-    // 场景变化时更新节点树
-    connect(m_scene, &QGraphicsScene::changed, this, &MainWindow::updateSceneNodeTree);
+    // 项目读写结果显示在状态栏
+    connect(m_projectIO, &ProjectIO::finished, this, [this](bool, const QString &message) {
+        setSceneEditingEnabled(true);
+        statusBar()->showMessage(message);
+    });
+    connect(m_autoLayout, &AutoLayout::finished, this, [this](bool, const QString &message) {
+        statusBar()->showMessage(message);
+    });
     
     connect(m_updatePropsButton, &QPushButton::clicked, this, &MainWindow::onUpdateNodeProperties);
 }
 
 void MainWindow::onNodeSelected(QGraphicsItem* item)
 {
+    // 在场景节点树中选中对应的顶层节点（模型按节点直接查到行，不遍历树）
+    const QModelIndex treeIndex = m_sceneNodeModel->indexOf(dynamic_cast<Node*>(item));
+    if (treeIndex.isValid()) {
+        m_sceneNodeTree->setCurrentIndex(treeIndex);
+        m_sceneNodeTree->scrollTo(treeIndex);
+    } else {
+        m_sceneNodeTree->clearSelection();
+    }
+    
     // 清空连接关系树
     m_connectionTree->clear();
     m_selectedConnection = nullptr;
@@ -568,43 +676,132 @@ void MainWindow::onConnectionCreated()
 
 void MainWindow::onGenerateCode()
 {
-    CodeGenerator generator;
-    QString code = generator.generateCode(m_scene->getFlowData());
-    m_codeOutput->setPlainText(code);
+    configureExecution();
+    QString code = m_codeGenerator.generateCode(m_scene->getFlowData());
+    // 内容未变化时不重新排版输出框
+    if (m_codeOutput->toPlainText() != code) {
+        m_codeOutput->setPlainText(code);
+    }
     statusBar()->showMessage("代码生成完成");
 }
 
 void MainWindow::onSaveProject()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "保存项目", "", "节点项目文件 (*.json)");
+    const QString jsonFilter = "节点项目文件 (*.json)";
+    const QString binaryFilter = "二进制项目文件 (*.dagb)";
+    QString selectedFilter;
+    QString fileName = QFileDialog::getSaveFileName(this, "保存项目", "",
+        jsonFilter + ";;" + binaryFilter, &selectedFilter);
     if (!fileName.isEmpty()) {
-        QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly)) {
-            QJsonObject flowData = m_scene->getFlowData();
-            QJsonDocument doc(flowData);
-            file.write(doc.toJson());
-            statusBar()->showMessage("项目保存成功");
+        // 按扩展名选择格式：.dagb 为二进制格式，其余为JSON
+        if (selectedFilter == binaryFilter && !fileName.endsWith(".dagb")) {
+            fileName += ".dagb";
+        }
+        if (m_projectIO->save(fileName)) {
+            showProjectProgress("保存项目");
+        } else {
+            statusBar()->showMessage("已有项目读写任务在进行");
         }
     }
 }
 
 void MainWindow::onLoadProject()
 {
-    QString fileName = QFileDialog::getOpenFileName(this, "打开项目", "", "节点项目文件 (*.json)");
+    QString fileName = QFileDialog::getOpenFileName(this, "打开项目", "",
+        "节点项目文件 (*.json *.dagb);;所有文件 (*)");
     if (!fileName.isEmpty()) {
-        QFile file(fileName);
-        if (file.open(QIODevice::ReadOnly)) {
-            QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-            m_scene->loadFlowData(doc.object());
-            statusBar()->showMessage("项目加载成功");
+        if (m_projectIO->open(fileName)) {
+            setSceneEditingEnabled(false);
+            showProjectProgress("打开项目");
+        } else {
+            statusBar()->showMessage("已有项目读写任务在进行");
         }
     }
 }
 
+/**
+ * @brief 为正在进行的项目读写任务显示进度对话框
+ * @param title 对话框标题
+ * 
+ * 读写在工作线程中进行，对话框只阻止对主窗口的操作，界面仍正常绘制；
+ * 小文件在 minimumDuration 内完成时不会弹出对话框。
+ */
+void MainWindow::showProjectProgress(const QString &title)
+{
+    QProgressDialog *progress = new QProgressDialog(title, "取消", 0, 100, this);
+    progress->setWindowTitle(title);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    
+    connect(m_projectIO, &ProjectIO::progressChanged, progress, [progress](int percent, const QString &stage) {
+        if (!stage.isEmpty()) {
+            progress->setLabelText(stage);
+        }
+        progress->setValue(percent);
+    });
+    connect(progress, &QProgressDialog::canceled, m_projectIO, &ProjectIO::cancel);
+    connect(m_projectIO, &ProjectIO::finished, progress, &QProgressDialog::close);
+}
+
+/**
+ * @brief 启用或禁用对场景的编辑
+ * @param enabled 为false时用户无法修改场景
+ * 
+ * 进度对话框在 minimumDuration 之后才弹出，不能依赖它阻止操作。
+ */
+void MainWindow::setSceneEditingEnabled(bool enabled)
+{
+    m_view->setEnabled(enabled);
+    m_nodeLibrary->setEnabled(enabled);
+    m_updatePropsButton->setEnabled(enabled);
+    for (QAction *action : m_sceneEditActions) {
+        action->setEnabled(enabled);
+    }
+}
+
+/**
+ * @brief 开始自动布局并显示进度对话框
+ * @param forceDirected true 使用力导向布局，false 使用分层布局
+ * 
+ * 布局在工作线程中计算，取消时场景保持不变；完成后整个布局可以一次撤销。
+ */
+void MainWindow::startAutoLayout(bool forceDirected)
+{
+    AutoLayout::Options options;
+    options.algorithm = forceDirected ? AutoLayout::ForceDirected : AutoLayout::Layered;
+    if (!m_autoLayout->start(options)) {
+        statusBar()->showMessage(m_autoLayout->isBusy() ? "已有自动布局任务在进行" : "画布中没有节点");
+        return;
+    }
+    
+    QProgressDialog *progress = new QProgressDialog("自动布局", "取消", 0, 100, this);
+    progress->setWindowTitle("自动布局");
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    
+    connect(m_autoLayout, &AutoLayout::progressChanged, progress, [progress](int percent, const QString &stage) {
+        if (!stage.isEmpty()) {
+            progress->setLabelText(stage);
+        }
+        progress->setValue(percent);
+    });
+    connect(progress, &QProgressDialog::canceled, m_autoLayout, &AutoLayout::cancel);
+    connect(m_autoLayout, &AutoLayout::finished, progress, &QProgressDialog::close);
+}
+
 void MainWindow::onClearCanvas()
 {
     if (QMessageBox::question(this, "确认", "确定要清空画布吗？") == QMessageBox::Yes) {
-        m_scene->clear();
+        // clearFlow 同时清空撤销栈和各项索引，并通知场景节点树重置
+        m_scene->clearFlow();
+        m_selectedConnection = nullptr;
+        m_connectionTree->clear();
         m_codeOutput->clear();
         statusBar()->showMessage("画布已清空");
     }
@@ -623,6 +820,7 @@ void MainWindow::onUpdateNodeProperties()
         selectedNode->setName(m_nodeNameEdit->text());
         selectedNode->setType(m_nodeTypeCombo->currentData().toString());
         selectedNode->setParameters(m_nodeParamsEdit->text().split(',', Qt::SkipEmptyParts));
+        m_scene->notifyNodeChanged(selectedNode);
         m_scene->update();
         statusBar()->showMessage("节点属性已更新");
     }
@@ -734,8 +932,7 @@ void MainWindow::onLoadNodeLibrary()
     if (!fileName.isEmpty()) {
         if (NodeLibrary::instance()->loadFromFile(fileName)) {
             // 自动保存到默认路径以保持同步
-            NodeLibrary::instance()->saveToFile(
-                NodeLibrary::instance()->getDefaultLibraryPath());
+            NodeLibrary::instance()->scheduleSave();
             statusBar()->showMessage(QString("节点库已从 %1 导入").arg(fileName));
         } else {
             QMessageBox::warning(this, "导入失败", "无法加载节点库文件");
@@ -749,44 +946,38 @@ void MainWindow::refreshNodeLibrary()
     m_nodeLibrary->clear();
     m_nodeTemplates.clear();
     
-    // 从NodeLibrary获取所有分类
-    QStringList categories = NodeLibrary::instance()->getCategories();
-    
-    // 创建分类节点
-    QMap<QString, QTreeWidgetItem*> categoryItems;
-    for (const QString &category : categories) {
-        QTreeWidgetItem *categoryItem = new QTreeWidgetItem(m_nodeLibrary, {category});
+    // 按分类索引遍历模板，不复制模板列表
+    const NodeLibrary *library = NodeLibrary::instance();
+    const QMap<QString, QStringList> &categoryIndex = library->categoryIndex();
+    for (auto category = categoryIndex.constBegin(); category != categoryIndex.constEnd(); ++category) {
+        // 创建分类节点
+        QTreeWidgetItem *categoryItem = new QTreeWidgetItem(m_nodeLibrary, {category.key()});
         categoryItem->setExpanded(true);
-        categoryItems[category] = categoryItem;
-    }
-    
-    // 添加节点模板
-    QList<NodeTemplate> templates = NodeLibrary::instance()->getAllTemplates();
-    for (const NodeTemplate &tmpl : templates) {
-        QTreeWidgetItem *parentItem = categoryItems.value(tmpl.getCategory());
-        if (!parentItem) {
-            // 如果分类不存在，创建一个
-            parentItem = new QTreeWidgetItem(m_nodeLibrary, {tmpl.getCategory()});
-            parentItem->setExpanded(true);
-            categoryItems[tmpl.getCategory()] = parentItem;
-        }
         
-        QTreeWidgetItem *nodeItem = new QTreeWidgetItem(parentItem, {tmpl.getDisplayName()});
-        nodeItem->setData(0, Qt::UserRole, tmpl.getTypeId());
-        
-        // 设置节点颜色图标
-        QPixmap pixmap(16, 16);
-        pixmap.fill(tmpl.getColor());
-        nodeItem->setIcon(0, QIcon(pixmap));
-        
-        // 设置提示文本
-        QString tooltip = QString("类型: %1\n描述: %2")
-            .arg(tmpl.getTypeId())
-            .arg(tmpl.getDescription().isEmpty() ? "无" : tmpl.getDescription());
-        nodeItem->setToolTip(0, tooltip);
-        
-        // 更新模板映射
-        m_nodeTemplates[tmpl.getTypeId()] = tmpl.getDisplayName();
+        // 添加节点模板
+        for (const QString &typeId : category.value()) {
+            const NodeTemplate *tmpl = library->findTemplate(typeId);
+            if (!tmpl) {
+                continue;
+            }
+            
+            QTreeWidgetItem *nodeItem = new QTreeWidgetItem(categoryItem, {tmpl->getDisplayName()});
+            nodeItem->setData(0, Qt::UserRole, typeId);
+            
+            // 设置节点颜色图标
+            QPixmap pixmap(16, 16);
+            pixmap.fill(tmpl->getColor());
+            nodeItem->setIcon(0, QIcon(pixmap));
+            
+            // 设置提示文本
+            QString tooltip = QString("类型: %1\n描述: %2")
+                .arg(typeId)
+                .arg(tmpl->getDescription().isEmpty() ? "无" : tmpl->getDescription());
+            nodeItem->setToolTip(0, tooltip);
+            
+            // 更新模板映射
+            m_nodeTemplates[typeId] = tmpl->getDisplayName();
+        }
     }
     
     m_nodeLibrary->expandAll();
@@ -818,232 +1009,159 @@ void MainWindow::onExportCodeAsJson()
             fileName += ".json";
         }
         
-        QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            CodeGenerator generator;
-            QString code = generator.generateCode(m_scene->getFlowData());
-            QTextStream stream(&file);
-            stream.setEncoding(QStringConverter::Utf8);
-            stream << code;
-            file.close();
-            statusBar()->showMessage(QString("代码已导出到 %1").arg(fileName));
-        } else {
-            QMessageBox::warning(this, "导出失败", "无法创建文件");
-        }
+        configureExecution();
+        writeGeneratedFile(fileName, m_codeGenerator.generateCode(m_scene->getFlowData()), "代码");
     }
 }
 
-void MainWindow::onExportCodeAsPython()
+void MainWindow::configureExecution(bool templatePipeline, int maxWorkers)
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "导出Python代码",
-        "", "Python文件 (*.py);;所有文件 (*)");
+    m_codeGenerator.setTemplatePipeline(templatePipeline);
+    m_codeGenerator.setParallelExecution(maxWorkers != 1);
+    m_codeGenerator.setMaxWorkers(maxWorkers);
+}
+
+void MainWindow::writeGeneratedFile(const QString &fileName, const QString &code, const QString &description)
+{
+    bool written = false;
+    if (!CodeGenerator::writeFileIfChanged(fileName, code, &written)) {
+        QMessageBox::warning(this, "导出失败", "无法创建文件");
+        return;
+    }
     
-    if (!fileName.isEmpty()) {
-        if (!fileName.endsWith(".py")) {
-            fileName += ".py";
-        }
-        
-        QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            CodeGenerator generator;
-            QString code = generator.generatePythonCode(m_scene->getFlowData());
-            QTextStream stream(&file);
-            stream.setEncoding(QStringConverter::Utf8);
-            stream << code;
-            file.close();
-            statusBar()->showMessage(QString("Python代码已导出到 %1").arg(fileName));
-        } else {
-            QMessageBox::warning(this, "导出失败", "无法创建文件");
-        }
+    // 未变化的文件保持原样，下游构建系统不会重新编译
+    const QString fragments = m_codeGenerator.incremental()
+        ? QString("（复用 %1 个节点片段，重新生成 %2 个）")
+              .arg(m_codeGenerator.reusedFragmentCount()).arg(m_codeGenerator.emittedFragmentCount())
+        : QString();
+    if (written) {
+        statusBar()->showMessage(QString("%1已导出到 %2%3").arg(description, fileName, fragments));
+    } else {
+        statusBar()->showMessage(QString("%1没有变化，%2 保持不变%3").arg(description, fileName, fragments));
     }
 }
 
-void MainWindow::onExportCodeAsYaml()
+void MainWindow::onExportCodeAsCpp()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "导出YAML配置",
-        "", "YAML文件 (*.yaml *.yml);;所有文件 (*)");
+    QString fileName = QFileDialog::getSaveFileName(this, "导出C++代码",
+        "", "C++文件 (*.cpp);;所有文件 (*)");
     
     if (!fileName.isEmpty()) {
-        if (!fileName.endsWith(".yaml") && !fileName.endsWith(".yml")) {
-            fileName += ".yaml";
+        if (!fileName.endsWith(".cpp")) {
+            fileName += ".cpp";
         }
         
-        QFile file(fileName);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            CodeGenerator generator;
-            QString code = generator.generateConfigFile(m_scene->getFlowData());
-            QTextStream stream(&file);
-            stream.setEncoding(QStringConverter::Utf8);
-            stream << code;
-            file.close();
-            statusBar()->showMessage(QString("YAML配置已导出到 %1").arg(fileName));
-        } else {
-            QMessageBox::warning(this, "导出失败", "无法创建文件");
+        // 层级并行：同一依赖层级的节点并行执行；模板流水线：线性链生成编译期组合的类型
+        const QStringList backends = {"层级并行", "模板流水线"};
+        bool ok = false;
+        const QString backend = QInputDialog::getItem(this, "代码生成方式",
+            "C++后端:", backends, 0, false, &ok);
+        if (!ok) {
+            return;
         }
+        const bool templatePipeline = backend == backends.at(1);
+        
+        // 0表示运行时使用全部硬件线程
+        int maxWorkers = 1;
+        if (!templatePipeline) {
+            maxWorkers = QInputDialog::getInt(this, "并行执行",
+                "最大工作线程数（0 = 自动，1 = 顺序执行）:", 0, 0, 1024, 1, &ok);
+            if (!ok) {
+                return;
+            }
+        }
+        
+        configureExecution(templatePipeline, maxWorkers);
+        writeGeneratedFile(fileName, m_codeGenerator.generateCppCode(m_scene->getFlowData()), "C++代码");
     }
 }
 
-// 辅助函数：递归添加节点到树
-static void addNodeToTree(QTreeWidgetItem *parentItem, Node *node, int depth, QSet<QString> &expandedItems)
+void MainWindow::onExportCppProject()
 {
-    QTreeWidgetItem *nodeItem = new QTreeWidgetItem();
-    
-    // 缩进前缀
-    QString indent = "";
-    for (int i = 0; i < depth; ++i) {
-        indent += "  ";
+    QString dirName = QFileDialog::getExistingDirectory(this, "导出C++工程到目录");
+    if (dirName.isEmpty()) {
+        return;
     }
-    if (depth > 0) {
-        indent += "├─ ";
+    
+    bool ok = false;
+    int maxWorkers = QInputDialog::getInt(this, "并行执行",
+        "最大工作线程数（0 = 自动，1 = 顺序执行）:", 0, 0, 1024, 1, &ok);
+    if (!ok) {
+        return;
     }
     
-    // 检查是否为组节点
-    GroupNode *groupNode = dynamic_cast<GroupNode*>(node);
-    
-    if (groupNode) {
-        // 组节点 - 使用特殊图标和样式，显示等级
-        QString displayName = QString("%1📦 %2 [Lv.%3]").arg(indent).arg(node->getName()).arg(groupNode->getGroupLevel());
-        nodeItem->setText(0, displayName);
-        nodeItem->setToolTip(0, QString("组合节点: %1\n组件等级: %2\n包含 %3 个内部节点\n嵌套深度: %4")
-                            .arg(node->getName())
-                            .arg(groupNode->getGroupLevel())
-                            .arg(groupNode->getInternalNodes().size())
-                            .arg(depth));
-        nodeItem->setForeground(0, QColor(100, 149, 237));  // 蓝色
-        
-        // 递归添加内部节点作为子项
-        for (Node *internalNode : groupNode->getInternalNodes()) {
-            addNodeToTree(nodeItem, internalNode, depth + 1, expandedItems);
+    configureExecution(false, maxWorkers);
+    const QMap<QString, QString> files = m_codeGenerator.generateCppProject(m_scene->getFlowData());
+    
+    // 只改写内容变化的文件，未变化的编译单元不会被重新编译
+    const QDir dir(dirName);
+    int writtenCount = 0;
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        bool written = false;
+        if (!CodeGenerator::writeFileIfChanged(dir.filePath(it.key()), it.value(), &written)) {
+            QMessageBox::warning(this, "导出失败", QString("无法创建文件 %1").arg(it.key()));
+            return;
         }
-        
-        // 恢复展开状态
-        if (expandedItems.contains(displayName)) {
-            nodeItem->setExpanded(true);
-        }
-    } else {
-        // 普通节点
-        QString displayType = node->getDisplayTypeName();
-        if (displayType.isEmpty()) {
-            displayType = node->getType();
-        }
-        nodeItem->setText(0, QString("%1● %2").arg(indent).arg(node->getName()));
-        nodeItem->setToolTip(0, QString("节点: %1\n类型: %2")
-                            .arg(node->getName())
-                            .arg(displayType));
-        
-        // 根据深度设置颜色
-        if (depth == 0) {
-            nodeItem->setForeground(0, QColor(81, 207, 102));  // 绿色（顶层）
-        } else {
-            nodeItem->setForeground(0, QColor(150, 180, 150));  // 浅绿色（内部）
+        if (written) {
+            ++writtenCount;
         }
     }
-    
-    // 存储节点指针
-    nodeItem->setData(0, Qt::UserRole, reinterpret_cast<quintptr>(node));
-    nodeItem->setData(0, Qt::UserRole + 1, depth > 0);  // 标记是否为内部节点
-    
-    if (parentItem) {
-        parentItem->addChild(nodeItem);
-    }
+    // 已删除或重命名节点遗留的阶段文件
+    const QStringList removed = CodeGenerator::removeStaleStageFiles(dirName, files);
+    statusBar()->showMessage(QString("C++工程已导出到 %1：共 %2 个文件，更新 %3 个，删除过期文件 %4 个")
+        .arg(dirName).arg(files.size()).arg(writtenCount).arg(removed.size()));
 }
 
-/**
- * @brief 更新场景节点树显示
- * 
- * 遍历场景中的所有节点，构建树形视图
- * 支持多层嵌套的组节点递归显示
- */
-void MainWindow::updateSceneNodeTree()
+void MainWindow::onExportCodeAsPython()
 {
-    // 保存当前展开状态（递归收集）
-    QSet<QString> expandedItems;
-    std::function<void(QTreeWidgetItem*)> collectExpanded = [&](QTreeWidgetItem *item) {
-        if (item->isExpanded()) {
-            expandedItems.insert(item->text(0));
+    QString fileName = QFileDialog::getSaveFileName(this, "导出Python代码",
+        "", "Python文件 (*.py);;所有文件 (*)");
+    
+    if (!fileName.isEmpty()) {
+        if (!fileName.endsWith(".py")) {
+            fileName += ".py";
         }
-        for (int i = 0; i < item->childCount(); ++i) {
-            collectExpanded(item->child(i));
+        
+        // 同一依赖层级的节点提交到线程池，与C++导出的选项互不影响
+        bool ok = false;
+        int maxWorkers = QInputDialog::getInt(this, "并行执行",
+            "最大工作线程数（0 = 自动，1 = 顺序执行）:", 0, 0, 1024, 1, &ok);
+        if (!ok) {
+            return;
         }
-    };
-    for (int i = 0; i < m_sceneNodeTree->topLevelItemCount(); ++i) {
-        collectExpanded(m_sceneNodeTree->topLevelItem(i));
+        
+        configureExecution(false, maxWorkers);
+        writeGeneratedFile(fileName, m_codeGenerator.generatePythonCode(m_scene->getFlowData()), "Python代码");
     }
+}
+
+void MainWindow::onExportCodeAsYaml()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "导出YAML配置",
+        "", "YAML文件 (*.yaml *.yml);;所有文件 (*)");
     
-    m_sceneNodeTree->clear();
-    
-    // 获取场景中的所有节点
-    QList<Node*> &nodes = m_scene->getNodes();
-    
-    for (Node *node : nodes) {
-        QTreeWidgetItem *nodeItem = new QTreeWidgetItem();
-        
-        // 检查是否为组节点
-        GroupNode *groupNode = dynamic_cast<GroupNode*>(node);
-        
-        if (groupNode) {
-            // 组节点 - 使用特殊图标和样式，显示等级
-            QString displayName = QString("📦 %1 [Lv.%2]").arg(node->getName()).arg(groupNode->getGroupLevel());
-            nodeItem->setText(0, displayName);
-            nodeItem->setToolTip(0, QString("组合节点: %1\n组件等级: %2\n包含 %3 个内部节点")
-                                .arg(node->getName())
-                                .arg(groupNode->getGroupLevel())
-                                .arg(groupNode->getInternalNodes().size()));
-            nodeItem->setForeground(0, QColor(100, 149, 237));  // 蓝色
-            
-            // 递归添加内部节点作为子项
-            for (Node *internalNode : groupNode->getInternalNodes()) {
-                addNodeToTree(nodeItem, internalNode, 1, expandedItems);
-            }
-            
-            // 恢复展开状态
-            if (expandedItems.contains(displayName)) {
-                nodeItem->setExpanded(true);
-            }
-        } else {
-            // 普通节点
-            QString displayType = node->getDisplayTypeName();
-            if (displayType.isEmpty()) {
-                displayType = node->getType();
-            }
-            nodeItem->setText(0, QString("● %1").arg(node->getName()));
-            nodeItem->setToolTip(0, QString("节点: %1\n类型: %2")
-                                .arg(node->getName())
-                                .arg(displayType));
-            nodeItem->setForeground(0, QColor(81, 207, 102));  // 绿色
+    if (!fileName.isEmpty()) {
+        if (!fileName.endsWith(".yaml") && !fileName.endsWith(".yml")) {
+            fileName += ".yaml";
         }
         
-        // 存储节点指针
-        nodeItem->setData(0, Qt::UserRole, reinterpret_cast<quintptr>(node));
-        nodeItem->setData(0, Qt::UserRole + 1, false);  // 标记为非内部节点
-        
-        m_sceneNodeTree->addTopLevelItem(nodeItem);
+        configureExecution();
+        writeGeneratedFile(fileName, m_codeGenerator.generateConfigFile(m_scene->getFlowData()), "YAML配置");
     }
-    
-    // 更新标题显示节点数量
-    m_sceneNodeTree->setHeaderLabel(QString("绘图中的节点 (%1)").arg(nodes.size()));
 }
 
 /**
  * @brief 场景节点树项被点击时的处理
- * @param item 被点击的树项
- * @param column 列索引
+ * @param index 被点击的模型索引
  * 
  * 点击树项时，在场景中选中并定位到对应节点
  */
-void MainWindow::onSceneNodeTreeItemClicked(QTreeWidgetItem *item, int column)
+void MainWindow::onSceneNodeTreeItemClicked(const QModelIndex &index)
 {
-    Q_UNUSED(column);
-    
-    if (!item) return;
-    
-    // 获取存储的节点指针
-    quintptr ptr = item->data(0, Qt::UserRole).toULongLong();
-    bool isInternalNode = item->data(0, Qt::UserRole + 1).toBool();
-    
-    if (ptr == 0) return;
+    Node *node = m_sceneNodeModel->nodeAt(index);
+    if (!node) return;
     
-    Node *node = reinterpret_cast<Node*>(ptr);
+    bool isInternalNode = index.data(SceneNodeModel::InternalNodeRole).toBool();
     
     // 如果是内部节点，提示用户
     if (isInternalNode) {
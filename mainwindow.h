@@ -11,19 +11,26 @@
 
 #include <QMainWindow>       // Qt主窗口基类
 #include <QMap>              // Qt映射容器
+#include <QList>             // Qt列表容器
 #include <QGraphicsScene>    // Qt图形场景
+#include "CodeGenerator.h"    // 代码生成器类
 
 // 前向声明
 class NodeScene;            // 节点场景类
 class NodeView;             // 节点视图类
+class ProjectIO;            // 项目文件异步读写类
+class AutoLayout;           // 自动布局类
 class QGraphicsScene;       // 图形场景类
 class QTreeWidget;          // 树形控件类
+class QTreeView;            // 树形视图类
+class SceneNodeModel;       // 场景节点树模型类
 class DraggableNodeTree;    // 可拖拽节点树控件类
 class QTreeWidgetItem;      // 树形项类
 class QTextEdit;            // 文本编辑控件类
 class QLineEdit;            // 单行输入框类
 class QComboBox;            // 下拉框类
 class QPushButton;          // 按钮类
+class QAction;              // 动作类
 
 /**
  * @class MainWindow
@@ -145,6 +152,16 @@ private slots:
      */
     void onExportCodeAsJson();
     
+    /**
+     * @brief 导出生成代码为C++源文件槽函数
+     */
+    void onExportCodeAsCpp();
+    
+    /**
+     * @brief 导出多文件C++工程槽函数（每个节点一个编译单元）
+     */
+    void onExportCppProject();
+    
     /**
      * @brief 导出生成代码为Python格式槽函数
      */
@@ -155,17 +172,11 @@ private slots:
      */
     void onExportCodeAsYaml();
     
-    /**
-     * @brief 更新场景节点树显示槽函数
-     */
-    void updateSceneNodeTree();
-    
     /**
      * @brief 场景节点树项被点击时的槽函数
-     * @param item 被点击的树项
-     * @param column 列索引
+     * @param index 被点击的模型索引
      */
-    void onSceneNodeTreeItemClicked(QTreeWidgetItem *item, int column);
+    void onSceneNodeTreeItemClicked(const QModelIndex &index);
 
 private:
     /**
@@ -193,9 +204,49 @@ private:
      */
     void setupConnections();
     
+    /**
+     * @brief 写入导出的代码文件，内容未变化时保持文件不动
+     * @param fileName 文件路径
+     * @param code 文件内容
+     * @param description 状态栏中显示的导出内容描述
+     */
+    void writeGeneratedFile(const QString &fileName, const QString &code, const QString &description);
+    
+    /**
+     * @brief 设置本次导出的执行方式，每次导出前调用，上一次导出的选项不会带入
+     * @param templatePipeline 是否使用模板流水线后端
+     * @param maxWorkers 最大工作线程数，0表示自动，1表示顺序执行
+     */
+    void configureExecution(bool templatePipeline = false, int maxWorkers = 0);
+    
+    /**
+     * @brief 为正在进行的项目读写任务显示进度对话框
+     * @param title 对话框标题
+     */
+    void showProjectProgress(const QString &title);
+    
+    /**
+     * @brief 启用或禁用对场景的编辑（画布、编辑菜单、新建和节点库）
+     * @param enabled 为false时用户无法修改场景
+     *
+     * 打开项目时场景分块导入、期间会回到事件循环，导入结束前禁止编辑，
+     * 否则删除、撤销或清空会释放导入过程仍在引用的节点。
+     */
+    void setSceneEditingEnabled(bool enabled);
+    
+    /**
+     * @brief 开始自动布局场景中的所有节点，并显示进度对话框
+     * @param forceDirected true 使用力导向布局，false 使用分层布局
+     */
+    void startAutoLayout(bool forceDirected);
+    
     // 核心组件
     NodeScene *m_scene;        // 节点场景，管理所有节点和连接
     NodeView *m_view;          // 节点视图，显示场景内容
+    CodeGenerator m_codeGenerator; // 代码生成器，跨多次生成保留节点片段缓存（启用增量生成时）
+    ProjectIO *m_projectIO;    // 项目文件异步读写
+    AutoLayout *m_autoLayout;  // 后台自动布局
+    QList<QAction*> m_sceneEditActions; // 修改场景的菜单和工具栏动作，导入项目期间禁用
     
     // UI界面组件
     DraggableNodeTree *m_nodeLibrary;  // 节点库树形控件（支持拖拽）
@@ -223,7 +274,8 @@ private:
     QMap<QString, QString> m_nodeTemplates;  // 节点类型到显示名称的映射
     
     // 场景节点树浏览
-    QTreeWidget *m_sceneNodeTree;  // 场景节点树控件
+    QTreeView *m_sceneNodeTree;          // 场景节点树视图
+    SceneNodeModel *m_sceneNodeModel;    // 场景节点树模型
     
     // 组节点属性编辑
     QWidget *m_groupPropsWidget;   // 组节点属性组件容器
@@ -0,0 +1,112 @@
+/**
+ * @file tst_pipelinefft.cpp
+ * @brief 模板流水线后端FFT长度测试：生成的代码在允许的各个FFT长度下都能编译运行
+ * @author
+ * @version 1.0.0
+ * @date 2024
+ *
+ * 编译器由环境变量 CXX 指定，未设置时使用 c++；找不到编译器时跳过测试。
+ */
+
+#include "CodeGenerator.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class PipelineFftTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void compileAndRun_data();
+    void compileAndRun();
+
+private:
+    /**
+     * @brief 构造 信号源 → FFT → 输出 的流程图
+     * @param size FFT长度参数
+     * @return 流程图JSON
+     */
+    static QJsonObject fftFlow(int size);
+};
+
+QJsonObject PipelineFftTest::fftFlow(int size)
+{
+    auto node = [](const QString &id, const QString &type, const QStringList &parameters) {
+        QJsonObject object;
+        object["id"] = id;
+        object["type"] = type;
+        object["name"] = id;
+        object["parameters"] = QJsonArray::fromStringList(parameters);
+        return object;
+    };
+    auto connection = [](const QString &from, const QString &to) {
+        QJsonObject object;
+        object["from"] = from;
+        object["to"] = to;
+        object["fromPort"] = 0;
+        object["toPort"] = 0;
+        return object;
+    };
+
+    QJsonObject flow;
+    flow["nodes"] = QJsonArray{
+        node("n1", "signal_source", {}),
+        node("n2", "fft", {QString("size=%1").arg(size)}),
+        node("n3", "sink", {})
+    };
+    flow["connections"] = QJsonArray{connection("n1", "n2"), connection("n2", "n3")};
+    return flow;
+}
+
+void PipelineFftTest::compileAndRun_data()
+{
+    QTest::addColumn<int>("size");
+
+    // 最小长度、编译期计算表的最大长度、首次执行时计算表的长度、允许的最大长度
+    QTest::newRow("2") << 2;
+    QTest::newRow("1024") << 1024;
+    QTest::newRow("2048") << 2048;
+    QTest::newRow("65536") << 65536;
+}
+
+void PipelineFftTest::compileAndRun()
+{
+    QFETCH(int, size);
+
+    const QString compiler = qEnvironmentVariable("CXX", "c++");
+    if (QStandardPaths::findExecutable(compiler).isEmpty()) {
+        QSKIP("找不到C++编译器");
+    }
+
+    CodeGenerator generator;
+    generator.setTemplatePipeline(true);
+    const QString code = generator.generateCppCode(fftFlow(size));
+    QVERIFY(code.contains(QString("static constexpr size_t size = %1;").arg(size)));
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile source(dir.filePath("flow.cpp"));
+    QVERIFY(source.open(QIODevice::WriteOnly));
+    source.write(code.toUtf8());
+    source.close();
+
+    QProcess compile;
+    compile.setProcessChannelMode(QProcess::MergedChannels);
+    compile.start(compiler, {"-std=c++17", "-O1", "-o", dir.filePath("flow"), source.fileName()});
+    QVERIFY(compile.waitForFinished(300000));
+    QVERIFY2(compile.exitCode() == 0, compile.readAll().constData());
+
+    QProcess run;
+    run.start(dir.filePath("flow"));
+    QVERIFY(run.waitForFinished(60000));
+    QCOMPARE(run.exitCode(), 0);
+}
+
+QTEST_APPLESS_MAIN(PipelineFftTest)
+
+#include "tst_pipelinefft.moc"
@@ -0,0 +1,23 @@
+# 模板流水线后端的生成代码编译测试：生成代码后调用系统C++编译器编译并运行
+QT = core testlib
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+
+TARGET = tst_pipelinefft
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../BufferPlanner.cpp \
+    ../../CodeGenerator.cpp \
+    ../../FlowScheduler.cpp \
+    tst_pipelinefft.cpp
+
+HEADERS += \
+    ../../BufferPlanner.h \
+    ../../CodeGenerator.h \
+    ../../FlowScheduler.h
+
+# 生成代码嵌入的 PipelineStages.h 来自资源
+RESOURCES += \
+    ../../resources.qrc